@@ -59,8 +59,8 @@ PyAPI_FUNC(int) PyModule_ExecDef(PyObject *module, PyModuleDef *def);
 
 #define Py_CLEANUP_SUPPORTED 0x20000
 
-#define PYTHON_API_VERSION 1013
-#define PYTHON_API_STRING "1013"
+#define PYTHON_API_VERSION 1014
+#define PYTHON_API_STRING "1014"
 /* The API version is maintained (independently from the Python version)
    so we can detect mismatches between the interpreter and dynamically
    loaded modules.  These are diagnosed by an error message but
@@ -74,6 +74,9 @@ PyAPI_FUNC(int) PyModule_ExecDef(PyObject *module, PyModuleDef *def);
    Please add a line or two to the top of this log for each API
    version change:
 
+   19-Oct-2026          1014    wstr moved from PyASCIIObject to
+                                PyCompactUnicodeObject; new state bits
+
    22-Feb-2006  MvL     1013    PEP 353 - long indices for sequence lengths
 
    19-Aug-2002  GvR     1012    Changes to string object struct for
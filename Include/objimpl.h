@@ -229,6 +229,7 @@ PyAPI_FUNC(Py_ssize_t) PyGC_Collect(void);
 
 #ifndef Py_LIMITED_API
 PyAPI_FUNC(Py_ssize_t) _PyGC_CollectNoFail(void);
+PyAPI_FUNC(int) _PyGC_VisitTracked(visitproc visit, void *arg);
 #endif
 
 /* Test if a type has a GC head */
@@ -316,10 +317,13 @@ extern PyGC_Head *_PyGC_generation0;
     (_PyGC_REFS(o) != _PyGC_REFS_UNTRACKED)
 
 /* True if the object may be tracked by the GC in the future, or already is.
-   This can be useful to implement some optimizations. */
+   This can be useful to implement some optimizations.  Untracked tuples and
+   frozensets are immutable and hold only atomic objects, so they are never
+   tracked again. */
 #define _PyObject_GC_MAY_BE_TRACKED(obj) \
     (PyObject_IS_GC(obj) && \
-        (!PyTuple_CheckExact(obj) || _PyObject_GC_IS_TRACKED(obj)))
+        ((!PyTuple_CheckExact(obj) && !PyFrozenSet_CheckExact(obj)) || \
+         _PyObject_GC_IS_TRACKED(obj)))
 #endif /* Py_LIMITED_API */
 
 PyAPI_FUNC(PyObject *) _PyObject_GC_Malloc(size_t size);
@@ -0,0 +1,45 @@
+#ifndef Py_PYCPU_H
+#define Py_PYCPU_H
+#ifndef Py_LIMITED_API
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Support for code paths specialized for instruction set extensions which
+   may or may not be available on the CPU running the interpreter.
+
+   When Py_CPU_DISPATCH is defined, a function can be compiled for a given
+   extension by prefixing it with the matching Py_TARGET_xxx attribute, and
+   must only be called when _Py_CPU_HAS() reports the extension as usable.
+   Such functions should include the intrinsics headers themselves.
+
+   Only GCC on x86-64 is supported for now; SSE2 is always available
+   there and needs no dispatch. */
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#define Py_CPU_DISPATCH 1
+#define Py_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define Py_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/* Flags of _Py_cpu_features */
+#define _Py_CPU_SSE42       (1 << 0)
+#define _Py_CPU_AVX2        (1 << 1)
+
+/* Extensions usable by the running interpreter; 0 until _PyCpu_Init() has
+   been called, so early code simply uses the generic code paths. */
+PyAPI_DATA(int) _Py_cpu_features;
+
+#define _Py_CPU_HAS(feature) ((_Py_cpu_features & (feature)) != 0)
+
+/* Number of CPUs online when the interpreter started, at least 1. */
+PyAPI_DATA(int) _Py_cpu_count;
+
+PyAPI_FUNC(void) _PyCpu_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* !Py_LIMITED_API */
+#endif /* !Py_PYCPU_H */
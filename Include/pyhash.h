@@ -36,14 +36,14 @@ PyAPI_FUNC(Py_hash_t) _Py_HashBytes(const void*, Py_ssize_t);
  * memory layout on 64 bit systems
  *   cccccccc cccccccc cccccccc  uc -- unsigned char[24]
  *   pppppppp ssssssss ........  fnv -- two Py_hash_t
- *   k0k0k0k0 k1k1k1k1 ........  siphash -- two PY_UINT64_T
+ *   k0k0k0k0 k1k1k1k1 ........  siphash24 and siphash13 -- two PY_UINT64_T
  *   ........ ........ ssssssss  djbx33a -- 16 bytes padding + one Py_hash_t
  *   ........ ........ eeeeeeee  pyexpat XML hash salt
  *
  * memory layout on 32 bit systems
  *   cccccccc cccccccc cccccccc  uc
  *   ppppssss ........ ........  fnv -- two Py_hash_t
- *   k0k0k0k0 k1k1k1k1 ........  siphash -- two PY_UINT64_T (*)
+ *   k0k0k0k0 k1k1k1k1 ........  siphash24 and siphash13 -- two PY_UINT64_T (*)
  *   ........ ........ ssss....  djbx33a -- 16 bytes padding + one Py_hash_t
  *   ........ ........ eeee....  pyexpat XML hash salt
  *
@@ -60,7 +60,7 @@ typedef union {
         Py_hash_t suffix;
     } fnv;
 #ifdef PY_UINT64_T
-    /* two uint64 for SipHash24 */
+    /* two uint64 for SipHash24 and SipHash13 */
     struct {
         PY_UINT64_T k0;
         PY_UINT64_T k1;
@@ -117,12 +117,15 @@ PyAPI_FUNC(PyHash_FuncDef*) PyHash_GetFuncDef(void);
 
 /* hash algorithm selection
  *
- * The values for Py_HASH_SIPHASH24 and Py_HASH_FNV are hard-coded in the
- * configure script.
+ * The values for Py_HASH_SIPHASH24, Py_HASH_FNV and Py_HASH_SIPHASH13 are
+ * hard-coded in the configure script.  Py_HASH_ALGORITHM is the default;
+ * the PYTHONHASHALGORITHM environment variable can select another of the
+ * available functions at startup.
  *
  * - FNV is available on all platforms and architectures.
- * - SIPHASH24 only works on plaforms that provide PY_UINT64_T and doesn't
- *   require aligned memory for integers.
+ * - SIPHASH24 and SIPHASH13 only work on plaforms that provide PY_UINT64_T
+ *   and don't require aligned memory for integers.  SIPHASH13 does fewer
+ *   rounds, so it is faster on long strings.
  * - With EXTERNAL embedders can provide an alternative implementation with::
  *
  *     PyHash_FuncDef PyHash_Func = {...};
@@ -132,6 +135,7 @@ PyAPI_FUNC(PyHash_FuncDef*) PyHash_GetFuncDef(void);
 #define Py_HASH_EXTERNAL 0
 #define Py_HASH_SIPHASH24 1
 #define Py_HASH_FNV 2
+#define Py_HASH_SIPHASH13 3
 
 #ifndef Py_HASH_ALGORITHM
 #  if (defined(PY_UINT64_T) && defined(PY_UINT32_T) \
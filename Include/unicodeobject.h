@@ -213,7 +213,10 @@ extern "C" {
 /* ASCII-only strings created through PyUnicode_New use the PyASCIIObject
    structure. state.ascii and state.compact are set, and the data
    immediately follow the structure. utf8_length and wstr_length can be found
-   in the length field; the utf8 pointer is equal to the data pointer. */
+   in the length field; the utf8 pointer is equal to the data pointer.
+   PyASCIIObject has no wstr pointer: the wchar_t representation of a compact
+   ASCII string, rarely needed, is stored outside of the object.  Changing
+   this layout again requires a new ABI tag (SOABI in configure.ac). */
 typedef struct {
     /* There are 4 forms of Unicode strings:
 
@@ -228,6 +231,9 @@ typedef struct {
          * (length is the length of the utf8 and wstr strings)
          * (data starts just after the structure)
          * (since ASCII is decoded from UTF-8, the utf8 string are the data)
+         * (wstr, created by PyUnicode_AsUnicode(), is kept in a table
+           indexed by the address of the string; ascii_wstr = 1 if it
+           exists)
 
        - compact:
 
@@ -272,12 +278,19 @@ typedef struct {
          * ready = 1
          * data.any is not NULL
          * utf8 is shared and utf8_length = length with data.any if ascii = 1
+           and shared = 0
          * utf8_length = 0 if utf8 is NULL
          * wstr is shared with data.any and wstr_length = length
            if kind=PyUnicode_2BYTE_KIND and sizeof(wchar_t)=2
-           or if kind=PyUnicode_4BYTE_KIND and sizeof(wchar_4)=4
+           or if kind=PyUnicode_4BYTE_KIND and sizeof(wchar_4)=4,
+           and shared = 0
          * wstr_length = 0 if wstr is NULL
 
+       Strings built by appending to a string which cannot be resized in
+       place (see PyUnicode_Append()) are non-compact strings with
+       shared = 1: data.any points into an over-allocated buffer which
+       other strings may share.
+
        Compact strings use only one memory block (structure + characters),
        whereas legacy strings use one block for the structure and one block
        for characters.
@@ -343,11 +356,23 @@ typedef struct {
            the data pointer is filled out. The bit is redundant, and helps
            to minimize the test in PyUnicode_IS_READY(). */
         unsigned int ready:1;
+        /* The characters of a non-compact string are stored in an append
+           buffer shared with other strings, which are prefixes or
+           extensions of it.  The characters are not null-terminated, and
+           neither utf8 nor wstr share memory with them. */
+        unsigned int shared:1;
+        /* A compact ASCII string has a wchar_t representation, stored
+           outside of the object (see PyUnicode_AsUnicode()). */
+        unsigned int ascii_wstr:1;
+        /* The characters of a non-compact UCS1 string are the buffer of
+           a bytes object, which the string holds (see
+           PyUnicode_FromEncodedObject()).  Neither utf8 nor wstr share
+           memory with them. */
+        unsigned int view:1;
         /* Padding to ensure that PyUnicode_DATA() is always aligned to
            4 bytes (see issue #19537 on m68k). */
-        unsigned int :24;
+        unsigned int :21;
     } state;
-    wchar_t *wstr;              /* wchar_t representation (null-terminated) */
 } PyASCIIObject;
 
 /* Non-ASCII strings allocated through PyUnicode_New use the
@@ -355,6 +380,7 @@ typedef struct {
    immediately follow the structure. */
 typedef struct {
     PyASCIIObject _base;
+    wchar_t *wstr;              /* wchar_t representation (null-terminated) */
     Py_ssize_t utf8_length;     /* Number of bytes in utf8, excluding the
                                  * terminating \0. */
     char *utf8;                 /* UTF-8 representation (null-terminated) */
@@ -398,10 +424,11 @@ PyAPI_DATA(PyTypeObject) PyUnicodeIter_Type;
 
 #define PyUnicode_GET_SIZE(op)                       \
     (assert(PyUnicode_Check(op)),                    \
-     (((PyASCIIObject *)(op))->wstr) ?               \
+     (PyUnicode_IS_COMPACT_ASCII(op) ||              \
+      ((PyCompactUnicodeObject *)(op))->wstr) ?      \
       PyUnicode_WSTR_LENGTH(op) :                    \
       ((void)PyUnicode_AsUnicode((PyObject *)(op)),  \
-       assert(((PyASCIIObject *)(op))->wstr),        \
+       assert(((PyCompactUnicodeObject *)(op))->wstr), \
        PyUnicode_WSTR_LENGTH(op)))
 
 #define PyUnicode_GET_DATA_SIZE(op) \
@@ -414,7 +441,9 @@ PyAPI_DATA(PyTypeObject) PyUnicodeIter_Type;
 
 #define PyUnicode_AS_UNICODE(op) \
     (assert(PyUnicode_Check(op)), \
-     (((PyASCIIObject *)(op))->wstr) ? (((PyASCIIObject *)(op))->wstr) : \
+     (!PyUnicode_IS_COMPACT_ASCII(op) && \
+      ((PyCompactUnicodeObject *)(op))->wstr) ? \
+      ((PyCompactUnicodeObject *)(op))->wstr : \
       PyUnicode_AsUnicode((PyObject *)(op)))
 
 #define PyUnicode_AS_DATA(op) \
@@ -1002,6 +1031,9 @@ PyAPI_FUNC(PyObject *) PyUnicode_InternFromString(
     );
 #ifndef Py_LIMITED_API
 PyAPI_FUNC(void) _Py_ReleaseInternedUnicodeStrings(void);
+
+/* Merge the equal strings held by code objects (sys.dedup_strings()) */
+PyAPI_FUNC(PyObject *) _PyUnicode_DedupStrings(void);
 #endif
 
 /* Use only if you know it's a string */
@@ -2252,6 +2284,8 @@ PyAPI_FUNC(int) _PyUnicode_CheckConsistency(
 PyAPI_FUNC(PyObject*) _PyUnicode_FromId(_Py_Identifier*);
 /* Clear all static strings. */
 PyAPI_FUNC(void) _PyUnicode_ClearStaticStrings(void);
+/* Clear the cache of compiled format strings (sys._clear_type_cache()) */
+PyAPI_FUNC(void) _PyUnicode_ClearFormatCache(void);
 
 #ifdef __cplusplus
 }
@@ -39,7 +39,7 @@ BlockingIOError = BlockingIOError
 
 
 def open(file, mode="r", buffering=-1, encoding=None, errors=None,
-         newline=None, closefd=True, opener=None):
+         newline=None, closefd=True, opener=None, mmap=False, readahead=0):
 
     r"""Open file and return a stream.  Raise OSError upon failure.
 
@@ -147,6 +147,15 @@ def open(file, mode="r", buffering=-1, encoding=None, errors=None,
     descriptor (passing os.open as *opener* results in functionality similar to
     passing None).
 
+    If mmap is true, a file opened for reading is memory-mapped when it is a
+    regular file larger than the buffer, and reads are served from the mapping
+    instead of read() system calls.  Truncating the file while it is mapped
+    crashes the process.
+
+    If readahead is positive, a helper thread reads up to readahead buffers
+    ahead when a regular file is opened for reading, so that reading the file
+    overlaps with processing the data.
+
     open() returns a file object whose type depends on the mode, and
     through which the standard file operations such as reading and writing
     are performed. When open() is used to open a file in a text mode ('w',
@@ -200,6 +209,10 @@ def open(file, mode="r", buffering=-1, encoding=None, errors=None,
         raise ValueError("binary mode doesn't take an errors argument")
     if binary and newline is not None:
         raise ValueError("binary mode doesn't take a newline argument")
+    if mmap and (not reading or updating):
+        raise ValueError("mmap is only supported in read mode")
+    if readahead and (not reading or updating):
+        raise ValueError("readahead is only supported in read mode")
     raw = FileIO(file,
                  (creating and "x" or "") +
                  (reading and "r" or "") +
@@ -225,15 +238,19 @@ def open(file, mode="r", buffering=-1, encoding=None, errors=None,
         if buffering < 0:
             raise ValueError("invalid buffering size")
         if buffering == 0:
-            if binary:
-                return result
-            raise ValueError("can't have unbuffered text I/O")
+            if not binary:
+                raise ValueError("can't have unbuffered text I/O")
+            if mmap:
+                raise ValueError("can't use mmap with unbuffered I/O")
+            if readahead:
+                raise ValueError("can't use readahead with unbuffered I/O")
+            return result
         if updating:
             buffer = BufferedRandom(raw, buffering)
         elif creating or writing or appending:
             buffer = BufferedWriter(raw, buffering)
         elif reading:
-            buffer = BufferedReader(raw, buffering)
+            buffer = BufferedReader(raw, buffering, mmap, readahead)
         else:
             raise ValueError("unknown mode: %r" % mode)
         result = buffer
@@ -830,9 +847,14 @@ class _BufferedIOMixin(BufferedIOBase):
 
 class BytesIO(BufferedIOBase):
 
-    """Buffered I/O implementation using an in-memory bytes buffer."""
+    """Buffered I/O implementation using an in-memory bytes buffer.
 
-    def __init__(self, initial_bytes=None):
+    The chunked argument is accepted for compatibility with the C
+    implementation, which stores the data appended at the end of the stream
+    as a list of chunks; the bytearray buffer already grows in place.
+    """
+
+    def __init__(self, initial_bytes=None, *, chunked=False):
         buf = bytearray()
         if initial_bytes is not None:
             buf += initial_bytes
@@ -858,6 +880,16 @@ class BytesIO(BufferedIOBase):
             raise ValueError("getbuffer on closed file")
         return memoryview(self._buffer)
 
+    def getbuffers(self):
+        """Return the bytes value (contents) of the buffer as a list of bytes
+        objects.
+        """
+        if self.closed:
+            raise ValueError("getbuffers on closed file")
+        if not self._buffer:
+            return []
+        return [bytes(self._buffer)]
+
     def close(self):
         self._buffer.clear()
         super().close()
@@ -900,6 +932,15 @@ class BytesIO(BufferedIOBase):
         self._pos += n
         return n
 
+    def write_many(self, buffers):
+        """Write an iterable of bytes-like objects to the file.
+
+        Return the total number of bytes written.
+        """
+        if self.closed:
+            raise ValueError("write to closed file")
+        return self.write(b"".join(buffers))
+
     def seek(self, pos, whence=0):
         if self.closed:
             raise ValueError("seek on closed file")
@@ -957,18 +998,25 @@ class BytesIO(BufferedIOBase):
 
 class BufferedReader(_BufferedIOMixin):
 
-    """BufferedReader(raw[, buffer_size])
+    """BufferedReader(raw[, buffer_size[, mmap[, readahead]]])
 
     A buffer for a readable, sequential BaseRawIO object.
 
     The constructor creates a BufferedReader for the given readable raw
     stream and buffer_size. If buffer_size is omitted, DEFAULT_BUFFER_SIZE
-    is used.
+    is used.  mmap and readahead are accepted for compatibility with the C
+    implementation, which memory-maps regular files or reads them ahead in
+    a helper thread; this implementation ignores them.
     """
 
-    def __init__(self, raw, buffer_size=DEFAULT_BUFFER_SIZE):
+    def __init__(self, raw, buffer_size=DEFAULT_BUFFER_SIZE, mmap=False,
+                 readahead=0):
         """Create a new buffered reader using the given readable raw IO object.
         """
+        if readahead < 0:
+            raise ValueError("readahead must be non-negative")
+        if mmap and readahead:
+            raise ValueError("can't use mmap and readahead together")
         if not raw.readable():
             raise OSError('"raw" argument must be readable.')
 
@@ -17,7 +17,6 @@ to modify the meaning of the API call itself.
 import collections
 import concurrent.futures
 import heapq
-import inspect
 import itertools
 import logging
 import os
@@ -37,6 +36,13 @@ from . import tasks
 from .coroutines import coroutine
 from .log import logger
 
+try:
+    # C implementation of the loop running the ready handles in
+    # BaseEventLoop._run_once(), used outside of debug mode.
+    from _asyncio import _run_ready
+except ImportError:
+    _run_ready = None
+
 
 __all__ = ['BaseEventLoop']
 
@@ -60,7 +66,7 @@ _FATAL_ERROR_IGNORE = (BrokenPipeError,
 
 def _format_handle(handle):
     cb = handle._callback
-    if inspect.ismethod(cb) and isinstance(cb.__self__, tasks.Task):
+    if isinstance(getattr(cb, '__self__', None), tasks._TASK_CLASSES):
         # format the task
         return repr(cb.__self__)
     else:
@@ -363,7 +369,7 @@ class BaseEventLoop(events.AbstractEventLoop):
         """
         self._check_closed()
 
-        new_task = not isinstance(future, futures.Future)
+        new_task = not futures.isfuture(future)
         future = tasks.ensure_future(future, loop=self)
         if new_task:
             # An exception is raised if the future didn't complete, so there
@@ -1293,6 +1299,9 @@ class BaseEventLoop(events.AbstractEventLoop):
         # they will be run the next time (after another I/O poll).
         # Use an idiom that is thread-safe without using locks.
         ntodo = len(self._ready)
+        if _run_ready is not None and not self._debug:
+            _run_ready(self._ready, ntodo)
+            return
         for i in range(ntodo):
             handle = self._ready.popleft()
             if handle._cancelled:
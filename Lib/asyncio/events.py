@@ -124,18 +124,27 @@ class Handle:
         try:
             self._callback(*self._args)
         except Exception as exc:
-            cb = _format_callback_source(self._callback, self._args)
-            msg = 'Exception in callback {}'.format(cb)
-            context = {
-                'message': msg,
-                'exception': exc,
-                'handle': self,
-            }
-            if self._source_traceback:
-                context['source_traceback'] = self._source_traceback
-            self._loop.call_exception_handler(context)
+            self._report_exception(exc)
         self = None  # Needed to break cycles when an exception occurs.
 
+    def _report_exception(self, exc):
+        """Internal: Pass an exception raised by the callback to the loop.
+
+        This is also called by the C implementation of the ready queue
+        drain (see BaseEventLoop._run_once()), which runs the callbacks
+        of Handle and TimerHandle objects without calling _run().
+        """
+        cb = _format_callback_source(self._callback, self._args)
+        msg = 'Exception in callback {}'.format(cb)
+        context = {
+            'message': msg,
+            'exception': exc,
+            'handle': self,
+        }
+        if self._source_traceback:
+            context['source_traceback'] = self._source_traceback
+        self._loop.call_exception_handler(context)
+
 
 class TimerHandle(Handle):
     """Object returned by timed callback registration methods."""
@@ -1,11 +1,12 @@
 """Event loop using a proactor and related classes.
 
 A proactor is a "notify-on-completion" multiplexer.  Currently a
-proactor is only implemented on Windows with IOCP.
+proactor is implemented on Windows with IOCP and on Linux with io_uring.
 """
 
 __all__ = ['BaseProactorEventLoop']
 
+import errno
 import socket
 import warnings
 
@@ -126,7 +127,12 @@ class _ProactorBasePipeTransport(transports._FlowControlMixin,
             # just close our end.  First calling shutdown() seems to
             # cure it, but maybe using DisconnectEx() would be better.
             if hasattr(self._sock, 'shutdown'):
-                self._sock.shutdown(socket.SHUT_RDWR)
+                try:
+                    self._sock.shutdown(socket.SHUT_RDWR)
+                except OSError as exc:
+                    # The peer already reset the connection
+                    if exc.errno != errno.ENOTCONN:
+                        raise
             self._sock.close()
             self._sock = None
             server = self._server
@@ -529,7 +535,7 @@ class BaseProactorEventLoop(base_events.BaseEventLoop):
         self.call_soon(loop)
 
     def _process_events(self, event_list):
-        # Events are processed in the IocpProactor._poll() method
+        # Events are processed in the _poll() method of the proactor
         pass
 
     def _stop_accept_futures(self):
@@ -22,6 +22,46 @@ from .log import logger
 _DEFAULT_LIMIT = 2 ** 16
 
 
+class _PyStreamBuffer(bytearray):
+    """Buffer of StreamReader.
+
+    The C implementation keeps the remaining data in place when data is
+    removed from the front, and copies the removed data only once.
+    """
+
+    def consume(self, n):
+        """Remove the first n bytes of the buffer and return them as
+        bytes."""
+        data = bytes(self[:n])
+        del self[:n]
+        return data
+
+    def readuntil(self, separator, limit):
+        """Remove and return the data up to and including the first
+        separator.
+
+        Return None if the buffer doesn't contain separator, or if more
+        than limit bytes precede it.
+        """
+        if not separator:
+            raise ValueError('Separator should be at least one-byte string')
+        isep = self.find(separator)
+        if isep == -1 or isep > limit:
+            return None
+        return self.consume(isep + len(separator))
+
+
+_StreamBuffer = _PyStreamBuffer
+
+try:
+    import _asyncio
+except ImportError:
+    pass
+else:
+    # _CStreamBuffer is needed for tests.
+    _StreamBuffer = _CStreamBuffer = _asyncio.StreamBuffer
+
+
 class IncompleteReadError(EOFError):
     """
     Incomplete read error. Attributes:
@@ -347,7 +387,7 @@ class StreamReader:
             self._loop = events.get_event_loop()
         else:
             self._loop = loop
-        self._buffer = bytearray()
+        self._buffer = _StreamBuffer()
         self._eof = False    # Whether we're done.
         self._waiter = None  # A future used by _wait_for_data()
         self._exception = None
@@ -477,13 +517,19 @@ class StreamReader:
         """
         sep = b'\n'
         seplen = len(sep)
+        if self._exception is None:
+            # Fast path: the line is already buffered
+            line = self._buffer.readuntil(sep, self._limit)
+            if line is not None:
+                self._maybe_resume_transport()
+                return line
         try:
             line = yield from self.readuntil(sep)
         except IncompleteReadError as e:
             return e.partial
         except LimitOverrunError as e:
             if self._buffer.startswith(sep, e.consumed):
-                del self._buffer[:e.consumed + seplen]
+                self._buffer.consume(e.consumed + seplen)
             else:
                 self._buffer.clear()
             self._maybe_resume_transport()
@@ -566,8 +612,7 @@ class StreamReader:
             # adds data which makes separator be found. That's why we check for
             # EOF *ater* inspecting the buffer.
             if self._eof:
-                chunk = bytes(self._buffer)
-                self._buffer.clear()
+                chunk = self._buffer.consume(len(self._buffer))
                 raise IncompleteReadError(chunk, None)
 
             # _wait_for_data() will resume reading if stream was paused.
@@ -577,10 +622,9 @@ class StreamReader:
             raise LimitOverrunError(
                 'Separator is found, but chunk is longer than limit', isep)
 
-        chunk = self._buffer[:isep + seplen]
-        del self._buffer[:isep + seplen]
+        chunk = self._buffer.consume(isep + seplen)
         self._maybe_resume_transport()
-        return bytes(chunk)
+        return chunk
 
     @coroutine
     def read(self, n=-1):
@@ -627,8 +671,7 @@ class StreamReader:
             yield from self._wait_for_data('read')
 
         # This will work right even if buffer is less than n bytes
-        data = bytes(self._buffer[:n])
-        del self._buffer[:n]
+        data = self._buffer.consume(n)
 
         self._maybe_resume_transport()
         return data
@@ -658,6 +701,12 @@ class StreamReader:
         if n == 0:
             return b''
 
+        if len(self._buffer) >= n:
+            # Fast path: the data is already buffered
+            data = self._buffer.consume(n)
+            self._maybe_resume_transport()
+            return data
+
         # There used to be "optimized" code here.  It created its own
         # Future and waited until self._buffer had at least the n
         # bytes, then called read(n).  Unfortunately, this could pause
@@ -0,0 +1,383 @@
+"""Proactor event loop for Linux using io_uring.
+
+The proactor queues the socket operations to a select.io_uring object
+and reaps their completions with a single system call per event loop
+iteration, instead of one system call to poll the sockets and one more
+per recv() and send().
+
+new_event_loop() falls back to the selector event loop (using epoll) if
+io_uring is not available.
+"""
+
+import errno
+import itertools
+import os
+import select
+import socket
+
+from . import events
+from . import futures
+from . import proactor_events
+from . import unix_events
+from .log import logger
+
+
+__all__ = ['IoUringEventLoop', 'IoUringProactor', 'IoUringEventLoopPolicy',
+           'new_event_loop',
+           ]
+
+
+# Number of entries of the submission queue
+RING_ENTRIES = 256
+
+# Results of an operation which must wait for the file descriptor to be
+# ready, because it is non-blocking
+_RETRY_ERRNOS = frozenset((-errno.EAGAIN, -errno.EWOULDBLOCK))
+
+# Sentinel returned by a completion callback to queue its operation again
+_RESUBMIT = object()
+
+
+def _check(res):
+    if res < 0:
+        raise OSError(-res, os.strerror(-res))
+    return res
+
+
+class _IoUringFuture(futures.Future):
+    """Subclass of Future which represents an io_uring operation.
+
+    Cancelling it cancels the operation in flight.
+    """
+
+    def __init__(self, proactor, *, loop=None):
+        super().__init__(loop=loop)
+        if self._source_traceback:
+            del self._source_traceback[-1]
+        self._proactor = proactor
+        self._user_data = None
+
+    def _repr_info(self):
+        info = super()._repr_info()
+        if self._user_data is not None:
+            info.insert(1, 'user_data=%s' % self._user_data)
+        return info
+
+    def cancel(self):
+        if not self.done() and self._user_data is not None:
+            self._proactor._cancel(self._user_data)
+            self._user_data = None
+        return super().cancel()
+
+
+class _Operation:
+    """State of an io_uring operation.
+
+    queue(user_data) queues the operation to the ring, and finish(res)
+    returns the value of the future from the result of the completion.
+    If the file descriptor is not ready, the operation is queued again
+    once poll_add() reports the events.  We only store obj to prevent it
+    from being garbage collected too early.
+    """
+
+    __slots__ = ('future', 'obj', 'queue', 'finish', 'events', 'polling',
+                 'discard')
+
+    def __init__(self, future, obj, queue, finish, events=0, discard=None):
+        self.future = future
+        self.obj = obj
+        self.queue = queue
+        self.finish = finish
+        self.events = events
+        self.polling = False
+        self.discard = discard
+
+
+class IoUringProactor:
+    """Proactor implementation using io_uring."""
+
+    _ring = None
+
+    def __init__(self, entries=RING_ENTRIES):
+        self._loop = None
+        self._results = []
+        self._ring = select.io_uring(entries)
+        self._cache = {}
+        self._user_data = itertools.count(1)
+
+    def __repr__(self):
+        return ('<%s operation#=%s result#=%s>'
+                % (self.__class__.__name__, len(self._cache),
+                   len(self._results)))
+
+    def set_loop(self, loop):
+        self._loop = loop
+
+    def select(self, timeout=None):
+        if not self._results:
+            self._poll(timeout)
+        tmp = self._results
+        self._results = []
+        return tmp
+
+    def _result(self, value):
+        fut = self._loop.create_future()
+        fut.set_result(value)
+        return fut
+
+    def recv(self, conn, nbytes, flags=0):
+        ring = self._ring
+        fd = conn.fileno()
+        buf = bytearray(nbytes)
+        is_socket = isinstance(conn, socket.socket)
+        if is_socket:
+            def queue(user_data):
+                ring.recv(fd, buf, user_data, flags)
+        else:
+            def queue(user_data):
+                ring.read(fd, buf, user_data)
+
+        def finish_recv(res):
+            if res == -errno.EIO and not is_socket:
+                # Reading a PTY master fails with EIO once the slave is
+                # closed
+                return b''
+            return bytes(memoryview(buf)[:_check(res)])
+
+        return self._register(conn, queue, finish_recv, select.POLLIN)
+
+    def send(self, conn, buf, flags=0):
+        ring = self._ring
+        fd = conn.fileno()
+        # The whole buffer is sent, even if the socket accepts less data
+        view = memoryview(buf).cast('B')
+        total = len(view)
+        if isinstance(conn, socket.socket):
+            def queue(user_data):
+                ring.send(fd, view, user_data, flags)
+        else:
+            def queue(user_data):
+                ring.write(fd, view, user_data)
+
+        def finish_send(res):
+            nonlocal view
+            view = view[_check(res):]
+            if view:
+                return _RESUBMIT
+            return total
+
+        return self._register(conn, queue, finish_send, select.POLLOUT)
+
+    def accept(self, listener):
+        ring = self._ring
+        fd = listener.fileno()
+
+        def queue(user_data):
+            ring.accept(fd, user_data)
+
+        def finish_accept(res):
+            conn = socket.socket(listener.family, socket.SOCK_STREAM,
+                                 listener.proto, fileno=_check(res))
+            conn.settimeout(listener.gettimeout())
+            return conn, conn.getpeername()
+
+        return self._register(listener, queue, finish_accept, select.POLLIN,
+                              _close_accepted)
+
+    def connect(self, conn, address):
+        # io_uring connect requires a struct sockaddr: connect in
+        # non-blocking mode and wait until the socket is writable
+        err = conn.connect_ex(address)
+        if err in (0, errno.EISCONN):
+            return self._result(None)
+        if err not in (errno.EINPROGRESS, errno.EAGAIN):
+            raise OSError(err, 'Connect call failed %s' % (address,))
+
+        def finish_connect(res):
+            _check(res)
+            err = conn.getsockopt(socket.SOL_SOCKET, socket.SO_ERROR)
+            if err != 0:
+                raise OSError(err, 'Connect call failed %s' % (address,))
+
+        return self._register(conn, self._queue_poll(conn, select.POLLOUT),
+                              finish_connect)
+
+    def wait_closed(self, pipe):
+        """Return a future set to b'' when the read end of the pipe is
+        closed, without reading the pipe."""
+        # POLLERR and POLLHUP are always reported
+        return self._register(pipe, self._queue_poll(pipe, 0),
+                              _finish_wait_closed)
+
+    def _queue_poll(self, obj, events):
+        ring = self._ring
+        fd = obj.fileno()
+
+        def queue(user_data):
+            ring.poll_add(fd, events, user_data)
+        return queue
+
+    def _register(self, obj, queue, finish, events=0, discard=None):
+        # Return a future which will be set with the result of the
+        # operation when it completes.  The future's value is actually
+        # the value returned by finish().
+        fut = _IoUringFuture(self, loop=self._loop)
+        if fut._source_traceback:
+            del fut._source_traceback[-1]
+        self._submit(_Operation(fut, obj, queue, finish, events, discard))
+        return fut
+
+    def _submit(self, op):
+        user_data = next(self._user_data)
+        self._cache[user_data] = op
+        try:
+            if op.polling:
+                self._ring.poll_add(op.obj.fileno(), op.events, user_data)
+            else:
+                op.queue(user_data)
+        except:
+            del self._cache[user_data]
+            raise
+        op.future._user_data = user_data
+
+    def _cancel(self, user_data):
+        # The cancelled operation completes with -ECANCELED, or with its
+        # result if it was already running
+        try:
+            self._ring.cancel(user_data, next(self._user_data))
+        except OSError as exc:
+            self._loop.call_exception_handler({
+                'message': 'Cancelling an io_uring operation failed',
+                'exception': exc,
+            })
+
+    def _poll(self, timeout=None):
+        if timeout is not None and timeout < 0:
+            raise ValueError("negative timeout")
+
+        for user_data, res, flags in self._ring.wait(timeout):
+            try:
+                op = self._cache.pop(user_data)
+            except KeyError:
+                # Completion of a cancellation
+                continue
+
+            fut = op.future
+            if fut.done():
+                # The future has been cancelled
+                if op.discard is not None and not op.polling:
+                    op.discard(res)
+                continue
+            fut._user_data = None
+            try:
+                if op.polling:
+                    # The file descriptor is ready: queue the operation
+                    # again
+                    _check(res)
+                    op.polling = False
+                    value = _RESUBMIT
+                elif res in _RETRY_ERRNOS and op.events:
+                    # The file descriptor is non-blocking: wait until it
+                    # is ready
+                    op.polling = True
+                    value = _RESUBMIT
+                else:
+                    value = op.finish(res)
+                if value is _RESUBMIT:
+                    self._submit(op)
+                    continue
+            except OSError as e:
+                fut.set_exception(e)
+                self._results.append(fut)
+            else:
+                fut.set_result(value)
+                self._results.append(fut)
+
+    def _stop_serving(self, obj):
+        # obj is a listening socket.  Closing it does not abort the accept
+        # in flight, which holds a reference to the socket: the accept
+        # future is cancelled by BaseProactorEventLoop._stop_serving().
+        pass
+
+    def close(self):
+        if self._ring is None:
+            return
+        # Cancel remaining registered operations.
+        for op in list(self._cache.values()):
+            if not op.future.done():
+                op.future.cancel()
+
+        while self._cache:
+            self._poll(1)
+            if self._cache:
+                logger.debug('taking long time to close proactor')
+
+        self._results = []
+        self._ring.close()
+        self._ring = None
+
+    def __del__(self):
+        if self._ring is not None and self._loop is not None:
+            self.close()
+
+
+def _close_accepted(res):
+    # The accept completed after its future was cancelled
+    if res >= 0:
+        os.close(res)
+
+
+def _finish_wait_closed(res):
+    _check(res)
+    return b''
+
+
+class _IoUringWritePipeTransport(
+        proactor_events._ProactorBaseWritePipeTransport):
+    """Transport for write pipes.
+
+    Unlike a Windows pipe, the write end of a pipe cannot be read to
+    detect when the read end is closed.
+    """
+
+    def __init__(self, *args, **kw):
+        super().__init__(*args, **kw)
+        self._read_fut = self._loop._proactor.wait_closed(self._sock)
+        self._read_fut.add_done_callback(self._pipe_closed)
+
+    _pipe_closed = proactor_events._ProactorWritePipeTransport._pipe_closed
+
+
+class IoUringEventLoop(proactor_events.BaseProactorEventLoop):
+    """Linux version of proactor event loop using io_uring."""
+
+    def __init__(self, proactor=None):
+        if proactor is None:
+            proactor = IoUringProactor()
+        super().__init__(proactor)
+
+    def _socketpair(self):
+        return socket.socketpair()
+
+    def _make_write_pipe_transport(self, sock, protocol, waiter=None,
+                                   extra=None):
+        return _IoUringWritePipeTransport(self, sock, protocol, waiter, extra)
+
+
+def new_event_loop():
+    """Create an io_uring event loop, or a selector event loop if io_uring
+    is not supported by the kernel."""
+    if hasattr(select, 'io_uring'):
+        try:
+            proactor = IoUringProactor()
+        except OSError:
+            # io_uring is disabled or the kernel is older than Linux 5.11
+            pass
+        else:
+            return IoUringEventLoop(proactor)
+    return unix_events.SelectorEventLoop()
+
+
+class IoUringEventLoopPolicy(events.BaseDefaultEventLoopPolicy):
+    """Event loop policy creating io_uring event loops."""
+    _loop_factory = staticmethod(new_event_loop)
@@ -436,22 +436,11 @@ if hasattr(select, 'epoll'):
             # FD is registered.
             max_ev = max(len(self._fd_to_key), 1)
 
-            ready = []
+            # epoll.select() maps the events to the keys in C
             try:
-                fd_event_list = self._epoll.poll(timeout, max_ev)
+                return self._epoll.select(self._fd_to_key, timeout, max_ev)
             except InterruptedError:
-                return ready
-            for fd, event in fd_event_list:
-                events = 0
-                if event & ~select.EPOLLIN:
-                    events |= EVENT_WRITE
-                if event & ~select.EPOLLOUT:
-                    events |= EVENT_READ
-
-                key = self._key_from_fd(fd)
-                if key:
-                    ready.append((key, events & key.events))
-            return ready
+                return []
 
         def close(self):
             self._epoll.close()
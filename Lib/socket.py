@@ -247,7 +247,53 @@ class socket(_socket.socket):
         text.mode = mode
         return text
 
-    if hasattr(os, 'sendfile'):
+    if hasattr(_socket.socket, '_sendfile'):
+
+        def _sendfile_use_sendfile(self, file, offset=0, count=None):
+            self._check_sendfile_params(file, offset, count)
+            try:
+                fileno = file.fileno()
+            except (AttributeError, io.UnsupportedOperation) as err:
+                raise _GiveupOnSendfile(err)  # not a regular file
+            try:
+                fsize = os.fstat(fileno).st_size
+            except OSError as err:
+                raise _GiveupOnSendfile(err)  # not a regular file
+            if not fsize:
+                return 0  # empty file
+            blocksize = fsize if not count else count
+
+            if self.gettimeout() == 0:
+                raise ValueError("non-blocking sockets are not supported")
+
+            total_sent = 0
+            try:
+                while True:
+                    if count:
+                        blocksize = count - total_sent
+                        if blocksize <= 0:
+                            break
+                    # _sendfile() loops over sendfile() in C, waiting for
+                    # the socket to be writable with its timeout
+                    try:
+                        sent = self._sendfile(fileno, offset, blocksize)
+                    except _socket.timeout:
+                        raise
+                    except OSError as err:
+                        if total_sent == 0:
+                            # See the comment in the os.sendfile() version
+                            raise _GiveupOnSendfile(err)
+                        raise err from None
+                    if sent == 0:
+                        break  # EOF
+                    offset += sent
+                    total_sent += sent
+                return total_sent
+            finally:
+                if total_sent > 0 and hasattr(file, 'seek'):
+                    file.seek(offset)
+
+    elif hasattr(os, 'sendfile'):
 
         def _sendfile_use_sendfile(self, file, offset=0, count=None):
             self._check_sendfile_params(file, offset, count)
@@ -139,6 +139,39 @@ def tabulate(r):
         doit(L) # !sort
         print()
 
+def randkeys(n):
+    """Return lists of n random keys of various types, with their names."""
+    floats = randfloats(n)
+    return [
+        ("float", floats),
+        ("int", [int(x * 2**30) for x in floats]),
+        ("bigint", [int(x * 2**90) for x in floats]),
+        ("str", ["%.9f" % x for x in floats]),
+        ("ucs2", ["\u20ac%.9f" % x for x in floats]),
+        ("tuple", [(x,) for x in floats]),
+        ("mixed", [int(x * n) if i & 1 else x for i, x in enumerate(floats)]),
+    ]
+
+def tabulate_types(r):
+    """Tabulate sort speed of random data for various types of keys.
+
+    The sizes are 2**i for i in r (the argument, a list).
+
+    The exact int (below 2**30), float and str types have specialized
+    comparisons; bigint, tuple and mixed lists use the generic one.
+
+    """
+    names = [name for name, L in randkeys(1)]
+    fmt = ("%2s %7s" + " %6s"*len(names))
+    print(fmt % (("i", "2**i") + tuple(names)))
+    for i in r:
+        n = 1 << i
+        print("%2d %7d" % (i, n), end=' ')
+        flush()
+        for name, L in randkeys(n):
+            doit(L)
+        print()
+
 def main():
     """Main program when invoked as a script.
 
@@ -164,6 +197,8 @@ def main():
                 random.seed(x)
     r = range(k1, k2+1)                 # include the end point
     tabulate(r)
+    print()
+    tabulate_types(r)
 
 if __name__ == '__main__':
     main()
@@ -213,6 +213,33 @@ class BaseTest:
                 if loc != -1:
                     self.assertEqual(i[loc:loc+len(j)], j)
 
+    def test_find_long_haystack(self):
+        # Long haystacks are searched by blocks of characters on some
+        # platforms: check matches at every offset of a block, and
+        # patterns which make naive searches quadratic.
+        for i in range(70):
+            s = 'a' * i + 'bcd' + 'a' * 70
+            self.checkequal(i, s, 'find', 'bcd')
+            self.checkequal(i + 1, s, 'find', 'c')
+            self.checkequal(1, s, 'count', 'bcd')
+            self.checkequal(-1, s, 'find', 'bce')
+            self.checkequal(i, 'a' * i + 'ab', 'find', 'ab')
+        haystack = 'a' * 10000
+        for needle in ('a' * 50 + 'b', 'b' + 'a' * 50,
+                       'a' * 25 + 'b' + 'a' * 25):
+            self.checkequal(-1, haystack, 'find', needle)
+            self.checkequal(0, haystack, 'count', needle)
+            s = haystack + needle + haystack
+            self.checkequal(10000, s, 'find', needle)
+            self.checkequal(1, s, 'count', needle)
+        # Periodic needles
+        s = 'ab' * 5000 + 'b' + 'ab' * 5000
+        self.checkequal(9996, s, 'find', 'abab' + 'b')
+        self.checkequal(9796, s, 'find', 'ab' * 102 + 'b')
+        self.checkequal(-1, s, 'find', 'ab' * 102 + 'bb')
+        self.checkequal(2500, 'ab' * 5000, 'count', 'abab')
+        self.checkequal(1666, 'ab' * 5000, 'count', 'ababab')
+
     def test_rfind(self):
         self.checkequal(9,  'abcdefghiabc', 'rfind', 'abc')
         self.checkequal(12, 'abcdefghiabc', 'rfind', '')
@@ -945,6 +972,34 @@ class BaseTest:
 
         self.checkraises(TypeError, 'abc', 'splitlines', 42, 42)
 
+    def test_split_long(self):
+        # Long strings are scanned a block of characters at a time; put
+        # the separators at every offset of a block.
+        for n in range(70):
+            fields = ['x' * n] * 5 + ['y' * n]
+            text = '|'.join(fields)
+            self.checkequal(fields, text, 'split', '|')
+            self.checkequal(fields, text, 'rsplit', '|')
+            self.checkequal(fields[:2] + ['|'.join(fields[2:])],
+                            text, 'split', '|', 2)
+            self.checkequal(['|'.join(fields[:-2])] + fields[-2:],
+                            text, 'rsplit', '|', 2)
+            self.checkequal([text], text, 'split', '#')
+            self.checkequal([text], text, 'rsplit', '#')
+            self.checkequal(['', text, ''], '\0' + text + '\0', 'split', '\0')
+            self.checkequal(['', text, ''], '\0' + text + '\0', 'rsplit', '\0')
+
+    def test_splitlines_long(self):
+        for n in range(70):
+            a, b, e = 'a' * n, 'b' * (100 - n), 'e' * (n + 1)
+            text = a + '\r\n' + b + '\n\rc\rd\n' + e
+            self.checkequal([a, b, '', 'c', 'd', e], text, 'splitlines')
+            self.checkequal([a + '\r\n', b + '\n', '\r', 'c\r', 'd\n', e],
+                            text, 'splitlines', True)
+            self.checkequal([a, 'b' * 100], a + '\r\n' + 'b' * 100,
+                            'splitlines')
+            self.checkequal([a + 'a' * 70], a + 'a' * 70, 'splitlines')
+
 
 class CommonTest(BaseTest):
     # This testcase contains tests that can be used in all
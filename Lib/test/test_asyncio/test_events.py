@@ -2008,6 +2008,7 @@ if sys.platform == 'win32':
             raise unittest.SkipTest("IocpEventLoop does not have add_reader()")
 else:
     from asyncio import selectors
+    from asyncio import uring_events
 
     class UnixEventLoopTestsMixin(EventLoopTestsMixin):
         def setUp(self):
@@ -2061,6 +2062,93 @@ else:
             def create_event_loop(self):
                 return asyncio.SelectorEventLoop(selectors.PollSelector())
 
+    def _has_io_uring():
+        try:
+            uring_events.IoUringProactor().close()
+        except (AttributeError, OSError):
+            return False
+        return True
+
+    @unittest.skipUnless(_has_io_uring(), 'requires io_uring')
+    class IoUringEventLoopTests(EventLoopTestsMixin, test_utils.TestCase):
+
+        def create_event_loop(self):
+            return uring_events.IoUringEventLoop()
+
+        def test_legacy_create_ssl_connection(self):
+            raise unittest.SkipTest("IoUringEventLoop incompatible with legacy SSL")
+
+        def test_legacy_create_server_ssl(self):
+            raise unittest.SkipTest("IoUringEventLoop incompatible with legacy SSL")
+
+        def test_legacy_create_server_ssl_verify_failed(self):
+            raise unittest.SkipTest("IoUringEventLoop incompatible with legacy SSL")
+
+        def test_legacy_create_server_ssl_match_failed(self):
+            raise unittest.SkipTest("IoUringEventLoop incompatible with legacy SSL")
+
+        def test_legacy_create_server_ssl_verified(self):
+            raise unittest.SkipTest("IoUringEventLoop incompatible with legacy SSL")
+
+        def test_reader_callback(self):
+            raise unittest.SkipTest("IoUringEventLoop does not have add_reader()")
+
+        def test_reader_callback_cancel(self):
+            raise unittest.SkipTest("IoUringEventLoop does not have add_reader()")
+
+        def test_writer_callback(self):
+            raise unittest.SkipTest("IoUringEventLoop does not have add_writer()")
+
+        def test_writer_callback_cancel(self):
+            raise unittest.SkipTest("IoUringEventLoop does not have add_writer()")
+
+        def test_create_datagram_endpoint(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop does not have create_datagram_endpoint()")
+
+        def test_create_datagram_endpoint_sock(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop does not have create_datagram_endpoint()")
+
+        def test_remove_fds_after_closing(self):
+            raise unittest.SkipTest("IoUringEventLoop does not have add_reader()")
+
+        def test_add_signal_handler(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop does not have add_signal_handler()")
+
+        def test_signal_handling_args(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop does not have add_signal_handler()")
+
+        def test_signal_handling_while_selecting(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop does not have add_signal_handler()")
+
+        def test_create_unix_connection(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop does not have create_unix_connection()")
+
+        def test_create_unix_server(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop does not have create_unix_server()")
+
+        def test_create_unix_server_path_socket_error(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop does not have create_unix_server()")
+
+        def test_unclosed_pipe_transport(self):
+            raise unittest.SkipTest(
+                "proactor transports don't show their state in repr()")
+
+        def test_write_pipe(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop writes pipes asynchronously")
+
+        def test_write_pty(self):
+            raise unittest.SkipTest(
+                "IoUringEventLoop writes pipes asynchronously")
+
     # Should always exist.
     class SelectEventLoopTests(UnixEventLoopTestsMixin,
                                SubprocessTestsMixin,
@@ -844,6 +844,132 @@ os.close(fd)
         stream._transport.__repr__.return_value = "<Transport>"
         self.assertEqual("<StreamReader t=<Transport>>", repr(stream))
 
+    def test_readline_fast_path(self):
+        stream = asyncio.StreamReader(loop=self.loop, limit=7)
+        stream.feed_data(b'line1\nline2\nlong line\nend')
+        self.assertEqual(b'line1\n',
+                         self.loop.run_until_complete(stream.readline()))
+        self.assertEqual(b'line2\n',
+                         self.loop.run_until_complete(stream.readline()))
+        # The limit is checked by the slow path
+        with self.assertRaises(ValueError):
+            self.loop.run_until_complete(stream.readline())
+        self.assertEqual(b'end', stream._buffer)
+        self.assertEqual(b'en',
+                         self.loop.run_until_complete(stream.readexactly(2)))
+        stream.feed_eof()
+        self.assertEqual(b'd',
+                         self.loop.run_until_complete(stream.readline()))
+
+        # An exception is raised even if a line is buffered
+        stream = asyncio.StreamReader(loop=self.loop)
+        stream.feed_data(b'line1\n')
+        stream.set_exception(ValueError())
+        self.assertRaises(ValueError, self.loop.run_until_complete,
+                          stream.readline())
+        self.assertRaises(ValueError, self.loop.run_until_complete,
+                          stream.readexactly(2))
+
+
+@unittest.skipUnless(hasattr(asyncio.streams, '_CStreamBuffer'),
+                     'requires the C _asyncio module')
+class PyBufferStreamReaderTests(StreamReaderTests):
+    # Run the StreamReader tests with the pure Python buffer
+
+    def setUp(self):
+        super().setUp()
+        patcher = mock.patch('asyncio.streams._StreamBuffer',
+                             asyncio.streams._PyStreamBuffer)
+        patcher.start()
+        self.addCleanup(patcher.stop)
+
+
+class BaseStreamBufferTests:
+
+    def test_extend_consume(self):
+        buf = self.cls()
+        self.assertEqual(len(buf), 0)
+        self.assertFalse(buf)
+        self.assertEqual(buf.consume(5), b'')
+        buf.extend(b'abc')
+        buf.extend(bytearray(b'def'))
+        buf.extend(memoryview(b'ghi'))
+        buf.extend(b'')
+        self.assertEqual(len(buf), 9)
+        self.assertTrue(buf)
+        self.assertEqual(buf, b'abcdefghi')
+        self.assertNotEqual(buf, b'abcdefgh')
+        self.assertEqual(bytes(buf), b'abcdefghi')
+        consumed = buf.consume(2)
+        self.assertIs(type(consumed), bytes)
+        self.assertEqual(consumed, b'ab')
+        self.assertEqual(buf.consume(0), b'')
+        self.assertEqual(buf, b'cdefghi')
+        self.assertEqual(buf.consume(100), b'cdefghi')
+        self.assertEqual(buf, b'')
+        self.assertRaises(TypeError, buf.extend, 'str')
+
+        # Interleave extend() and consume() over a growing buffer
+        expected = bytearray()
+        for i in range(1000):
+            data = bytes([i % 256]) * (i % 37)
+            buf.extend(data)
+            expected += data
+            n = i % 29
+            self.assertEqual(buf.consume(n), expected[:n])
+            del expected[:n]
+        self.assertEqual(buf, expected)
+        buf.clear()
+        self.assertEqual(buf, b'')
+
+    def test_find_startswith(self):
+        buf = self.cls()
+        self.assertEqual(buf.find(b'\n'), -1)
+        self.assertTrue(buf.startswith(b''))
+        buf.extend(b'xxline1\nline2\r\n')
+        buf.consume(2)
+        self.assertEqual(buf.find(b'\n'), 5)
+        self.assertEqual(buf.find(b'\n', 6), 12)
+        self.assertEqual(buf.find(b'\r\n'), 11)
+        self.assertEqual(buf.find(b'line', 1), 6)
+        self.assertEqual(buf.find(b'xx'), -1)
+        self.assertEqual(buf.find(b'\n', 13), -1)
+        self.assertEqual(buf.find(b'\n', -1), 12)
+        self.assertTrue(buf.startswith(b'line1'))
+        self.assertTrue(buf.startswith(b'\n', 5))
+        self.assertFalse(buf.startswith(b'\n', 6))
+        self.assertFalse(buf.startswith(b'\r\n\n', 11))
+
+    def test_readuntil(self):
+        buf = self.cls()
+        self.assertIsNone(buf.readuntil(b'\n', 100))
+        buf.extend(b'line1\nline2\r\nline')
+        self.assertEqual(buf.readuntil(b'\n', 100), b'line1\n')
+        self.assertIsNone(buf.readuntil(b'\r\n', 4))
+        self.assertEqual(buf.readuntil(b'\r\n', 5), b'line2\r\n')
+        self.assertIsNone(buf.readuntil(b'\n', 100))
+        self.assertEqual(buf, b'line')
+        self.assertRaises(ValueError, buf.readuntil, b'', 100)
+
+    def test_exports(self):
+        buf = self.cls()
+        buf.extend(b'data')
+        with memoryview(buf) as view:
+            self.assertEqual(view, b'data')
+            self.assertRaises(BufferError, buf.extend, b'x')
+            self.assertRaises(BufferError, buf.consume, 1)
+        self.assertEqual(buf.consume(1), b'd')
+
+
+@unittest.skipUnless(hasattr(asyncio.streams, '_CStreamBuffer'),
+                     'requires the C _asyncio module')
+class CStreamBufferTests(BaseStreamBufferTests, unittest.TestCase):
+    cls = getattr(asyncio.streams, '_CStreamBuffer', None)
+
+
+class PyStreamBufferTests(BaseStreamBufferTests, unittest.TestCase):
+    cls = asyncio.streams._PyStreamBuffer
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,155 @@
+import errno
+import select
+import socket
+import unittest
+from unittest import mock
+
+if not hasattr(select, 'io_uring'):
+    raise unittest.SkipTest('io_uring only')
+
+import asyncio
+from asyncio import test_utils
+from asyncio import uring_events
+
+try:
+    uring_events.IoUringProactor().close()
+except OSError:
+    raise unittest.SkipTest("kernel doesn't support io_uring")
+
+
+class ProactorTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = uring_events.IoUringEventLoop()
+        self.set_event_loop(self.loop)
+
+    def socketpair(self):
+        a, b = socket.socketpair()
+        a.setblocking(False)
+        b.setblocking(False)
+        self.addCleanup(a.close)
+        self.addCleanup(b.close)
+        return a, b
+
+    def test_recv_send(self):
+        a, b = self.socketpair()
+        data = b'x' * (4 * 1024 * 1024)
+        # The socket buffer is smaller than data: send() completes after
+        # several partial sends
+        f = self.loop.sock_sendall(a, data)
+        received = bytearray()
+        while len(received) < len(data):
+            received += self.loop.run_until_complete(
+                self.loop.sock_recv(b, 65536))
+        self.assertEqual(self.loop.run_until_complete(f), len(data))
+        self.assertEqual(received, data)
+
+    def test_recv_error(self):
+        a, b = self.socketpair()
+        b.close()
+        f = self.loop.sock_recv(a, 100)
+        self.assertEqual(self.loop.run_until_complete(f), b'')
+        a.close()
+        f = self.loop.sock_recv(a, 100)
+        self.assertRaises(OSError, self.loop.run_until_complete, f)
+
+    def test_cancel(self):
+        a, b = self.socketpair()
+        f = self.loop.sock_recv(a, 100)
+        test_utils.run_briefly(self.loop)
+        user_data = f._user_data
+        self.assertIn(user_data, self.loop._proactor._cache)
+        self.assertTrue(f.cancel())
+        self.assertFalse(f.cancel())
+        test_utils.run_briefly(self.loop)
+        self.assertNotIn(user_data, self.loop._proactor._cache)
+
+        # The data is not consumed by the cancelled recv()
+        b.send(b'spam')
+        f = self.loop.sock_recv(a, 100)
+        self.assertEqual(self.loop.run_until_complete(f), b'spam')
+
+    def test_accept_connect(self):
+        listener = socket.socket()
+        self.addCleanup(listener.close)
+        listener.bind(('127.0.0.1', 0))
+        listener.listen()
+        listener.setblocking(False)
+        client = socket.socket()
+        self.addCleanup(client.close)
+        client.setblocking(False)
+
+        accept = self.loop.sock_accept(listener)
+        connect = self.loop.sock_connect(client, listener.getsockname())
+        conn, address = self.loop.run_until_complete(accept)
+        self.loop.run_until_complete(connect)
+        with conn:
+            self.assertEqual(address, client.getsockname())
+            self.assertEqual(conn.gettimeout(), 0)
+
+    def test_close(self):
+        a, b = self.socketpair()
+        f = self.loop.sock_recv(a, 100)
+        test_utils.run_briefly(self.loop)
+        proactor = self.loop._proactor
+        self.loop.close()
+        self.assertTrue(f.cancelled())
+        self.assertEqual(proactor._cache, {})
+        self.assertTrue(proactor._ring is None)
+
+    def test_create_server(self):
+        class EchoProto(asyncio.Protocol):
+            def connection_made(self, transport):
+                self.transport = transport
+
+            def data_received(self, data):
+                self.transport.write(data)
+
+        server = self.loop.run_until_complete(
+            self.loop.create_server(EchoProto, '127.0.0.1', 0))
+        address = server.sockets[0].getsockname()
+
+        @asyncio.coroutine
+        def client():
+            reader, writer = yield from asyncio.open_connection(
+                *address, loop=self.loop)
+            writer.write(b'ham\n')
+            line = yield from reader.readline()
+            writer.close()
+            return line
+
+        self.assertEqual(self.loop.run_until_complete(client()), b'ham\n')
+        server.close()
+        self.loop.run_until_complete(server.wait_closed())
+
+
+class NewEventLoopTests(unittest.TestCase):
+
+    def test_new_event_loop(self):
+        loop = uring_events.new_event_loop()
+        self.addCleanup(loop.close)
+        self.assertIsInstance(loop, uring_events.IoUringEventLoop)
+
+    def test_fallback(self):
+        # The kernel doesn't support io_uring
+        with mock.patch.object(uring_events.select, 'io_uring',
+                               side_effect=OSError(errno.ENOSYS, 'ENOSYS')):
+            loop = uring_events.new_event_loop()
+        self.addCleanup(loop.close)
+        self.assertIsInstance(loop, asyncio.SelectorEventLoop)
+
+        # The select module doesn't have io_uring
+        with mock.patch.object(uring_events, 'select', object()):
+            loop = uring_events.new_event_loop()
+        self.addCleanup(loop.close)
+        self.assertIsInstance(loop, asyncio.SelectorEventLoop)
+
+    def test_policy(self):
+        policy = uring_events.IoUringEventLoopPolicy()
+        loop = policy.new_event_loop()
+        self.addCleanup(loop.close)
+        self.assertIsInstance(loop, uring_events.IoUringEventLoop)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -829,6 +829,23 @@ class DictTest(unittest.TestCase):
         d.update([(x, y), (z, w)])
         self._tracked(d)
 
+    @support.cpython_only
+    def test_track_split_dicts(self):
+        # Instance dicts with split tables are untracked by any collection
+        # once their values are all atomic.
+        class C:
+            pass
+        a, b = C(), C()
+        a.x = b.x = []
+        a.y = b.y = 1
+        d = a.__dict__
+        self.assertTrue(gc.is_tracked(d))
+        a.x = "a"
+        gc.collect(0)
+        self.assertFalse(gc.is_tracked(d))
+        a.x = []
+        self.assertTrue(gc.is_tracked(d))
+
     @support.cpython_only
     def test_track_subtypes(self):
         # Dict subtypes are always tracked
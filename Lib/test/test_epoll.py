@@ -21,9 +21,11 @@
 """
 Tests for epoll wrapper.
 """
+import array
 import errno
 import os
 import select
+import selectors
 import socket
 import time
 import unittest
@@ -203,6 +205,81 @@ class TestEPoll(unittest.TestCase):
         expected = [(server.fileno(), select.EPOLLOUT)]
         self.assertEqual(events, expected)
 
+    def test_poll_into(self):
+        client, server = self._connected_pair()
+        ep = select.epoll(16)
+        self.addCleanup(ep.close)
+        ep.register(client.fileno(), select.EPOLLIN | select.EPOLLOUT)
+        ep.register(server.fileno(), select.EPOLLIN)
+
+        buf = array.array('I', [0] * 8)
+        self.assertEqual(ep.poll_into(buf, 1), 1)
+        self.assertEqual(list(buf[:2]), [client.fileno(), select.EPOLLOUT])
+
+        client.send(b"Hello!")
+        self.assertEqual(ep.poll_into(buf, 1), 2)
+        events = sorted(zip(buf[0:4:2], buf[1:4:2]))
+        expected = sorted([(client.fileno(), select.EPOLLOUT),
+                           (server.fileno(), select.EPOLLIN)])
+        self.assertEqual(events, expected)
+
+        # The number of events is limited by the size of the buffer
+        buf = bytearray(9)
+        self.assertEqual(ep.poll_into(buf, 1), 1)
+        self.assertEqual(ep.poll_into(memoryview(bytearray(17))[1:]), 2)
+
+        ep.unregister(client.fileno())
+        ep.unregister(server.fileno())
+        self.assertEqual(ep.poll_into(buf, 0), 0)
+
+        self.assertRaises(TypeError, ep.poll_into, b'x' * 8, 0)
+        self.assertRaises(ValueError, ep.poll_into, bytearray(7), 0)
+        ep.close()
+        self.assertRaises(ValueError, ep.poll_into, buf, 0)
+
+    def test_select(self):
+        client, server = self._connected_pair()
+        ep = select.epoll(16)
+        self.addCleanup(ep.close)
+        ep.register(client.fileno(), select.EPOLLIN | select.EPOLLOUT)
+        ep.register(server.fileno(), select.EPOLLIN)
+        read_write = selectors.EVENT_READ | selectors.EVENT_WRITE
+        client_key = selectors.SelectorKey(client, client.fileno(),
+                                           read_write, 'client')
+        server_key = selectors.SelectorKey(server, server.fileno(),
+                                           selectors.EVENT_READ, 'server')
+        keys = {client.fileno(): client_key, server.fileno(): server_key}
+
+        self.assertEqual(ep.select(keys, 1),
+                         [(client_key, selectors.EVENT_WRITE)])
+
+        client.send(b"Hello!")
+        ready = ep.select(keys, timeout=1, maxevents=4)
+        self.assertEqual(sorted(ready, key=lambda item: item[0].fd),
+                         sorted([(client_key, selectors.EVENT_WRITE),
+                                 (server_key, selectors.EVENT_READ)],
+                                key=lambda item: item[0].fd))
+
+        # Unknown file descriptors are skipped
+        self.assertEqual(ep.select({}, 1), [])
+
+        # The events are restricted to the events of the key
+        write_key = server_key._replace(events=selectors.EVENT_WRITE)
+        self.assertEqual(ep.select({server.fileno(): write_key}, 1, 2),
+                         [(write_key, 0)])
+
+        # Any object with an events attribute can be used as key
+        class Key:
+            events = selectors.EVENT_READ
+        key = Key()
+        self.assertEqual(ep.select({server.fileno(): key}, 1, 2),
+                         [(key, selectors.EVENT_READ)])
+
+        self.assertRaises(TypeError, ep.select, list(keys.items()), 0)
+        self.assertRaises(ValueError, ep.select, keys, 0, 0)
+        ep.close()
+        self.assertRaises(ValueError, ep.select, keys, 0)
+
     def test_errors(self):
         self.assertRaises(ValueError, select.epoll, -2)
         self.assertRaises(ValueError, select.epoll().register, -1,
@@ -4,6 +4,7 @@ from test.support import (verbose, refcount_test, run_unittest,
                             temp_dir)
 from test.support.script_helper import assert_python_ok, make_script
 
+import os
 import sys
 import time
 import gc
@@ -718,10 +719,13 @@ class GCTests(unittest.TestCase):
         for st in stats:
             self.assertIsInstance(st, dict)
             self.assertEqual(set(st),
-                             {"collected", "collections", "uncollectable"})
+                             {"collected", "collections", "uncollectable",
+                              "tracked", "untracked"})
             self.assertGreaterEqual(st["collected"], 0)
             self.assertGreaterEqual(st["collections"], 0)
             self.assertGreaterEqual(st["uncollectable"], 0)
+            self.assertGreaterEqual(st["tracked"], 0)
+            self.assertGreaterEqual(st["untracked"], 0)
         # Check that collection counts are incremented correctly
         if gc.isenabled():
             self.addCleanup(gc.enable)
@@ -738,6 +742,125 @@ class GCTests(unittest.TestCase):
         self.assertEqual(new[1]["collections"], old[1]["collections"])
         self.assertEqual(new[2]["collections"], old[2]["collections"] + 1)
 
+    def test_set_threads(self):
+        old = gc.get_threads()
+        self.addCleanup(gc.set_threads, old)
+        self.assertEqual(old, 1)
+        self.assertRaises(ValueError, gc.set_threads, 0)
+        self.assertRaises(ValueError, gc.set_threads, -1)
+        self.assertRaises(TypeError, gc.set_threads, 2.0)
+        try:
+            gc.set_threads(4)
+        except ValueError:
+            self.skipTest("parallel collection not supported")
+        self.assertEqual(gc.get_threads(), 4)
+
+        # Build a graph large enough to be split across threads, made of
+        # cycles which are reachable only through other chunks.
+        class Node:
+            pass
+        def make_cycles(n):
+            nodes = [Node() for i in range(n)]
+            for i, node in enumerate(nodes):
+                node.next = nodes[(i * 7919 + 1) % n]
+                node.items = [i]
+            return nodes
+        gc.collect()
+        keep = make_cycles(100000)
+        garbage = make_cycles(100000)
+        wr = weakref.ref(garbage[-1])
+        del garbage
+        # Each Node holds a dict, a list and itself.
+        self.assertEqual(gc.collect(), 300000)
+        self.assertIsNone(wr())
+        self.assertEqual(gc.collect(), 0)
+        self.assertEqual(keep[-1].items, [len(keep) - 1])
+
+    def test_set_threads_matches_serial(self):
+        # The parallel and serial collections find the same garbage
+        old = gc.get_threads()
+        self.addCleanup(gc.set_threads, old)
+        try:
+            gc.set_threads(3)
+        except ValueError:
+            self.skipTest("parallel collection not supported")
+        self.addCleanup(gc.set_debug, gc.get_debug())
+
+        class Node:
+            pass
+        def make_graph(n, seed):
+            nodes = [Node() for i in range(n)]
+            for i, node in enumerate(nodes):
+                node.next = nodes[(i * seed + 1) % n]
+                node.items = [i]
+            # only every other chain is kept alive from outside
+            return nodes[::2]
+        def collect(threads, seed):
+            gc.set_threads(threads)
+            gc.collect()
+            keep = make_graph(50000, seed)
+            gc.set_debug(gc.DEBUG_SAVEALL)
+            try:
+                n = gc.collect()
+                found = sorted(o.items[0] for o in gc.garbage
+                               if isinstance(o, Node))
+            finally:
+                gc.set_debug(0)
+                del gc.garbage[:]
+            self.assertEqual(len(keep), 25000)
+            return n, found
+
+        # The workers are reused by successive collections, and stopped or
+        # started when the number of threads changes.
+        for seed in (2, 7919, 104729):
+            serial = collect(1, seed)
+            self.assertEqual(collect(3, seed), serial)
+            self.assertEqual(collect(2, seed), serial)
+            self.assertEqual(collect(3, seed), serial)
+
+    @unittest.skipUnless(hasattr(os, "fork"), "requires os.fork()")
+    def test_set_threads_fork(self):
+        # A child process starts its own workers
+        old = gc.get_threads()
+        self.addCleanup(gc.set_threads, old)
+        try:
+            gc.set_threads(2)
+        except ValueError:
+            self.skipTest("parallel collection not supported")
+        class Node:
+            pass
+        nodes = [Node() for i in range(50000)]
+        for node in nodes:
+            node.self = node
+        pid = os.fork()
+        if pid == 0:
+            try:
+                del nodes[:]
+                ok = gc.collect() >= 100000 and gc.collect() == 0
+            finally:
+                os._exit(0 if ok else 1)
+        self.assertEqual(os.waitpid(pid, 0)[1], 0)
+        del nodes[:]
+        self.assertGreaterEqual(gc.collect(), 100000)
+
+    def test_get_stats_untracked(self):
+        if gc.isenabled():
+            self.addCleanup(gc.enable)
+            gc.disable()
+        # Tuples built with PyTuple_New() stay tracked until a collection
+        # finds out they only hold atomic objects.
+        x = [1, 2]
+        atomic = [t[:2] for t in zip(x, x, x)]
+        self.assertTrue(all(gc.is_tracked(t) for t in atomic))
+        old = gc.get_stats()
+        gc.collect(0)
+        new = gc.get_stats()
+        self.assertFalse(any(gc.is_tracked(t) for t in atomic))
+        self.assertGreaterEqual(new[0]["untracked"],
+                                old[0]["untracked"] + len(atomic))
+        self.assertEqual(new[1]["untracked"], old[1]["untracked"])
+        self.assertGreater(new[1]["tracked"], 0)
+
 
 class GCCallbackTests(unittest.TestCase):
     def setUp(self):
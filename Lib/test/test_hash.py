@@ -5,9 +5,10 @@
 
 import datetime
 import os
+import re
 import sys
 import unittest
-from test.support.script_helper import assert_python_ok
+from test.support.script_helper import assert_python_ok, assert_python_failure
 from collections import Hashable
 
 IS_64BIT = sys.maxsize > 2**32
@@ -40,10 +41,55 @@ def pysiphash(uint64):
         int32 = uint32
     return int32, int64
 
+def siphash(key, data, c_rounds=2, d_rounds=4):
+    """Reference SipHash-c-d of data, keyed with the 16 bytes of key
+
+    Like CPython, return v0 ^ v1 ^ v2 ^ v3 instead of the standard
+    finalization (which also xors in b).
+    """
+    mask = (1 << 64) - 1
+    def rotl(x, b):
+        return ((x << b) | (x >> (64 - b))) & mask
+    def rounds(v, n):
+        v0, v1, v2, v3 = v
+        for i in range(n):
+            v0 = (v0 + v1) & mask; v2 = (v2 + v3) & mask
+            v1 = rotl(v1, 13) ^ v0; v3 = rotl(v3, 16) ^ v2
+            v0 = rotl(v0, 32)
+            v2 = (v2 + v1) & mask; v0 = (v0 + v3) & mask
+            v1 = rotl(v1, 17) ^ v2; v3 = rotl(v3, 21) ^ v0
+            v2 = rotl(v2, 32)
+        return [v0, v1, v2, v3]
+    k0 = int.from_bytes(key[:8], 'little')
+    k1 = int.from_bytes(key[8:16], 'little')
+    v = [k0 ^ 0x736f6d6570736575, k1 ^ 0x646f72616e646f6d,
+         k0 ^ 0x6c7967656e657261, k1 ^ 0x7465646279746573]
+    tail = len(data) & ~7
+    for i in range(0, tail, 8):
+        m = int.from_bytes(data[i:i + 8], 'little')
+        v[3] ^= m
+        v = rounds(v, c_rounds)
+        v[0] ^= m
+    b = ((len(data) & 0xff) << 56) | int.from_bytes(data[tail:], 'little')
+    v[3] ^= b
+    v = rounds(v, c_rounds)
+    v[0] ^= b
+    v[2] ^= 0xff
+    v = rounds(v, d_rounds)
+    return v[0] ^ v[1] ^ v[2] ^ v[3]
+
+def to_py_hash(uint64):
+    """Convert a 64-bit hash to the Py_hash_t returned by hash()"""
+    width = sys.hash_info.width
+    x = uint64 & ((1 << width) - 1)
+    if x >= 1 << (width - 1):
+        x -= 1 << width
+    return -2 if x == -1 else x
+
 def skip_unless_internalhash(test):
-    """Skip decorator for tests that depend on SipHash24 or FNV"""
-    ok = sys.hash_info.algorithm in {"fnv", "siphash24"}
-    msg = "Requires SipHash24 or FNV"
+    """Skip decorator for tests that depend on SipHash or FNV"""
+    ok = sys.hash_info.algorithm in {"fnv", "siphash24", "siphash13"}
+    msg = "Requires SipHash24, SipHash13 or FNV"
     return test if ok else unittest.skip(msg)(test)
 
 
@@ -219,6 +265,18 @@ class StringlikeHashRandomizationTests(HashRandomizationTests):
             # seed 42, 'äú∑ℇ'
             [-1677110816, -2947981342227738144, -1860207793, -4296699217652516017],
         ],
+        'siphash13': [
+            # seed 0, 'abc'
+            [69611762, -4594863902769663758, 69611762, -4594863902769663758],
+            # seed 42, 'abc'
+            [-975800855, 3869580338025362921, -975800855, 3869580338025362921],
+            # seed 42, 'abcdefghijk'
+            [-595844228, 7764564197781545852, -595844228, 7764564197781545852],
+            # seed 0, '\xe4\xfa\u2211\u2107'
+            [-1093288643, -2810468059467891395, -1041341092, 4925090034378237276],
+            # seed 42, '\xe4\xfa\u2211\u2107'
+            [-585999602, -2845126246016066802, -817336969, -2219421378907968137],
+        ],
         'fnv': [
             # seed 0, 'abc'
             [-1600925533, 1453079729188098211, -1600925533,
@@ -342,5 +400,100 @@ class HashDistributionTestCase(unittest.TestCase):
                 self.assertGreater(len(s15), 8, prefix)
                 self.assertGreater(len(s255), 128, prefix)
 
+
+class HashAlgorithmTests(unittest.TestCase):
+    # Check the hash functions which can be selected with the
+    # PYTHONHASHALGORITHM environment variable
+
+    rounds = {'siphash24': (2, 4), 'siphash13': (1, 3)}
+
+    @classmethod
+    def setUpClass(cls):
+        # The fatal error lists the algorithms available in this build
+        env = dict(os.environ, __cleanenv=True,
+                   PYTHONHASHALGORITHM='invalid')
+        out = assert_python_failure('-c', 'pass', **env)
+        match = re.search(rb'PYTHONHASHALGORITHM must be one of: (.*)',
+                          out.err)
+        if match is None:
+            raise AssertionError(out.err)
+        cls.algorithms = match.group(1).decode().strip().split(', ')
+
+    def get_hashes(self, algorithm, seed, expr):
+        # Evaluate the list of hashes expr in a subprocess
+        env = dict(os.environ, __cleanenv=True,
+                   PYTHONHASHALGORITHM=algorithm, PYTHONHASHSEED=str(seed))
+        code = 'import sys; print(sys.hash_info.algorithm, %s)' % expr
+        out = assert_python_ok('-c', code, **env)
+        name, hashes = out.out.decode().split(' ', 1)
+        self.assertEqual(name, algorithm)
+        return eval(hashes)
+
+    def siphash_algorithms(self):
+        algorithms = [name for name in self.algorithms if name in self.rounds]
+        if not algorithms:
+            self.skipTest("requires SipHash")
+        return algorithms
+
+    def test_algorithms(self):
+        self.assertIn(sys.hash_info.algorithm, self.algorithms)
+        self.assertIn('fnv', self.algorithms)
+        for algorithm in self.algorithms:
+            with self.subTest(algorithm=algorithm):
+                hashes = self.get_hashes(algorithm, 0, "[hash(b'')]")
+                self.assertEqual(hashes, [0])
+
+    def test_ignore_environment(self):
+        # -E ignores PYTHONHASHALGORITHM
+        env = dict(os.environ, __cleanenv=True,
+                   PYTHONHASHALGORITHM='invalid')
+        out = assert_python_ok('-E', '-c',
+                               'import sys; print(sys.hash_info.algorithm)',
+                               **env)
+        self.assertIn(out.out.decode().strip(), self.algorithms)
+
+    def test_siphash_reference(self):
+        # Compare with the pure Python SipHash on every length of the tail
+        # and of a few blocks, for bytes, memoryview and 1-byte str
+        lengths = range(max(sys.hash_info.cutoff, 1), 65)
+        expr = ("[(hash(d), hash(memoryview(d)), hash(d.decode('latin-1')))"
+                " for d in %r]" % [lcg(n, n) for n in lengths])
+        for algorithm in self.siphash_algorithms():
+            for seed in (1, 42):
+                key = lcg(seed)
+                with self.subTest(algorithm=algorithm, seed=seed):
+                    hashes = self.get_hashes(algorithm, seed, expr)
+                    for n, h in zip(lengths, hashes):
+                        data = lcg(n, n)
+                        expected = to_py_hash(
+                            siphash(key, data, *self.rounds[algorithm]))
+                        self.assertEqual(h, (expected,) * 3, data)
+
+    def test_seed_independence(self):
+        # Keys whose hashes collide in a table of 256 slots under one seed
+        # must be scattered under another seed: an attacker who learns the
+        # collisions of one process can't reuse them against another one.
+        expr = "[hash(b'key%d' % i) for i in range(16384)]"
+        for algorithm in self.siphash_algorithms():
+            with self.subTest(algorithm=algorithm):
+                hashes1 = self.get_hashes(algorithm, 1, expr)
+                hashes2 = self.get_hashes(algorithm, 2, expr)
+                colliding = [i for i, h in enumerate(hashes1)
+                             if h & 0xff == 0]
+                self.assertGreater(len(colliding), 32)
+                slots = {hashes2[i] & 0xff for i in colliding}
+                self.assertGreater(len(slots), len(colliding) // 2)
+
+    def test_distribution(self):
+        # 4096 similar keys should fill most of 1024 slots (a random
+        # function fills 98% of them)
+        expr = "[hash('k%d' % i) for i in range(4096)]"
+        for algorithm in self.algorithms:
+            with self.subTest(algorithm=algorithm):
+                hashes = self.get_hashes(algorithm, 42, expr)
+                self.assertEqual(len(set(hashes)), len(hashes))
+                slots = {h & 0x3ff for h in hashes}
+                self.assertGreater(len(slots), 950)
+
 if __name__ == "__main__":
     unittest.main()
@@ -1221,6 +1221,33 @@ class BufferedReaderTest(unittest.TestCase, CommonBufferedTests):
         self.assertEqual(bufio().readlines(5), [b"abc\n", b"d\n"])
         self.assertEqual(bufio().readlines(None), [b"abc\n", b"d\n", b"ef"])
 
+    def test_readlines_buffer_size(self):
+        # Lines shorter and longer than the buffer, and spanning several
+        # buffer fills
+        lines = [b"x" * n + b"\n" for n in (0, 1, 5, 7, 8, 9, 20, 3, 0)]
+        lines.append(b"tail")
+        data = b"".join(lines)
+        for bufsize in (1, 2, 8, 16, 1024):
+            rawio = self.MockRawIO([data[i:i+5] for i in range(0, len(data), 5)])
+            bufio = self.tp(rawio, buffer_size=bufsize)
+            self.assertEqual(bufio.readlines(), lines)
+            self.assertEqual(bufio.readlines(), [])
+            bufio = self.tp(self.BytesIO(data), buffer_size=bufsize)
+            self.assertEqual(bufio.readline(), lines[0])
+            self.assertEqual(bufio.read(1), b"x")
+            self.assertEqual(bufio.readlines(13), [lines[1][1:]] + lines[2:4])
+            self.assertEqual(bufio.tell(), sum(map(len, lines[:4])))
+            self.assertEqual(bufio.readlines(), lines[4:])
+
+    def test_readlines_subclass(self):
+        # readlines() calls an overridden readline()
+        class MyBufferedReader(self.tp):
+            def readline(self, size=-1):
+                return super().readline(size).upper()
+        rawio = self.MockRawIO((b"abc\n", b"d\n", b"ef"))
+        bufio = MyBufferedReader(rawio)
+        self.assertEqual(bufio.readlines(), [b"ABC\n", b"D\n", b"EF"])
+
     def test_buffering(self):
         data = b"abcdefghi"
         dlen = len(data)
@@ -1397,7 +1424,7 @@ class CBufferedReaderTest(BufferedReaderTest, SizeofTest):
     def test_args_error(self):
         # Issue #17275
         with self.assertRaisesRegex(TypeError, "BufferedReader"):
-            self.tp(io.BytesIO(), 1024, 1024, 1024)
+            self.tp(io.BytesIO(), 1024, 1024, 1024, 1024)
 
 
 class PyBufferedReaderTest(BufferedReaderTest):
@@ -2802,6 +2829,43 @@ class TextIOWrapperTest(unittest.TestCase):
         txt.seek(0)
         self.assertEqual(txt.readlines(5), ["AA\n", "BB\n"])
 
+    def test_readlines_kinds(self):
+        # Long lines of 1-, 2- and 4-byte characters, with all kinds of line
+        # endings, spanning several chunks
+        for ch in ("a", "\xe9", "\u20ac", "\U0001f40d"):
+            lines = [ch * n + nl
+                     for n in (0, 1, 31, 32, 33, 100, 300)
+                     for nl in ("\n", "\r\n", "\r")]
+            lines.append(ch * 40)
+            data = "".join(lines).encode("utf-8")
+            for newline in (None, "", "\n", "\r", "\r\n"):
+                txt = self.TextIOWrapper(self.BytesIO(data), encoding="utf-8",
+                                         newline=newline)
+                txt._CHUNK_SIZE = 64
+                expected = list(txt)
+                txt.seek(0)
+                self.assertEqual(txt.readlines(), expected)
+                self.assertEqual(txt.tell(), len(data))
+                self.assertEqual(txt.readlines(), [])
+                if newline == "":
+                    self.assertEqual(expected, lines)
+
+                # Stop in the middle
+                txt.seek(0)
+                self.assertEqual(txt.readline(), expected[0])
+                partial = txt.readlines(100)
+                self.assertGreater(sum(map(len, partial)), 100)
+                self.assertEqual(partial, expected[1:1 + len(partial)])
+                self.assertEqual(txt.readlines(), expected[1 + len(partial):])
+
+    def test_readlines_subclass(self):
+        # readlines() calls an overridden readline()
+        class MyTextIO(self.TextIOWrapper):
+            def readline(self, size=-1):
+                return super().readline(size).upper()
+        txt = MyTextIO(self.BytesIO(b"AA\nbb\ncc"), encoding="ascii")
+        self.assertEqual(txt.readlines(), ["AA\n", "BB\n", "CC"])
+
     # read in amounts equal to TextIOWrapper._CHUNK_SIZE which is 128.
     def test_read_by_chunk(self):
         # make sure "\r\n" straddles 128 char boundary.
@@ -2895,6 +2959,54 @@ class TextIOWrapperTest(unittest.TestCase):
 
         self.assertEqual(buffer.seekable(), txt.seekable())
 
+    def test_common_codecs(self):
+        # Characters and BOMs split between chunks, tell() and seek() for
+        # the codecs which the C implementation decodes itself
+        text = "h\xe9llo\r\nw\u20acrld\n\U0001f600\r\rend"
+        for encoding in ("ascii", "latin-1", "utf-8", "utf-16", "utf-16-le",
+                         "utf-16-be"):
+            data = text.encode(encoding, "replace")
+            for newline in (None, "", "\n"):
+                expected = self.TextIOWrapper(self.BytesIO(data),
+                                              encoding=encoding,
+                                              newline=newline).read()
+                for chunk_size in (1, 2, 3, 5):
+                    with self.subTest(encoding=encoding, newline=newline,
+                                      chunk_size=chunk_size):
+                        txt = self.TextIOWrapper(self.BytesIO(data),
+                                                 encoding=encoding,
+                                                 newline=newline)
+                        txt._CHUNK_SIZE = chunk_size
+                        cookies = []
+                        chars = []
+                        while True:
+                            cookies.append(txt.tell())
+                            c = txt.read(1)
+                            if not c:
+                                break
+                            chars.append(c)
+                        self.assertEqual("".join(chars), expected)
+                        for i, cookie in enumerate(cookies):
+                            txt.seek(cookie)
+                            self.assertEqual(txt.read(), expected[i:])
+
+    def test_common_codecs_errors(self):
+        data = b"ab\xe2\x82cd\xe2\x82\xacef\xff"
+        for chunk_size in (1, 2, 3, 8192):
+            with self.subTest(chunk_size=chunk_size):
+                txt = self.TextIOWrapper(self.BytesIO(data), encoding="utf-8",
+                                         errors="replace")
+                txt._CHUNK_SIZE = chunk_size
+                self.assertEqual(txt.read(), data.decode("utf-8", "replace"))
+                txt = self.TextIOWrapper(self.BytesIO(data), encoding="utf-8")
+                txt._CHUNK_SIZE = chunk_size
+                self.assertRaises(UnicodeDecodeError, txt.read)
+        txt = self.TextIOWrapper(self.BytesIO(b"a\x00b\x00"),
+                                 encoding="utf-16")
+        self.assertRaises(UnicodeError, txt.read)
+        txt = self.TextIOWrapper(self.BytesIO(b"a\x80"), encoding="ascii")
+        self.assertRaises(UnicodeDecodeError, txt.read)
+
     def test_append_bom(self):
         # The BOM is not written again when appending to a non-empty file
         filename = support.TESTFN
@@ -3628,10 +3740,299 @@ class MiscIOTest(unittest.TestCase):
         # there used to be a buffer overflow in the parser for rawmode
         self.assertRaises(ValueError, self.open, support.TESTFN, 'rwax+')
 
+    def test_open_mmap(self):
+        data = b"".join(b"line %d\n" % i for i in range(1000))
+        with self.open(support.TESTFN, "wb") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+
+        with self.open(support.TESTFN, "rb", buffering=64, mmap=True) as f:
+            self.assertEqual(f.readline(), b"line 0\n")
+            self.assertEqual(f.read(5), b"line ")
+            self.assertEqual(f.tell(), 12)
+            b = bytearray(4)
+            self.assertEqual(f.readinto(b), 4)
+            self.assertEqual(b, b"1\nli")
+            self.assertTrue(data[16:].startswith(f.peek(1)))
+            self.assertEqual(f.read1(3), b"ne ")
+            self.assertEqual(f.seek(-7, 2), len(data) - 7)
+            self.assertEqual(f.read(), data[-7:])
+            self.assertEqual(f.read(), b"")
+            self.assertEqual(f.seek(100), 100)
+            self.assertEqual(f.read(20), data[100:120])
+            self.assertEqual(f.seek(-20, 1), 100)
+            self.assertEqual(list(f), data[100:].splitlines(True))
+            f.seek(0)
+            self.assertEqual(f.read(), data)
+
+        # Data appended after the file was opened is read
+        with self.open(support.TESTFN, "rb", buffering=64, mmap=True) as f:
+            with self.open(support.TESTFN, "ab") as g:
+                g.write(b"tail")
+            self.assertEqual(f.read(len(data) + 10), data + b"tail")
+
+        with self.open(support.TESTFN, "r", buffering=64, mmap=True) as f:
+            self.assertEqual(f.read(), data.decode() + "tail")
+
+        # The file is smaller than the buffer
+        with self.open(support.TESTFN, "rb", mmap=True) as f:
+            self.assertEqual(f.read(), data + b"tail")
+
+        for mode in ("wb", "ab", "r+b", "w"):
+            self.assertRaises(ValueError, self.open, support.TESTFN, mode,
+                              mmap=True)
+        self.assertRaises(ValueError, self.open, support.TESTFN, "rb",
+                          buffering=0, mmap=True)
+        # The file was not truncated
+        self.assertEqual(os.path.getsize(support.TESTFN), len(data) + 4)
+
+    def test_open_readahead(self):
+        data = b"".join(b"line %d\n" % i for i in range(1000))
+        with self.open(support.TESTFN, "wb") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+
+        with self.open(support.TESTFN, "rb", buffering=64, readahead=3) as f:
+            self.assertEqual(f.readline(), b"line 0\n")
+            self.assertEqual(f.read(5), b"line ")
+            self.assertEqual(f.tell(), 12)
+            b = bytearray(300)
+            self.assertEqual(f.readinto(b), 300)
+            self.assertEqual(b, data[12:312])
+            self.assertTrue(data[312:].startswith(f.peek(1)))
+            self.assertEqual(f.read1(3), data[312:315])
+            self.assertEqual(f.seek(-7, 2), len(data) - 7)
+            self.assertEqual(f.read(), data[-7:])
+            self.assertEqual(f.read(), b"")
+            self.assertEqual(f.seek(100), 100)
+            self.assertEqual(f.read(20), data[100:120])
+            self.assertEqual(f.seek(-20, 1), 100)
+            self.assertEqual(list(f), data[100:].splitlines(True))
+            f.seek(0)
+            self.assertEqual(f.read(1000), data[:1000])
+            self.assertEqual(f.read(), data[1000:])
+
+            # Data appended after EOF is read
+            with self.open(support.TESTFN, "ab") as g:
+                g.write(b"tail")
+            self.assertEqual(f.read(), b"tail")
+
+        with self.open(support.TESTFN, "r", buffering=64, readahead=2) as f:
+            self.assertEqual(f.read(), data.decode() + "tail")
+
+        for mode in ("wb", "ab", "r+b", "w"):
+            self.assertRaises(ValueError, self.open, support.TESTFN, mode,
+                              readahead=2)
+        self.assertRaises(ValueError, self.open, support.TESTFN, "rb",
+                          buffering=0, readahead=2)
+        self.assertRaises(ValueError, self.open, support.TESTFN, "rb",
+                          readahead=-1)
+        self.assertRaises(ValueError, self.open, support.TESTFN, "rb",
+                          mmap=True, readahead=2)
+        self.assertEqual(os.path.getsize(support.TESTFN), len(data) + 4)
+
 
 class CMiscIOTest(MiscIOTest):
     io = io
 
+    def test_open_mmap_raw_position(self):
+        # The whole file is mapped and the raw stream is moved to its end
+        data = b"x" * 1000
+        with self.open(support.TESTFN, "wb") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+        with self.open(support.TESTFN, "rb", buffering=64, mmap=True) as f:
+            self.assertEqual(f.raw.tell(), len(data))
+            self.assertEqual(f.read(10), data[:10])
+            self.assertEqual(f.tell(), 10)
+        with self.open(support.TESTFN, "rb", buffering=64) as f:
+            self.assertEqual(f.raw.tell(), 0)
+        # Only regular files are mapped
+        r, w = os.pipe()
+        os.write(w, data)
+        os.close(w)
+        with self.open(r, "rb", buffering=64, mmap=True) as f:
+            self.assertEqual(f.read(10), data[:10])
+            self.assertEqual(f.read(), data[10:])
+
+    def test_open_mmap_kept(self):
+        # Seeking, telling and reading to the end keep the file mapped: the
+        # raw stream stays at the end of the mapping
+        data = "".join("line %d\n" % i for i in range(1000))
+        with self.open(support.TESTFN, "w") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+        size = len(data)
+        with self.open(support.TESTFN, "r", buffering=64, mmap=True) as f:
+            raw = f.buffer.raw
+            self.assertEqual(f.readline(), "line 0\n")
+            pos = f.tell()
+            self.assertEqual(raw.tell(), size)
+            self.assertEqual(f.readline(), "line 1\n")
+            f.seek(pos)
+            self.assertEqual(f.readline(), "line 1\n")
+            self.assertEqual(raw.tell(), size)
+            self.assertEqual(f.seek(0, 2), size)
+            self.assertEqual(raw.tell(), size)
+            f.seek(0)
+            self.assertEqual(f.read(), data)
+            self.assertEqual(raw.tell(), size)
+            f.seek(0)
+            self.assertEqual(raw.tell(), size)
+            self.assertEqual(f.read(), data)
+        with self.open(support.TESTFN, "rb", buffering=64, mmap=True) as f:
+            self.assertEqual(f.seek(-10, 2), size - 10)
+            self.assertEqual(f.raw.tell(), size)
+            self.assertEqual(f.read(), data[-10:].encode())
+            # Seeking past the end releases the mapping
+            self.assertEqual(f.seek(size + 10), size + 10)
+            self.assertEqual(f.raw.tell(), size + 10)
+            self.assertEqual(f.read(), b"")
+            f.seek(5)
+            self.assertEqual(f.read(5), data[5:10].encode())
+
+    def test_open_readahead_raw_position(self):
+        # The raw stream is moved to the next byte to read whenever it is
+        # used directly
+        data = bytes(range(256)) * 100
+        with self.open(support.TESTFN, "wb") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+        f = self.open(support.TESTFN, "rb", buffering=64, readahead=4)
+        self.assertEqual(f.read(1000), data[:1000])
+        # The read-ahead memory is accounted for
+        self.assertGreaterEqual(sys.getsizeof(f), 5 * 64)
+        self.assertEqual(f.tell(), 1000)
+        with f.detach() as raw:
+            self.assertEqual(raw.tell(), 1024)
+            self.assertEqual(raw.read(10), data[1024:1034])
+
+        fd = os.open(support.TESTFN, os.O_RDONLY)
+        with self.open(fd, "rb", buffering=64, readahead=4) as f:
+            self.assertEqual(f.read(100), data[:100])
+        # The file descriptor is closed
+        self.assertRaises(OSError, os.fstat, fd)
+        fd = os.open(support.TESTFN, os.O_RDONLY)
+        with self.open(fd, "rb", buffering=64, readahead=4,
+                       closefd=False) as f:
+            self.assertEqual(f.read(100), data[:100])
+        self.assertEqual(os.lseek(fd, 0, os.SEEK_CUR), 128)
+        os.close(fd)
+
+        # Pipes are read normally
+        r, w = os.pipe()
+        os.write(w, data[:1000])
+        os.close(w)
+        with self.open(r, "rb", buffering=64, readahead=4) as f:
+            self.assertEqual(f.read(10), data[:10])
+            self.assertEqual(f.read(), data[10:1000])
+
+    def test_open_readahead_seek(self):
+        # Seeks inside the buffers read ahead don't pause the thread, which
+        # leaves the file position untouched while it runs
+        data = bytes(range(256)) * 100
+        with self.open(support.TESTFN, "wb") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+        fd = os.open(support.TESTFN, os.O_RDONLY)
+        self.addCleanup(os.close, fd)
+        with self.open(fd, "rb", buffering=64, readahead=4,
+                       closefd=False) as f:
+            self.assertEqual(f.read(10), data[:10])
+            # Let the thread fill the ring
+            time.sleep(0.5)
+            self.assertEqual(f.seek(100), 100)
+            self.assertEqual(f.tell(), 100)
+            self.assertEqual(f.read(10), data[100:110])
+            self.assertEqual(f.seek(20, 1), 130)
+            self.assertEqual(f.read(10), data[130:140])
+            self.assertEqual(os.lseek(fd, 0, os.SEEK_CUR), 0)
+            # Out of range: the thread restarts from the target
+            self.assertEqual(f.seek(50), 50)
+            self.assertEqual(f.read(10), data[50:60])
+            self.assertEqual(os.lseek(fd, 0, os.SEEK_CUR), 50)
+            self.assertEqual(f.seek(20000), 20000)
+            self.assertEqual(f.read(10), data[20000:20010])
+            self.assertEqual(os.lseek(fd, 0, os.SEEK_CUR), 20000)
+            self.assertEqual(f.seek(-10, 2), len(data) - 10)
+            self.assertEqual(f.read(), data[-10:])
+
+    @unittest.skipUnless(hasattr(os, "fork"), "requires os.fork()")
+    def test_open_readahead_fork(self):
+        # The child process reads the file without the parent's thread
+        data = bytes(range(256)) * 100
+        with self.open(support.TESTFN, "wb") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+        with self.open(support.TESTFN, "rb", buffering=64, readahead=4) as f:
+            self.assertEqual(f.read(1000), data[:1000])
+            pid = os.fork()
+            if pid == 0:
+                try:
+                    ok = (f.read(3000) == data[1000:4000]
+                          and f.seek(10) == 10
+                          and f.read() == data[10:])
+                finally:
+                    os._exit(0 if ok else 1)
+            self.assertEqual(os.waitpid(pid, 0)[1], 0)
+
+    def test_open_readahead_threads(self):
+        # Concurrent reads of the same file
+        data = bytes(range(256)) * 1000
+        with self.open(support.TESTFN, "wb") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+        chunks = []
+        with self.open(support.TESTFN, "rb", buffering=512, readahead=4) as f:
+            def reader():
+                while True:
+                    chunk = f.read(100)
+                    if not chunk:
+                        break
+                    chunks.append(chunk)
+            threads = [threading.Thread(target=reader) for i in range(4)]
+            with support.start_threads(threads):
+                pass
+        self.assertEqual(sorted(chunks), sorted(data[i:i+100]
+                                                for i in range(0, len(data), 100)))
+
+    def test_open_readahead_threads_tell(self):
+        # tell() in a thread while another one reads
+        data = bytes(range(256)) * 1000
+        with self.open(support.TESTFN, "wb") as f:
+            f.write(data)
+        self.addCleanup(support.unlink, support.TESTFN)
+        chunks = []
+        positions = []
+        with self.open(support.TESTFN, "rb", buffering=512, readahead=4) as f:
+            self.assertEqual(f.read(1000), data[:1000])
+            # tell() doesn't pause the thread to move the file position
+            self.assertEqual(f.tell(), 1000)
+            self.assertEqual(os.lseek(f.fileno(), 0, os.SEEK_CUR), 0)
+            done = threading.Event()
+            def reader():
+                try:
+                    while True:
+                        chunk = f.read(100)
+                        if not chunk:
+                            break
+                        chunks.append(chunk)
+                finally:
+                    done.set()
+            def teller():
+                while not done.is_set():
+                    positions.append(f.tell())
+            threads = [threading.Thread(target=reader),
+                       threading.Thread(target=teller)]
+            with support.start_threads(threads):
+                pass
+            self.assertEqual(f.tell(), len(data))
+        self.assertEqual(b"".join(chunks), data[1000:])
+        self.assertEqual(positions, sorted(positions))
+        for pos in positions:
+            self.assertEqual(pos % 100, 0)
+            self.assertLessEqual(pos, len(data))
+
     def test_readinto_buffer_overflow(self):
         # Issue #18025
         class BadReader(self.io.BufferedIOBase):
@@ -0,0 +1,294 @@
+"""
+Tests for io_uring wrapper.
+"""
+import errno
+import os
+import select
+import socket
+import time
+import unittest
+try:
+    import threading
+except ImportError:
+    threading = None
+
+from test import support
+if not hasattr(select, "io_uring"):
+    raise unittest.SkipTest("test works only on Linux 5.11 and newer")
+
+try:
+    select.io_uring().close()
+except OSError as e:
+    if e.errno in (errno.ENOSYS, errno.EPERM):
+        raise unittest.SkipTest("kernel doesn't support io_uring")
+    raise
+
+
+class TestIoUring(unittest.TestCase):
+
+    def setUp(self):
+        self.ring = select.io_uring(8)
+        self.addCleanup(self.ring.close)
+
+    def socketpair(self):
+        a, b = socket.socketpair()
+        self.addCleanup(a.close)
+        self.addCleanup(b.close)
+        return a, b
+
+    def test_create(self):
+        ring = select.io_uring()
+        self.assertGreater(ring.fileno(), 0)
+        self.assertFalse(ring.closed)
+        self.assertFalse(os.get_inheritable(ring.fileno()))
+        self.assertEqual(ring.pending, 0)
+        ring.close()
+        self.assertTrue(ring.closed)
+        self.assertRaises(ValueError, ring.fileno)
+        self.assertRaises(ValueError, ring.wait, 0)
+        self.assertRaises(ValueError, ring.submit)
+        ring.close()
+
+        self.assertRaises(ValueError, select.io_uring, 0)
+        self.assertRaises(TypeError, select.io_uring, 'a')
+
+        with select.io_uring(entries=4) as ring:
+            self.assertFalse(ring.closed)
+        self.assertTrue(ring.closed)
+        with self.assertRaises(ValueError):
+            with ring:
+                pass
+
+    def test_recv_send(self):
+        a, b = self.socketpair()
+        buf = bytearray(10)
+        self.ring.recv(a.fileno(), buf, 1)
+        self.assertEqual(self.ring.pending, 1)
+        self.assertEqual(self.ring.wait(0), [])
+        self.ring.send(b.fileno(), b'spam', 2)
+        completions = []
+        while len(completions) < 2:
+            completions += self.ring.wait(10)
+        self.assertEqual(sorted(completions), [(1, 4, 0), (2, 4, 0)])
+        self.assertEqual(buf[:4], b'spam')
+        self.assertEqual(self.ring.pending, 0)
+
+    def test_recv_buffer(self):
+        a, b = self.socketpair()
+        self.assertRaises(TypeError, self.ring.recv, a.fileno(), b'abc', 1)
+        self.assertRaises(TypeError, self.ring.recv, a.fileno(), 'abc', 1)
+        self.assertRaises(BufferError, self.ring.recv, a.fileno(),
+                          memoryview(bytearray(10))[::2], 1)
+        self.assertEqual(self.ring.pending, 0)
+
+        # The buffer stays exported until the completion
+        buf = bytearray(10)
+        self.ring.recv(a.fileno(), buf, 1)
+        self.assertRaises(BufferError, buf.extend, b'x')
+        b.send(b'x')
+        self.assertEqual(self.ring.wait(10), [(1, 1, 0)])
+        buf.extend(b'x')
+
+    def test_user_data(self):
+        a, b = self.socketpair()
+        buf = bytearray(10)
+        self.ring.recv(a.fileno(), buf, 2**64 - 1)
+        self.assertRaises(ValueError,
+                          self.ring.recv, a.fileno(), buf, 2**64 - 1)
+        self.assertRaises(OverflowError,
+                          self.ring.recv, a.fileno(), buf, 2**64)
+        self.assertRaises(OverflowError,
+                          self.ring.recv, a.fileno(), buf, -1)
+        self.assertEqual(self.ring.pending, 1)
+        b.send(b'x')
+        self.assertEqual(self.ring.wait(10), [(2**64 - 1, 1, 0)])
+
+    def test_error(self):
+        r, w = os.pipe()
+        os.close(w)
+        self.addCleanup(os.close, r)
+        # recv() of a pipe fails with ENOTSOCK
+        self.ring.recv(r, bytearray(10), 1)
+        self.assertEqual(self.ring.wait(10), [(1, -errno.ENOTSOCK, 0)])
+
+    def test_read_write(self):
+        r, w = os.pipe()
+        self.addCleanup(os.close, r)
+        self.addCleanup(os.close, w)
+        buf = bytearray(10)
+        self.ring.write(w, b'eggs', 1)
+        self.assertEqual(self.ring.wait(10), [(1, 4, 0)])
+        self.ring.read(r, buf, 2)
+        self.assertEqual(self.ring.wait(10), [(2, 4, 0)])
+        self.assertEqual(buf[:4], b'eggs')
+
+        with open(support.TESTFN, 'wb+') as f:
+            self.addCleanup(support.unlink, support.TESTFN)
+            self.ring.write(f.fileno(), b'0123456789', 3, offset=0)
+            self.assertEqual(self.ring.wait(10), [(3, 10, 0)])
+            self.ring.read(f.fileno(), memoryview(buf)[:3], 4, offset=5)
+            self.assertEqual(self.ring.wait(10), [(4, 3, 0)])
+            self.assertEqual(buf[:3], b'567')
+
+    def test_accept(self):
+        with socket.socket() as listener:
+            listener.bind(('127.0.0.1', 0))
+            listener.listen()
+            self.ring.accept(listener.fileno(), 1)
+            self.ring.submit()
+            client = socket.create_connection(listener.getsockname())
+            self.addCleanup(client.close)
+            [(user_data, fd, flags)] = self.ring.wait(10)
+        self.assertEqual(user_data, 1)
+        self.assertGreaterEqual(fd, 0)
+        with socket.socket(fileno=fd) as conn:
+            self.assertFalse(conn.get_inheritable())
+            self.assertEqual(conn.getpeername(), client.getsockname())
+
+    def test_poll_add(self):
+        a, b = self.socketpair()
+        self.ring.poll_add(a.fileno(), select.POLLIN, 1)
+        self.assertEqual(self.ring.wait(0), [])
+        b.send(b'x')
+        self.assertEqual(self.ring.wait(10), [(1, select.POLLIN, 0)])
+        self.ring.poll_add(a.fileno(), select.POLLIN | select.POLLOUT, 2)
+        self.assertEqual(self.ring.wait(10),
+                         [(2, select.POLLIN | select.POLLOUT, 0)])
+
+    def test_cancel(self):
+        a, b = self.socketpair()
+        self.ring.recv(a.fileno(), bytearray(10), 1)
+        self.ring.submit()
+        self.ring.cancel(1, 2)
+        completions = []
+        while len(completions) < 2:
+            completions += self.ring.wait(10)
+        self.assertEqual(sorted(completions),
+                         [(1, -errno.ECANCELED, 0), (2, 0, 0)])
+        self.ring.cancel(1, 3)
+        self.assertEqual(self.ring.wait(10), [(3, -errno.ENOENT, 0)])
+        self.assertEqual(self.ring.pending, 0)
+
+    def test_wait_timeout(self):
+        a, b = self.socketpair()
+        self.ring.recv(a.fileno(), bytearray(10), 1)
+        t = time.monotonic()
+        self.assertEqual(self.ring.wait(0.1), [])
+        self.assertGreaterEqual(time.monotonic() - t, 0.09)
+        self.assertRaises(TypeError, self.ring.wait, 'a')
+        self.assertEqual(self.ring.wait(-1), [])
+
+    def test_submission_queue_full(self):
+        a, b = self.socketpair()
+        # More operations than submission queue entries: the queued
+        # operations are submitted to make room
+        n = 20
+        for i in range(n):
+            self.ring.poll_add(a.fileno(), select.POLLOUT, i)
+        self.assertEqual(self.ring.pending, n)
+        completions = []
+        while len(completions) < n:
+            completions += self.ring.wait(10)
+        self.assertEqual(sorted(user_data for user_data, res, flags
+                                in completions), list(range(n)))
+        self.assertEqual(self.ring.submit(), 0)
+
+    def test_fixed_buffers(self):
+        r, w = os.pipe()
+        self.addCleanup(os.close, r)
+        self.addCleanup(os.close, w)
+        bufs = [bytearray(b'abcdef'), bytearray(4)]
+        self.assertRaises(ValueError, self.ring.unregister_buffers)
+        self.assertRaises(TypeError, self.ring.register_buffers, [b'abc'])
+        self.assertRaises(ValueError, self.ring.register_buffers, [])
+        self.ring.register_buffers(bufs)
+        self.assertRaises(ValueError, self.ring.register_buffers, bufs)
+        self.assertRaises(BufferError, bufs[0].extend, b'x')
+
+        self.assertRaises(IndexError, self.ring.write_fixed, w, 2, 1)
+        self.ring.write_fixed(w, 0, 1, nbytes=3)
+        self.assertEqual(self.ring.wait(10), [(1, 3, 0)])
+        self.ring.read_fixed(r, 1, 2)
+        self.assertEqual(self.ring.wait(10), [(2, 3, 0)])
+        self.assertEqual(bufs[1], b'abc\0')
+
+        self.ring.unregister_buffers()
+        bufs[0].extend(b'x')
+
+    def test_close_releases_buffers(self):
+        a, b = self.socketpair()
+        buf = bytearray(10)
+        fixed = [bytearray(10)]
+        ring = select.io_uring(4)
+        ring.recv(a.fileno(), buf, 1)
+        ring.register_buffers(fixed)
+        ring.close()
+        buf.extend(b'x')
+        fixed[0].extend(b'x')
+
+    def test_unregister_buffers_pending(self):
+        a, b = self.socketpair()
+        fixed = [bytearray(10)]
+        self.ring.register_buffers(fixed)
+        self.ring.read_fixed(a.fileno(), 0, 1)
+        self.ring.submit()
+        self.assertRaises(BufferError, self.ring.unregister_buffers)
+        b.send(b'abc')
+        self.assertEqual(self.ring.wait(10), [(1, 3, 0)])
+        self.ring.unregister_buffers()
+        self.assertEqual(fixed[0][:3], b'abc')
+        fixed[0].extend(b'x')
+
+    def test_close_cancels(self):
+        # close() cancels the operations in flight, submitted or not,
+        # before releasing their buffers
+        a, b = self.socketpair()
+        buf = bytearray(10)
+        fixed = [bytearray(10)]
+        ring = select.io_uring(4)
+        ring.register_buffers(fixed)
+        ring.read_fixed(a.fileno(), 0, 1)
+        ring.recv(a.fileno(), buf, 2)
+        ring.submit()
+        ring.poll_add(a.fileno(), select.POLLIN, 3)
+        self.assertEqual(ring.pending, 3)
+        ring.close()
+        self.assertEqual(ring.pending, 0)
+        fixed[0].extend(b'x')
+        buf.extend(b'x')
+        b.send(b'abc')
+        self.assertEqual(a.recv(10), b'abc')
+        self.assertEqual(fixed[0], bytes(10) + b'x')
+        self.assertEqual(buf, bytes(10) + b'x')
+
+    @unittest.skipUnless(threading, 'Threading required for this test.')
+    def test_close_while_waiting(self):
+        # close() doesn't unmap the rings under a thread blocked in wait()
+        a, b = self.socketpair()
+        self.ring.recv(a.fileno(), bytearray(10), 1)
+        results = []
+        thread = threading.Thread(
+            target=lambda: results.append(self.ring.wait(10)))
+        thread.start()
+        try:
+            time.sleep(0.2)
+            self.assertRaises(RuntimeError, self.ring.close)
+            self.assertFalse(self.ring.closed)
+        finally:
+            b.send(b'abc')
+            thread.join()
+        self.assertEqual(results, [[(1, 3, 0)]])
+        self.ring.close()
+        self.assertTrue(self.ring.closed)
+
+    def test_closed_fixed(self):
+        self.ring.close()
+        self.assertRaises(ValueError, self.ring.read_fixed, 0, 0, 1)
+        self.assertRaises(ValueError, self.ring.write_fixed, 0, 0, 1)
+
+
+def test_main():
+    support.run_unittest(TestIoUring)
+
+if __name__ == "__main__":
+    test_main()
@@ -512,6 +512,95 @@ class PyBytesIOTest(MemoryTestMixin, MemorySeekTestMixin, unittest.TestCase):
         self.ioclass(initial_bytes=buf)
         self.assertRaises(TypeError, self.ioclass, buf, foo=None)
 
+    def test_write_many(self):
+        memio = self.ioclass(b"12345")
+        self.assertEqual(memio.write_many([b"ab", bytearray(b"cd"),
+                                           memoryview(b"ef"), b""]), 6)
+        self.assertEqual(memio.getvalue(), b"abcdef")
+        self.assertEqual(memio.write_many(iter([b"g", b"h"])), 2)
+        self.assertEqual(memio.write_many([]), 0)
+        self.assertEqual(memio.tell(), 8)
+        memio.seek(10)
+        self.assertEqual(memio.write_many([b"i"]), 1)
+        self.assertEqual(memio.getvalue(), b"abcdefgh\0\0i")
+        self.assertRaises(TypeError, memio.write_many, [b"j", "k"])
+        self.assertRaises(TypeError, memio.write_many, None)
+        self.assertEqual(memio.getvalue(), b"abcdefgh\0\0i")
+        memio.close()
+        self.assertRaises(ValueError, memio.write_many, [b"l"])
+
+    def test_getbuffers(self):
+        memio = self.ioclass()
+        self.assertEqual(memio.getbuffers(), [])
+        memio = self.ioclass(b"1234567890")
+        self.assertEqual(b"".join(memio.getbuffers()), b"1234567890")
+        for buf in memio.getbuffers():
+            self.assertIsInstance(buf, bytes)
+        memio.close()
+        self.assertRaises(ValueError, memio.getbuffers)
+
+    def test_chunked(self):
+        big = b"x" * 100000
+        memio = self.ioclass(b"12345", chunked=True)
+        memio.seek(0, 2)
+        self.assertEqual(memio.write(b"ab"), 2)
+        self.assertEqual(memio.write(bytearray(b"cd")), 2)
+        self.assertEqual(memio.write(big), len(big))
+        self.assertEqual(memio.write_many([b"ef", big, b"gh"]),
+                         len(big) + 4)
+        expected = b"12345abcd" + big + b"ef" + big + b"gh"
+        self.assertEqual(memio.tell(), len(expected))
+        bufs = memio.getbuffers()
+        self.assertEqual(b"".join(bufs), expected)
+        for buf in bufs:
+            self.assertIsInstance(buf, bytes)
+        # Writing after getbuffers() doesn't modify the returned chunks
+        memio.write(b"ij")
+        self.assertEqual(b"".join(bufs), expected)
+        expected += b"ij"
+        self.assertEqual(b"".join(memio.getbuffers()), expected)
+        # Reads and writes inside the stream see all the chunks
+        memio.seek(3)
+        self.assertEqual(memio.read(4), b"45ab")
+        memio.write(b"AB")
+        expected = expected[:7] + b"AB" + expected[9:]
+        self.assertEqual(memio.getvalue(), expected)
+        memio.seek(0, 2)
+        memio.write(b"kl")
+        memio.seek(0)
+        self.assertEqual(memio.readline(), expected + b"kl")
+        memio.write(b"mn")
+        memio.seek(-2, 2)
+        b = bytearray(5)
+        self.assertEqual(memio.readinto(b), 2)
+        self.assertEqual(b[:2], b"mn")
+        self.assertEqual(memio.truncate(3), 3)
+        self.assertEqual(memio.getvalue(), b"123")
+        # Writing past the end pads with null bytes
+        memio.seek(5)
+        memio.write(b"op")
+        memio.write(b"qr")
+        self.assertEqual(memio.getvalue(), b"123\0\0opqr")
+
+        memio = self.ioclass(chunked=True)
+        memio.write(b"abc")
+        memio.write(b"def")
+        self.assertEqual(list(memio), [])
+        memio.seek(0)
+        self.assertEqual(list(memio), [b"abcdef"])
+        memio.write(b"gh")
+        buf = memio.getbuffer()
+        self.assertEqual(bytes(buf), b"abcdefgh")
+        self.assertRaises(BufferError, memio.write, b"i")
+        self.assertRaises(BufferError, memio.write_many, [b"i"])
+        buf.release()
+        memio.write(b"i")
+        self.assertEqual(memio.getvalue(), b"abcdefghi")
+        memio.close()
+        self.assertRaises(ValueError, memio.write, b"j")
+
+        self.assertRaises(TypeError, self.ioclass, b"", True)
+
 
 class TextIOTestMixin:
 
@@ -729,11 +818,47 @@ class CBytesIOTest(PyBytesIOTest):
 
     @support.cpython_only
     def test_sizeof(self):
-        basesize = support.calcobjsize('P2n2Pn')
+        basesize = support.calcobjsize('P2n2Pni2P2n')
         check = self.check_sizeof
         self.assertEqual(object.__sizeof__(io.BytesIO()), basesize)
         check(io.BytesIO(), basesize )
         check(io.BytesIO(b'a' * 1000), basesize + sys.getsizeof(b'a' * 1000))
+        memio = io.BytesIO(chunked=True)
+        memio.write(b'a' * 1000)
+        memio.write(b'a' * 1000)
+        self.assertGreater(sys.getsizeof(memio), basesize + 2000)
+
+    @support.cpython_only
+    def test_chunked_no_copy(self):
+        # Large bytes objects are stored and returned without copying
+        big = b'x' * 100000
+        memio = self.ioclass(b'spam', chunked=True)
+        memio.seek(0, 2)
+        memio.write(big)
+        memio.write_many([b'ham', big])
+        bufs = memio.getbuffers()
+        self.assertEqual(len(bufs), 4)
+        self.assertIs(bufs[1], big)
+        self.assertEqual(bufs[2], b'ham')
+        self.assertIs(bufs[3], big)
+
+        # A single chunk becomes the buffer
+        memio = self.ioclass(chunked=True)
+        memio.write(big)
+        self.assertIs(memio.getvalue(), big)
+
+    def test_chunked_truncate_shared(self):
+        # Joining the chunks must not write into the shared initial value,
+        # even when it is large enough to hold them
+        big = bytes(1000)
+        memio = self.ioclass(big, chunked=True)
+        memio.truncate(900)
+        memio.seek(0, 2)
+        memio.write(b'abc')
+        memio.seek(0)
+        self.assertEqual(memio.read(), bytes(900) + b'abc')
+        self.assertEqual(big[900:903], bytes(3))
+        self.assertEqual(big, bytes(1000))
 
     # Various tests of copy-on-write behaviour for BytesIO.
 
@@ -2431,6 +2431,66 @@ class TestSendfile(unittest.TestCase):
                 raise
 
 
+@unittest.skipUnless(hasattr(os, 'splice'), "test needs os.splice()")
+class TestSplice(unittest.TestCase):
+
+    DATA = b"12345abcde" * 1024
+
+    def setUp(self):
+        with open(support.TESTFN, "wb") as f:
+            f.write(self.DATA)
+        self.addCleanup(support.unlink, support.TESTFN)
+        self.file = open(support.TESTFN, "rb")
+        self.addCleanup(self.file.close)
+        self.r, self.w = os.pipe()
+        self.addCleanup(os.close, self.r)
+        self.addCleanup(os.close, self.w)
+
+    def test_file_to_pipe(self):
+        fd = self.file.fileno()
+        self.assertEqual(os.splice(fd, self.w, 4000), 4000)
+        self.assertEqual(os.read(self.r, 5000), self.DATA[:4000])
+        self.assertEqual(os.lseek(fd, 0, os.SEEK_CUR), 4000)
+
+    def test_offset(self):
+        fd = self.file.fileno()
+        self.assertEqual(os.splice(fd, self.w, 10, offset_src=5), 10)
+        self.assertEqual(os.read(self.r, 100), b"abcde12345")
+        # The file position is unchanged
+        self.assertEqual(os.lseek(fd, 0, os.SEEK_CUR), 0)
+        self.assertEqual(os.splice(fd, self.w, 10, len(self.DATA)), 0)
+
+    def test_pipe_to_socket(self):
+        a, b = socket.socketpair()
+        with a, b:
+            os.write(self.w, b"spam" * 100)
+            self.assertEqual(os.splice(self.r, a.fileno(), 400,
+                                       flags=os.SPLICE_F_MORE), 400)
+            data = b""
+            while len(data) < 400:
+                data += b.recv(400)
+            self.assertEqual(data, b"spam" * 100)
+
+    def test_nonblock(self):
+        # An empty pipe
+        r, w = os.pipe()
+        self.addCleanup(os.close, r)
+        self.addCleanup(os.close, w)
+        self.assertRaises(BlockingIOError, os.splice, r, self.w, 10,
+                          flags=os.SPLICE_F_NONBLOCK)
+
+    def test_errors(self):
+        fd = self.file.fileno()
+        self.assertRaises(ValueError, os.splice, fd, self.w, -1)
+        self.assertRaises(TypeError, os.splice, fd, self.w, 10, "0")
+        # Offsets can't be used with pipes
+        with self.assertRaises(OSError) as cm:
+            os.splice(fd, self.w, 10, 0, 0)
+        self.assertEqual(cm.exception.errno, errno.ESPIPE)
+        # Neither file descriptor is a pipe
+        self.assertRaises(OSError, os.splice, fd, fd, 10)
+
+
 def supports_extended_attributes():
     if not hasattr(os, "setxattr"):
         return False
@@ -369,6 +369,23 @@ class TestSet(TestJointOps, unittest.TestCase):
     thetype = set
     basetype = set
 
+    def test_colliding_keys(self):
+        # Keys sharing their initial slot go through the linear probes of
+        # the lookup, among deleted entries.
+        keys = [i << 24 for i in range(300)]
+        s = self.thetype(keys)
+        removed = set(keys[::3])
+        for k in keys[::3]:
+            s.remove(k)
+        for k in keys:
+            self.assertEqual(k in s, k not in removed)
+        for k in keys[::6]:
+            s.add(k)
+            removed.discard(k)
+        for k in keys:
+            self.assertEqual(k in s, k not in removed)
+        self.assertEqual(len(s), len(keys) - len(removed))
+
     def test_init(self):
         s = self.thetype()
         s.__init__(self.word)
@@ -714,6 +731,56 @@ class TestFrozenSet(TestJointOps, unittest.TestCase):
             addhashvalue(hash(frozenset([e for e, m in elemmasks if m&i])))
         self.assertEqual(len(hashvalues), 2**n)
 
+    def _not_tracked(self, s):
+        # Nested containers can take several collections to untrack
+        gc.collect()
+        gc.collect()
+        self.assertFalse(gc.is_tracked(s), s)
+
+    def _tracked(self, s):
+        self.assertTrue(gc.is_tracked(s), s)
+        gc.collect()
+        gc.collect()
+        self.assertTrue(gc.is_tracked(s), s)
+
+    @support.cpython_only
+    def test_track_dynamic(self):
+        # Test GC-optimization of frozensets holding only atomic objects.
+        # Frozenset subtypes must always be tracked.
+        x, y, z = 1.5, "a", (1, None)
+        tp = self.thetype
+        exact = tp is frozenset
+
+        s = tp([x, y, z])
+        if exact:
+            # Untracked as soon as it is built, without a collection.
+            self.assertFalse(gc.is_tracked(s))
+        check = self._not_tracked if exact else self._tracked
+        check(s)
+        check(tp(range(100)))
+        check(tp([tp([x])]))
+        # Set operations return exact frozensets, even for subtypes.
+        self._not_tracked(s | tp([2, 3]))
+        self._not_tracked(s & tp([x]))
+
+        class C:
+            pass
+        self._tracked(tp([C()]))
+        self._tracked(tp([(x, C())]))
+        self._tracked(tp([x]) | tp([C()]))
+
+    @support.cpython_only
+    def test_track_after_update(self):
+        # An untracked frozenset still under construction (as in set
+        # operations) must be tracked again when a container is added.
+        class C:
+            pass
+        c = C()
+        s = self.thetype([1, 2])
+        t = s | self.thetype([c])
+        self._tracked(t)
+        self.assertIn(c, t)
+
 class FrozenSetSubclass(frozenset):
     pass
 
@@ -1871,6 +1871,126 @@ class BasicUDPTest(ThreadedUDPSocketTest):
     def _testRecvFromNegative(self):
         self.cli.sendto(MSG, 0, (HOST, self.port))
 
+class BatchedUDPTest(SocketUDPTest):
+    # Tests for recvmmsg_into() and sendmmsg().
+
+    def setUp(self):
+        super().setUp()
+        self.cli = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.addCleanup(self.cli.close)
+        self.cli.bind((HOST, 0))
+        self.serv.settimeout(self.fail_timeout)
+
+    fail_timeout = 3.0
+
+    def sendDatagrams(self, msgs):
+        for msg in msgs:
+            self.cli.sendto(msg, (HOST, self.port))
+
+    @requireAttrs(socket.socket, "sendmmsg")
+    def testSendmmsg(self):
+        msgs = [MSG, b"", bytearray(b"x" * 100), memoryview(b"abc")]
+        self.assertEqual(self.cli.sendmmsg(msgs, 0, (HOST, self.port)),
+                         len(msgs))
+        for msg in msgs:
+            self.assertEqual(self.serv.recv(1024), bytes(msg))
+
+    @requireAttrs(socket.socket, "sendmmsg")
+    def testSendmmsgConnected(self):
+        self.cli.connect((HOST, self.port))
+        self.assertEqual(self.cli.sendmmsg(iter([MSG, MSG[::-1]])), 2)
+        self.assertEqual(self.serv.recv(1024), MSG)
+        self.assertEqual(self.serv.recv(1024), MSG[::-1])
+
+    @requireAttrs(socket.socket, "sendmmsg")
+    def testSendmmsgErrors(self):
+        self.assertEqual(self.cli.sendmmsg([], 0, (HOST, self.port)), 0)
+        self.assertRaises(TypeError, self.cli.sendmmsg, None)
+        self.assertRaises(TypeError, self.cli.sendmmsg, ["abc"],
+                          0, (HOST, self.port))
+        self.assertRaises(TypeError, self.cli.sendmmsg, [MSG], 0, "spam")
+
+    @requireAttrs(socket.socket, "recvmmsg_into")
+    def testRecvmmsgInto(self):
+        self.sendDatagrams([b"a", b"bc", b"def"])
+        bufs = [bytearray(2) for i in range(5)]
+        # Wait for the datagrams to be queued
+        select.select([self.serv], [], [], self.fail_timeout)
+        time.sleep(0.1)
+        result = self.serv.recvmmsg_into(bufs)
+        self.assertEqual([nbytes for nbytes, addr in result], [1, 2, 2])
+        self.assertEqual(bufs[:3], [b"a\0", b"bc", b"de"])
+        self.assertEqual(bufs[3:], [b"\0\0", b"\0\0"])
+        addr = self.cli.getsockname()
+        for nbytes, address in result:
+            self.assertEqual(address, addr)
+        # The address is shared by datagrams from the same peer
+        self.assertIs(result[0][1], result[2][1])
+
+    @requireAttrs(socket.socket, "recvmmsg_into")
+    def testRecvmmsgIntoWaitsForOne(self):
+        # Only the first datagram is waited for
+        self.sendDatagrams([MSG])
+        bufs = [bytearray(1024) for i in range(3)]
+        result = self.serv.recvmmsg_into(bufs)
+        self.assertEqual(len(result), 1)
+        self.assertEqual(bufs[0][:result[0][0]], MSG)
+
+    @requireAttrs(socket.socket, "recvmmsg_into")
+    def testRecvmmsgIntoSizes(self):
+        self.sendDatagrams([MSG, b"xy"])
+        select.select([self.serv], [], [], self.fail_timeout)
+        time.sleep(0.1)
+        bufs = [bytearray(1024), memoryview(bytearray(1024)), bytearray(1)]
+        sizes = array.array("I", [99] * 4)
+        self.assertEqual(self.serv.recvmmsg_into(bufs, 0, sizes), 2)
+        self.assertEqual(list(sizes), [len(MSG), 2, 99, 99])
+        self.assertEqual(bufs[0][:len(MSG)], MSG)
+        self.assertEqual(bufs[1][:2], b"xy")
+
+    @requireAttrs(socket.socket, "recvmmsg_into")
+    def testRecvmmsgIntoTimeout(self):
+        self.serv.settimeout(0.01)
+        self.assertRaises(socket.timeout, self.serv.recvmmsg_into,
+                          [bytearray(10)])
+        self.serv.setblocking(False)
+        self.assertRaises(BlockingIOError, self.serv.recvmmsg_into,
+                          [bytearray(10)])
+
+    @requireAttrs(socket.socket, "recvmmsg_into")
+    def testRecvmmsgIntoErrors(self):
+        self.assertEqual(self.serv.recvmmsg_into([]), [])
+        self.assertEqual(self.serv.recvmmsg_into([], 0, array.array("I")), 0)
+        self.assertRaises(TypeError, self.serv.recvmmsg_into, None)
+        self.assertRaises(TypeError, self.serv.recvmmsg_into, [b"abc"])
+        bufs = [bytearray(10)] * 2
+        self.assertRaises(TypeError, self.serv.recvmmsg_into,
+                          bufs, 0, bytearray(8))
+        self.assertRaises(TypeError, self.serv.recvmmsg_into,
+                          bufs, 0, array.array("d", [0, 0]))
+        self.assertRaises(BufferError, self.serv.recvmmsg_into,
+                          bufs, 0, b"\0" * 8)
+        self.assertRaises(ValueError, self.serv.recvmmsg_into,
+                          bufs, 0, array.array("I", [0]))
+
+    @requireAttrs(socket.socket, "sendmmsg")
+    @requireAttrs(socket.socket, "recvmmsg_into")
+    def testRoundTrip(self):
+        msgs = [bytes([i]) * i for i in range(1, 65)]
+        self.assertEqual(self.cli.sendmmsg(msgs, 0, (HOST, self.port)),
+                         len(msgs))
+        bufs = [bytearray(64) for i in range(len(msgs))]
+        sizes = array.array("I", [0] * len(bufs))
+        received = 0
+        while received < len(msgs):
+            count = self.serv.recvmmsg_into(bufs[received:], 0,
+                                            memoryview(sizes)[received:])
+            self.assertGreater(count, 0)
+            received += count
+        self.assertEqual([bytes(buf[:size]) for buf, size in zip(bufs, sizes)],
+                         msgs)
+
+
 # Tests for the sendmsg()/recvmsg() interface.  Where possible, the
 # same test code is used with different families and types of socket
 # (e.g. stream, datagram), and tests using recvmsg() are repeated
@@ -5298,10 +5418,45 @@ class SendfileUsingSendfileTest(SendfileUsingSendTest):
     def meth_from_sock(self, sock):
         return getattr(sock, "_sendfile_use_sendfile")
 
+    # partial send with the C implementation
+
+    @requireAttrs(socket.socket, "_sendfile")
+    def _testPartialSendTimeout(self):
+        address = self.serv.getsockname()
+        file = open(support.TESTFN, 'rb')
+        with socket.create_connection(address, timeout=0.1) as sock, \
+                file as file:
+            # The data sent before the timeout is reported, then the next
+            # call raises the timeout
+            sent = sock._sendfile(file.fileno(), 0, self.FILESIZE)
+            self.assertGreater(sent, 0)
+            self.assertLess(sent, self.FILESIZE)
+            self.assertRaises(socket.timeout, sock._sendfile,
+                              file.fileno(), sent, self.FILESIZE - sent)
+            self.assertEqual(file.tell(), 0)
+
+    @requireAttrs(socket.socket, "_sendfile")
+    def testPartialSendTimeout(self):
+        conn = self.accept_conn()
+        conn.recv(88192)
+
+    def _test_sendfile_args(self):
+        pass
+
+    @requireAttrs(socket.socket, "_sendfile")
+    def test_sendfile_args(self):
+        with open(support.TESTFN, 'rb') as file, socket.socket() as s:
+            self.assertRaises(ValueError, s._sendfile, file.fileno(), -1, 1)
+            self.assertRaises(ValueError, s._sendfile, file.fileno(), 0, -1)
+            self.assertRaises(TypeError, s._sendfile, file, 0, 1)
+            # Not connected
+            self.assertRaises(OSError, s._sendfile, file.fileno(), 0, 1)
+
 
 def test_main():
     tests = [GeneralModuleTests, BasicTCPTest, TCPCloserTest, TCPTimeoutTest,
-             TestExceptions, BufferIOTest, BasicTCPTest2, BasicUDPTest, UDPTimeoutTest ]
+             TestExceptions, BufferIOTest, BasicTCPTest2, BasicUDPTest, BatchedUDPTest,
+             UDPTimeoutTest ]
 
     tests.extend([
         NonBlockingTCPTests,
@@ -262,5 +262,140 @@ class TestDecorateSortUndecorate(unittest.TestCase):
 
 #==============================================================================
 
+def check_against_PyObject_RichCompare(test, L):
+    # The specialized comparisons must agree with the generic one, which
+    # cmp_to_key() forces.
+    def cmp(x, y):
+        return (x > y) - (x < y)
+    for reverse in (False, True):
+        expected = sorted(L, key=cmp_to_key(cmp), reverse=reverse)
+        result = sorted(L, reverse=reverse)
+        test.assertEqual(len(result), len(expected))
+        for a, b in zip(result, expected):
+            test.assertIs(a, b)
+
+class TestOptimizedCompares(unittest.TestCase):
+
+    def test_small_ints(self):
+        L = [random.randrange(-2**30 + 1, 2**30) for i in range(500)]
+        L += [0, -0, 1, -1]
+        check_against_PyObject_RichCompare(self, L)
+
+    def test_big_ints(self):
+        L = [random.randrange(-2**100, 2**100) for i in range(500)]
+        L += [random.randrange(-1000, 1000) for i in range(100)]
+        check_against_PyObject_RichCompare(self, L)
+
+    def test_floats(self):
+        L = [random.uniform(-1e300, 1e300) for i in range(500)]
+        L += [0.0, -0.0, float('inf'), float('-inf')]
+        check_against_PyObject_RichCompare(self, L)
+
+    def test_float_nans(self):
+        nan = float('nan')
+        L = [random.random() for i in range(100)]
+        L[::10] = [nan] * 10
+        check_against_PyObject_RichCompare(self, L)
+
+    def test_strs(self):
+        for maxchar in (0x7f, 0xff, 0xffff, sys.maxunicode):
+            L = [''.join(chr(random.randint(0, maxchar))
+                         for j in range(random.randrange(6)))
+                 for i in range(500)]
+            check_against_PyObject_RichCompare(self, L)
+        # Mixed kinds.
+        L = ['a', '\xe9', '\u20ac', '\U0001f600', 'ab', '\u20aca', '']
+        check_against_PyObject_RichCompare(self, L * 10)
+
+    def test_strs_common_prefix(self):
+        L = ['\u20ac' * 10 + chr(0x20ac + i % 7) for i in range(100)]
+        L += ['\u20ac' * 10, '\u20ac' * 11]
+        check_against_PyObject_RichCompare(self, L)
+
+    def test_mixed_types(self):
+        check_against_PyObject_RichCompare(self, [1, 2.5, True, 0, -1.5] * 20)
+        check_against_PyObject_RichCompare(self, [3, 2**70, 1, -2**70])
+        class MyInt(int):
+            pass
+        check_against_PyObject_RichCompare(self,
+                                           [MyInt(i % 7) for i in range(50)])
+        self.assertRaises(TypeError, sorted, [1, 'a'] * 10)
+        self.assertRaises(TypeError, sorted, ['a'] * 10 + [1.0])
+
+    def test_key_function(self):
+        L = list(range(100))
+        random.shuffle(L)
+        self.assertEqual(list(map(str, sorted(L, key=str))),
+                         sorted(map(str, L)))
+        self.assertEqual(sorted(L, key=float), list(range(100)))
+        self.assertEqual(sorted(L, key=lambda x: -x), list(range(99, -1, -1)))
+
+    def test_stability(self):
+        data = [(random.randrange(20), i) for i in range(300)]
+        result = sorted(data, key=lambda x: x[0])
+        self.assertEqual(result, sorted(data))
+        result = sorted(data, key=lambda x: str(x[0]))
+        self.assertEqual(result, sorted(data, key=lambda x: (str(x[0]), x[1])))
+
+class TestParallel(unittest.TestCase):
+    # Large enough to be cut into several chunks.
+    size = 150001
+
+    def check(self, L, **kwargs):
+        expected = sorted(L, **kwargs)
+        for parallel in (True, 2, 3, 4, 64):
+            result = sorted(L, parallel=parallel, **kwargs)
+            self.assertEqual(len(result), len(expected))
+            for a, b in zip(result, expected):
+                self.assertIs(a, b)
+            copy = L[:]
+            copy.sort(parallel=parallel, **kwargs)
+            self.assertEqual(copy, expected)
+
+    def test_types(self):
+        floats = [random.random() for i in range(self.size)]
+        self.check(floats)
+        self.check(floats, reverse=True)
+        self.check([int(x * 1000) for x in floats])
+        self.check([str(x) for x in floats])
+        self.check(['\u20ac' + str(x) for x in floats])
+
+    def test_presorted(self):
+        self.check(list(range(self.size)))
+        self.check(list(range(self.size, 0, -1)))
+        self.check([0.5] * self.size)
+
+    def test_stability(self):
+        data = [(random.randrange(100), i) for i in range(self.size)]
+        self.check(data, key=lambda x: x[0])
+        self.check(data, key=lambda x: x[0], reverse=True)
+        self.check(data, key=lambda x: str(x[0]))
+
+    def test_generic_keys(self):
+        # Keys without a specialized comparison are sorted serially.
+        self.check([(random.random(),) for i in range(self.size)])
+        self.check([random.random() if i & 1 else i
+                    for i in range(self.size)])
+
+    def test_small(self):
+        self.check([])
+        self.check([1])
+        self.check([3, 1, 2])
+
+    def test_errors(self):
+        L = [3, 1, 2]
+        self.assertRaises(ValueError, L.sort, parallel=-1)
+        self.assertRaises(TypeError, L.sort, parallel='2')
+        self.assertRaises(TypeError, L.sort, parallel=2.0)
+        self.assertRaises(TypeError, sorted, L, parallel=[])
+        self.assertRaises(TypeError, sorted, [1, 'a'] * self.size,
+                          parallel=4)
+        L.sort(parallel=0)
+        self.assertEqual(L, [1, 2, 3])
+        L.sort(parallel=None, reverse=True)
+        self.assertEqual(L, [3, 2, 1])
+
+#==============================================================================
+
 if __name__ == "__main__":
     unittest.main()
@@ -546,6 +546,64 @@ class SysModuleTest(unittest.TestCase):
 
         self.assertRaises(TypeError, sys.intern, S("abc"))
 
+    def test_intern_many(self):
+        # Interned strings are removed from the table when they die, and the
+        # table is resized as it fills up.
+        kept = []
+        for i in range(20000):
+            s = sys.intern("intern many %d" % i)
+            if i % 3 == 0:
+                kept.append(s)
+        for i, s in zip(range(0, 20000, 3), kept):
+            self.assertIs(sys.intern("intern many %d" % i), s)
+        s = "intern many %d" % 1
+        self.assertIs(sys.intern(s), s)
+
+    def test_dedup_strings(self):
+        def fresh(value):
+            # a new string object equal to value
+            return "".join(list(value))
+
+        src = ("def f():\n"
+               "    return 'a constant!'\n"
+               "def g():\n"
+               "    def h():\n"
+               "        return ['a constant!', 'interned constant!']\n"
+               "    return h\n")
+        funcs = []
+        for i in range(3):
+            ns = {}
+            exec(compile(src, "<dedup %d>" % i, "exec"), ns)
+            funcs.append(ns["f"])
+            funcs.append(ns["g"]())
+        interned = sys.intern(fresh("interned constant!"))
+        self.assertEqual(len({id(f()) for f in funcs[::2]}), 3)
+        records = [{"name": fresh("value")} for i in range(10)]
+        items = [fresh("not interned") for i in range(10)]
+        keys = [id(v) for r in records for v in r.values()]
+
+        stats = sys.dedup_strings()
+        self.assertEqual(sorted(stats),
+                         ["freed", "merged", "reclaimed", "strings"])
+        self.assertGreaterEqual(stats["strings"], 12)
+        # other duplicates may be merged too
+        self.assertGreaterEqual(stats["merged"], 2 + 3 + 3)
+        self.assertGreaterEqual(stats["freed"], 2 + 3 + 3)
+        self.assertGreater(stats["reclaimed"], 0)
+
+        self.assertEqual(len({id(f()) for f in funcs[::2]}), 1)
+        self.assertIs(funcs[1]()[0], funcs[0]())
+        for h in funcs[1::2]:
+            self.assertEqual(h(), ["a constant!", "interned constant!"])
+            self.assertIs(h()[1], interned)
+        # Strings held by other objects are left alone
+        self.assertEqual([id(v) for r in records for v in r.values()], keys)
+        self.assertEqual(len(set(map(id, items))), 10)
+
+        # Once merged, the strings are left alone.
+        stats = sys.dedup_strings()
+        self.assertEqual(stats["merged"], 0)
+
     def test_sys_flags(self):
         self.assertTrue(sys.flags)
         attrs = ("debug",
@@ -1106,8 +1164,8 @@ class SizeofTest(unittest.TestCase):
         samples = ['1'*100, '\xff'*50,
                    '\u0100'*40, '\uffff'*100,
                    '\U00010000'*30, '\U0010ffff'*100]
-        asciifields = "nnbP"
-        compactfields = asciifields + "nPn"
+        asciifields = "nnb"
+        compactfields = asciifields + "PnPn"
         unicodefields = compactfields + "P"
         for s in samples:
             maxchar = ord(max(s))
@@ -1161,7 +1219,9 @@ class SizeofTest(unittest.TestCase):
         check(S(), set(), '3P')
         class FS(frozenset):
             __slots__ = 'a', 'b', 'c'
-        check(FS(), frozenset(), '3P')
+        # An empty frozenset is not tracked, but it has a GC header anyway.
+        self.assertEqual(sys.getsizeof(FS()),
+                         sys.getsizeof(frozenset()) + struct.calcsize('3P'))
         from collections import OrderedDict
         class OD(OrderedDict):
             __slots__ = 'a', 'b', 'c'
@@ -400,6 +400,16 @@ class TestSysConfig(unittest.TestCase):
             else: # 8 byte pointer size
                 self.assertTrue(suffix.endswith('x86_64-linux-gnu.so'), suffix)
 
+    @unittest.skipIf(sysconfig.get_config_var('SOABI') is None,
+                     'SOABI required for this test')
+    def test_str_layout_in_soabi(self):
+        # compact ASCII strings have no wstr member: extension modules
+        # built for the previous layout must not be imported
+        soabi = sysconfig.get_config_var('SOABI')
+        self.assertTrue(soabi.startswith('cpython-%d%d%sa' % (
+                            sys.version_info[:2] + (sys.abiflags,))), soabi)
+        self.assertIn('.%s.' % soabi, sysconfig.get_config_var('EXT_SUFFIX'))
+
     @unittest.skipUnless(sys.platform == 'darwin', 'OS X-specific test')
     def test_osx_ext_suffix(self):
         suffix = sysconfig.get_config_var('EXT_SUFFIX')
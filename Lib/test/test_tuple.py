@@ -149,6 +149,21 @@ class TupleTest(seq_tests.CommonTest):
         # Test GC-optimization of dynamically constructed tuples.
         self.check_track_dynamic(tuple, False)
 
+    @support.cpython_only
+    def test_track_eagerly(self):
+        # Tuples built from atomic items are untracked right away, without
+        # waiting for a collection.
+        x, y, z = 1.5, "a", []
+        t = tuple([x, y, 1])
+        self.assertFalse(gc.is_tracked(t))
+        self.assertFalse(gc.is_tracked(tuple(i for i in range(10))))
+        self.assertFalse(gc.is_tracked(t[1:]))
+        self.assertFalse(gc.is_tracked(t + t))
+        self.assertFalse(gc.is_tracked(t * 3))
+        self.assertTrue(gc.is_tracked(tuple([x, z])))
+        self.assertTrue(gc.is_tracked(t + (z,)))
+        self.assertTrue(gc.is_tracked((z,) + t))
+
     @support.cpython_only
     def test_track_subtypes(self):
         # Tuple subtypes must always be tracked
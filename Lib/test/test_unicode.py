@@ -410,6 +410,44 @@ class UnicodeTest(string_tests.CommonTest,
                 self.checkequal([left, right],
                                 left + delim * 2 + right, 'rsplit', delim *2)
 
+    def test_split_long(self):
+        string_tests.CommonTest.test_split_long(self)
+        # test wide kinds and mixed kinds
+        for fill, delim in (('\xe9', '\x85'), ('\u0101', '\u0102'),
+                            ('\U00010301', '\U00010302'),
+                            ('\U00010301', '\u0102'), ('a', '\U00010302')):
+            for n in (0, 7, 15, 16, 31, 40):
+                fields = [fill * n] * 6 + [fill]
+                text = delim.join(fields)
+                self.checkequal(fields, text, 'split', delim)
+                self.checkequal(fields, text, 'rsplit', delim)
+                self.checkequal(fields[:3] + [delim.join(fields[3:])],
+                                text, 'split', delim, 3)
+                self.checkequal([delim.join(fields[:-3])] + fields[-3:],
+                                text, 'rsplit', delim, 3)
+                # a character of a wider kind with the same low bits
+                self.checkequal([text], text, 'split', chr(ord(delim) + 0x100))
+
+    def test_splitlines_long(self):
+        string_tests.CommonTest.test_splitlines_long(self)
+        # all line breaks, and characters close to them which are not
+        breaks = '\n\x0b\x0c\r\x1c\x1d\x1e\x85\u2028\u2029'
+        others = '\t\x0e\x1b\x1f \x84\x86\u2027\u202a\U00012028'
+        for fill, maxchar in (('a', '\x7f'), ('\xe9', '\xff'),
+                              ('\u20ac', '\uffff'),
+                              ('\U0001f600', '\U0010ffff')):
+            kind_breaks = [c for c in breaks if c <= maxchar]
+            kind_others = ''.join(c for c in others if c <= maxchar)
+            for n in (0, 7, 15, 16, 31, 40):
+                lines = [fill * n + kind_others + fill * k
+                         for k in range(len(kind_breaks))]
+                text = ''.join(line + c for line, c in zip(lines, kind_breaks))
+                self.checkequal(lines, text, 'splitlines')
+                self.checkequal([line + c
+                                 for line, c in zip(lines, kind_breaks)],
+                                text, 'splitlines', True)
+                self.checkequal(lines + [fill], text + fill, 'splitlines')
+
     def test_partition(self):
         string_tests.MixinStrUnicodeUserStringTest.test_partition(self)
         # test mixed kinds
@@ -1293,6 +1331,95 @@ class UnicodeTest(string_tests.CommonTest,
         self.assertEqual('{:{f}}{g}{}'.format(1, 3, g='g', f=2), ' 1g3')
         self.assertEqual('{f:{}}{}{g}'.format(2, 4, f=1, g='g'), ' 14g')
 
+    def test_format_repeated(self):
+        # Format strings are compiled and cached the second time they are
+        # used; the following calls must give the same results.
+        class Missing(dict):
+            def __missing__(self, key):
+                return key.upper()
+
+        class Spec:
+            def __format__(self, spec):
+                return '<%s>' % spec
+
+        class StrSubclass(str):
+            pass
+
+        tests = [
+            ('{} {}', (1, 'a'), {}, '1 a'),
+            ('{1}{0}{1}', ('a', 'b'), {}, 'bab'),
+            ('{x!r}:{y!s}:{z!a}', (), {'x': 'a', 'y': 2, 'z': '\xe9'},
+             "'a':2:'\\xe9'"),
+            ('{:>6}|{:<6.2f}|{:#x}|{}', ('ab', 2.5, 255, 1j), {},
+             '    ab|2.50  |0xff|1j'),
+            ('{0:x<3}{0:{{}}>3}', (Spec(),), {}, '<x<3><{}>3>'),
+            ('\u20ac{}\xe9', ('a',), {}, '\u20aca\xe9'),
+            ('{}\U0001f40d', ('a',), {}, 'a\U0001f40d'),
+            ('{}', ('x' * 1000,), {}, 'x' * 1000),
+            ('{{}}{{{}}}', (1,), {}, '{}{1}'),
+            ('', (), {}, ''),
+        ]
+        for fmt, args, kwargs, expected in tests:
+            for i in range(3):
+                self.assertEqual(fmt.format(*args, **kwargs), expected)
+        for i in range(3):
+            self.assertEqual('{a}{b}'.format_map(Missing(a=1)), '1B')
+            self.assertEqual(StrSubclass('{}!').format(1), '1!')
+            # the predicted length doesn't limit the output
+            self.assertEqual('{}'.format('a' * 10 ** i), 'a' * 10 ** i)
+        for i in range(3):
+            self.assertRaises(IndexError, '{}{}'.format, 1)
+            self.assertRaises(KeyError, '{x}'.format, 1)
+            self.assertRaises(ValueError, '{!x}'.format, 1)
+            self.assertRaises(ValueError, '{0}{}'.format, 1, 2)
+            self.assertRaises(ValueError, '{}'.format_map, {})
+            self.assertRaises(ValueError, '{'.format)
+
+        # A format string may be evicted from the cache while it is used.
+        class Evict:
+            def __format__(self, spec):
+                for i in range(1000):
+                    ('{}%d' % i).format(i)
+                    ('%%s%d' % i) % (i,)
+                return spec
+            def __str__(self):
+                return format(self, 's')
+        for i in range(3):
+            self.assertEqual('a{:x}b{:y}c'.format(Evict(), Evict()), 'axbyc')
+            self.assertEqual('a%sb%sc' % (Evict(), Evict()), 'asbsc')
+
+    @support.cpython_only
+    def test_format_cache_refs(self):
+        # Format strings used once are not kept
+        sys._clear_type_cache()
+        fmt = ''.join(['{} ', 'cached {}'])
+        pct = ''.join(['%s ', 'cached %d'])
+        refs = sys.getrefcount(fmt), sys.getrefcount(pct)
+        self.assertEqual(fmt.format(1, 2), '1 cached 2')
+        self.assertEqual(pct % (1, 2), '1 cached 2')
+        self.assertEqual((sys.getrefcount(fmt), sys.getrefcount(pct)), refs)
+        # The second use compiles and caches them
+        self.assertEqual(fmt.format(3, 4), '3 cached 4')
+        self.assertEqual(pct % (3, 4), '3 cached 4')
+        self.assertEqual((sys.getrefcount(fmt), sys.getrefcount(pct)),
+                         (refs[0] + 1, refs[1] + 1))
+        self.assertEqual(fmt.format(5, 6), '5 cached 6')
+        self.assertEqual(pct % (5, 6), '5 cached 6')
+        sys._clear_type_cache()
+        self.assertEqual((sys.getrefcount(fmt), sys.getrefcount(pct)), refs)
+
+        # The cache holds a bounded number of characters
+        fmts = ['{}%d' % i + ' ' * 4000 for i in range(256)]
+        refs = sum(map(sys.getrefcount, fmts))
+        for i in range(len(fmts)):
+            fmts[i].format(1)
+            fmts[i].format(2)
+        held = sum(map(sys.getrefcount, fmts)) - refs
+        self.assertGreater(held, 0)
+        self.assertLessEqual(held, 64 * 1024 // 4000)
+        sys._clear_type_cache()
+        self.assertEqual(sum(map(sys.getrefcount, fmts)), refs)
+
     def test_formatting(self):
         string_tests.MixinStrUnicodeUserStringTest.test_formatting(self)
         # Testing Unicode formatting strings...
@@ -1429,6 +1556,44 @@ class UnicodeTest(string_tests.CommonTest,
         with self.assertRaises(ValueError):
             result = format_string % 2.34
 
+    def test_formatting_repeated(self):
+        # Format strings are compiled and cached the second time they are
+        # used; the following calls must give the same results.
+        class Missing(dict):
+            def __missing__(self, key):
+                return key.upper()
+
+        tests = [
+            ('%s %r %a', ('a', 'b', '\xe9'), "a 'b' '\\xe9'"),
+            ('%5d|%-5i|%+.2f|%#o|%x|%X|%e|%c%c', (1, 2, 3, 8, 255, 255, 1.0,
+                                                  'x', 0x20ac),
+             '    1|2    |+3.00|0o10|ff|FF|1.000000e+00|x\u20ac'),
+            ('%s%%', (50,), '50%'),
+            ('%(a)s-%(b)05d', {'a': 'x', 'b': 3}, 'x-00003'),
+            ('%(a)s%%%(a)s', {'a': 1}, '1%1'),
+            ('%s', 'abc', 'abc'),
+            ('%*d|%.*f', (4, 1, 2, 3.14159), '   1|3.14'),
+            ('\u20ac%s\xe9', ('a',), '\u20aca\xe9'),
+            ('%s\U0001f40d', ('a',), 'a\U0001f40d'),
+            ('%s', ('x' * 1000,), 'x' * 1000),
+            ('abc', (), 'abc'),
+            ('', (), ''),
+        ]
+        for fmt, args, expected in tests:
+            for i in range(3):
+                self.assertEqual(fmt % args, expected)
+        for i in range(3):
+            self.assertEqual('%(a)s%(b)s' % Missing(a=1), '1B')
+            self.assertEqual('%s' % ('a' * 10 ** i,), 'a' * 10 ** i)
+        for i in range(3):
+            self.assertRaises(TypeError, operator.mod, '%s %s', (1,))
+            self.assertRaises(TypeError, operator.mod, '%s', (1, 2))
+            self.assertRaises(TypeError, operator.mod, '%(a)s', (1,))
+            self.assertRaises(KeyError, operator.mod, '%(a)s', {})
+            self.assertRaises(TypeError, operator.mod, '%d', 'a')
+            self.assertRaises(ValueError, operator.mod, '%y', 1)
+            self.assertRaises(ValueError, operator.mod, '%', ())
+
     def test_startswith_endswith_errors(self):
         for meth in ('foo'.startswith, 'foo'.endswith):
             with self.assertRaises(TypeError) as cm:
@@ -1632,6 +1797,38 @@ class UnicodeTest(string_tests.CommonTest,
         for seq, res in sequences:
             self.assertEqual(seq.decode('utf-8'), res)
 
+    def test_utf8_decode_long_sequences(self):
+        # Long inputs are validated and decoded by blocks of 32 bytes on
+        # some platforms: check sequences at every offset of a block.
+        valid = ['\x80', '\xff', '\u0100', '\u07ff', '\u0800', '\ud7ff',
+                 '\ue000', '\uffff', '\U00010000', '\U0010ffff']
+        invalid = [b'\x80', b'\xbf', b'\xc0\x80', b'\xc1\xbf', b'\xc3',
+                   b'\xe0\x9f\xbf', b'\xed\xa0\x80', b'\xf0\x8f\xbf\xbf',
+                   b'\xf4\x90\x80\x80', b'\xf5\x80\x80\x80', b'\xff',
+                   b'\xe4\xb8', b'\xf0\x90\x80', b'\xc3\xc3']
+        for i in range(70):
+            for char in valid:
+                for filler in ('a', '\xe9', '\u20ac', '\U0001f600'):
+                    text = filler * i + char + filler * (70 - i)
+                    self.assertEqual(text.encode().decode(), text)
+            prefix = b'a' * i
+            for seq in invalid:
+                data = prefix + seq + b'a' * 40
+                with self.assertRaises(UnicodeDecodeError) as cm:
+                    data.decode('utf-8')
+                self.assertEqual(cm.exception.start, i)
+                self.assertEqual(data.decode('utf-8', 'ignore'),
+                                 'a' * (i + 40))
+            # A sequence cut at the end of the input is kept for the next
+            # call of a stateful decoder.
+            data = prefix + '\U0001f600'.encode() + b'a' * 40
+            for cut in range(1, 4):
+                chunk = data[:i + cut]
+                text, consumed = codecs.utf_8_decode(chunk, 'strict', False)
+                self.assertEqual(consumed, i)
+                self.assertEqual(text, 'a' * i)
+                self.assertRaises(UnicodeDecodeError,
+                                  codecs.utf_8_decode, chunk, 'strict', True)
 
     def test_utf8_decode_invalid_sequences(self):
         # continuation bytes in a sequence of 2, 3, or 4 bytes
@@ -2238,14 +2435,35 @@ class UnicodeTest(string_tests.CommonTest,
         s = 'abc'
         self.assertIs(s.expandtabs(), s)
 
+    @support.cpython_only
+    def test_latin1_char_cache(self):
+        # Strings of one Latin-1 character are shared
+        for char in ('a', 'Z', '5', ' ', '\xe9', '\xff', '\x00'):
+            with self.subTest(char=char):
+                self.assertIs(('x' + char + 'y')[1], char)
+                self.assertIs(('x' + char).replace('x', ''), char)
+                self.assertIs(''.join(['', char]), char)
+                self.assertIs(''.join(['x', char])[1:], char)
+                self.assertIs(char.lower().lower(), char.lower())
+                self.assertIs(char.casefold(), char.lower())
+                if char.upper() <= '\xff':
+                    self.assertIs(char.upper().upper(), char.upper())
+                    self.assertIs(char.swapcase().swapcase(), char)
+                self.assertIs(char.encode('utf-8').decode('utf-8'), char)
+                self.assertIs(char.encode('latin-1').decode('latin-1'), char)
+        for i in range(10):
+            self.assertIs(str(i), '0123456789'[i])
+        self.assertEqual(str(10), '10')
+
+    @support.cpython_only
     def test_raiseMemError(self):
         if struct.calcsize('P') == 8:
             # 64 bits pointers
-            ascii_struct_size = 48
+            ascii_struct_size = 40
             compact_struct_size = 72
         else:
             # 32 bits pointers
-            ascii_struct_size = 24
+            ascii_struct_size = 20
             compact_struct_size = 36
 
         for char in ('a', '\xe9', '\u20ac', '\U0010ffff'):
@@ -2561,6 +2779,14 @@ class UnicodeTest(string_tests.CommonTest,
         self.assertEqual(size, 7)
         self.assertEqual(wchar, 'abc\0def\0')
 
+        # strings sharing an append buffer
+        strings = ['\U0010ffff' * 300]
+        for part in ('abc', 'def', 'ghi'):
+            strings.append(strings[-1] + part)
+        for text in strings:
+            wchar, size = unicode_aswidecharstring(text)
+            self.assertEqual(wchar, text + '\0')
+
         nonbmp = chr(0x10ffff)
         if sizeof(c_wchar) == 2:
             nchar = 2
@@ -2570,6 +2796,105 @@ class UnicodeTest(string_tests.CommonTest,
         self.assertEqual(size, nchar)
         self.assertEqual(wchar, nonbmp + '\0')
 
+    # Test PyUnicode_AsUnicode() on compact ASCII strings, whose wchar_t
+    # representation is stored outside of the string
+    @support.cpython_only
+    def test_ascii_asunicode(self):
+        from _testcapi import getargs_u
+        import array
+        wchar_size = array.array('u').itemsize
+
+        strings = ['w%d' % i for i in range(1000)]
+        sizes = [sys.getsizeof(text) for text in strings]
+        for text in strings:
+            self.assertEqual(getargs_u(text), text)
+        for text, size in zip(strings, sizes):
+            self.assertEqual(sys.getsizeof(text),
+                             size + (len(text) + 1) * wchar_size)
+        # remove entries from the middle of the table
+        del strings[::3], sizes[::3]
+        for text, size in zip(strings, sizes):
+            self.assertEqual(getargs_u(text), text)
+            self.assertEqual(sys.getsizeof(text),
+                             size + (len(text) + 1) * wchar_size)
+        del strings, sizes
+
+        # resized strings drop their wchar_t representation
+        text = ''.join(['abc', 'def'])
+        self.assertEqual(getargs_u(text), 'abcdef')
+        text += 'ghi'
+        self.assertEqual(getargs_u(text), 'abcdefghi')
+        self.assertEqual(getargs_u(''), '')
+
+    # Long bytes objects decoded with ASCII or Latin-1 are not copied
+    @support.cpython_only
+    def test_buffer_view(self):
+        from _testcapi import getargs_s, getargs_u
+        data = b'abc\n' * 4096
+        text = 'abc\n' * 4096
+        for encoding in ('ascii', 'latin-1', 'iso8859_1', 'US-ASCII'):
+            with self.subTest(encoding=encoding):
+                view = data.decode(encoding)
+                self.assertEqual(view, text)
+                self.assertLess(sys.getsizeof(view), len(data) // 4)
+                self.assertEqual(hash(view), hash(text))
+                self.assertEqual(view.encode('utf-8'), data)
+                self.assertEqual(view[4:7], 'abc')
+                self.assertEqual(view.splitlines()[-1], 'abc')
+                self.assertEqual(view + '!', text + '!')
+                self.assertEqual(getargs_s(view), data)
+                self.assertEqual(getargs_u(view), text)
+
+        latin1 = (b'\xe9t\xe9' * 2000).decode('latin-1')
+        self.assertEqual(latin1, '\xe9t\xe9' * 2000)
+        self.assertLess(sys.getsizeof(latin1), 2000)
+        self.assertEqual(latin1.encode('utf-8'), '\xe9t\xe9'.encode() * 2000)
+        self.assertEqual(latin1.upper(), '\xc9T\xc9' * 2000)
+
+        # non-ASCII bytes are decoded by the codec
+        self.assertRaises(UnicodeDecodeError, (data + b'\xff').decode)
+        self.assertRaises(UnicodeDecodeError, (data + b'\xff').decode, 'ascii')
+        self.assertEqual((data + b'\xff').decode('ascii', 'replace'),
+                         text + '\ufffd')
+        # short bytes objects and other buffers are copied
+        for obj in (data[:100], bytearray(data), memoryview(bytearray(data)),
+                    memoryview(data), memoryview(data)[:-1]):
+            with self.subTest(type=type(obj)):
+                copy = str(obj, 'ascii')
+                self.assertEqual(copy, text[:len(obj)])
+                self.assertGreater(sys.getsizeof(copy), len(obj))
+        # other codecs
+        self.assertGreater(sys.getsizeof(data.decode('utf-8')), len(data))
+
+    @support.cpython_only
+    def test_buffer_view_mmap(self):
+        # A mmap may change or be closed: it is copied
+        import mmap
+        with open(support.TESTFN, 'wb') as f:
+            f.write(b'0123456789' * 1000)
+        self.addCleanup(support.unlink, support.TESTFN)
+        with open(support.TESTFN, 'rb') as f:
+            m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        text = str(m, 'ascii')
+        self.assertEqual(text, '0123456789' * 1000)
+        self.assertGreater(sys.getsizeof(text), 10000)
+        m.close()
+        self.assertEqual(text[-10:], '0123456789')
+
+    @support.cpython_only
+    def test_buffer_view_subclass(self):
+        class S(str):
+            pass
+        class B(bytes):
+            pass
+        data = B(b'1' * 4096)
+        text = str(data, 'ascii')
+        self.assertLess(sys.getsizeof(text), 1000)
+        sub = S(text)
+        self.assertEqual(sub, '1' * 4096)
+        self.assertEqual(int(sub), int('1' * 4096))
+        self.assertEqual(sub.encode('ascii'), b'1' * 4096)
+
     def test_subclass_add(self):
         class S(str):
             def __add__(self, o):
@@ -2634,6 +2959,69 @@ class UnicodeTest(string_tests.CommonTest,
                 self.assertNotEqual(abc, abcdef)
                 self.assertEqual(abcdef.decode('unicode_internal'), text)
 
+    def test_append_long_strings(self):
+        # Appending to a long string which has other references
+        # (attributes, list items, cells...) extends the string in place
+        # in a buffer shared with the new string; the other references
+        # must not see the appended characters.
+        chars = ('a', '\xe9', '\u20ac', '\U0001f40d')
+        for first, second in itertools.product(chars, repeat=2):
+            with self.subTest(first=first, second=second):
+                parts = [first * 300] + [second * (i % 3) for i in range(100)]
+                strings = [parts[0]]
+                for part in parts[1:]:
+                    strings.append(strings[-1] + part)
+                branch = strings[50] + 'b' * 10
+                strings[-1] += first
+                parts[-1] += first
+                self.assertEqual(branch, ''.join(parts[:51]) + 'b' * 10)
+                for i, text in enumerate(strings):
+                    expected = ''.join(parts[:i + 1])
+                    self.assertEqual(text, expected)
+                    self.assertEqual(hash(text), hash(expected))
+                    self.assertEqual(text.encode('utf-8', 'surrogatepass'),
+                                     expected.encode('utf-8'))
+
+    def test_append_subclass(self):
+        # The characters of a string sharing an append buffer may be
+        # followed by characters appended by another string
+        class S(str):
+            pass
+        strings = ['1' * 300]
+        for digit in '2345':
+            strings[0] += digit
+            strings.append(strings[0])
+        for text in strings:
+            sub = S(text)
+            self.assertEqual(sub, text)
+            self.assertEqual(int(sub), int(text))
+            self.assertEqual(sub.encode('ascii'), text.encode('ascii'))
+
+    def test_append_targets(self):
+        class Namespace:
+            pass
+        line = 'x = %r\n' % ('\u20ac' * 50)
+        expected = line * 1000
+        ns = Namespace()
+        ns.text = ''
+        items = ['']
+        mapping = {'text': ''}
+        text = ''
+        def append_nonlocal():
+            nonlocal text
+            text += line
+        for i in range(1000):
+            ns.text += line
+            items[0] += line
+            mapping['text'] += line
+            append_nonlocal()
+        for result in (ns.text, items[0], mapping['text'], text):
+            self.assertEqual(result, expected)
+            self.assertIs(sys.intern(result), sys.intern(expected))
+            namespace = {}
+            exec(result, namespace)
+            self.assertEqual(namespace['x'], '\u20ac' * 50)
+
     def test_compare(self):
         # Issue #17615
         N = 10
@@ -0,0 +1,2717 @@
+/* C implementation of asyncio.Future and asyncio.Task, of the loop
+   which runs the ready callbacks in BaseEventLoop._run_once(), and of the
+   buffer of asyncio.StreamReader.
+
+   The classes mirror Lib/asyncio/futures.py and Lib/asyncio/tasks.py
+   (which keep the Python implementations as _PyFuture and _PyTask);
+   the rarely used methods (__repr__, get_stack(), ...) call back into
+   helper functions of these modules. */
+
+#include "Python.h"
+#include "structmember.h"
+#include "frameobject.h"
+
+
+/*[clinic input]
+module _asyncio
+[clinic start generated code]*/
+/*[clinic end generated code: output=da39a3ee5e6b4b0d input=8fd17862aa989c69]*/
+
+
+_Py_IDENTIFIER(__name__);
+_Py_IDENTIFIER(_all_tasks);
+_Py_IDENTIFIER(_args);
+_Py_IDENTIFIER(_blocking);
+_Py_IDENTIFIER(_callback);
+_Py_IDENTIFIER(_cancelled);
+_Py_IDENTIFIER(_current_tasks);
+_Py_IDENTIFIER(_loop);
+_Py_IDENTIFIER(_report_exception);
+_Py_IDENTIFIER(_repr_info);
+_Py_IDENTIFIER(_run);
+_Py_IDENTIFIER(_schedule_callbacks);
+_Py_IDENTIFIER(_step);
+_Py_IDENTIFIER(_wakeup);
+_Py_IDENTIFIER(add);
+_Py_IDENTIFIER(add_done_callback);
+_Py_IDENTIFIER(call_exception_handler);
+_Py_IDENTIFIER(call_soon);
+_Py_IDENTIFIER(cancel);
+_Py_IDENTIFIER(get);
+_Py_IDENTIFIER(get_debug);
+_Py_IDENTIFIER(get_event_loop);
+_Py_IDENTIFIER(pop);
+_Py_IDENTIFIER(popleft);
+_Py_IDENTIFIER(result);
+_Py_IDENTIFIER(send);
+_Py_IDENTIFIER(set_exception);
+_Py_IDENTIFIER(set_result);
+_Py_IDENTIFIER(throw);
+
+
+/* Objects of the asyncio package, imported by module_init() when the
+   first Future is created: _asyncio is imported by asyncio.futures, so
+   it cannot import the package from its init function. */
+static int module_initialized = 0;
+static PyObject *asyncio_events = NULL;
+static PyObject *asyncio_handle_type = NULL;
+static PyObject *asyncio_timer_handle_type = NULL;
+static PyObject *asyncio_iscoroutine_func = NULL;
+static PyObject *asyncio_CancelledError = NULL;
+static PyObject *asyncio_InvalidStateError = NULL;
+static PyObject *asyncio_py_future_type = NULL;
+static PyObject *asyncio_future_repr_info_func = NULL;
+static PyObject *asyncio_task_repr_info_func = NULL;
+static PyObject *asyncio_task_get_stack_func = NULL;
+static PyObject *asyncio_task_print_stack_func = NULL;
+static PyObject *traceback_extract_stack = NULL;
+
+/* Values of the _state attribute */
+static PyObject *state_pending = NULL;
+static PyObject *state_cancelled = NULL;
+static PyObject *state_finished = NULL;
+
+
+typedef enum {
+    STATE_PENDING,
+    STATE_CANCELLED,
+    STATE_FINISHED
+} fut_state;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *fut_loop;
+    PyObject *fut_callbacks;
+    PyObject *fut_exception;
+    PyObject *fut_result;
+    PyObject *fut_source_tb;
+    fut_state fut_state;
+    int fut_log_tb;
+    int fut_blocking;
+    PyObject *dict;
+    PyObject *fut_weakreflist;
+} FutureObj;
+
+typedef struct {
+    FutureObj task_future;
+    PyObject *task_fut_waiter;
+    PyObject *task_coro;
+    int task_must_cancel;
+    int task_log_destroy_pending;
+} TaskObj;
+
+typedef struct {
+    PyObject_HEAD
+    FutureObj *future;
+    int yielded;
+} futureiterobject;
+
+/* Bytes buffered by a StreamReader: data[start:end] is the content.
+   Consuming data from the front only advances start; the content is moved
+   back to the beginning of the allocation when more room is needed. */
+typedef struct {
+    PyObject_HEAD
+    char *data;
+    Py_ssize_t start;
+    Py_ssize_t end;
+    Py_ssize_t alloc;
+    Py_ssize_t exports;
+} StreamBufferObj;
+
+static PyTypeObject FutureType;
+static PyTypeObject TaskType;
+static PyTypeObject FutureIterType;
+static PyTypeObject StreamBufferType;
+
+#define Future_CheckExact(obj) (Py_TYPE(obj) == &FutureType)
+#define Task_CheckExact(obj) (Py_TYPE(obj) == &TaskType)
+#define Future_Check(obj) PyObject_TypeCheck(obj, &FutureType)
+#define Task_Check(obj) PyObject_TypeCheck(obj, &TaskType)
+
+/* Methods of Future and Task objects whose type is exactly Future or
+   Task are called directly; for subclasses, they are looked up so that
+   they can be overridden, as in the Python implementation. */
+#define Future_Methods_Exact(obj) \
+    (Future_CheckExact(obj) || Task_CheckExact(obj))
+
+/*[clinic input]
+class _asyncio.Future "FutureObj *" "&FutureType"
+class _asyncio.Task "TaskObj *" "&TaskType"
+class _asyncio.StreamBuffer "StreamBufferObj *" "&StreamBufferType"
+[clinic start generated code]*/
+/*[clinic end generated code: output=da39a3ee5e6b4b0d input=f4ab8261978532d8]*/
+
+#include "clinic/_asynciomodule.c.h"
+
+
+static PyObject *
+get_module_attr(const char *module_name, const char *attr_name)
+{
+    PyObject *module, *attr;
+
+    module = PyImport_ImportModule(module_name);
+    if (module == NULL)
+        return NULL;
+    attr = PyObject_GetAttrString(module, attr_name);
+    Py_DECREF(module);
+    return attr;
+}
+
+static int
+module_init(void)
+{
+    if (module_initialized)
+        return 0;
+
+#define GET_ATTR(var, module_name, attr_name)              \
+    do {                                                    \
+        if (var == NULL) {                                  \
+            var = get_module_attr(module_name, attr_name);  \
+            if (var == NULL)                                \
+                return -1;                                  \
+        }                                                   \
+    } while (0)
+
+    if (asyncio_events == NULL) {
+        asyncio_events = PyImport_ImportModule("asyncio.events");
+        if (asyncio_events == NULL)
+            return -1;
+    }
+    GET_ATTR(asyncio_handle_type, "asyncio.events", "Handle");
+    GET_ATTR(asyncio_timer_handle_type, "asyncio.events", "TimerHandle");
+    GET_ATTR(asyncio_iscoroutine_func, "asyncio.coroutines", "iscoroutine");
+    GET_ATTR(asyncio_CancelledError, "asyncio.futures", "CancelledError");
+    GET_ATTR(asyncio_InvalidStateError, "asyncio.futures",
+             "InvalidStateError");
+    GET_ATTR(asyncio_py_future_type, "asyncio.futures", "_PyFuture");
+    GET_ATTR(asyncio_future_repr_info_func, "asyncio.futures",
+             "_future_repr_info");
+    GET_ATTR(asyncio_task_repr_info_func, "asyncio.tasks",
+             "_task_repr_info");
+    GET_ATTR(asyncio_task_get_stack_func, "asyncio.tasks",
+             "_task_get_stack");
+    GET_ATTR(asyncio_task_print_stack_func, "asyncio.tasks",
+             "_task_print_stack");
+    GET_ATTR(traceback_extract_stack, "traceback", "extract_stack");
+
+#undef GET_ATTR
+
+    module_initialized = 1;
+    return 0;
+}
+
+static PyObject *
+get_event_loop(void)
+{
+    /* Look get_event_loop() up each time, as the Python code does */
+    return _PyObject_CallMethodId(asyncio_events, &PyId_get_event_loop,
+                                  NULL);
+}
+
+static PyObject *
+type_name(PyObject *obj)
+{
+    return _PyObject_GetAttrId((PyObject *)Py_TYPE(obj), &PyId___name__);
+}
+
+/* Call loop.call_exception_handler(context) from a finalizer: any error
+   is reported with PyErr_WriteUnraisable(). */
+static void
+call_exception_handler(PyObject *loop, PyObject *context, PyObject *obj)
+{
+    PyObject *res;
+
+    res = _PyObject_CallMethodIdObjArgs(loop, &PyId_call_exception_handler,
+                                        context, NULL);
+    if (res == NULL)
+        PyErr_WriteUnraisable(obj);
+    else
+        Py_DECREF(res);
+}
+
+/* Return a RuntimeError instance with the formatted message */
+static PyObject *
+make_runtime_error(const char *format, ...)
+{
+    PyObject *msg, *exc;
+    va_list vargs;
+
+#ifdef HAVE_STDARG_PROTOTYPES
+    va_start(vargs, format);
+#else
+    va_start(vargs);
+#endif
+    msg = PyUnicode_FromFormatV(format, vargs);
+    va_end(vargs);
+    if (msg == NULL)
+        return NULL;
+    exc = PyObject_CallFunctionObjArgs(PyExc_RuntimeError, msg, NULL);
+    Py_DECREF(msg);
+    return exc;
+}
+
+
+/* --- Future ------------------------------------------------------------ */
+
+static int
+future_init(FutureObj *fut, PyObject *loop)
+{
+    PyObject *res;
+    int is_true;
+
+    if (module_init() < 0)
+        return -1;
+
+    if (loop == Py_None) {
+        loop = get_event_loop();
+        if (loop == NULL)
+            return -1;
+    }
+    else {
+        Py_INCREF(loop);
+    }
+    Py_XSETREF(fut->fut_loop, loop);
+    Py_XSETREF(fut->fut_callbacks, PyList_New(0));
+    if (fut->fut_callbacks == NULL)
+        return -1;
+
+    res = _PyObject_CallMethodId(fut->fut_loop, &PyId_get_debug, NULL);
+    if (res == NULL)
+        return -1;
+    is_true = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    if (is_true < 0)
+        return -1;
+    if (is_true) {
+        /* The stack of the caller: there is no frame for this function */
+        PyObject *frame = (PyObject *)PyEval_GetFrame();
+        if (frame == NULL)
+            frame = Py_None;
+        Py_XSETREF(fut->fut_source_tb,
+                   PyObject_CallFunctionObjArgs(traceback_extract_stack,
+                                                frame, NULL));
+        if (fut->fut_source_tb == NULL)
+            return -1;
+    }
+    return 0;
+}
+
+static int
+future_ensure_alive(FutureObj *fut)
+{
+    if (fut->fut_loop == NULL) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "Future object is not initialized.");
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *
+future_state_name(FutureObj *fut)
+{
+    switch (fut->fut_state) {
+    case STATE_PENDING:
+        return state_pending;
+    case STATE_CANCELLED:
+        return state_cancelled;
+    default:
+        return state_finished;
+    }
+}
+
+static int
+future_schedule_callbacks(FutureObj *fut)
+{
+    PyObject *callbacks;
+    Py_ssize_t len, i;
+
+    if (fut->fut_callbacks == NULL)
+        return 0;
+    len = PyList_GET_SIZE(fut->fut_callbacks);
+    if (len == 0)
+        return 0;
+
+    callbacks = PyList_GetSlice(fut->fut_callbacks, 0, len);
+    if (callbacks == NULL)
+        return -1;
+    if (PyList_SetSlice(fut->fut_callbacks, 0, len, NULL) < 0) {
+        Py_DECREF(callbacks);
+        return -1;
+    }
+
+    for (i = 0; i < PyList_GET_SIZE(callbacks); i++) {
+        PyObject *cb = PyList_GET_ITEM(callbacks, i);
+        PyObject *handle;
+
+        handle = _PyObject_CallMethodIdObjArgs(fut->fut_loop,
+                                               &PyId_call_soon,
+                                               cb, fut, NULL);
+        if (handle == NULL) {
+            Py_DECREF(callbacks);
+            return -1;
+        }
+        Py_DECREF(handle);
+    }
+    Py_DECREF(callbacks);
+    return 0;
+}
+
+/* Call self._schedule_callbacks(), which subclasses may override */
+static int
+future_call_schedule_callbacks(FutureObj *fut)
+{
+    PyObject *res;
+
+    if (Future_Methods_Exact(fut))
+        return future_schedule_callbacks(fut);
+    res = _PyObject_CallMethodId((PyObject *)fut, &PyId__schedule_callbacks,
+                                 NULL);
+    if (res == NULL)
+        return -1;
+    Py_DECREF(res);
+    return 0;
+}
+
+static PyObject *
+future_set_result(FutureObj *fut, PyObject *res)
+{
+    if (future_ensure_alive(fut) < 0)
+        return NULL;
+    if (fut->fut_state != STATE_PENDING) {
+        PyErr_Format(asyncio_InvalidStateError, "%U: %R",
+                     future_state_name(fut), fut);
+        return NULL;
+    }
+
+    Py_INCREF(res);
+    Py_XSETREF(fut->fut_result, res);
+    fut->fut_state = STATE_FINISHED;
+    if (future_call_schedule_callbacks(fut) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+future_set_exception(FutureObj *fut, PyObject *exc)
+{
+    PyObject *exc_val = NULL;
+
+    if (future_ensure_alive(fut) < 0)
+        return NULL;
+    if (fut->fut_state != STATE_PENDING) {
+        PyErr_Format(asyncio_InvalidStateError, "%U: %R",
+                     future_state_name(fut), fut);
+        return NULL;
+    }
+
+    if (PyType_Check(exc)) {
+        exc_val = PyObject_CallObject(exc, NULL);
+        if (exc_val == NULL)
+            return NULL;
+    }
+    else {
+        exc_val = exc;
+        Py_INCREF(exc_val);
+    }
+    if (Py_TYPE(exc_val) == (PyTypeObject *)PyExc_StopIteration) {
+        Py_DECREF(exc_val);
+        PyErr_SetString(PyExc_TypeError,
+                        "StopIteration interacts badly with generators "
+                        "and cannot be raised into a Future");
+        return NULL;
+    }
+
+    Py_XSETREF(fut->fut_exception, exc_val);
+    fut->fut_state = STATE_FINISHED;
+    if (future_call_schedule_callbacks(fut) < 0)
+        return NULL;
+    fut->fut_log_tb = 1;
+    Py_RETURN_NONE;
+}
+
+/* Implement result(): return a new reference to the result, or set the
+   exception of the future and return NULL. */
+static PyObject *
+future_get_result(FutureObj *fut)
+{
+    PyObject *exc;
+
+    if (fut->fut_state == STATE_CANCELLED) {
+        PyErr_SetNone(asyncio_CancelledError);
+        return NULL;
+    }
+    if (fut->fut_state != STATE_FINISHED) {
+        PyErr_SetString(asyncio_InvalidStateError, "Result is not ready.");
+        return NULL;
+    }
+
+    fut->fut_log_tb = 0;
+    exc = fut->fut_exception;
+    if (exc != NULL) {
+        if (!PyExceptionInstance_Check(exc)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "exceptions must derive from BaseException");
+            return NULL;
+        }
+        PyErr_SetObject(PyExceptionInstance_Class(exc), exc);
+        return NULL;
+    }
+    if (fut->fut_result == NULL)
+        Py_RETURN_NONE;
+    Py_INCREF(fut->fut_result);
+    return fut->fut_result;
+}
+
+/* Call fut.result(), which subclasses may override */
+static PyObject *
+future_call_result(FutureObj *fut)
+{
+    if (Future_Methods_Exact(fut))
+        return future_get_result(fut);
+    return _PyObject_CallMethodId((PyObject *)fut, &PyId_result, NULL);
+}
+
+static PyObject *
+future_add_done_callback(FutureObj *fut, PyObject *fn)
+{
+    if (fut->fut_state != STATE_PENDING) {
+        return _PyObject_CallMethodIdObjArgs(fut->fut_loop, &PyId_call_soon,
+                                             fn, fut, NULL);
+    }
+    if (PyList_Append(fut->fut_callbacks, fn) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+future_cancel(FutureObj *fut)
+{
+    if (fut->fut_state != STATE_PENDING)
+        Py_RETURN_FALSE;
+    fut->fut_state = STATE_CANCELLED;
+    if (future_call_schedule_callbacks(fut) < 0)
+        return NULL;
+    Py_RETURN_TRUE;
+}
+
+
+/*[clinic input]
+_asyncio.Future.__init__
+
+    *
+    loop: object = None
+
+This class is *almost* compatible with concurrent.futures.Future.
+
+    Differences:
+
+    - result() and exception() do not take a timeout argument and
+      raise an exception when the future isn't done yet.
+
+    - Callbacks registered with add_done_callback() are always called
+      via the event loop's call_soon_threadsafe().
+
+    - This class is not compatible with the wait() and as_completed()
+      methods in the concurrent.futures package.
+[clinic start generated code]*/
+
+static int
+_asyncio_Future___init___impl(FutureObj *self, PyObject *loop)
+/*[clinic end generated code: output=9ed75799eaccb5d6 input=89af317082bc0bf8]*/
+{
+    return future_init(self, loop);
+}
+
+/*[clinic input]
+_asyncio.Future.result
+
+Return the result this future represents.
+
+If the future has been cancelled, raises CancelledError.  If the
+future's result isn't yet available, raises InvalidStateError.  If
+the future is done and has an exception set, this exception is raised.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_result_impl(FutureObj *self)
+/*[clinic end generated code: output=f35f940936a4b1e5 input=49ecf9cf5ec50dc5]*/
+{
+    return future_get_result(self);
+}
+
+/*[clinic input]
+_asyncio.Future.exception
+
+Return the exception that was set on this future.
+
+The exception (or None if no exception was set) is returned only if
+the future is done.  If the future has been cancelled, raises
+CancelledError.  If the future isn't done yet, raises
+InvalidStateError.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_exception_impl(FutureObj *self)
+/*[clinic end generated code: output=88b20d4f855e0710 input=733547a70c841c68]*/
+{
+    if (future_ensure_alive(self) < 0)
+        return NULL;
+    if (self->fut_state == STATE_CANCELLED) {
+        PyErr_SetNone(asyncio_CancelledError);
+        return NULL;
+    }
+    if (self->fut_state != STATE_FINISHED) {
+        PyErr_SetString(asyncio_InvalidStateError, "Exception is not set.");
+        return NULL;
+    }
+
+    self->fut_log_tb = 0;
+    if (self->fut_exception == NULL)
+        Py_RETURN_NONE;
+    Py_INCREF(self->fut_exception);
+    return self->fut_exception;
+}
+
+/*[clinic input]
+_asyncio.Future.set_result
+
+    res: object
+    /
+
+Mark the future done and set its result.
+
+If the future is already done when this method is called, raises
+InvalidStateError.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_set_result(FutureObj *self, PyObject *res)
+/*[clinic end generated code: output=a620abfc2796bfb6 input=5b9dc180f1baa56d]*/
+{
+    return future_set_result(self, res);
+}
+
+/*[clinic input]
+_asyncio.Future.set_exception
+
+    exception: object
+    /
+
+Mark the future done and set an exception.
+
+If the future is already done when this method is called, raises
+InvalidStateError.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_set_exception(FutureObj *self, PyObject *exception)
+/*[clinic end generated code: output=f1c1b0cd321be360 input=e45b7d7aa71cc66d]*/
+{
+    return future_set_exception(self, exception);
+}
+
+/*[clinic input]
+_asyncio.Future.add_done_callback
+
+    fn: object
+    /
+
+Add a callback to be run when the future becomes done.
+
+The callback is called with a single argument - the future object. If
+the future is already done when this is called, the callback is
+scheduled with call_soon.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_add_done_callback(FutureObj *self, PyObject *fn)
+/*[clinic end generated code: output=819e09629b2ec2b5 input=8f818b39990b027d]*/
+{
+    if (future_ensure_alive(self) < 0)
+        return NULL;
+    return future_add_done_callback(self, fn);
+}
+
+/*[clinic input]
+_asyncio.Future.remove_done_callback
+
+    fn: object
+    /
+
+Remove all instances of a callback from the "call when done" list.
+
+Returns the number of callbacks removed.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_remove_done_callback(FutureObj *self, PyObject *fn)
+/*[clinic end generated code: output=5ab1fb52b24ef31f input=0a43280a149d505b]*/
+{
+    PyObject *callbacks, *filtered;
+    Py_ssize_t len, i;
+
+    if (future_ensure_alive(self) < 0)
+        return NULL;
+    callbacks = self->fut_callbacks;
+    filtered = PyList_New(0);
+    if (filtered == NULL)
+        return NULL;
+    for (i = 0; i < PyList_GET_SIZE(callbacks); i++) {
+        PyObject *item = PyList_GET_ITEM(callbacks, i);
+        PyObject *ne;
+        int keep;
+
+        Py_INCREF(item);
+        ne = PyObject_RichCompare(item, fn, Py_NE);
+        if (ne == NULL) {
+            Py_DECREF(item);
+            goto fail;
+        }
+        keep = PyObject_IsTrue(ne);
+        Py_DECREF(ne);
+        if (keep > 0)
+            keep = PyList_Append(filtered, item) < 0 ? -1 : 1;
+        Py_DECREF(item);
+        if (keep < 0)
+            goto fail;
+    }
+
+    len = PyList_GET_SIZE(callbacks) - PyList_GET_SIZE(filtered);
+    if (len && PyList_SetSlice(callbacks, 0, PyList_GET_SIZE(callbacks),
+                               filtered) < 0)
+        goto fail;
+    Py_DECREF(filtered);
+    return PyLong_FromSsize_t(len);
+
+fail:
+    Py_DECREF(filtered);
+    return NULL;
+}
+
+/*[clinic input]
+_asyncio.Future.cancel
+
+Cancel the future and schedule callbacks.
+
+If the future is already done or cancelled, return False.  Otherwise,
+change the future's state to cancelled, schedule the callbacks and
+return True.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_cancel_impl(FutureObj *self)
+/*[clinic end generated code: output=e45b932ba8bd68a1 input=515709a127995109]*/
+{
+    if (future_ensure_alive(self) < 0)
+        return NULL;
+    return future_cancel(self);
+}
+
+/*[clinic input]
+_asyncio.Future.cancelled
+
+Return True if the future was cancelled.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_cancelled_impl(FutureObj *self)
+/*[clinic end generated code: output=145197ced586357d input=943ab8b7b7b17e45]*/
+{
+    if (self->fut_state == STATE_CANCELLED)
+        Py_RETURN_TRUE;
+    Py_RETURN_FALSE;
+}
+
+/*[clinic input]
+_asyncio.Future.done
+
+Return True if the future is done.
+
+Done means either that a result / exception are available, or that the
+future was cancelled.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future_done_impl(FutureObj *self)
+/*[clinic end generated code: output=244c5ac351145096 input=28d7b23fdb65d2ac]*/
+{
+    if (self->fut_state == STATE_PENDING)
+        Py_RETURN_FALSE;
+    Py_RETURN_TRUE;
+}
+
+/*[clinic input]
+_asyncio.Future._schedule_callbacks
+
+Internal: Ask the event loop to call all callbacks.
+
+The callbacks are scheduled to be called as soon as possible. Also
+clears the callback list.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future__schedule_callbacks_impl(FutureObj *self)
+/*[clinic end generated code: output=5e8958d89ea1c5dc input=e26cf52c199e1c26]*/
+{
+    if (future_ensure_alive(self) < 0)
+        return NULL;
+    if (future_schedule_callbacks(self) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_asyncio.Future._repr_info
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Future__repr_info_impl(FutureObj *self)
+/*[clinic end generated code: output=fa69e901bd176cfb input=f21504d8e2ae1ca2]*/
+{
+    return PyObject_CallFunctionObjArgs(asyncio_future_repr_info_func,
+                                        self, NULL);
+}
+
+static PyObject *
+FutureObj_repr(FutureObj *fut)
+{
+    PyObject *info, *sep, *joined, *name, *repr = NULL;
+
+    if (module_init() < 0)
+        return NULL;
+    info = _PyObject_CallMethodId((PyObject *)fut, &PyId__repr_info, NULL);
+    if (info == NULL)
+        return NULL;
+    sep = PyUnicode_FromString(" ");
+    if (sep == NULL) {
+        Py_DECREF(info);
+        return NULL;
+    }
+    joined = PyUnicode_Join(sep, info);
+    Py_DECREF(sep);
+    Py_DECREF(info);
+    if (joined == NULL)
+        return NULL;
+    name = type_name((PyObject *)fut);
+    if (name != NULL) {
+        repr = PyUnicode_FromFormat("<%S %U>", name, joined);
+        Py_DECREF(name);
+    }
+    Py_DECREF(joined);
+    return repr;
+}
+
+static void
+FutureObj_finalize(FutureObj *fut)
+{
+    PyObject *error_type, *error_value, *error_traceback;
+    PyObject *context = NULL, *name = NULL, *message = NULL;
+
+    if (!fut->fut_log_tb)
+        return;
+    /* set_exception() was called, and neither result() nor exception()
+       consumed the exception */
+    assert(fut->fut_exception != NULL);
+    fut->fut_log_tb = 0;
+
+    /* Save the current exception, if any. */
+    PyErr_Fetch(&error_type, &error_value, &error_traceback);
+
+    context = PyDict_New();
+    if (context == NULL)
+        goto finally;
+    name = type_name((PyObject *)fut);
+    if (name == NULL)
+        goto finally;
+    message = PyUnicode_FromFormat("%S exception was never retrieved",
+                                   name);
+    if (message == NULL)
+        goto finally;
+    if (PyDict_SetItemString(context, "message", message) < 0 ||
+        PyDict_SetItemString(context, "exception", fut->fut_exception) < 0 ||
+        PyDict_SetItemString(context, "future", (PyObject *)fut) < 0)
+        goto finally;
+    if (fut->fut_source_tb != NULL) {
+        int is_true = PyObject_IsTrue(fut->fut_source_tb);
+        if (is_true < 0)
+            goto finally;
+        if (is_true && PyDict_SetItemString(context, "source_traceback",
+                                            fut->fut_source_tb) < 0)
+            goto finally;
+    }
+
+    call_exception_handler(fut->fut_loop, context, (PyObject *)fut);
+
+finally:
+    if (PyErr_Occurred())
+        PyErr_WriteUnraisable((PyObject *)fut);
+    Py_XDECREF(context);
+    Py_XDECREF(name);
+    Py_XDECREF(message);
+
+    /* Restore the saved exception. */
+    PyErr_Restore(error_type, error_value, error_traceback);
+}
+
+static PyObject *
+future_new_iter(PyObject *fut)
+{
+    futureiterobject *it;
+
+    if (!Future_Check(fut)) {
+        PyErr_BadInternalCall();
+        return NULL;
+    }
+    it = PyObject_GC_New(futureiterobject, &FutureIterType);
+    if (it == NULL)
+        return NULL;
+    Py_INCREF(fut);
+    it->future = (FutureObj *)fut;
+    it->yielded = 0;
+    _PyObject_GC_TRACK(it);
+    return (PyObject *)it;
+}
+
+static PyObject *
+FutureObj_get_state(FutureObj *fut)
+{
+    PyObject *state = future_state_name(fut);
+    Py_INCREF(state);
+    return state;
+}
+
+#define FUTURE_GETTER(name, field)                          \
+    static PyObject *                                       \
+    FutureObj_get_##name(FutureObj *fut)                    \
+    {                                                       \
+        if (fut->field == NULL)                             \
+            Py_RETURN_NONE;                                 \
+        Py_INCREF(fut->field);                              \
+        return fut->field;                                  \
+    }
+
+FUTURE_GETTER(loop, fut_loop)
+FUTURE_GETTER(callbacks, fut_callbacks)
+FUTURE_GETTER(result, fut_result)
+FUTURE_GETTER(exception, fut_exception)
+FUTURE_GETTER(source_traceback, fut_source_tb)
+
+#undef FUTURE_GETTER
+
+static PyObject *
+FutureObj_get_log_traceback(FutureObj *fut)
+{
+    return PyBool_FromLong(fut->fut_log_tb);
+}
+
+static int
+FutureObj_set_log_traceback(FutureObj *fut, PyObject *val)
+{
+    int is_true;
+
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+    is_true = PyObject_IsTrue(val);
+    if (is_true < 0)
+        return -1;
+    fut->fut_log_tb = is_true;
+    return 0;
+}
+
+static PyObject *
+FutureObj_get_blocking(FutureObj *fut)
+{
+    return PyBool_FromLong(fut->fut_blocking);
+}
+
+static int
+FutureObj_set_blocking(FutureObj *fut, PyObject *val)
+{
+    int is_true;
+
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+    is_true = PyObject_IsTrue(val);
+    if (is_true < 0)
+        return -1;
+    fut->fut_blocking = is_true;
+    return 0;
+}
+
+static PyGetSetDef FutureType_getsetlist[] = {
+    {"_state", (getter)FutureObj_get_state, NULL, NULL},
+    {"_loop", (getter)FutureObj_get_loop, NULL, NULL},
+    {"_callbacks", (getter)FutureObj_get_callbacks, NULL, NULL},
+    {"_result", (getter)FutureObj_get_result, NULL, NULL},
+    {"_exception", (getter)FutureObj_get_exception, NULL, NULL},
+    {"_source_traceback", (getter)FutureObj_get_source_traceback, NULL, NULL},
+    {"_log_traceback", (getter)FutureObj_get_log_traceback,
+                       (setter)FutureObj_set_log_traceback, NULL},
+    {"_blocking", (getter)FutureObj_get_blocking,
+                  (setter)FutureObj_set_blocking, NULL},
+    {"__dict__", PyObject_GenericGetDict, PyObject_GenericSetDict},
+    {NULL} /* Sentinel */
+};
+
+static PyMethodDef FutureType_methods[] = {
+    _ASYNCIO_FUTURE_RESULT_METHODDEF
+    _ASYNCIO_FUTURE_EXCEPTION_METHODDEF
+    _ASYNCIO_FUTURE_SET_RESULT_METHODDEF
+    _ASYNCIO_FUTURE_SET_EXCEPTION_METHODDEF
+    _ASYNCIO_FUTURE_ADD_DONE_CALLBACK_METHODDEF
+    _ASYNCIO_FUTURE_REMOVE_DONE_CALLBACK_METHODDEF
+    _ASYNCIO_FUTURE_CANCEL_METHODDEF
+    _ASYNCIO_FUTURE_CANCELLED_METHODDEF
+    _ASYNCIO_FUTURE_DONE_METHODDEF
+    _ASYNCIO_FUTURE__SCHEDULE_CALLBACKS_METHODDEF
+    _ASYNCIO_FUTURE__REPR_INFO_METHODDEF
+    {NULL, NULL}        /* Sentinel */
+};
+
+static int
+FutureObj_clear(FutureObj *fut)
+{
+    Py_CLEAR(fut->fut_loop);
+    Py_CLEAR(fut->fut_callbacks);
+    Py_CLEAR(fut->fut_result);
+    Py_CLEAR(fut->fut_exception);
+    Py_CLEAR(fut->fut_source_tb);
+    Py_CLEAR(fut->dict);
+    return 0;
+}
+
+static int
+FutureObj_traverse(FutureObj *fut, visitproc visit, void *arg)
+{
+    Py_VISIT(fut->fut_loop);
+    Py_VISIT(fut->fut_callbacks);
+    Py_VISIT(fut->fut_result);
+    Py_VISIT(fut->fut_exception);
+    Py_VISIT(fut->fut_source_tb);
+    Py_VISIT(fut->dict);
+    return 0;
+}
+
+static void
+FutureObj_dealloc(PyObject *self)
+{
+    FutureObj *fut = (FutureObj *)self;
+
+    if (Future_CheckExact(fut)) {
+        /* When fut is a subclass of Future, the finalizer is called
+           by subtype_dealloc(). */
+        if (PyObject_CallFinalizerFromDealloc(self) < 0) {
+            /* resurrected */
+            return;
+        }
+    }
+
+    PyObject_GC_UnTrack(self);
+    if (fut->fut_weakreflist != NULL)
+        PyObject_ClearWeakRefs(self);
+    (void)FutureObj_clear(fut);
+    Py_TYPE(fut)->tp_free(fut);
+}
+
+static PyAsyncMethods FutureType_as_async = {
+    (unaryfunc)future_new_iter,         /* am_await */
+    0,                                  /* am_aiter */
+    0                                   /* am_anext */
+};
+
+static PyTypeObject FutureType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.Future",                          /* tp_name */
+    sizeof(FutureObj),                          /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)FutureObj_dealloc,              /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    &FutureType_as_async,                       /* tp_as_async */
+    (reprfunc)FutureObj_repr,                   /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    0,                                          /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC
+        | Py_TPFLAGS_HAVE_FINALIZE,             /* tp_flags */
+    _asyncio_Future___init____doc__,            /* tp_doc */
+    (traverseproc)FutureObj_traverse,           /* tp_traverse */
+    (inquiry)FutureObj_clear,                   /* tp_clear */
+    0,                                          /* tp_richcompare */
+    offsetof(FutureObj, fut_weakreflist),       /* tp_weaklistoffset */
+    (getiterfunc)future_new_iter,               /* tp_iter */
+    0,                                          /* tp_iternext */
+    FutureType_methods,                         /* tp_methods */
+    0,                                          /* tp_members */
+    FutureType_getsetlist,                      /* tp_getset */
+    0,                                          /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    offsetof(FutureObj, dict),                  /* tp_dictoffset */
+    (initproc)_asyncio_Future___init__,         /* tp_init */
+    PyType_GenericAlloc,                        /* tp_alloc */
+    PyType_GenericNew,                          /* tp_new */
+    PyObject_GC_Del,                            /* tp_free */
+    0,                                          /* tp_is_gc */
+    0,                                          /* tp_bases */
+    0,                                          /* tp_mro */
+    0,                                          /* tp_cache */
+    0,                                          /* tp_subclasses */
+    0,                                          /* tp_weaklist */
+    0,                                          /* tp_del */
+    0,                                          /* tp_version_tag */
+    (destructor)FutureObj_finalize,             /* tp_finalize */
+};
+
+
+/* --- Future iterator --------------------------------------------------- */
+
+/* The iterator returned by Future.__iter__() and Future.__await__(): it
+   implements the generator of the Python version,
+
+       if not self.done():
+           self._blocking = True
+           yield self  # This tells Task to wait for completion.
+       assert self.done(), "yield from wasn't used with future"
+       return self.result()  # May raise too.
+*/
+
+static void
+FutureIter_dealloc(futureiterobject *it)
+{
+    PyObject_GC_UnTrack(it);
+    Py_XDECREF(it->future);
+    PyObject_GC_Del(it);
+}
+
+static int
+FutureIter_traverse(futureiterobject *it, visitproc visit, void *arg)
+{
+    Py_VISIT(it->future);
+    return 0;
+}
+
+static PyObject *
+FutureIter_iternext(futureiterobject *it)
+{
+    PyObject *res, *exc;
+    FutureObj *fut = it->future;
+
+    if (fut == NULL)
+        return NULL;
+
+    if (fut->fut_state == STATE_PENDING) {
+        if (!it->yielded) {
+            it->yielded = 1;
+            fut->fut_blocking = 1;
+            Py_INCREF(fut);
+            return (PyObject *)fut;
+        }
+        it->future = NULL;
+        PyErr_SetString(PyExc_AssertionError,
+                        "yield from wasn't used with future");
+        Py_DECREF(fut);
+        return NULL;
+    }
+
+    it->future = NULL;
+    res = future_call_result(fut);
+    Py_DECREF(fut);
+    if (res == NULL)
+        return NULL;
+    /* Raise StopIteration(res): create the exception explicitly, since
+       PyErr_SetObject() would unpack a tuple result */
+    exc = PyObject_CallFunctionObjArgs(PyExc_StopIteration, res, NULL);
+    Py_DECREF(res);
+    if (exc == NULL)
+        return NULL;
+    PyErr_SetObject(PyExc_StopIteration, exc);
+    Py_DECREF(exc);
+    return NULL;
+}
+
+static PyObject *
+FutureIter_send(futureiterobject *it, PyObject *unused)
+{
+    /* Future.__iter__ doesn't care about values that are pushed to the
+       generator, it just returns "self.result()". */
+    return FutureIter_iternext(it);
+}
+
+static PyObject *
+FutureIter_throw(futureiterobject *it, PyObject *args)
+{
+    PyObject *type = NULL, *val = NULL, *tb = NULL;
+
+    if (!PyArg_UnpackTuple(args, "throw", 1, 3, &type, &val, &tb))
+        return NULL;
+
+    if (val == Py_None)
+        val = NULL;
+    if (tb == Py_None)
+        tb = NULL;
+    else if (tb != NULL && !PyTraceBack_Check(tb)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "throw() third argument must be a traceback");
+        return NULL;
+    }
+
+    Py_INCREF(type);
+    Py_XINCREF(val);
+    Py_XINCREF(tb);
+
+    if (PyExceptionClass_Check(type)) {
+        PyErr_NormalizeException(&type, &val, &tb);
+    }
+    else if (PyExceptionInstance_Check(type)) {
+        if (val != NULL) {
+            PyErr_SetString(PyExc_TypeError,
+                            "instance exception may not have a separate "
+                            "value");
+            goto fail;
+        }
+        val = type;
+        type = PyExceptionInstance_Class(type);
+        Py_INCREF(type);
+        if (tb == NULL)
+            tb = PyException_GetTraceback(val);
+    }
+    else {
+        PyErr_Format(PyExc_TypeError,
+                     "exceptions must be classes or instances deriving "
+                     "from BaseException, not %s",
+                     Py_TYPE(type)->tp_name);
+        goto fail;
+    }
+
+    /* The exception is raised at the yield, which ends the generator */
+    Py_CLEAR(it->future);
+    PyErr_Restore(type, val, tb);
+    return NULL;
+
+fail:
+    Py_DECREF(type);
+    Py_XDECREF(val);
+    Py_XDECREF(tb);
+    return NULL;
+}
+
+static PyObject *
+FutureIter_close(futureiterobject *it, PyObject *unused)
+{
+    Py_CLEAR(it->future);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef FutureIter_methods[] = {
+    {"send",  (PyCFunction)FutureIter_send, METH_O, NULL},
+    {"throw", (PyCFunction)FutureIter_throw, METH_VARARGS, NULL},
+    {"close", (PyCFunction)FutureIter_close, METH_NOARGS, NULL},
+    {NULL, NULL}        /* Sentinel */
+};
+
+static PyTypeObject FutureIterType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.FutureIter",                      /* tp_name */
+    sizeof(futureiterobject),                   /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)FutureIter_dealloc,             /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_as_async */
+    0,                                          /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    PyObject_GenericGetAttr,                    /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,    /* tp_flags */
+    0,                                          /* tp_doc */
+    (traverseproc)FutureIter_traverse,          /* tp_traverse */
+    0,                                          /* tp_clear */
+    0,                                          /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    PyObject_SelfIter,                          /* tp_iter */
+    (iternextfunc)FutureIter_iternext,          /* tp_iternext */
+    FutureIter_methods,                         /* tp_methods */
+    0,                                          /* tp_members */
+};
+
+
+/* --- Task -------------------------------------------------------------- */
+
+#define TASK_FUT(task) (&(task)->task_future)
+
+static PyObject *task_step(TaskObj *, PyObject *);
+
+/* Call self._step(exc), which subclasses may override */
+static PyObject *
+task_call_step(TaskObj *task, PyObject *exc)
+{
+    if (Task_CheckExact(task))
+        return task_step(task, exc);
+    return _PyObject_CallMethodIdObjArgs((PyObject *)task, &PyId__step,
+                                         exc, NULL);
+}
+
+/* Schedule self._step(arg) with loop.call_soon(); arg can be NULL */
+static int
+task_call_soon_step(TaskObj *task, PyObject *arg)
+{
+    PyObject *step, *handle;
+
+    step = _PyObject_GetAttrId((PyObject *)task, &PyId__step);
+    if (step == NULL)
+        return -1;
+    handle = _PyObject_CallMethodIdObjArgs(TASK_FUT(task)->fut_loop,
+                                           &PyId_call_soon, step, arg, NULL);
+    Py_DECREF(step);
+    if (handle == NULL)
+        return -1;
+    Py_DECREF(handle);
+    return 0;
+}
+
+/* Schedule self._step(RuntimeError(message)); steal a reference to exc */
+static int
+task_call_soon_step_error(TaskObj *task, PyObject *exc)
+{
+    int res;
+
+    if (exc == NULL)
+        return -1;
+    res = task_call_soon_step(task, exc);
+    Py_DECREF(exc);
+    return res;
+}
+
+/* Return the class attribute _current_tasks or _all_tasks of the task */
+static PyObject *
+task_class_attr(TaskObj *task, _Py_Identifier *name)
+{
+    return _PyObject_GetAttrId((PyObject *)Py_TYPE(task), name);
+}
+
+/* Handle the value yielded by the coroutine, as the "else" block of the
+   try statement of Task._step() */
+static int
+task_handle_yield(TaskObj *task, PyObject *result)
+{
+    FutureObj *fut_self = TASK_FUT(task);
+    PyObject *wakeup, *res;
+    PyObject *loop = NULL;
+    int blocking, is_true;
+
+    if (result == Py_None) {
+        /* Bare yield relinquishes control for one event loop iteration. */
+        return task_call_soon_step(task, NULL);
+    }
+
+    if (Future_Check(result)) {
+        FutureObj *fut = (FutureObj *)result;
+        /* Yielded Future must come from Future.__iter__(). */
+        if (fut->fut_loop != fut_self->fut_loop) {
+            return task_call_soon_step_error(task, make_runtime_error(
+                "Task %R got Future %R attached to a different loop",
+                task, result));
+        }
+        if (!fut->fut_blocking) {
+            return task_call_soon_step_error(task, make_runtime_error(
+                "yield was used instead of yield from in task %R with %R",
+                task, result));
+        }
+        fut->fut_blocking = 0;
+        wakeup = _PyObject_GetAttrId((PyObject *)task, &PyId__wakeup);
+        if (wakeup == NULL)
+            return -1;
+        if (Future_Methods_Exact(fut)) {
+            res = future_add_done_callback(fut, wakeup);
+        }
+        else {
+            res = _PyObject_CallMethodIdObjArgs(result,
+                                                &PyId_add_done_callback,
+                                                wakeup, NULL);
+        }
+        Py_DECREF(wakeup);
+        if (res == NULL)
+            return -1;
+        Py_DECREF(res);
+    }
+    else {
+        is_true = PyObject_IsInstance(result, asyncio_py_future_type);
+        if (is_true < 0)
+            return -1;
+        if (!is_true) {
+            if (PyGen_Check(result)) {
+                /* Yielding a generator is just wrong. */
+                return task_call_soon_step_error(task, make_runtime_error(
+                    "yield was used instead of yield from for generator "
+                    "in task %R with %S", task, result));
+            }
+            /* Yielding something else is an error. */
+            return task_call_soon_step_error(task, make_runtime_error(
+                "Task got bad yield: %R", result));
+        }
+
+        /* A future of the Python implementation */
+        loop = _PyObject_GetAttrId(result, &PyId__loop);
+        if (loop == NULL)
+            return -1;
+        Py_DECREF(loop);
+        if (loop != fut_self->fut_loop) {
+            return task_call_soon_step_error(task, make_runtime_error(
+                "Task %R got Future %R attached to a different loop",
+                task, result));
+        }
+        res = _PyObject_GetAttrId(result, &PyId__blocking);
+        if (res == NULL)
+            return -1;
+        blocking = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (blocking < 0)
+            return -1;
+        if (!blocking) {
+            return task_call_soon_step_error(task, make_runtime_error(
+                "yield was used instead of yield from in task %R with %R",
+                task, result));
+        }
+        if (_PyObject_SetAttrId(result, &PyId__blocking, Py_False) < 0)
+            return -1;
+        wakeup = _PyObject_GetAttrId((PyObject *)task, &PyId__wakeup);
+        if (wakeup == NULL)
+            return -1;
+        res = _PyObject_CallMethodIdObjArgs(result, &PyId_add_done_callback,
+                                            wakeup, NULL);
+        Py_DECREF(wakeup);
+        if (res == NULL)
+            return -1;
+        Py_DECREF(res);
+    }
+
+    Py_INCREF(result);
+    Py_XSETREF(task->task_fut_waiter, result);
+    if (task->task_must_cancel) {
+        res = _PyObject_CallMethodId(result, &PyId_cancel, NULL);
+        if (res == NULL)
+            return -1;
+        is_true = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (is_true < 0)
+            return -1;
+        if (is_true)
+            task->task_must_cancel = 0;
+    }
+    return 0;
+}
+
+static PyObject *
+task_step(TaskObj *task, PyObject *exc)
+{
+    FutureObj *fut = TASK_FUT(task);
+    PyObject *current_tasks, *coro, *result, *res, *popped;
+    PyObject *et, *ev, *tb;
+    int status;
+
+    if (future_ensure_alive(fut) < 0)
+        return NULL;
+    if (fut->fut_state != STATE_PENDING) {
+        PyErr_Format(PyExc_AssertionError,
+                     "_step(): already done: %R, %R",
+                     task, exc ? exc : Py_None);
+        return NULL;
+    }
+
+    if (exc == Py_None)
+        exc = NULL;
+    Py_XINCREF(exc);
+    if (task->task_must_cancel) {
+        int is_cancel = 0;
+        if (exc != NULL) {
+            is_cancel = PyObject_IsInstance(exc, asyncio_CancelledError);
+            if (is_cancel < 0) {
+                Py_DECREF(exc);
+                return NULL;
+            }
+        }
+        if (!is_cancel) {
+            Py_XSETREF(exc, PyObject_CallObject(asyncio_CancelledError,
+                                                NULL));
+            if (exc == NULL)
+                return NULL;
+        }
+        task->task_must_cancel = 0;
+    }
+    Py_CLEAR(task->task_fut_waiter);
+
+    current_tasks = task_class_attr(task, &PyId__current_tasks);
+    if (current_tasks == NULL) {
+        Py_XDECREF(exc);
+        return NULL;
+    }
+    if (PyObject_SetItem(current_tasks, fut->fut_loop,
+                         (PyObject *)task) < 0) {
+        Py_DECREF(current_tasks);
+        Py_XDECREF(exc);
+        return NULL;
+    }
+
+    /* Call either coro.throw(exc) or coro.send(None). */
+    coro = task->task_coro;
+    Py_INCREF(coro);
+    if (exc == NULL) {
+        if (PyGen_CheckExact(coro) || PyCoro_CheckExact(coro))
+            result = _PyGen_Send((PyGenObject *)coro, Py_None);
+        else
+            result = _PyObject_CallMethodIdObjArgs(coro, &PyId_send,
+                                                   Py_None, NULL);
+    }
+    else {
+        result = _PyObject_CallMethodIdObjArgs(coro, &PyId_throw,
+                                               exc, NULL);
+        Py_CLEAR(exc);
+    }
+    Py_DECREF(coro);
+
+    if (result != NULL) {
+        status = task_handle_yield(task, result);
+        Py_DECREF(result);
+        res = status < 0 ? NULL : Py_None;
+        Py_XINCREF(res);
+    }
+    else if (_PyGen_FetchStopIterationValue(&result) == 0) {
+        if (Future_Methods_Exact(task))
+            res = future_set_result(fut, result);
+        else
+            res = _PyObject_CallMethodIdObjArgs((PyObject *)task,
+                                                &PyId_set_result,
+                                                result, NULL);
+        Py_DECREF(result);
+    }
+    else if (PyErr_ExceptionMatches(asyncio_CancelledError)) {
+        /* super().cancel(), i.e. Future.cancel(self) */
+        PyErr_Clear();
+        res = future_cancel(fut);
+    }
+    else {
+        PyErr_Fetch(&et, &ev, &tb);
+        PyErr_NormalizeException(&et, &ev, &tb);
+        if (tb != NULL)
+            PyException_SetTraceback(ev, tb);
+        if (Future_Methods_Exact(task))
+            res = future_set_exception(fut, ev);
+        else
+            res = _PyObject_CallMethodIdObjArgs((PyObject *)task,
+                                                &PyId_set_exception,
+                                                ev, NULL);
+        if (res != NULL
+            && !PyErr_GivenExceptionMatches(et, PyExc_Exception)) {
+            /* A BaseException like KeyboardInterrupt is raised again */
+            Py_CLEAR(res);
+            PyErr_Restore(et, ev, tb);
+        }
+        else {
+            Py_DECREF(et);
+            Py_XDECREF(ev);
+            Py_XDECREF(tb);
+        }
+    }
+
+    /* finally: self.__class__._current_tasks.pop(self._loop) */
+    PyErr_Fetch(&et, &ev, &tb);
+    popped = _PyObject_CallMethodIdObjArgs(current_tasks, &PyId_pop,
+                                           fut->fut_loop, NULL);
+    Py_DECREF(current_tasks);
+    if (popped == NULL) {
+        Py_XDECREF(et);
+        Py_XDECREF(ev);
+        Py_XDECREF(tb);
+        Py_XDECREF(res);
+        return NULL;
+    }
+    Py_DECREF(popped);
+    PyErr_Restore(et, ev, tb);
+    return res;
+}
+
+static PyObject *
+task_wakeup(TaskObj *task, PyObject *future)
+{
+    PyObject *res, *et, *ev, *tb;
+
+    if (Future_Check(future))
+        res = future_call_result((FutureObj *)future);
+    else
+        res = _PyObject_CallMethodId(future, &PyId_result, NULL);
+
+    if (res != NULL) {
+        /* Don't pass the value of `future.result()` explicitly,
+           as `Future.__iter__` and `Future.__await__` don't need it. */
+        Py_DECREF(res);
+        return task_call_step(task, NULL);
+    }
+
+    if (!PyErr_ExceptionMatches(PyExc_Exception))
+        return NULL;
+    /* This may also be a cancellation. */
+    PyErr_Fetch(&et, &ev, &tb);
+    PyErr_NormalizeException(&et, &ev, &tb);
+    if (tb != NULL)
+        PyException_SetTraceback(ev, tb);
+    res = task_call_step(task, ev);
+    Py_DECREF(et);
+    Py_XDECREF(ev);
+    Py_XDECREF(tb);
+    return res;
+}
+
+/*[clinic input]
+_asyncio.Task.__init__
+
+    coro: object
+    *
+    loop: object = None
+
+A coroutine wrapped in a Future.
+[clinic start generated code]*/
+
+static int
+_asyncio_Task___init___impl(TaskObj *self, PyObject *coro, PyObject *loop)
+/*[clinic end generated code: output=9f24774c2287fc2f input=8d132974b049593e]*/
+{
+    PyObject *res, *all_tasks;
+    int is_coro;
+
+    if (module_init() < 0)
+        return -1;
+
+    if (!Py_OptimizeFlag
+        && !PyGen_CheckExact(coro) && !PyCoro_CheckExact(coro)) {
+        /* assert coroutines.iscoroutine(coro), repr(coro) */
+        res = PyObject_CallFunctionObjArgs(asyncio_iscoroutine_func, coro,
+                                           NULL);
+        if (res == NULL)
+            return -1;
+        is_coro = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (is_coro < 0)
+            return -1;
+        if (!is_coro) {
+            PyObject *repr = PyObject_Repr(coro);
+            if (repr != NULL) {
+                PyErr_SetObject(PyExc_AssertionError, repr);
+                Py_DECREF(repr);
+            }
+            return -1;
+        }
+    }
+
+    /* The source traceback already ends with the caller of Task(), which
+       the Python implementation gets by removing the frame of its
+       __init__() method. */
+    if (future_init(TASK_FUT(self), loop) < 0)
+        return -1;
+
+    Py_INCREF(coro);
+    Py_XSETREF(self->task_coro, coro);
+    Py_CLEAR(self->task_fut_waiter);
+    self->task_must_cancel = 0;
+    self->task_log_destroy_pending = 1;
+
+    if (task_call_soon_step(self, NULL) < 0)
+        return -1;
+
+    all_tasks = task_class_attr(self, &PyId__all_tasks);
+    if (all_tasks == NULL)
+        return -1;
+    res = _PyObject_CallMethodIdObjArgs(all_tasks, &PyId_add, self, NULL);
+    Py_DECREF(all_tasks);
+    if (res == NULL)
+        return -1;
+    Py_DECREF(res);
+    return 0;
+}
+
+/*[clinic input]
+@classmethod
+_asyncio.Task.current_task
+
+    loop: object = None
+
+Return the currently running task in an event loop or None.
+
+By default the current task for the current event loop is returned.
+
+None is returned when called not in the context of a Task.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Task_current_task_impl(PyTypeObject *type, PyObject *loop)
+/*[clinic end generated code: output=99fbe7332c516e03 input=cd14770c5b79c7eb]*/
+{
+    PyObject *current_tasks, *res;
+
+    if (module_init() < 0)
+        return NULL;
+    if (loop == Py_None) {
+        loop = get_event_loop();
+        if (loop == NULL)
+            return NULL;
+    }
+    else {
+        Py_INCREF(loop);
+    }
+
+    current_tasks = _PyObject_GetAttrId((PyObject *)type,
+                                        &PyId__current_tasks);
+    if (current_tasks == NULL) {
+        Py_DECREF(loop);
+        return NULL;
+    }
+    res = _PyObject_CallMethodIdObjArgs(current_tasks, &PyId_get, loop, NULL);
+    Py_DECREF(current_tasks);
+    Py_DECREF(loop);
+    return res;
+}
+
+/*[clinic input]
+@classmethod
+_asyncio.Task.all_tasks
+
+    loop: object = None
+
+Return a set of all tasks for an event loop.
+
+By default all tasks for the current event loop are returned.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Task_all_tasks_impl(PyTypeObject *type, PyObject *loop)
+/*[clinic end generated code: output=11f9b20749ccca5d input=497f80bc9ce726b5]*/
+{
+    PyObject *all_tasks, *iter, *task, *task_loop, *set;
+
+    if (module_init() < 0)
+        return NULL;
+    if (loop == Py_None) {
+        loop = get_event_loop();
+        if (loop == NULL)
+            return NULL;
+    }
+    else {
+        Py_INCREF(loop);
+    }
+
+    set = PySet_New(NULL);
+    if (set == NULL)
+        goto fail;
+    all_tasks = _PyObject_GetAttrId((PyObject *)type, &PyId__all_tasks);
+    if (all_tasks == NULL)
+        goto fail;
+    iter = PyObject_GetIter(all_tasks);
+    Py_DECREF(all_tasks);
+    if (iter == NULL)
+        goto fail;
+
+    while ((task = PyIter_Next(iter)) != NULL) {
+        task_loop = _PyObject_GetAttrId(task, &PyId__loop);
+        if (task_loop == NULL) {
+            Py_DECREF(task);
+            break;
+        }
+        if (task_loop == loop && PySet_Add(set, task) < 0) {
+            Py_DECREF(task_loop);
+            Py_DECREF(task);
+            break;
+        }
+        Py_DECREF(task_loop);
+        Py_DECREF(task);
+    }
+    Py_DECREF(iter);
+    if (PyErr_Occurred())
+        goto fail;
+    Py_DECREF(loop);
+    return set;
+
+fail:
+    Py_XDECREF(set);
+    Py_DECREF(loop);
+    return NULL;
+}
+
+/*[clinic input]
+_asyncio.Task._repr_info
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Task__repr_info_impl(TaskObj *self)
+/*[clinic end generated code: output=6a490eb66d5ba34b input=3c6d051ed3ddec8b]*/
+{
+    return PyObject_CallFunctionObjArgs(asyncio_task_repr_info_func,
+                                        self, NULL);
+}
+
+/*[clinic input]
+_asyncio.Task.cancel
+
+Request that this task cancel itself.
+
+This arranges for a CancelledError to be thrown into the
+wrapped coroutine on the next cycle through the event loop.
+The coroutine then has a chance to clean up or even deny
+the request using try/except/finally.
+
+Unlike Future.cancel, this does not guarantee that the
+task will be cancelled: the exception might be caught and
+acted upon, delaying cancellation of the task or preventing
+cancellation completely.  The task may also return a value or
+raise a different exception.
+
+Immediately after this method is called, Task.cancelled() will
+not return True (unless the task was already cancelled).  A
+task will be marked as cancelled when the wrapped coroutine
+terminates with a CancelledError exception (even if cancel()
+was not called).
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Task_cancel_impl(TaskObj *self)
+/*[clinic end generated code: output=6bfc0479da9d5757 input=13f9bf496695cb52]*/
+{
+    if (TASK_FUT(self)->fut_state != STATE_PENDING)
+        Py_RETURN_FALSE;
+
+    if (self->task_fut_waiter != NULL) {
+        PyObject *res;
+        int is_true;
+
+        res = _PyObject_CallMethodId(self->task_fut_waiter, &PyId_cancel,
+                                     NULL);
+        if (res == NULL)
+            return NULL;
+        is_true = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (is_true < 0)
+            return NULL;
+        if (is_true) {
+            /* Leave self._fut_waiter; it may be a Task that
+               catches and ignores the cancellation so we may have
+               to cancel it again later. */
+            Py_RETURN_TRUE;
+        }
+    }
+
+    /* It must be the case that self._step is already scheduled. */
+    self->task_must_cancel = 1;
+    Py_RETURN_TRUE;
+}
+
+/*[clinic input]
+_asyncio.Task.get_stack
+
+    *
+    limit: object = None
+
+Return the list of stack frames for this task's coroutine.
+
+If the coroutine is not done, this returns the stack where it is
+suspended.  If the coroutine has completed successfully or was
+cancelled, this returns an empty list.  If the coroutine was
+terminated by an exception, this returns the list of traceback
+frames.
+
+The frames are always ordered from oldest to newest.
+
+The optional limit gives the maximum number of frames to
+return; by default all available frames are returned.  Its
+meaning differs depending on whether a stack or a traceback is
+returned: the newest frames of a stack are returned, but the
+oldest frames of a traceback are returned.  (This matches the
+behavior of the traceback module.)
+
+For reasons beyond our control, only one stack frame is
+returned for a suspended coroutine.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Task_get_stack_impl(TaskObj *self, PyObject *limit)
+/*[clinic end generated code: output=c9aeeeebd1e18118 input=05b323d42b809b90]*/
+{
+    return PyObject_CallFunctionObjArgs(asyncio_task_get_stack_func,
+                                        self, limit, NULL);
+}
+
+/*[clinic input]
+_asyncio.Task.print_stack
+
+    *
+    limit: object = None
+    file: object = None
+
+Print the stack or traceback for this task's coroutine.
+
+This produces output similar to that of the traceback module,
+for the frames retrieved by get_stack().  The limit argument
+is passed to get_stack().  The file argument is an I/O stream
+to which the output is written; by default output is written
+to sys.stderr.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Task_print_stack_impl(TaskObj *self, PyObject *limit,
+                               PyObject *file)
+/*[clinic end generated code: output=7339e10314cd3f4d input=1a0352913b7fcd92]*/
+{
+    return PyObject_CallFunctionObjArgs(asyncio_task_print_stack_func,
+                                        self, limit, file, NULL);
+}
+
+/*[clinic input]
+_asyncio.Task._step
+
+    exc: object = None
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Task__step_impl(TaskObj *self, PyObject *exc)
+/*[clinic end generated code: output=7ed23f0cefd5ae42 input=1e19a985ace87ca4]*/
+{
+    return task_step(self, exc);
+}
+
+/*[clinic input]
+_asyncio.Task._wakeup
+
+    future: object
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_Task__wakeup_impl(TaskObj *self, PyObject *future)
+/*[clinic end generated code: output=25df964f576410ab input=0bcb601c63022558]*/
+{
+    return task_wakeup(self, future);
+}
+
+static void
+TaskObj_finalize(TaskObj *task)
+{
+    PyObject *error_type, *error_value, *error_traceback;
+    PyObject *context = NULL, *message = NULL;
+    PyObject *source_tb = TASK_FUT(task)->fut_source_tb;
+
+    if (TASK_FUT(task)->fut_state != STATE_PENDING
+        || !task->task_log_destroy_pending)
+        goto done;
+
+    /* Save the current exception, if any. */
+    PyErr_Fetch(&error_type, &error_value, &error_traceback);
+
+    context = PyDict_New();
+    if (context == NULL)
+        goto finally;
+    message = PyUnicode_FromString("Task was destroyed but it is pending!");
+    if (message == NULL)
+        goto finally;
+    if (PyDict_SetItemString(context, "message", message) < 0 ||
+        PyDict_SetItemString(context, "task", (PyObject *)task) < 0)
+        goto finally;
+    if (source_tb != NULL) {
+        int is_true = PyObject_IsTrue(source_tb);
+        if (is_true < 0)
+            goto finally;
+        if (is_true && PyDict_SetItemString(context, "source_traceback",
+                                            source_tb) < 0)
+            goto finally;
+    }
+
+    call_exception_handler(TASK_FUT(task)->fut_loop, context,
+                           (PyObject *)task);
+
+finally:
+    if (PyErr_Occurred())
+        PyErr_WriteUnraisable((PyObject *)task);
+    Py_XDECREF(context);
+    Py_XDECREF(message);
+
+    /* Restore the saved exception. */
+    PyErr_Restore(error_type, error_value, error_traceback);
+
+done:
+    FutureObj_finalize(TASK_FUT(task));
+}
+
+static PyObject *
+TaskObj_get_log_destroy_pending(TaskObj *task)
+{
+    return PyBool_FromLong(task->task_log_destroy_pending);
+}
+
+static int
+TaskObj_set_log_destroy_pending(TaskObj *task, PyObject *val)
+{
+    int is_true;
+
+    if (val == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "cannot delete attribute");
+        return -1;
+    }
+    is_true = PyObject_IsTrue(val);
+    if (is_true < 0)
+        return -1;
+    task->task_log_destroy_pending = is_true;
+    return 0;
+}
+
+static PyObject *
+TaskObj_get_must_cancel(TaskObj *task)
+{
+    return PyBool_FromLong(task->task_must_cancel);
+}
+
+static PyObject *
+TaskObj_get_coro(TaskObj *task)
+{
+    if (task->task_coro == NULL)
+        Py_RETURN_NONE;
+    Py_INCREF(task->task_coro);
+    return task->task_coro;
+}
+
+static PyObject *
+TaskObj_get_fut_waiter(TaskObj *task)
+{
+    if (task->task_fut_waiter == NULL)
+        Py_RETURN_NONE;
+    Py_INCREF(task->task_fut_waiter);
+    return task->task_fut_waiter;
+}
+
+static PyGetSetDef TaskType_getsetlist[] = {
+    {"_log_destroy_pending", (getter)TaskObj_get_log_destroy_pending,
+                             (setter)TaskObj_set_log_destroy_pending, NULL},
+    {"_must_cancel", (getter)TaskObj_get_must_cancel, NULL, NULL},
+    {"_coro", (getter)TaskObj_get_coro, NULL, NULL},
+    {"_fut_waiter", (getter)TaskObj_get_fut_waiter, NULL, NULL},
+    {NULL} /* Sentinel */
+};
+
+static PyMethodDef TaskType_methods[] = {
+    _ASYNCIO_TASK_CURRENT_TASK_METHODDEF
+    _ASYNCIO_TASK_ALL_TASKS_METHODDEF
+    _ASYNCIO_TASK_CANCEL_METHODDEF
+    _ASYNCIO_TASK_GET_STACK_METHODDEF
+    _ASYNCIO_TASK_PRINT_STACK_METHODDEF
+    _ASYNCIO_TASK__STEP_METHODDEF
+    _ASYNCIO_TASK__WAKEUP_METHODDEF
+    _ASYNCIO_TASK__REPR_INFO_METHODDEF
+    {NULL, NULL}        /* Sentinel */
+};
+
+static int
+TaskObj_clear(TaskObj *task)
+{
+    (void)FutureObj_clear(TASK_FUT(task));
+    Py_CLEAR(task->task_coro);
+    Py_CLEAR(task->task_fut_waiter);
+    return 0;
+}
+
+static int
+TaskObj_traverse(TaskObj *task, visitproc visit, void *arg)
+{
+    Py_VISIT(task->task_coro);
+    Py_VISIT(task->task_fut_waiter);
+    (void)FutureObj_traverse(TASK_FUT(task), visit, arg);
+    return 0;
+}
+
+static void
+TaskObj_dealloc(PyObject *self)
+{
+    TaskObj *task = (TaskObj *)self;
+
+    if (Task_CheckExact(self)) {
+        /* When task is a subclass of Task, the finalizer is called
+           by subtype_dealloc(). */
+        if (PyObject_CallFinalizerFromDealloc(self) < 0) {
+            /* resurrected */
+            return;
+        }
+    }
+
+    PyObject_GC_UnTrack(self);
+    if (TASK_FUT(task)->fut_weakreflist != NULL)
+        PyObject_ClearWeakRefs(self);
+    (void)TaskObj_clear(task);
+    Py_TYPE(task)->tp_free(task);
+}
+
+static PyTypeObject TaskType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.Task",                            /* tp_name */
+    sizeof(TaskObj),                            /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)TaskObj_dealloc,                /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    &FutureType_as_async,                       /* tp_as_async */
+    (reprfunc)FutureObj_repr,                   /* tp_repr */
+    0,                                          /* tp_as_number */
+    0,                                          /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    0,                                          /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    0,                                          /* tp_getattro */
+    0,                                          /* tp_setattro */
+    0,                                          /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC
+        | Py_TPFLAGS_HAVE_FINALIZE,             /* tp_flags */
+    _asyncio_Task___init____doc__,              /* tp_doc */
+    (traverseproc)TaskObj_traverse,             /* tp_traverse */
+    (inquiry)TaskObj_clear,                     /* tp_clear */
+    0,                                          /* tp_richcompare */
+    offsetof(TaskObj, task_future.fut_weakreflist), /* tp_weaklistoffset */
+    (getiterfunc)future_new_iter,               /* tp_iter */
+    0,                                          /* tp_iternext */
+    TaskType_methods,                           /* tp_methods */
+    0,                                          /* tp_members */
+    TaskType_getsetlist,                        /* tp_getset */
+    &FutureType,                                /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    offsetof(TaskObj, task_future.dict),        /* tp_dictoffset */
+    (initproc)_asyncio_Task___init__,           /* tp_init */
+    PyType_GenericAlloc,                        /* tp_alloc */
+    PyType_GenericNew,                          /* tp_new */
+    PyObject_GC_Del,                            /* tp_free */
+    0,                                          /* tp_is_gc */
+    0,                                          /* tp_bases */
+    0,                                          /* tp_mro */
+    0,                                          /* tp_cache */
+    0,                                          /* tp_subclasses */
+    0,                                          /* tp_weaklist */
+    0,                                          /* tp_del */
+    0,                                          /* tp_version_tag */
+    (destructor)TaskObj_finalize,               /* tp_finalize */
+};
+
+
+/* --- Ready queue ------------------------------------------------------- */
+
+/* Run the callback of a Handle or TimerHandle object: this is
+   Handle._run(), without the call of a Python method and the creation
+   of its frame. */
+static int
+run_handle(PyObject *handle)
+{
+    PyObject *callback, *args, *res;
+    PyObject *et, *ev, *tb;
+    PyObject *saved_type, *saved_value, *saved_tb;
+
+    callback = _PyObject_GetAttrId(handle, &PyId__callback);
+    if (callback == NULL)
+        return -1;
+    args = _PyObject_GetAttrId(handle, &PyId__args);
+    if (args == NULL) {
+        Py_DECREF(callback);
+        return -1;
+    }
+    if (!PyTuple_CheckExact(args)) {
+        Py_SETREF(args, PySequence_Tuple(args));
+        if (args == NULL) {
+            Py_DECREF(callback);
+            return -1;
+        }
+    }
+    res = PyObject_Call(callback, args, NULL);
+    Py_DECREF(callback);
+    Py_DECREF(args);
+    if (res != NULL) {
+        Py_DECREF(res);
+        return 0;
+    }
+
+    if (!PyErr_ExceptionMatches(PyExc_Exception))
+        return -1;
+
+    /* except Exception as exc: self._report_exception(exc)
+
+       The exception is handled while _report_exception() runs, as in
+       the except block of the Python code. */
+    PyErr_Fetch(&et, &ev, &tb);
+    PyErr_NormalizeException(&et, &ev, &tb);
+    if (tb != NULL)
+        PyException_SetTraceback(ev, tb);
+    PyErr_GetExcInfo(&saved_type, &saved_value, &saved_tb);
+    Py_INCREF(et);
+    Py_INCREF(ev);
+    Py_XINCREF(tb);
+    PyErr_SetExcInfo(et, ev, tb);
+    res = _PyObject_CallMethodIdObjArgs(handle, &PyId__report_exception,
+                                        ev, NULL);
+    PyErr_SetExcInfo(saved_type, saved_value, saved_tb);
+    Py_DECREF(et);
+    Py_DECREF(ev);
+    Py_XDECREF(tb);
+    if (res == NULL)
+        return -1;
+    Py_DECREF(res);
+    return 0;
+}
+
+/*[clinic input]
+_asyncio._run_ready
+
+    ready: object
+    ntodo: Py_ssize_t
+    /
+
+Run the ntodo first handles of the ready queue of an event loop.
+
+This is the loop of BaseEventLoop._run_once() outside of debug mode:
+pop the handles from the left of the ready deque and run the ones which
+are not cancelled.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio__run_ready_impl(PyModuleDef *module, PyObject *ready,
+                         Py_ssize_t ntodo)
+/*[clinic end generated code: output=d67e750bf81f3282 input=738d4ae2de3de34e]*/
+{
+    PyObject *handle, *res;
+    Py_ssize_t i;
+    int cancelled;
+
+    if (module_init() < 0)
+        return NULL;
+
+    for (i = 0; i < ntodo; i++) {
+        handle = _PyObject_CallMethodId(ready, &PyId_popleft, NULL);
+        if (handle == NULL)
+            return NULL;
+
+        res = _PyObject_GetAttrId(handle, &PyId__cancelled);
+        if (res == NULL)
+            goto error;
+        cancelled = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (cancelled < 0)
+            goto error;
+        if (cancelled) {
+            Py_DECREF(handle);
+            continue;
+        }
+
+        if (Py_TYPE(handle) == (PyTypeObject *)asyncio_handle_type
+            || Py_TYPE(handle) == (PyTypeObject *)asyncio_timer_handle_type) {
+            if (run_handle(handle) < 0)
+                goto error;
+        }
+        else {
+            res = _PyObject_CallMethodId(handle, &PyId__run, NULL);
+            if (res == NULL)
+                goto error;
+            Py_DECREF(res);
+        }
+        Py_DECREF(handle);
+    }
+    Py_RETURN_NONE;
+
+error:
+    Py_DECREF(handle);
+    return NULL;
+}
+
+
+/* --- Stream buffer ----------------------------------------------------- */
+
+/* Allocations larger than this are released when the buffer is emptied */
+#define STREAMBUF_KEEP_ALLOC (64 * 1024)
+
+#define STREAMBUF_LEN(self) ((self)->end - (self)->start)
+
+#define STREAMBUF_CHECK_EXPORTS(self) \
+    if ((self)->exports > 0) { \
+        PyErr_SetString(PyExc_BufferError, \
+                        "Existing exports of data: object cannot be re-sized"); \
+        return NULL; \
+    }
+
+/* Return the offset of the first occurrence of sep in the content at or
+   after start, or -1 */
+static Py_ssize_t
+streambuf_find(StreamBufferObj *self, const char *sep, Py_ssize_t seplen,
+               Py_ssize_t start)
+{
+    const char *s = self->data + self->start;
+    Py_ssize_t len = STREAMBUF_LEN(self);
+    const char *p, *last;
+
+    if (start < 0) {
+        start += len;
+        if (start < 0)
+            start = 0;
+    }
+    if (seplen > len - start)
+        return seplen == 0 && start <= len ? start : -1;
+    if (seplen == 0)
+        return start;
+
+    p = s + start;
+    last = s + len - seplen;
+    while (p <= last) {
+        p = memchr(p, sep[0], last - p + 1);
+        if (p == NULL)
+            return -1;
+        if (memcmp(p + 1, sep + 1, seplen - 1) == 0)
+            return p - s;
+        p++;
+    }
+    return -1;
+}
+
+/* Remove the first n bytes of the content and return them as bytes */
+static PyObject *
+streambuf_consume(StreamBufferObj *self, Py_ssize_t n)
+{
+    PyObject *res;
+
+    assert(self->exports == 0);
+    if (n > STREAMBUF_LEN(self))
+        n = STREAMBUF_LEN(self);
+    if (n <= 0)
+        return PyBytes_FromStringAndSize(NULL, 0);
+    res = PyBytes_FromStringAndSize(self->data + self->start, n);
+    if (res == NULL)
+        return NULL;
+    self->start += n;
+    if (self->start == self->end) {
+        self->start = self->end = 0;
+        if (self->alloc > STREAMBUF_KEEP_ALLOC) {
+            PyMem_Free(self->data);
+            self->data = NULL;
+            self->alloc = 0;
+        }
+    }
+    return res;
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.extend
+
+    data: Py_buffer
+    /
+
+Append data at the end of the buffer.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_extend_impl(StreamBufferObj *self, Py_buffer *data)
+/*[clinic end generated code: output=2c7129e21089042d input=0f94115bb078d28c]*/
+{
+    Py_ssize_t len = STREAMBUF_LEN(self);
+
+    STREAMBUF_CHECK_EXPORTS(self);
+    if (data->len == 0)
+        Py_RETURN_NONE;
+    if (data->len > PY_SSIZE_T_MAX - len)
+        return PyErr_NoMemory();
+
+    if (data->len > self->alloc - self->end) {
+        if (len + data->len <= self->alloc - self->alloc / 4) {
+            /* Enough room once the content is moved to the beginning: the
+               consumed data was at least a quarter of the allocation */
+            memmove(self->data, self->data + self->start, len);
+        }
+        else {
+            Py_ssize_t alloc = len + data->len;
+            char *newdata;
+            if (alloc <= PY_SSIZE_T_MAX - (alloc >> 1))
+                alloc += alloc >> 1;
+            newdata = PyMem_Malloc(alloc);
+            if (newdata == NULL)
+                return PyErr_NoMemory();
+            if (len)
+                memcpy(newdata, self->data + self->start, len);
+            PyMem_Free(self->data);
+            self->data = newdata;
+            self->alloc = alloc;
+        }
+        self->start = 0;
+        self->end = len;
+    }
+    memcpy(self->data + self->end, data->buf, data->len);
+    self->end += data->len;
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.clear
+
+Remove all the data of the buffer.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_clear_impl(StreamBufferObj *self)
+/*[clinic end generated code: output=44696c317697feb8 input=4ed20dc8084e8cfd]*/
+{
+    STREAMBUF_CHECK_EXPORTS(self);
+    PyMem_Free(self->data);
+    self->data = NULL;
+    self->start = self->end = self->alloc = 0;
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.find
+
+    sub: Py_buffer
+    start: Py_ssize_t = 0
+    /
+
+Return the lowest index of sub in the buffer at or after start, or -1.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_find_impl(StreamBufferObj *self, Py_buffer *sub,
+                                Py_ssize_t start)
+/*[clinic end generated code: output=9085af42da28535e input=841154f97fbce955]*/
+{
+    return PyLong_FromSsize_t(streambuf_find(self, sub->buf, sub->len,
+                                             start));
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.startswith
+
+    prefix: Py_buffer
+    start: Py_ssize_t = 0
+    /
+
+Return True if the data of the buffer at start begins with prefix.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_startswith_impl(StreamBufferObj *self,
+                                      Py_buffer *prefix, Py_ssize_t start)
+/*[clinic end generated code: output=9800b29237c2f5c3 input=f85b3e7fd7a5155f]*/
+{
+    Py_ssize_t len = STREAMBUF_LEN(self);
+
+    if (start < 0) {
+        start += len;
+        if (start < 0)
+            start = 0;
+    }
+    if (start > len || prefix->len > len - start)
+        Py_RETURN_FALSE;
+    if (prefix->len == 0)
+        Py_RETURN_TRUE;
+    return PyBool_FromLong(memcmp(self->data + self->start + start,
+                                  prefix->buf, prefix->len) == 0);
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.consume
+
+    n: Py_ssize_t
+    /
+
+Remove the first n bytes of the buffer and return them as bytes.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_consume_impl(StreamBufferObj *self, Py_ssize_t n)
+/*[clinic end generated code: output=3fe98a472a79f768 input=0ffd286310c1a221]*/
+{
+    STREAMBUF_CHECK_EXPORTS(self);
+    return streambuf_consume(self, n);
+}
+
+/*[clinic input]
+_asyncio.StreamBuffer.readuntil
+
+    separator: Py_buffer
+    limit: Py_ssize_t
+    /
+
+Remove and return the data up to and including the first separator.
+
+Return None if the buffer doesn't contain separator, or if more than limit
+bytes precede it.
+[clinic start generated code]*/
+
+static PyObject *
+_asyncio_StreamBuffer_readuntil_impl(StreamBufferObj *self,
+                                     Py_buffer *separator, Py_ssize_t limit)
+/*[clinic end generated code: output=a189e5c0135f681d input=c0434ef4663b9641]*/
+{
+    Py_ssize_t isep;
+
+    STREAMBUF_CHECK_EXPORTS(self);
+    if (separator->len == 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "Separator should be at least one-byte string");
+        return NULL;
+    }
+    isep = streambuf_find(self, separator->buf, separator->len, 0);
+    if (isep < 0 || isep > limit)
+        Py_RETURN_NONE;
+    return streambuf_consume(self, isep + separator->len);
+}
+
+static void
+StreamBuffer_dealloc(StreamBufferObj *self)
+{
+    PyMem_Free(self->data);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static Py_ssize_t
+StreamBuffer_length(StreamBufferObj *self)
+{
+    return STREAMBUF_LEN(self);
+}
+
+static PyObject *
+StreamBuffer_richcompare(StreamBufferObj *self, PyObject *other, int op)
+{
+    Py_buffer view;
+    int equal;
+
+    if ((op != Py_EQ && op != Py_NE) || !PyObject_CheckBuffer(other)) {
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    if (PyObject_GetBuffer(other, &view, PyBUF_SIMPLE) < 0) {
+        PyErr_Clear();
+        Py_RETURN_NOTIMPLEMENTED;
+    }
+    equal = (view.len == STREAMBUF_LEN(self) &&
+             (view.len == 0 ||
+              memcmp(view.buf, self->data + self->start, view.len) == 0));
+    PyBuffer_Release(&view);
+    return PyBool_FromLong(equal == (op == Py_EQ));
+}
+
+static PyObject *
+StreamBuffer_repr(StreamBufferObj *self)
+{
+    PyObject *content, *res;
+
+    content = PyBytes_FromStringAndSize(self->data + self->start,
+                                        STREAMBUF_LEN(self));
+    if (content == NULL)
+        return NULL;
+    res = PyUnicode_FromFormat("%s(%R)", Py_TYPE(self)->tp_name, content);
+    Py_DECREF(content);
+    return res;
+}
+
+static int
+StreamBuffer_getbuffer(StreamBufferObj *self, Py_buffer *view, int flags)
+{
+    char *buf = self->data != NULL ? self->data + self->start : "";
+
+    if (PyBuffer_FillInfo(view, (PyObject *)self, buf, STREAMBUF_LEN(self),
+                          1, flags) < 0)
+        return -1;
+    self->exports++;
+    return 0;
+}
+
+static void
+StreamBuffer_releasebuffer(StreamBufferObj *self, Py_buffer *view)
+{
+    self->exports--;
+}
+
+static PySequenceMethods StreamBufferType_as_sequence = {
+    (lenfunc)StreamBuffer_length,               /* sq_length */
+};
+
+static PyBufferProcs StreamBufferType_as_buffer = {
+    (getbufferproc)StreamBuffer_getbuffer,
+    (releasebufferproc)StreamBuffer_releasebuffer,
+};
+
+static PyMethodDef StreamBufferType_methods[] = {
+    _ASYNCIO_STREAMBUFFER_EXTEND_METHODDEF
+    _ASYNCIO_STREAMBUFFER_CLEAR_METHODDEF
+    _ASYNCIO_STREAMBUFFER_FIND_METHODDEF
+    _ASYNCIO_STREAMBUFFER_STARTSWITH_METHODDEF
+    _ASYNCIO_STREAMBUFFER_CONSUME_METHODDEF
+    _ASYNCIO_STREAMBUFFER_READUNTIL_METHODDEF
+    {NULL, NULL}        /* Sentinel */
+};
+
+PyDoc_STRVAR(StreamBuffer_doc,
+"StreamBuffer()\n\
+--\n\
+\n\
+Bytes buffer of asyncio.StreamReader.\n\
+\n\
+Data is appended at the end and removed from the front with consume()\n\
+and readuntil(), which don't move the remaining data.");
+
+static PyTypeObject StreamBufferType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_asyncio.StreamBuffer",                    /* tp_name */
+    sizeof(StreamBufferObj),                    /* tp_basicsize */
+    0,                                          /* tp_itemsize */
+    (destructor)StreamBuffer_dealloc,           /* tp_dealloc */
+    0,                                          /* tp_print */
+    0,                                          /* tp_getattr */
+    0,                                          /* tp_setattr */
+    0,                                          /* tp_reserved */
+    (reprfunc)StreamBuffer_repr,                /* tp_repr */
+    0,                                          /* tp_as_number */
+    &StreamBufferType_as_sequence,              /* tp_as_sequence */
+    0,                                          /* tp_as_mapping */
+    PyObject_HashNotImplemented,                /* tp_hash */
+    0,                                          /* tp_call */
+    0,                                          /* tp_str */
+    0,                                          /* tp_getattro */
+    0,                                          /* tp_setattro */
+    &StreamBufferType_as_buffer,                /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,   /* tp_flags */
+    StreamBuffer_doc,                           /* tp_doc */
+    0,                                          /* tp_traverse */
+    0,                                          /* tp_clear */
+    (richcmpfunc)StreamBuffer_richcompare,      /* tp_richcompare */
+    0,                                          /* tp_weaklistoffset */
+    0,                                          /* tp_iter */
+    0,                                          /* tp_iternext */
+    StreamBufferType_methods,                   /* tp_methods */
+    0,                                          /* tp_members */
+    0,                                          /* tp_getset */
+    0,                                          /* tp_base */
+    0,                                          /* tp_dict */
+    0,                                          /* tp_descr_get */
+    0,                                          /* tp_descr_set */
+    0,                                          /* tp_dictoffset */
+    0,                                          /* tp_init */
+    0,                                          /* tp_alloc */
+    PyType_GenericNew,                          /* tp_new */
+};
+
+
+/* --- Module ------------------------------------------------------------ */
+
+static PyMethodDef asyncio_methods[] = {
+    _ASYNCIO__RUN_READY_METHODDEF
+    {NULL, NULL}        /* Sentinel */
+};
+
+PyDoc_STRVAR(module_doc, "Accelerator module for asyncio");
+
+static struct PyModuleDef _asynciomodule = {
+    PyModuleDef_HEAD_INIT,
+    "_asyncio",
+    module_doc,
+    -1,
+    asyncio_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+/* Create the class attributes of Task: the weak set of all the tasks
+   and the dictionary of the current task of each running loop */
+static int
+task_init_class_attrs(void)
+{
+    PyObject *weakset, *value;
+    int res;
+
+    value = PyDict_New();
+    if (value == NULL)
+        return -1;
+    res = PyDict_SetItemString(TaskType.tp_dict, "_current_tasks", value);
+    Py_DECREF(value);
+    if (res < 0)
+        return -1;
+
+    weakset = get_module_attr("weakref", "WeakSet");
+    if (weakset == NULL)
+        return -1;
+    value = PyObject_CallObject(weakset, NULL);
+    Py_DECREF(weakset);
+    if (value == NULL)
+        return -1;
+    res = PyDict_SetItemString(TaskType.tp_dict, "_all_tasks", value);
+    Py_DECREF(value);
+    if (res < 0)
+        return -1;
+    PyType_Modified(&TaskType);
+    return 0;
+}
+
+PyMODINIT_FUNC
+PyInit__asyncio(void)
+{
+    PyObject *m;
+
+    if (PyType_Ready(&FutureType) < 0)
+        return NULL;
+    if (PyType_Ready(&FutureIterType) < 0)
+        return NULL;
+    if (PyType_Ready(&TaskType) < 0)
+        return NULL;
+    if (PyType_Ready(&StreamBufferType) < 0)
+        return NULL;
+    if (task_init_class_attrs() < 0)
+        return NULL;
+
+    state_pending = PyUnicode_InternFromString("PENDING");
+    if (state_pending == NULL)
+        return NULL;
+    state_cancelled = PyUnicode_InternFromString("CANCELLED");
+    if (state_cancelled == NULL)
+        return NULL;
+    state_finished = PyUnicode_InternFromString("FINISHED");
+    if (state_finished == NULL)
+        return NULL;
+
+    m = PyModule_Create(&_asynciomodule);
+    if (m == NULL)
+        return NULL;
+
+    Py_INCREF(&FutureType);
+    if (PyModule_AddObject(m, "Future", (PyObject *)&FutureType) < 0) {
+        Py_DECREF(&FutureType);
+        return NULL;
+    }
+    Py_INCREF(&TaskType);
+    if (PyModule_AddObject(m, "Task", (PyObject *)&TaskType) < 0) {
+        Py_DECREF(&TaskType);
+        return NULL;
+    }
+    Py_INCREF(&StreamBufferType);
+    if (PyModule_AddObject(m, "StreamBuffer",
+                           (PyObject *)&StreamBufferType) < 0) {
+        Py_DECREF(&StreamBufferType);
+        return NULL;
+    }
+    return m;
+}
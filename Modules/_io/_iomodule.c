@@ -105,6 +105,8 @@ _io.open
     newline: str(accept={str, NoneType}) = NULL
     closefd: int(c_default="1") = True
     opener: object = None
+    mmap as use_mmap: int(c_default="0") = False
+    readahead: int = 0
 
 Open file and return a stream.  Raise IOError upon failure.
 
@@ -211,6 +213,15 @@ calling *opener* with (*file*, *flags*). *opener* must return an open
 file descriptor (passing os.open as *opener* results in functionality
 similar to passing None).
 
+If mmap is true, a file opened for reading is memory-mapped when it is a
+regular file larger than the buffer, and reads are served from the mapping
+instead of read() system calls.  Truncating the file while it is mapped
+crashes the process.
+
+If readahead is positive, a helper thread reads up to readahead buffers
+ahead when a regular file is opened for reading, so that reading the file
+overlaps with processing the data.
+
 open() returns a file object whose type depends on the mode, and
 through which the standard file operations such as reading and writing
 are performed. When open() is used to open a file in a text mode ('w',
@@ -229,8 +240,9 @@ opened in a binary mode.
 static PyObject *
 _io_open_impl(PyModuleDef *module, PyObject *file, const char *mode,
               int buffering, const char *encoding, const char *errors,
-              const char *newline, int closefd, PyObject *opener)
-/*[clinic end generated code: output=7615d0d746eb14d2 input=f4e1ca75223987bc]*/
+              const char *newline, int closefd, PyObject *opener,
+              int use_mmap, int readahead)
+/*[clinic end generated code: output=65e60c5401883951 input=c928c4e60d8506c1]*/
 {
     unsigned i;
 
@@ -348,6 +360,18 @@ _io_open_impl(PyModuleDef *module, PyObject *file, const char *mode,
         return NULL;
     }
 
+    if (use_mmap && (!reading || updating)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "mmap is only supported in read mode");
+        return NULL;
+    }
+
+    if (readahead && (!reading || updating)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "readahead is only supported in read mode");
+        return NULL;
+    }
+
     /* Create the Raw file stream */
     raw = PyObject_CallFunction((PyObject *)&PyFileIO_Type,
                                 "OsiO", file, rawmode, closefd, opener);
@@ -400,6 +424,16 @@ _io_open_impl(PyModuleDef *module, PyObject *file, const char *mode,
                             "can't have unbuffered text I/O");
             goto error;
         }
+        if (use_mmap) {
+            PyErr_SetString(PyExc_ValueError,
+                            "can't use mmap with unbuffered I/O");
+            goto error;
+        }
+        if (readahead) {
+            PyErr_SetString(PyExc_ValueError,
+                            "can't use readahead with unbuffered I/O");
+            goto error;
+        }
 
         Py_DECREF(modeobj);
         return result;
@@ -421,7 +455,13 @@ _io_open_impl(PyModuleDef *module, PyObject *file, const char *mode,
             goto error;
         }
 
-        buffer = PyObject_CallFunction(Buffered_class, "Oi", raw, buffering);
+        if (use_mmap || readahead)
+            buffer = PyObject_CallFunction(Buffered_class, "Oiii",
+                                           raw, buffering, use_mmap,
+                                           readahead);
+        else
+            buffer = PyObject_CallFunction(Buffered_class, "Oi",
+                                           raw, buffering);
     }
     if (buffer == NULL)
         goto error;
@@ -713,6 +753,8 @@ PyInit__io(void)
 
     /* IncrementalNewlineDecoder */
     ADD_TYPE(&PyIncrementalNewlineDecoder_Type, "IncrementalNewlineDecoder");
+    if (PyType_Ready(&_PyTextDecoder_Type) < 0)
+        goto fail;
 
     /* Interned strings */
 #define ADD_INTERNED(name) \
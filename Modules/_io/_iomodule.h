@@ -45,6 +45,13 @@ extern int _PyFileIO_closed(PyObject *self);
 extern PyObject *_PyIncrementalNewlineDecoder_decode(
     PyObject *self, PyObject *input, int final);
 
+/* Decoder used by TextIOWrapper for the most common codecs.
+   _PyTextDecoder_New() returns NULL without setting an exception if name
+   is not one of them. */
+extern PyObject *_PyTextDecoder_New(PyObject *name, PyObject *errors);
+extern PyObject *_PyTextDecoder_Decode(
+    PyObject *self, PyObject *input, int final);
+
 /* Finds the first line ending between `start` and `end`.
    If found, returns the index after the line ending and doesn't touch
    `*consumed`.
@@ -175,3 +182,4 @@ extern PyObject *_PyIO_empty_bytes;
 extern PyObject *_PyIO_zero;
 
 extern PyTypeObject _PyBytesIOBuffer_Type;
+extern PyTypeObject _PyTextDecoder_Type;
@@ -12,6 +12,15 @@
 #include "structmember.h"
 #include "pythread.h"
 #include "_iomodule.h"
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+/* A helper thread can read regular files ahead with pread(), so that it
+   doesn't move the file position */
+#if defined(WITH_THREAD) && defined(HAVE_PREAD)
+#define HAVE_PREFETCH
+#endif
 
 /*[clinic input]
 module _io
@@ -43,6 +52,7 @@ _Py_IDENTIFIER(read1);
 _Py_IDENTIFIER(readable);
 _Py_IDENTIFIER(readinto);
 _Py_IDENTIFIER(readinto1);
+_Py_IDENTIFIER(readlines);
 _Py_IDENTIFIER(writable);
 _Py_IDENTIFIER(write);
 
@@ -222,6 +232,19 @@ typedef struct {
 
     /* A static buffer of size `buffer_size` */
     char *buffer;
+#ifdef HAVE_MMAP
+    /* In mmap mode, `buffer` is a read-only mapping of the whole file,
+       of size `map_size`, and the static buffer is kept in `heap_buffer`
+       until the mapping is released. */
+    char *heap_buffer;
+    Py_ssize_t map_size;
+#endif
+#ifdef HAVE_PREFETCH
+    /* Number of buffers read ahead by a helper thread (0 if disabled), and
+       the state shared with the thread, created by the first read. */
+    int prefetch_buffers;
+    struct prefetcher *prefetcher;
+#endif
     /* Current logical position in the buffer. */
     Py_off_t pos;
     /* Position of the raw stream in the buffer. */
@@ -387,12 +410,38 @@ _enter_buffered_busy(buffered *self)
 #define RAW_TELL(self) \
     (self->abs_pos != -1 ? self->abs_pos : _buffered_raw_tell(self))
 
+#ifdef HAVE_MMAP
+#define MAPPED(self) (self->heap_buffer != NULL)
+#else
+#define MAPPED(self) 0
+#endif
+
 #define MINUS_LAST_BLOCK(self, size) \
     (self->buffer_mask ? \
         (size & ~self->buffer_mask) : \
         (self->buffer_size * (size / self->buffer_size)))
 
 
+static void
+_bufferedreader_unmap(buffered *self);
+static int
+_bufferedreader_map_reposition(buffered *self, Py_off_t pos);
+#ifdef HAVE_PREFETCH
+static int
+_bufferedreader_prefetch_stop(buffered *self);
+static void
+_bufferedreader_prefetch_free(buffered *self);
+static Py_off_t
+_bufferedreader_prefetch_tell(buffered *self);
+static Py_off_t
+_bufferedreader_prefetch_seek(buffered *self, Py_off_t target, int whence);
+#else
+#define _bufferedreader_prefetch_stop(self) 0
+#define _bufferedreader_prefetch_free(self)
+#define _bufferedreader_prefetch_tell(self) -1
+#define _bufferedreader_prefetch_seek(self, target, whence) -1
+#endif
+
 static void
 buffered_dealloc(buffered *self)
 {
@@ -403,7 +452,9 @@ buffered_dealloc(buffered *self)
     self->ok = 0;
     if (self->weakreflist != NULL)
         PyObject_ClearWeakRefs((PyObject *)self);
+    _bufferedreader_prefetch_free(self);
     Py_CLEAR(self->raw);
+    _bufferedreader_unmap(self);
     if (self->buffer) {
         PyMem_Free(self->buffer);
         self->buffer = NULL;
@@ -426,6 +477,10 @@ buffered_sizeof(buffered *self, void *unused)
     res = _PyObject_SIZE(Py_TYPE(self));
     if (self->buffer)
         res += self->buffer_size;
+#ifdef HAVE_PREFETCH
+    if (self->prefetcher)
+        res += self->prefetch_buffers * self->buffer_size;
+#endif
     return PyLong_FromSsize_t(res);
 }
 
@@ -441,6 +496,7 @@ static int
 buffered_clear(buffered *self)
 {
     self->ok = 0;
+    _bufferedreader_prefetch_free(self);
     Py_CLEAR(self->raw);
     Py_CLEAR(self->dict);
     return 0;
@@ -535,8 +591,18 @@ buffered_close(buffered *self, PyObject *args)
     else
         Py_DECREF(res);
 
+    /* The helper thread must not read the file once it is closed */
+    if (_bufferedreader_prefetch_stop(self) < 0) {
+        if (exc == NULL)
+            PyErr_Fetch(&exc, &val, &tb);
+        else
+            PyErr_Clear();
+    }
+    _bufferedreader_prefetch_free(self);
+
     res = PyObject_CallMethodObjArgs(self->raw, _PyIO_str_close, NULL);
 
+    _bufferedreader_unmap(self);
     if (self->buffer) {
         PyMem_Free(self->buffer);
         self->buffer = NULL;
@@ -558,11 +624,20 @@ static PyObject *
 buffered_detach(buffered *self, PyObject *args)
 {
     PyObject *raw, *res;
+    int r;
     CHECK_INITIALIZED(self)
     res = PyObject_CallMethodObjArgs((PyObject *)self, _PyIO_str_flush, NULL);
     if (res == NULL)
         return NULL;
     Py_DECREF(res);
+    if (!ENTER_BUFFERED(self))
+        return NULL;
+    r = _bufferedreader_prefetch_stop(self);
+    if (r == 0)
+        _bufferedreader_prefetch_free(self);
+    LEAVE_BUFFERED(self)
+    if (r < 0)
+        return NULL;
     raw = self->raw;
     self->raw = NULL;
     self->detached = 1;
@@ -694,6 +769,13 @@ _buffered_raw_tell(buffered *self)
 {
     Py_off_t n;
     PyObject *res;
+    n = _bufferedreader_prefetch_tell(self);
+    if (n >= 0) {
+        self->abs_pos = n;
+        return n;
+    }
+    if (_bufferedreader_prefetch_stop(self) < 0)
+        return -1;
     res = PyObject_CallMethodObjArgs(self->raw, _PyIO_str_tell, NULL);
     if (res == NULL)
         return -1;
@@ -716,6 +798,13 @@ _buffered_raw_seek(buffered *self, Py_off_t target, int whence)
     PyObject *res, *posobj, *whenceobj;
     Py_off_t n;
 
+    n = _bufferedreader_prefetch_seek(self, target, whence);
+    if (n >= 0) {
+        self->abs_pos = n;
+        return n;
+    }
+    if (_bufferedreader_prefetch_stop(self) < 0)
+        return -1;
     posobj = PyLong_FromOff_t(target);
     if (posobj == NULL)
         return -1;
@@ -752,6 +841,8 @@ _buffered_init(buffered *self)
             "buffer size must be strictly positive");
         return -1;
     }
+    _bufferedreader_prefetch_free(self);
+    _bufferedreader_unmap(self);
     if (self->buffer)
         PyMem_Free(self->buffer);
     self->buffer = PyMem_Malloc(self->buffer_size);
@@ -829,7 +920,8 @@ buffered_flush_and_rewind_unlocked(buffered *self)
         return NULL;
     Py_DECREF(res);
 
-    if (self->readable) {
+    /* A mapped reader keeps the logical position inside the mapping */
+    if (self->readable && !MAPPED(self)) {
         /* Rewind the raw stream so that its position corresponds to
            the current logical position. */
         Py_off_t n;
@@ -1101,7 +1193,7 @@ _buffered_readline(buffered *self, Py_ssize_t limit)
     PyObject *res = NULL;
     PyObject *chunks = NULL;
     Py_ssize_t n, written = 0;
-    const char *start, *s, *end;
+    const char *start, *s;
 
     CHECK_CLOSED(self, "readline of closed file")
 
@@ -1164,16 +1256,14 @@ _buffered_readline(buffered *self, Py_ssize_t limit)
         if (limit >= 0 && n > limit)
             n = limit;
         start = self->buffer;
-        end = start + n;
-        s = start;
-        while (s < end) {
-            if (*s++ == '\n') {
-                res = PyBytes_FromStringAndSize(start, s - start);
-                if (res == NULL)
-                    goto end;
-                self->pos = s - start;
-                goto found;
-            }
+        s = memchr(start, '\n', n);
+        if (s != NULL) {
+            s++;
+            res = PyBytes_FromStringAndSize(start, s - start);
+            if (res == NULL)
+                goto end;
+            self->pos = s - start;
+            goto found;
         }
         res = PyBytes_FromStringAndSize(start, n);
         if (res == NULL)
@@ -1219,6 +1309,112 @@ _io__Buffered_readline_impl(buffered *self, Py_ssize_t size)
     return _buffered_readline(self, size);
 }
 
+/* Append the complete lines of the buffer to the list, until their total
+   size exceeds hint (if hint > 0).  Return 1 if it does, 0 if the buffer
+   has no complete line left, -1 on error. */
+static int
+_bufferedreader_split_lines(buffered *self, PyObject *list, Py_ssize_t hint,
+                            Py_ssize_t *length)
+{
+    Py_ssize_t n = Py_SAFE_DOWNCAST(READAHEAD(self), Py_off_t, Py_ssize_t);
+    const char *start = self->buffer + self->pos;
+    const char *s;
+
+    while (n > 0 && (s = memchr(start, '\n', n)) != NULL) {
+        Py_ssize_t len = s - start + 1;
+        PyObject *line = PyBytes_FromStringAndSize(start, len);
+        if (line == NULL)
+            return -1;
+        if (PyList_Append(list, line) < 0) {
+            Py_DECREF(line);
+            return -1;
+        }
+        Py_DECREF(line);
+        self->pos += len;
+        start += len;
+        n -= len;
+        *length += len;
+        if (hint > 0 && *length > hint)
+            return 1;
+    }
+    return 0;
+}
+
+/*[clinic input]
+_io._Buffered.readlines
+    hint: io_ssize_t = -1
+    /
+
+Return a list of lines from the stream.
+
+hint can be specified to control the number of lines read: no more
+lines will be read if the total size (in bytes) of all lines so far
+exceeds hint.
+[clinic start generated code]*/
+
+static PyObject *
+_io__Buffered_readlines_impl(buffered *self, Py_ssize_t hint)
+/*[clinic end generated code: output=7d233d201760aab3 input=dd0d4897d9da0ef6]*/
+{
+    PyObject *result, *line;
+    Py_ssize_t length = 0;
+    int r;
+
+    CHECK_INITIALIZED(self)
+    if (Py_TYPE(self) != &PyBufferedReader_Type &&
+        Py_TYPE(self) != &PyBufferedRandom_Type) {
+        /* readline() may be overridden */
+        return _PyObject_CallMethodId((PyObject *)&PyIOBase_Type,
+                                      &PyId_readlines, "On", self, hint);
+    }
+    CHECK_CLOSED(self, "readline of closed file")
+
+    result = PyList_New(0);
+    if (result == NULL)
+        return NULL;
+
+    for (;;) {
+        /* Split the complete lines of the buffer in one go... */
+        if (!ENTER_BUFFERED(self))
+            goto error;
+        if (IS_CLOSED(self)) {
+            LEAVE_BUFFERED(self)
+            PyErr_SetString(PyExc_ValueError, "readline of closed file");
+            goto error;
+        }
+        r = _bufferedreader_split_lines(self, result, hint, &length);
+        LEAVE_BUFFERED(self)
+        if (r < 0)
+            goto error;
+        if (r > 0)
+            break;
+
+        /* ...and let readline() join the line which spans several buffer
+           fills and read more */
+        line = _buffered_readline(self, -1);
+        if (line == NULL)
+            goto error;
+        if (PyBytes_GET_SIZE(line) == 0) {
+            /* Reached EOF or would have blocked */
+            Py_DECREF(line);
+            break;
+        }
+        if (PyList_Append(result, line) < 0) {
+            Py_DECREF(line);
+            goto error;
+        }
+        length += PyBytes_GET_SIZE(line);
+        Py_DECREF(line);
+        if (hint > 0 && length > hint)
+            break;
+    }
+    return result;
+
+  error:
+    Py_DECREF(result);
+    return NULL;
+}
+
 
 static PyObject *
 buffered_tell(buffered *self, PyObject *args)
@@ -1226,10 +1422,15 @@ buffered_tell(buffered *self, PyObject *args)
     Py_off_t pos;
 
     CHECK_INITIALIZED(self)
+    if (!ENTER_BUFFERED(self))
+        return NULL;
     pos = _buffered_raw_tell(self);
-    if (pos == -1)
+    if (pos == -1) {
+        LEAVE_BUFFERED(self)
         return NULL;
+    }
     pos -= RAW_OFFSET(self);
+    LEAVE_BUFFERED(self)
     /* TODO: sanity check (pos >= 0) */
     return PyLong_FromOff_t(pos);
 }
@@ -1289,7 +1490,8 @@ _io__Buffered_seek_impl(buffered *self, PyObject *targetobj, int whence)
            state at this point. */
         current = RAW_TELL(self);
         avail = READAHEAD(self);
-        if (avail > 0) {
+        /* In mmap mode, the buffer contains the whole file */
+        if (avail > 0 || MAPPED(self)) {
             Py_off_t offset;
             if (whence == 0)
                 offset = target - (current - RAW_OFFSET(self));
@@ -1321,6 +1523,15 @@ _io__Buffered_seek_impl(buffered *self, PyObject *targetobj, int whence)
     if (n == -1)
         goto end;
     self->raw_pos = -1;
+    if (MAPPED(self)) {
+        int r = _bufferedreader_map_reposition(self, n);
+        if (r < 0)
+            goto end;
+        if (r > 0) {
+            res = PyLong_FromOff_t(n);
+            goto end;
+        }
+    }
     res = PyLong_FromOff_t(n);
     if (res != NULL && self->readable)
         _bufferedreader_reset_buf(self);
@@ -1352,6 +1563,8 @@ _io__Buffered_truncate_impl(buffered *self, PyObject *pos)
             goto end;
         Py_CLEAR(res);
     }
+    if (_bufferedreader_prefetch_stop(self) < 0)
+        goto end;
     res = PyObject_CallMethodObjArgs(self->raw, _PyIO_str_truncate, pos, NULL);
     if (res == NULL)
         goto end;
@@ -1429,25 +1642,539 @@ buffered_repr(buffered *self)
 
 static void _bufferedreader_reset_buf(buffered *self)
 {
+    /* The buffer is about to be refilled: stop using the mapping, its
+       content has been consumed */
+    _bufferedreader_unmap(self);
     self->read_end = -1;
 }
 
+/* Release the mapping of the file and restore the static buffer. */
+static void
+_bufferedreader_unmap(buffered *self)
+{
+#ifdef HAVE_MMAP
+    if (self->heap_buffer != NULL) {
+        (void)munmap(self->buffer, self->map_size);
+        self->buffer = self->heap_buffer;
+        self->heap_buffer = NULL;
+    }
+#endif
+}
+
+/* Map the whole file of the raw stream and use the mapping as the read
+   buffer, so that reads are served from the page cache without system
+   calls nor copies through the static buffer.  The raw stream is moved to
+   the end of the mapping, as if the whole file had been read.  The file is
+   not mapped if it is not a regular file larger than the buffer or if
+   mmap() fails.  Return -1 with an exception set on error. */
+static int
+_bufferedreader_map(buffered *self)
+{
+#ifdef HAVE_MMAP
+    struct _Py_stat_struct st;
+    Py_off_t pos;
+    char *map;
+    int fd;
+
+    if (Py_TYPE(self->raw) != &PyFileIO_Type)
+        return 0;
+    fd = PyObject_AsFileDescriptor(self->raw);
+    if (fd < 0)
+        return -1;
+    if (_Py_fstat_noraise(fd, &st) < 0 || !S_ISREG(st.st_mode))
+        return 0;
+    if (st.st_size <= self->buffer_size || st.st_size > PY_SSIZE_T_MAX)
+        return 0;
+    pos = _buffered_raw_tell(self);
+    if (pos == -1)
+        return -1;
+    if (pos >= st.st_size)
+        return 0;
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        return 0;
+#ifdef MADV_SEQUENTIAL
+    (void)madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+    if (_buffered_raw_seek(self, st.st_size, 0) == -1) {
+        (void)munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    self->heap_buffer = self->buffer;
+    self->buffer = map;
+    self->map_size = (Py_ssize_t)st.st_size;
+    self->pos = pos;
+    self->raw_pos = st.st_size;
+    self->read_end = st.st_size;
+#endif
+    return 0;
+}
+
+/* The raw stream of a mapped reader was moved to pos: keep using the
+   mapping if pos lies inside it, moving the raw stream back to the end of
+   the mapping.  Otherwise release the mapping.  Return 1 if the mapping is
+   kept, 0 if it was released, -1 with an exception set on error. */
+static int
+_bufferedreader_map_reposition(buffered *self, Py_off_t pos)
+{
+#ifdef HAVE_MMAP
+    if (pos >= 0 && pos <= self->map_size) {
+        if (pos != self->map_size &&
+            _buffered_raw_seek(self, self->map_size, 0) == -1) {
+            _bufferedreader_reset_buf(self);
+            return -1;
+        }
+        self->pos = (Py_ssize_t)pos;
+        self->raw_pos = self->map_size;
+        self->read_end = self->map_size;
+        return 1;
+    }
+#endif
+    _bufferedreader_reset_buf(self);
+    return 0;
+}
+
+/*
+ * Read-ahead
+ *
+ * A helper thread reads the file ahead into a ring of buffers with pread(),
+ * without the GIL, while the reader copies the filled buffers out in order
+ * in _bufferedreader_raw_read().  The file position is left untouched
+ * while the thread runs: it is moved to the next byte to consume whenever
+ * the raw stream is used directly, after pausing the thread.  The thread
+ * lives until the reader is closed.
+ *
+ * Both sides sleep on their own lock, which the other side releases when it
+ * changes the state the sleeper waits for.  The fields from `mutex` to
+ * `count` are protected by `mutex`.  The filled buffers belong to the reader
+ * and the others to the thread, so they are copied without the mutex.  The
+ * reader side is only used with the buffered lock held (or from dealloc),
+ * so there is a single reader sleeping at a time; tell() doesn't pause the
+ * thread, it returns the position of the next byte to consume.
+ */
+
+#ifdef HAVE_PREFETCH
+typedef struct prefetcher {
+    int fd;
+    int nbufs;
+    Py_ssize_t bufsize;
+    char **bufs;
+    Py_ssize_t *lens;       /* result of pread() in each buffer */
+    int *errnos;            /* errno of a failed pread() */
+    pid_t pid;              /* process running the thread */
+
+    PyThread_type_lock mutex;
+    PyThread_type_lock wake_reader;
+    PyThread_type_lock wake_thread;
+    int reader_sleeping;
+    int thread_sleeping;
+    int running;            /* the thread is alive */
+    int quit;               /* asks the thread to exit */
+    int active;             /* the thread reads ahead, it is paused if 0 */
+    int busy;               /* the thread is in pread() */
+    int eof;                /* the last pread() reached EOF or failed */
+    Py_off_t offset;        /* file offset of the next pread() */
+    int head;               /* next buffer to fill */
+    int count;              /* number of filled buffers */
+
+    int tail;               /* next buffer to consume */
+    Py_ssize_t tail_pos;    /* bytes of the tail buffer already consumed */
+    Py_off_t pos;           /* file offset of the next byte to consume */
+} prefetcher;
+
+/* Wake up the reader or the thread if it sleeps; called with the mutex
+   held. */
+#define PREFETCH_WAKE(pf, who) \
+    do { \
+        if ((pf)->who##_sleeping) { \
+            (pf)->who##_sleeping = 0; \
+            PyThread_release_lock((pf)->wake_##who); \
+        } \
+    } while (0)
+
+static void
+prefetcher_thread(void *arg)
+{
+    prefetcher *pf = (prefetcher *)arg;
+    int head;
+    Py_off_t offset;
+    Py_ssize_t n;
+    int err;
+
+    PyThread_acquire_lock(pf->mutex, 1);
+    while (!pf->quit) {
+        if (!pf->active || pf->eof || pf->count == pf->nbufs) {
+            pf->thread_sleeping = 1;
+            PyThread_release_lock(pf->mutex);
+            PyThread_acquire_lock(pf->wake_thread, 1);
+            PyThread_acquire_lock(pf->mutex, 1);
+            continue;
+        }
+        head = pf->head;
+        offset = pf->offset;
+        pf->busy = 1;
+        PyThread_release_lock(pf->mutex);
+
+        do {
+            n = pread(pf->fd, pf->bufs[head], pf->bufsize, offset);
+        } while (n < 0 && errno == EINTR);
+        err = errno;
+
+        PyThread_acquire_lock(pf->mutex, 1);
+        pf->busy = 0;
+        /* Drop the data if the reader paused the thread meanwhile */
+        if (pf->active) {
+            pf->lens[head] = n;
+            pf->errnos[head] = err;
+            pf->head = (head + 1) % pf->nbufs;
+            pf->count++;
+            if (n > 0)
+                pf->offset += n;
+            else
+                pf->eof = 1;
+        }
+        PREFETCH_WAKE(pf, reader);
+    }
+    pf->running = 0;
+    PREFETCH_WAKE(pf, reader);
+    PyThread_release_lock(pf->mutex);
+}
+
+/* Sleep until the thread wakes the reader up; called with the GIL and the
+   mutex held, returns with both. */
+static void
+prefetcher_wait(prefetcher *pf)
+{
+    pf->reader_sleeping = 1;
+    PyThread_release_lock(pf->mutex);
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(pf->wake_reader, 1);
+    PyThread_acquire_lock(pf->mutex, 1);
+    Py_END_ALLOW_THREADS
+}
+
+static void
+prefetcher_dealloc(prefetcher *pf)
+{
+    int i;
+    if (pf->bufs != NULL) {
+        for (i = 0; i < pf->nbufs; i++)
+            PyMem_RawFree(pf->bufs[i]);
+        PyMem_RawFree(pf->bufs);
+    }
+    PyMem_RawFree(pf->lens);
+    PyMem_RawFree(pf->errnos);
+    if (pf->mutex)
+        PyThread_free_lock(pf->mutex);
+    if (pf->wake_reader)
+        PyThread_free_lock(pf->wake_reader);
+    if (pf->wake_thread)
+        PyThread_free_lock(pf->wake_thread);
+    PyMem_RawFree(pf);
+}
+
+/* Create the ring and start the thread.  Return NULL, without an exception
+   set, if the resources are not available: the file is then read
+   normally. */
+static prefetcher *
+prefetcher_new(int fd, int nbufs, Py_ssize_t bufsize)
+{
+    prefetcher *pf;
+    int i;
+
+    pf = PyMem_RawCalloc(1, sizeof(prefetcher));
+    if (pf == NULL)
+        return NULL;
+    pf->fd = fd;
+    pf->nbufs = nbufs;
+    pf->bufsize = bufsize;
+    pf->pid = getpid();
+    pf->bufs = PyMem_RawCalloc(nbufs, sizeof(char *));
+    pf->lens = PyMem_RawCalloc(nbufs, sizeof(Py_ssize_t));
+    pf->errnos = PyMem_RawCalloc(nbufs, sizeof(int));
+    if (pf->bufs == NULL || pf->lens == NULL || pf->errnos == NULL)
+        goto error;
+    for (i = 0; i < nbufs; i++) {
+        pf->bufs[i] = PyMem_RawMalloc(bufsize);
+        if (pf->bufs[i] == NULL)
+            goto error;
+    }
+    pf->mutex = PyThread_allocate_lock();
+    pf->wake_reader = PyThread_allocate_lock();
+    pf->wake_thread = PyThread_allocate_lock();
+    if (!pf->mutex || !pf->wake_reader || !pf->wake_thread)
+        goto error;
+    /* The sleepers block on these locks until they are released */
+    PyThread_acquire_lock(pf->wake_reader, 1);
+    PyThread_acquire_lock(pf->wake_thread, 1);
+
+    pf->running = 1;
+    if (PyThread_start_new_thread(prefetcher_thread, pf) == -1)
+        goto error;
+    return pf;
+
+error:
+    prefetcher_dealloc(pf);
+    return NULL;
+}
+
+/* Stop the thread and release the ring. */
+static void
+_bufferedreader_prefetch_free(buffered *self)
+{
+    prefetcher *pf = self->prefetcher;
+    if (pf == NULL)
+        return;
+    self->prefetcher = NULL;
+    /* In a child process, the thread doesn't exist */
+    if (pf->pid == getpid()) {
+        PyThread_acquire_lock(pf->mutex, 1);
+        pf->quit = 1;
+        PREFETCH_WAKE(pf, thread);
+        while (pf->running)
+            prefetcher_wait(pf);
+        PyThread_release_lock(pf->mutex);
+    }
+    prefetcher_dealloc(pf);
+}
+
+/* Pause the thread and drop the buffers read ahead, then move the file to
+   the next byte to consume, so that the raw stream can be used directly.
+   Return -1 with an exception set on error. */
+static int
+_bufferedreader_prefetch_stop(buffered *self)
+{
+    prefetcher *pf = self->prefetcher;
+    if (pf == NULL || !pf->active)
+        return 0;
+    if (pf->pid == getpid()) {
+        PyThread_acquire_lock(pf->mutex, 1);
+        pf->active = 0;
+        while (pf->busy)
+            prefetcher_wait(pf);
+        PyThread_release_lock(pf->mutex);
+    }
+    else {
+        /* Forked: the thread doesn't exist in this process and its locks
+           may be held, forget them */
+        self->prefetcher = NULL;
+    }
+    pf->active = 0;
+    pf->eof = 0;
+    pf->head = pf->tail = pf->count = 0;
+    pf->tail_pos = 0;
+    if (lseek(pf->fd, pf->pos, SEEK_SET) < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    return 0;
+}
+
+/* Return the file offset of the next byte to consume if the thread reads
+   ahead, without pausing it, or -1. */
+static Py_off_t
+_bufferedreader_prefetch_tell(buffered *self)
+{
+    prefetcher *pf = self->prefetcher;
+    if (pf == NULL || !pf->active || pf->pid != getpid())
+        return -1;
+    return pf->pos;
+}
+
+/* Move the next byte to consume without pausing the thread if the target
+   lies in the buffers read ahead: the buffers skipped are given back to the
+   thread.  Return the new file offset, or -1 if the target is out of range
+   and the thread must be paused. */
+static Py_off_t
+_bufferedreader_prefetch_seek(buffered *self, Py_off_t target, int whence)
+{
+    prefetcher *pf = self->prefetcher;
+    Py_off_t skip, avail = 0;
+    Py_ssize_t slot, step;
+    int filled, done = 0, i, k;
+
+    if (pf == NULL || !pf->active || pf->pid != getpid())
+        return -1;
+    if (whence == 0)
+        skip = target - pf->pos;
+    else if (whence == 1)
+        skip = target;
+    else
+        return -1;
+    if (skip < 0) {
+        /* The consumed part of the tail buffer is still there */
+        if (-skip > pf->tail_pos)
+            return -1;
+        pf->tail_pos += (Py_ssize_t)skip;
+        pf->pos += skip;
+        return pf->pos;
+    }
+
+    PyThread_acquire_lock(pf->mutex, 1);
+    filled = pf->count;
+    PyThread_release_lock(pf->mutex);
+    for (k = 0, i = pf->tail; k < filled && avail < skip; k++) {
+        if (pf->lens[i] <= 0)
+            break;
+        avail += pf->lens[i] - (k == 0 ? pf->tail_pos : 0);
+        i = (i + 1) % pf->nbufs;
+    }
+    if (skip > avail)
+        return -1;
+
+    while (skip > 0) {
+        slot = pf->lens[pf->tail];
+        step = (Py_ssize_t)Py_MIN(slot - pf->tail_pos, skip);
+        pf->tail_pos += step;
+        pf->pos += step;
+        skip -= step;
+        if (pf->tail_pos == slot) {
+            pf->tail = (pf->tail + 1) % pf->nbufs;
+            pf->tail_pos = 0;
+            done++;
+        }
+    }
+    if (done) {
+        PyThread_acquire_lock(pf->mutex, 1);
+        pf->count -= done;
+        PREFETCH_WAKE(pf, thread);
+        PyThread_release_lock(pf->mutex);
+    }
+    return pf->pos;
+}
+
+/* (Re)start reading ahead from the current file position.  Return -1 with
+   an exception set on error, 0 if the file must be read normally. */
+static int
+_bufferedreader_prefetch_start(buffered *self)
+{
+    prefetcher *pf = self->prefetcher;
+    Py_off_t pos;
+
+    if (pf != NULL && pf->pid != getpid()) {
+        /* Forked: start a new thread from the next byte to consume */
+        if (_bufferedreader_prefetch_stop(self) < 0)
+            return -1;
+        self->prefetcher = NULL;
+        pf = NULL;
+    }
+    if (pf == NULL) {
+        int fd = PyObject_AsFileDescriptor(self->raw);
+        if (fd < 0)
+            return -1;
+        pf = prefetcher_new(fd, self->prefetch_buffers, self->buffer_size);
+        if (pf == NULL) {
+            self->prefetch_buffers = 0;
+            return 0;
+        }
+        self->prefetcher = pf;
+    }
+    pos = lseek(pf->fd, 0, SEEK_CUR);
+    if (pos < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    PyThread_acquire_lock(pf->mutex, 1);
+    pf->pos = pf->offset = pos;
+    pf->active = 1;
+    PREFETCH_WAKE(pf, thread);
+    PyThread_release_lock(pf->mutex);
+    return 1;
+}
+
+/* Copy up to len bytes read ahead to start, waiting for the thread if no
+   buffer is filled yet.  Return the number of bytes copied (0 at EOF), or
+   -1 with an exception set on error. */
+static Py_ssize_t
+_bufferedreader_prefetch_read(buffered *self, char *start, Py_ssize_t len)
+{
+    prefetcher *pf = self->prefetcher;
+    Py_ssize_t n = 0, avail, slot;
+    int filled, done = 0;
+
+    PyThread_acquire_lock(pf->mutex, 1);
+    while (pf->count == 0)
+        prefetcher_wait(pf);
+    filled = pf->count;
+    PyThread_release_lock(pf->mutex);
+
+    while (done < filled && n < len) {
+        slot = pf->lens[pf->tail];
+        if (slot <= 0) {
+            /* EOF or error: report them after the data, then read the
+               file again if asked to, in case it grows */
+            int err = pf->errnos[pf->tail];
+            if (n > 0)
+                break;
+            if (_bufferedreader_prefetch_stop(self) < 0)
+                return -1;
+            if (slot < 0) {
+                errno = err;
+                PyErr_SetFromErrno(PyExc_OSError);
+                return -1;
+            }
+            return 0;
+        }
+        avail = Py_MIN(slot - pf->tail_pos, len - n);
+        memcpy(start + n, pf->bufs[pf->tail] + pf->tail_pos, avail);
+        n += avail;
+        pf->pos += avail;
+        pf->tail_pos += avail;
+        if (pf->tail_pos == slot) {
+            pf->tail = (pf->tail + 1) % pf->nbufs;
+            pf->tail_pos = 0;
+            done++;
+        }
+    }
+    if (done) {
+        PyThread_acquire_lock(pf->mutex, 1);
+        pf->count -= done;
+        PREFETCH_WAKE(pf, thread);
+        PyThread_release_lock(pf->mutex);
+    }
+    return n;
+}
+#endif /* HAVE_PREFETCH */
+
 /*[clinic input]
 _io.BufferedReader.__init__
     raw: object
     buffer_size: Py_ssize_t(c_default="DEFAULT_BUFFER_SIZE") = DEFAULT_BUFFER_SIZE
+    mmap as use_mmap: int(c_default="0") = False
+    readahead: int = 0
 
 Create a new buffered reader using the given readable raw IO object.
+
+If mmap is true and raw is a FileIO object of a regular file larger than
+buffer_size, the file is memory-mapped and reads are served from the
+mapping.  Truncating the file while it is mapped crashes the process.
+
+If readahead is positive and raw is a FileIO object of a regular file, a
+helper thread reads up to readahead buffers of buffer_size bytes ahead,
+so that reading the file overlaps with processing the data.
 [clinic start generated code]*/
 
 static int
 _io_BufferedReader___init___impl(buffered *self, PyObject *raw,
-                                 Py_ssize_t buffer_size)
-/*[clinic end generated code: output=cddcfefa0ed294c4 input=fb887e06f11b4e48]*/
+                                 Py_ssize_t buffer_size, int use_mmap,
+                                 int readahead)
+/*[clinic end generated code: output=97d84fc747595d80 input=55210341d8c193af]*/
 {
     self->ok = 0;
     self->detached = 0;
 
+    if (readahead < 0) {
+        PyErr_SetString(PyExc_ValueError, "readahead must be non-negative");
+        return -1;
+    }
+    if (use_mmap && readahead) {
+        PyErr_SetString(PyExc_ValueError,
+                        "can't use mmap and readahead together");
+        return -1;
+    }
+
     if (_PyIOBase_check_readable(raw, Py_True) == NULL)
         return -1;
 
@@ -1460,6 +2187,20 @@ _io_BufferedReader___init___impl(buffered *self, PyObject *raw,
     if (_buffered_init(self) < 0)
         return -1;
     _bufferedreader_reset_buf(self);
+    if (use_mmap && _bufferedreader_map(self) < 0)
+        return -1;
+#ifdef HAVE_PREFETCH
+    self->prefetch_buffers = 0;
+    if (readahead && Py_TYPE(raw) == &PyFileIO_Type) {
+        struct _Py_stat_struct st;
+        int fd = PyObject_AsFileDescriptor(raw);
+        if (fd < 0)
+            return -1;
+        /* pread() needs a regular file */
+        if (_Py_fstat_noraise(fd, &st) == 0 && S_ISREG(st.st_mode))
+            self->prefetch_buffers = readahead;
+    }
+#endif
 
     self->fast_closed_checks = (Py_TYPE(self) == &PyBufferedReader_Type &&
                                 Py_TYPE(raw) == &PyFileIO_Type);
@@ -1474,6 +2215,22 @@ _bufferedreader_raw_read(buffered *self, char *start, Py_ssize_t len)
     Py_buffer buf;
     PyObject *memobj, *res;
     Py_ssize_t n;
+#ifdef HAVE_PREFETCH
+    if (self->prefetch_buffers > 0) {
+        prefetcher *pf = self->prefetcher;
+        int r = 1;
+        if (pf == NULL || !pf->active || pf->pid != getpid())
+            r = _bufferedreader_prefetch_start(self);
+        if (r < 0)
+            return -1;
+        if (r > 0) {
+            n = _bufferedreader_prefetch_read(self, start, len);
+            if (n > 0 && self->abs_pos != -1)
+                self->abs_pos += n;
+            return n;
+        }
+    }
+#endif
     /* NOTE: the buffer needn't be released as its object is NULL. */
     if (PyBuffer_FillInfo(&buf, NULL, start, len, 0, PyBUF_CONTIG) == -1)
         return -1;
@@ -1532,6 +2289,9 @@ _bufferedreader_read_all(buffered *self)
     Py_ssize_t current_size;
     PyObject *res = NULL, *data = NULL, *tmp = NULL, *chunks = NULL;
 
+    if (_bufferedreader_prefetch_stop(self) < 0)
+        return NULL;
+
     /* First copy what we have in the current buffer. */
     current_size = Py_SAFE_DOWNCAST(READAHEAD(self), Py_off_t, Py_ssize_t);
     if (current_size) {
@@ -1548,7 +2308,9 @@ _bufferedreader_read_all(buffered *self)
             goto cleanup;
         Py_CLEAR(tmp);
     }
-    _bufferedreader_reset_buf(self);
+    /* Keep the mapping unless the file has grown past its end */
+    if (!MAPPED(self))
+        _bufferedreader_reset_buf(self);
 
     if (PyObject_HasAttr(self->raw, _PyIO_str_readall)) {
         tmp = PyObject_CallMethodObjArgs(self->raw, _PyIO_str_readall, NULL);
@@ -1558,6 +2320,8 @@ _bufferedreader_read_all(buffered *self)
             PyErr_SetString(PyExc_TypeError, "readall() should return bytes");
             goto cleanup;
         }
+        if (MAPPED(self) && (tmp == Py_None || PyBytes_GET_SIZE(tmp) > 0))
+            _bufferedreader_reset_buf(self);
         if (tmp == Py_None) {
             if (current_size == 0) {
                 res = Py_None;
@@ -1578,6 +2342,7 @@ _bufferedreader_read_all(buffered *self)
         }
     }
 
+    _bufferedreader_reset_buf(self);
     chunks = PyList_New(0);
     if (chunks == NULL)
         goto cleanup;
@@ -1754,6 +2519,9 @@ _bufferedreader_peek_unlocked(buffered *self)
        Therefore, we either return `have` bytes (if > 0), or a full buffer.
     */
     if (have > 0) {
+        /* Don't copy the whole file in mmap mode */
+        if (MAPPED(self) && have > self->buffer_size)
+            have = self->buffer_size;
         return PyBytes_FromStringAndSize(self->buffer + self->pos, have);
     }
 
@@ -2409,6 +3177,7 @@ static PyMethodDef bufferedreader_methods[] = {
     _IO__BUFFERED_READINTO_METHODDEF
     _IO__BUFFERED_READINTO1_METHODDEF
     _IO__BUFFERED_READLINE_METHODDEF
+    _IO__BUFFERED_READLINES_METHODDEF
     _IO__BUFFERED_SEEK_METHODDEF
     {"tell", (PyCFunction)buffered_tell, METH_NOARGS},
     _IO__BUFFERED_TRUNCATE_METHODDEF
@@ -2671,6 +3440,7 @@ static PyMethodDef bufferedrandom_methods[] = {
     _IO__BUFFERED_READINTO_METHODDEF
     _IO__BUFFERED_READINTO1_METHODDEF
     _IO__BUFFERED_READLINE_METHODDEF
+    _IO__BUFFERED_READLINES_METHODDEF
     _IO__BUFFERED_PEEK_METHODDEF
     _IO_BUFFEREDWRITER_WRITE_METHODDEF
     {"__sizeof__", (PyCFunction)buffered_sizeof, METH_NOARGS},
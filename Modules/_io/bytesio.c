@@ -16,6 +16,16 @@ typedef struct {
     PyObject *dict;
     PyObject *weakreflist;
     Py_ssize_t exports;
+    /* In chunked mode, the data appended at the end of the stream is stored
+       in a list of bytes objects followed by a partially filled tail, and
+       only copied to buf when needed.  chunks_size counts the bytes stored
+       in the chunks and the tail: buf holds the first
+       string_size - chunks_size bytes. */
+    int chunked;
+    PyObject *chunks;
+    PyObject *tail;
+    Py_ssize_t tail_size;
+    Py_ssize_t chunks_size;
 } bytesio;
 
 typedef struct {
@@ -46,6 +56,17 @@ typedef struct {
 
 #define SHARED_BUF(self) (Py_REFCNT((self)->buf) > 1)
 
+/* Copy the chunks to the buffer before accessing it */
+#define JOIN_CHUNKS(self) \
+    if ((self)->chunks_size > 0 && join_chunks(self) < 0) \
+        return NULL;
+
+/* Bounds of the size of the tail chunk, which is proportional to the size of
+   the stream.  Bytes objects at least as large as the minimum are stored as
+   chunks without copying. */
+#define CHUNK_SIZE_MIN (64 * 1024)
+#define CHUNK_SIZE_MAX (16 * 1024 * 1024)
+
 
 /* Internal routine to get a line from the buffer of a BytesIO
    object. Returns the length between the current position to the
@@ -202,6 +223,162 @@ write_bytes(bytesio *self, const char *bytes, Py_ssize_t len)
     return len;
 }
 
+/* Internal routine for moving the tail of a chunked BytesIO object to the
+   list of chunks.  Returns 0 on success, -1 otherwise. */
+static int
+finalize_tail(bytesio *self)
+{
+    if (self->tail == NULL)
+        return 0;
+    if (self->tail_size == 0) {
+        Py_CLEAR(self->tail);
+        return 0;
+    }
+    if (self->chunks == NULL && (self->chunks = PyList_New(0)) == NULL)
+        return -1;
+    if (self->tail_size < PyBytes_GET_SIZE(self->tail)) {
+        /* The tail is never shared */
+        if (_PyBytes_Resize(&self->tail, self->tail_size) < 0) {
+            self->chunks_size -= self->tail_size;
+            self->string_size -= self->tail_size;
+            self->tail_size = 0;
+            return -1;
+        }
+    }
+    if (PyList_Append(self->chunks, self->tail) < 0)
+        return -1;
+    Py_CLEAR(self->tail);
+    self->tail_size = 0;
+    return 0;
+}
+
+/* Internal routine for appending a string of bytes to a chunked BytesIO
+   object, at the end of the stream.  If obj is not NULL, it is the bytes
+   object holding the string, which may be stored without copying.  Returns
+   the number of bytes written, or -1 on error. */
+static Py_ssize_t
+append_chunk(bytesio *self, PyObject *obj, const char *bytes, Py_ssize_t len)
+{
+    assert(self->chunked);
+    assert(self->pos == self->string_size);
+    assert(self->exports == 0);
+    assert(len > 0);
+
+    if (len > PY_SSIZE_T_MAX - self->string_size) {
+        PyErr_SetString(PyExc_OverflowError,
+                        "new buffer size too large");
+        return -1;
+    }
+
+    if (obj != NULL && len >= CHUNK_SIZE_MIN) {
+        assert(PyBytes_CheckExact(obj));
+        if (finalize_tail(self) < 0)
+            return -1;
+        if (self->chunks == NULL && (self->chunks = PyList_New(0)) == NULL)
+            return -1;
+        if (PyList_Append(self->chunks, obj) < 0)
+            return -1;
+    }
+    else {
+        if (self->tail == NULL ||
+            len > PyBytes_GET_SIZE(self->tail) - self->tail_size) {
+            /* Start a new tail, the unused end of the old one is freed */
+            PyObject *tail;
+            Py_ssize_t size = self->chunks_size >> 3;
+            size = Py_MAX(size, CHUNK_SIZE_MIN);
+            size = Py_MIN(size, CHUNK_SIZE_MAX);
+            size = Py_MAX(size, len);
+            tail = PyBytes_FromStringAndSize(NULL, size);
+            if (tail == NULL)
+                return -1;
+            if (finalize_tail(self) < 0) {
+                Py_DECREF(tail);
+                return -1;
+            }
+            self->tail = tail;
+        }
+        memcpy(PyBytes_AS_STRING(self->tail) + self->tail_size, bytes, len);
+        self->tail_size += len;
+    }
+
+    self->chunks_size += len;
+    self->string_size += len;
+    self->pos = self->string_size;
+    return len;
+}
+
+/* Internal routine for copying the chunks of a chunked BytesIO object to its
+   buffer.  Returns 0 on success, -1 otherwise. */
+static int
+join_chunks(bytesio *self)
+{
+    Py_ssize_t i, nchunks, size, pos;
+
+    assert(self->exports == 0);
+    if (self->chunks_size == 0)
+        return 0;
+
+    size = self->string_size;
+    pos = size - self->chunks_size;
+    nchunks = self->chunks ? PyList_GET_SIZE(self->chunks) : 0;
+    if (pos == 0 && nchunks + (self->tail != NULL) == 1) {
+        /* A single chunk: use it as the buffer */
+        if (finalize_tail(self) < 0)
+            return -1;
+        Py_INCREF(PyList_GET_ITEM(self->chunks, 0));
+        Py_SETREF(self->buf, PyList_GET_ITEM(self->chunks, 0));
+    }
+    else {
+        /* Only the first pos bytes of the buffer are kept; the chunks are
+           copied after them.  A shared buffer (e.g. the initial value after
+           a truncate()) must be unshared, even if it is already large
+           enough, since the chunks are written in place. */
+        int res;
+        self->string_size = pos;
+        if (SHARED_BUF(self))
+            res = unshare_buffer(self, size);
+        else
+            res = resize_buffer(self, size);
+        self->string_size = size;
+        if (res < 0)
+            return -1;
+        /* Release each chunk once copied, so that the pages of the buffer
+           and of the chunks are not all resident at the same time */
+        for (i = 0; i < nchunks; i++) {
+            PyObject *chunk = PyList_GET_ITEM(self->chunks, i);
+            memcpy(PyBytes_AS_STRING(self->buf) + pos,
+                   PyBytes_AS_STRING(chunk), PyBytes_GET_SIZE(chunk));
+            pos += PyBytes_GET_SIZE(chunk);
+            Py_INCREF(Py_None);
+            PyList_SET_ITEM(self->chunks, i, Py_None);
+            Py_DECREF(chunk);
+        }
+        if (self->tail != NULL) {
+            memcpy(PyBytes_AS_STRING(self->buf) + pos,
+                   PyBytes_AS_STRING(self->tail), self->tail_size);
+            pos += self->tail_size;
+        }
+        assert(pos == size);
+    }
+
+    Py_CLEAR(self->chunks);
+    Py_CLEAR(self->tail);
+    self->tail_size = 0;
+    self->chunks_size = 0;
+    return 0;
+}
+
+/* Internal routine for dropping the chunks of a BytesIO object; the caller
+   resets string_size. */
+static void
+clear_chunks(bytesio *self)
+{
+    Py_CLEAR(self->chunks);
+    Py_CLEAR(self->tail);
+    self->tail_size = 0;
+    self->chunks_size = 0;
+}
+
 static PyObject *
 bytesio_get_closed(bytesio *self)
 {
@@ -306,6 +483,7 @@ _io_BytesIO_getvalue_impl(bytesio *self)
 /*[clinic end generated code: output=b3f6a3233c8fd628 input=4b403ac0af3973ed]*/
 {
     CHECK_CLOSED(self);
+    JOIN_CHUNKS(self);
     if (self->string_size <= 1 || self->exports > 0)
         return PyBytes_FromStringAndSize(PyBytes_AS_STRING(self->buf),
                                          self->string_size);
@@ -324,6 +502,78 @@ _io_BytesIO_getvalue_impl(bytesio *self)
     return self->buf;
 }
 
+/*[clinic input]
+_io.BytesIO.getbuffers
+
+Retrieve the entire contents of the BytesIO object as a list of bytes.
+
+The chunks of a chunked BytesIO object are returned without being joined,
+so that they can be passed to socket.sendmsg() or os.writev().
+[clinic start generated code]*/
+
+static PyObject *
+_io_BytesIO_getbuffers_impl(bytesio *self)
+/*[clinic end generated code: output=a18771c9581aec3d input=e8cf0e96f79d4cd9]*/
+{
+    PyObject *result, *first;
+    Py_ssize_t size;
+
+    CHECK_CLOSED(self);
+    if (self->chunks_size == 0) {
+        if (self->string_size == 0)
+            return PyList_New(0);
+        first = _io_BytesIO_getvalue_impl(self);
+        if (first == NULL)
+            return NULL;
+        result = PyList_New(1);
+        if (result == NULL) {
+            Py_DECREF(first);
+            return NULL;
+        }
+        PyList_SET_ITEM(result, 0, first);
+        return result;
+    }
+
+    if (finalize_tail(self) < 0)
+        return NULL;
+    assert(self->exports == 0);
+    result = PyList_New(0);
+    if (result == NULL)
+        return NULL;
+
+    /* The data in the buffer, shared if possible */
+    size = self->string_size - self->chunks_size;
+    if (size > 0) {
+        if (size <= 1 || SHARED_BUF(self)) {
+            first = PyBytes_FromStringAndSize(PyBytes_AS_STRING(self->buf),
+                                              size);
+            if (first == NULL)
+                goto error;
+        }
+        else {
+            if (size != PyBytes_GET_SIZE(self->buf) &&
+                _PyBytes_Resize(&self->buf, size) < 0)
+                goto error;
+            first = self->buf;
+            Py_INCREF(first);
+        }
+        if (PyList_Append(result, first) < 0) {
+            Py_DECREF(first);
+            goto error;
+        }
+        Py_DECREF(first);
+    }
+
+    if (PyList_SetSlice(result, PY_SSIZE_T_MAX, PY_SSIZE_T_MAX,
+                        self->chunks) < 0)
+        goto error;
+    return result;
+
+  error:
+    Py_DECREF(result);
+    return NULL;
+}
+
 /*[clinic input]
 _io.BytesIO.isatty
 
@@ -392,6 +642,7 @@ _io_BytesIO_read_impl(bytesio *self, PyObject *arg)
     Py_ssize_t size, n;
 
     CHECK_CLOSED(self);
+    JOIN_CHUNKS(self);
 
     if (PyLong_Check(arg)) {
         size = PyLong_AsSsize_t(arg);
@@ -457,6 +708,7 @@ _io_BytesIO_readline_impl(bytesio *self, PyObject *arg)
     Py_ssize_t size, n;
 
     CHECK_CLOSED(self);
+    JOIN_CHUNKS(self);
 
     if (PyLong_Check(arg)) {
         size = PyLong_AsSsize_t(arg);
@@ -499,6 +751,7 @@ _io_BytesIO_readlines_impl(bytesio *self, PyObject *arg)
     char *output;
 
     CHECK_CLOSED(self);
+    JOIN_CHUNKS(self);
 
     if (PyLong_Check(arg)) {
         maxsize = PyLong_AsSsize_t(arg);
@@ -561,6 +814,7 @@ _io_BytesIO_readinto_impl(bytesio *self, Py_buffer *buffer)
     Py_ssize_t len, n;
 
     CHECK_CLOSED(self);
+    JOIN_CHUNKS(self);
 
     /* adjust invalid sizes */
     len = buffer->len;
@@ -598,6 +852,7 @@ _io_BytesIO_truncate_impl(bytesio *self, PyObject *arg)
 
     CHECK_CLOSED(self);
     CHECK_EXPORTS(self);
+    JOIN_CHUNKS(self);
 
     if (PyLong_Check(arg)) {
         size = PyLong_AsSsize_t(arg);
@@ -635,6 +890,7 @@ bytesio_iternext(bytesio *self)
     Py_ssize_t n;
 
     CHECK_CLOSED(self);
+    JOIN_CHUNKS(self);
 
     n = scan_eol(self, -1);
 
@@ -726,13 +982,108 @@ _io_BytesIO_write(bytesio *self, PyObject *b)
     if (PyObject_GetBuffer(b, &buf, PyBUF_CONTIG_RO) < 0)
         return NULL;
 
-    if (buf.len != 0)
-        n = write_bytes(self, buf.buf, buf.len);
+    if (buf.len != 0) {
+        if (self->chunked && self->pos == self->string_size)
+            n = append_chunk(self, PyBytes_CheckExact(b) ? b : NULL,
+                             buf.buf, buf.len);
+        else if (self->chunks_size > 0 && join_chunks(self) < 0)
+            n = -1;
+        else
+            n = write_bytes(self, buf.buf, buf.len);
+    }
 
     PyBuffer_Release(&buf);
     return n >= 0 ? PyLong_FromSsize_t(n) : NULL;
 }
 
+/*[clinic input]
+_io.BytesIO.write_many
+    buffers: object
+    /
+
+Write an iterable of bytes-like objects to the file.
+
+Return the total number of bytes written.  The buffer is resized once for
+all the data, and the large bytes objects written at the end of a chunked
+BytesIO object are stored without being copied.
+[clinic start generated code]*/
+
+static PyObject *
+_io_BytesIO_write_many(bytesio *self, PyObject *buffers)
+/*[clinic end generated code: output=559ae3800cfe5165 input=acd03fd6b0a21535]*/
+{
+    PyObject *seq, **items;
+    Py_buffer *views;
+    Py_ssize_t i, nviews = 0, nitems, n, total = 0;
+    PyObject *result = NULL;
+
+    CHECK_CLOSED(self);
+    CHECK_EXPORTS(self);
+
+    seq = PySequence_Fast(buffers, "write_many() argument must be iterable");
+    if (seq == NULL)
+        return NULL;
+    nitems = PySequence_Fast_GET_SIZE(seq);
+    items = PySequence_Fast_ITEMS(seq);
+    views = PyMem_New(Py_buffer, nitems);
+    if (views == NULL) {
+        PyErr_NoMemory();
+        goto end;
+    }
+    for (nviews = 0; nviews < nitems; nviews++) {
+        if (PyObject_GetBuffer(items[nviews], &views[nviews],
+                               PyBUF_CONTIG_RO) < 0)
+            goto end;
+        if (views[nviews].len > PY_SSIZE_T_MAX - total) {
+            nviews++;
+            PyErr_SetString(PyExc_OverflowError,
+                            "new buffer size too large");
+            goto end;
+        }
+        total += views[nviews].len;
+    }
+
+    if (self->chunked && self->pos == self->string_size) {
+        for (i = 0; i < nitems; i++) {
+            if (views[i].len == 0)
+                continue;
+            n = append_chunk(self,
+                             PyBytes_CheckExact(items[i]) ? items[i] : NULL,
+                             views[i].buf, views[i].len);
+            if (n < 0)
+                goto end;
+        }
+    }
+    else if (total > 0) {
+        if (join_chunks(self) < 0)
+            goto end;
+        if (total > PY_SSIZE_T_MAX - self->pos) {
+            PyErr_SetString(PyExc_OverflowError,
+                            "new buffer size too large");
+            goto end;
+        }
+        /* Resize the buffer once, write_bytes() then only copies */
+        if (self->pos + total > PyBytes_GET_SIZE(self->buf) &&
+            resize_buffer(self, self->pos + total) < 0)
+            goto end;
+        for (i = 0; i < nitems; i++) {
+            if (views[i].len == 0)
+                continue;
+            n = write_bytes(self, views[i].buf, views[i].len);
+            if (n < 0)
+                goto end;
+        }
+    }
+    result = PyLong_FromSsize_t(total);
+
+  end:
+    for (i = 0; i < nviews; i++)
+        PyBuffer_Release(&views[i]);
+    PyMem_Free(views);
+    Py_DECREF(seq);
+    return result;
+}
+
 /*[clinic input]
 _io.BytesIO.writelines
     lines: object
@@ -788,6 +1139,7 @@ _io_BytesIO_close_impl(bytesio *self)
 {
     CHECK_EXPORTS(self);
     Py_CLEAR(self->buf);
+    clear_chunks(self);
     Py_RETURN_NONE;
 }
 
@@ -854,6 +1206,7 @@ bytesio_setstate(bytesio *self, PyObject *state)
     CHECK_EXPORTS(self);
     /* Reset the object to its default state. This is only needed to handle
        the case of repeated calls to __setstate__. */
+    clear_chunks(self);
     self->string_size = 0;
     self->pos = 0;
 
@@ -918,6 +1271,7 @@ bytesio_dealloc(bytesio *self)
         PyErr_Print();
     }
     Py_CLEAR(self->buf);
+    clear_chunks(self);
     Py_CLEAR(self->dict);
     if (self->weakreflist != NULL)
         PyObject_ClearWeakRefs((PyObject *) self);
@@ -949,13 +1303,19 @@ bytesio_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 /*[clinic input]
 _io.BytesIO.__init__
     initial_bytes as initvalue: object(c_default="NULL") = b''
+    *
+    chunked: int(c_default="0") = False
 
 Buffered I/O implementation using an in-memory bytes buffer.
+
+If chunked is true, the data written at the end of the stream is stored as
+a list of chunks which are only joined when the contents are read, instead
+of growing a single buffer.
 [clinic start generated code]*/
 
 static int
-_io_BytesIO___init___impl(bytesio *self, PyObject *initvalue)
-/*[clinic end generated code: output=65c0c51e24c5b621 input=aac7f31b67bf0fb6]*/
+_io_BytesIO___init___impl(bytesio *self, PyObject *initvalue, int chunked)
+/*[clinic end generated code: output=9f2e14faeafcaf65 input=87cca66e2ead522e]*/
 {
     /* In case, __init__ is called multiple times. */
     self->string_size = 0;
@@ -966,6 +1326,8 @@ _io_BytesIO___init___impl(bytesio *self, PyObject *initvalue)
                         "Existing exports of data: object cannot be re-sized");
         return -1;
     }
+    clear_chunks(self);
+    self->chunked = chunked != 0;
     if (initvalue && initvalue != Py_None) {
         if (PyBytes_CheckExact(initvalue)) {
             Py_INCREF(initvalue);
@@ -993,6 +1355,17 @@ bytesio_sizeof(bytesio *self, void *unused)
     res = _PyObject_SIZE(Py_TYPE(self));
     if (self->buf && !SHARED_BUF(self))
         res += _PySys_GetSizeOf(self->buf);
+    if (self->chunks) {
+        Py_ssize_t i;
+        res += _PySys_GetSizeOf(self->chunks);
+        for (i = 0; i < PyList_GET_SIZE(self->chunks); i++) {
+            PyObject *chunk = PyList_GET_ITEM(self->chunks, i);
+            if (Py_REFCNT(chunk) == 1)
+                res += _PySys_GetSizeOf(chunk);
+        }
+    }
+    if (self->tail)
+        res += _PySys_GetSizeOf(self->tail);
     return PyLong_FromSsize_t(res);
 }
 
@@ -1029,6 +1402,7 @@ static struct PyMethodDef bytesio_methods[] = {
     _IO_BYTESIO_TELL_METHODDEF
     _IO_BYTESIO_WRITE_METHODDEF
     _IO_BYTESIO_WRITELINES_METHODDEF
+    _IO_BYTESIO_WRITE_MANY_METHODDEF
     _IO_BYTESIO_READ1_METHODDEF
     _IO_BYTESIO_READINTO_METHODDEF
     _IO_BYTESIO_READLINE_METHODDEF
@@ -1036,6 +1410,7 @@ static struct PyMethodDef bytesio_methods[] = {
     _IO_BYTESIO_READ_METHODDEF
     _IO_BYTESIO_GETBUFFER_METHODDEF
     _IO_BYTESIO_GETVALUE_METHODDEF
+    _IO_BYTESIO_GETBUFFERS_METHODDEF
     _IO_BYTESIO_SEEK_METHODDEF
     _IO_BYTESIO_TRUNCATE_METHODDEF
     {"__getstate__",  (PyCFunction)bytesio_getstate,  METH_NOARGS, NULL},
@@ -1103,6 +1478,8 @@ bytesiobuf_getbuffer(bytesiobuf *obj, Py_buffer *view, int flags)
             "bytesiobuf_getbuffer: view==NULL argument is obsolete");
         return -1;
     }
+    if (b->chunks_size > 0 && join_chunks(b) < 0)
+        return -1;
     if (SHARED_BUF(b)) {
         if (unshare_buffer(b, b->string_size) < 0)
             return -1;
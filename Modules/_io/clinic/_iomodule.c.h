@@ -4,7 +4,8 @@ preserve
 
 PyDoc_STRVAR(_io_open__doc__,
 "open($module, /, file, mode=\'r\', buffering=-1, encoding=None,\n"
-"     errors=None, newline=None, closefd=True, opener=None)\n"
+"     errors=None, newline=None, closefd=True, opener=None, mmap=False,\n"
+"     readahead=0)\n"
 "--\n"
 "\n"
 "Open file and return a stream.  Raise IOError upon failure.\n"
@@ -112,6 +113,15 @@ PyDoc_STRVAR(_io_open__doc__,
 "file descriptor (passing os.open as *opener* results in functionality\n"
 "similar to passing None).\n"
 "\n"
+"If mmap is true, a file opened for reading is memory-mapped when it is a\n"
+"regular file larger than the buffer, and reads are served from the mapping\n"
+"instead of read() system calls.  Truncating the file while it is mapped\n"
+"crashes the process.\n"
+"\n"
+"If readahead is positive, a helper thread reads up to readahead buffers\n"
+"ahead when a regular file is opened for reading, so that reading the file\n"
+"overlaps with processing the data.\n"
+"\n"
 "open() returns a file object whose type depends on the mode, and\n"
 "through which the standard file operations such as reading and writing\n"
 "are performed. When open() is used to open a file in a text mode (\'w\',\n"
@@ -132,13 +142,14 @@ PyDoc_STRVAR(_io_open__doc__,
 static PyObject *
 _io_open_impl(PyModuleDef *module, PyObject *file, const char *mode,
               int buffering, const char *encoding, const char *errors,
-              const char *newline, int closefd, PyObject *opener);
+              const char *newline, int closefd, PyObject *opener,
+              int use_mmap, int readahead);
 
 static PyObject *
 _io_open(PyModuleDef *module, PyObject *args, PyObject *kwargs)
 {
     PyObject *return_value = NULL;
-    static char *_keywords[] = {"file", "mode", "buffering", "encoding", "errors", "newline", "closefd", "opener", NULL};
+    static char *_keywords[] = {"file", "mode", "buffering", "encoding", "errors", "newline", "closefd", "opener", "mmap", "readahead", NULL};
     PyObject *file;
     const char *mode = "r";
     int buffering = -1;
@@ -147,13 +158,15 @@ _io_open(PyModuleDef *module, PyObject *args, PyObject *kwargs)
     const char *newline = NULL;
     int closefd = 1;
     PyObject *opener = Py_None;
+    int use_mmap = 0;
+    int readahead = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sizzziO:open", _keywords,
-        &file, &mode, &buffering, &encoding, &errors, &newline, &closefd, &opener))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sizzziOii:open", _keywords,
+        &file, &mode, &buffering, &encoding, &errors, &newline, &closefd, &opener, &use_mmap, &readahead))
         goto exit;
-    return_value = _io_open_impl(module, file, mode, buffering, encoding, errors, newline, closefd, opener);
+    return_value = _io_open_impl(module, file, mode, buffering, encoding, errors, newline, closefd, opener, use_mmap, readahead);
 
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=97cdc09bf68a8064 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=26cb4d1752d6bcbf input=a9049054013a1b77]*/
@@ -242,6 +242,37 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(_io__Buffered_readlines__doc__,
+"readlines($self, hint=-1, /)\n"
+"--\n"
+"\n"
+"Return a list of lines from the stream.\n"
+"\n"
+"hint can be specified to control the number of lines read: no more\n"
+"lines will be read if the total size (in bytes) of all lines so far\n"
+"exceeds hint.");
+
+#define _IO__BUFFERED_READLINES_METHODDEF    \
+    {"readlines", (PyCFunction)_io__Buffered_readlines, METH_VARARGS, _io__Buffered_readlines__doc__},
+
+static PyObject *
+_io__Buffered_readlines_impl(buffered *self, Py_ssize_t hint);
+
+static PyObject *
+_io__Buffered_readlines(buffered *self, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t hint = -1;
+
+    if (!PyArg_ParseTuple(args, "|O&:readlines",
+        _PyIO_ConvertSsize_t, &hint))
+        goto exit;
+    return_value = _io__Buffered_readlines_impl(self, hint);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(_io__Buffered_seek__doc__,
 "seek($self, target, whence=0, /)\n"
 "--\n"
@@ -297,27 +328,39 @@ exit:
 }
 
 PyDoc_STRVAR(_io_BufferedReader___init____doc__,
-"BufferedReader(raw, buffer_size=DEFAULT_BUFFER_SIZE)\n"
+"BufferedReader(raw, buffer_size=DEFAULT_BUFFER_SIZE, mmap=False,\n"
+"               readahead=0)\n"
 "--\n"
 "\n"
-"Create a new buffered reader using the given readable raw IO object.");
+"Create a new buffered reader using the given readable raw IO object.\n"
+"\n"
+"If mmap is true and raw is a FileIO object of a regular file larger than\n"
+"buffer_size, the file is memory-mapped and reads are served from the\n"
+"mapping.  Truncating the file while it is mapped crashes the process.\n"
+"\n"
+"If readahead is positive and raw is a FileIO object of a regular file, a\n"
+"helper thread reads up to readahead buffers of buffer_size bytes ahead,\n"
+"so that reading the file overlaps with processing the data.");
 
 static int
 _io_BufferedReader___init___impl(buffered *self, PyObject *raw,
-                                 Py_ssize_t buffer_size);
+                                 Py_ssize_t buffer_size, int use_mmap,
+                                 int readahead);
 
 static int
 _io_BufferedReader___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     int return_value = -1;
-    static char *_keywords[] = {"raw", "buffer_size", NULL};
+    static char *_keywords[] = {"raw", "buffer_size", "mmap", "readahead", NULL};
     PyObject *raw;
     Py_ssize_t buffer_size = DEFAULT_BUFFER_SIZE;
+    int use_mmap = 0;
+    int readahead = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n:BufferedReader", _keywords,
-        &raw, &buffer_size))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nii:BufferedReader", _keywords,
+        &raw, &buffer_size, &use_mmap, &readahead))
         goto exit;
-    return_value = _io_BufferedReader___init___impl((buffered *)self, raw, buffer_size);
+    return_value = _io_BufferedReader___init___impl((buffered *)self, raw, buffer_size, use_mmap, readahead);
 
 exit:
     return return_value;
@@ -451,4 +494,4 @@ _io_BufferedRandom___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=2bbb5e239b4ffe6f input=a9049054013a1b77]*/
+/*[clinic end generated code: output=02088930e7e297b2 input=a9049054013a1b77]*/
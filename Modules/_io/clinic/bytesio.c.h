@@ -110,6 +110,27 @@ _io_BytesIO_getvalue(bytesio *self, PyObject *Py_UNUSED(ignored))
     return _io_BytesIO_getvalue_impl(self);
 }
 
+PyDoc_STRVAR(_io_BytesIO_getbuffers__doc__,
+"getbuffers($self, /)\n"
+"--\n"
+"\n"
+"Retrieve the entire contents of the BytesIO object as a list of bytes.\n"
+"\n"
+"The chunks of a chunked BytesIO object are returned without being joined,\n"
+"so that they can be passed to socket.sendmsg() or os.writev().");
+
+#define _IO_BYTESIO_GETBUFFERS_METHODDEF    \
+    {"getbuffers", (PyCFunction)_io_BytesIO_getbuffers, METH_NOARGS, _io_BytesIO_getbuffers__doc__},
+
+static PyObject *
+_io_BytesIO_getbuffers_impl(bytesio *self);
+
+static PyObject *
+_io_BytesIO_getbuffers(bytesio *self, PyObject *Py_UNUSED(ignored))
+{
+    return _io_BytesIO_getbuffers_impl(self);
+}
+
 PyDoc_STRVAR(_io_BytesIO_isatty__doc__,
 "isatty($self, /)\n"
 "--\n"
@@ -364,6 +385,19 @@ PyDoc_STRVAR(_io_BytesIO_write__doc__,
 #define _IO_BYTESIO_WRITE_METHODDEF    \
     {"write", (PyCFunction)_io_BytesIO_write, METH_O, _io_BytesIO_write__doc__},
 
+PyDoc_STRVAR(_io_BytesIO_write_many__doc__,
+"write_many($self, buffers, /)\n"
+"--\n"
+"\n"
+"Write an iterable of bytes-like objects to the file.\n"
+"\n"
+"Return the total number of bytes written.  The buffer is resized once for\n"
+"all the data, and the large bytes objects written at the end of a chunked\n"
+"BytesIO object are stored without being copied.");
+
+#define _IO_BYTESIO_WRITE_MANY_METHODDEF    \
+    {"write_many", (PyCFunction)_io_BytesIO_write_many, METH_O, _io_BytesIO_write_many__doc__},
+
 PyDoc_STRVAR(_io_BytesIO_writelines__doc__,
 "writelines($self, lines, /)\n"
 "--\n"
@@ -396,27 +430,32 @@ _io_BytesIO_close(bytesio *self, PyObject *Py_UNUSED(ignored))
 }
 
 PyDoc_STRVAR(_io_BytesIO___init____doc__,
-"BytesIO(initial_bytes=b\'\')\n"
+"BytesIO(initial_bytes=b\'\', *, chunked=False)\n"
 "--\n"
 "\n"
-"Buffered I/O implementation using an in-memory bytes buffer.");
+"Buffered I/O implementation using an in-memory bytes buffer.\n"
+"\n"
+"If chunked is true, the data written at the end of the stream is stored as\n"
+"a list of chunks which are only joined when the contents are read, instead\n"
+"of growing a single buffer.");
 
 static int
-_io_BytesIO___init___impl(bytesio *self, PyObject *initvalue);
+_io_BytesIO___init___impl(bytesio *self, PyObject *initvalue, int chunked);
 
 static int
 _io_BytesIO___init__(PyObject *self, PyObject *args, PyObject *kwargs)
 {
     int return_value = -1;
-    static char *_keywords[] = {"initial_bytes", NULL};
+    static char *_keywords[] = {"initial_bytes", "chunked", NULL};
     PyObject *initvalue = NULL;
+    int chunked = 0;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:BytesIO", _keywords,
-        &initvalue))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O$i:BytesIO", _keywords,
+        &initvalue, &chunked))
         goto exit;
-    return_value = _io_BytesIO___init___impl((bytesio *)self, initvalue);
+    return_value = _io_BytesIO___init___impl((bytesio *)self, initvalue, chunked);
 
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=60ce2c6272718431 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=eeb236c816d35b8c input=a9049054013a1b77]*/
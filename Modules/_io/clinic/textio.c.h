@@ -2,6 +2,81 @@
 preserve
 [clinic start generated code]*/
 
+PyDoc_STRVAR(_io__TextDecoder_decode__doc__,
+"decode($self, /, input, final=False)\n"
+"--\n"
+"\n");
+
+#define _IO__TEXTDECODER_DECODE_METHODDEF    \
+    {"decode", (PyCFunction)_io__TextDecoder_decode, METH_VARARGS|METH_KEYWORDS, _io__TextDecoder_decode__doc__},
+
+static PyObject *
+_io__TextDecoder_decode_impl(textdecoder_object *self, Py_buffer *input,
+                             int final);
+
+static PyObject *
+_io__TextDecoder_decode(textdecoder_object *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"input", "final", NULL};
+    Py_buffer input = {NULL, NULL};
+    int final = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "y*|i:decode", _keywords,
+        &input, &final))
+        goto exit;
+    return_value = _io__TextDecoder_decode_impl(self, &input, final);
+
+exit:
+    /* Cleanup for input */
+    if (input.obj)
+       PyBuffer_Release(&input);
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_io__TextDecoder_getstate__doc__,
+"getstate($self, /)\n"
+"--\n"
+"\n");
+
+#define _IO__TEXTDECODER_GETSTATE_METHODDEF    \
+    {"getstate", (PyCFunction)_io__TextDecoder_getstate, METH_NOARGS, _io__TextDecoder_getstate__doc__},
+
+static PyObject *
+_io__TextDecoder_getstate_impl(textdecoder_object *self);
+
+static PyObject *
+_io__TextDecoder_getstate(textdecoder_object *self, PyObject *Py_UNUSED(ignored))
+{
+    return _io__TextDecoder_getstate_impl(self);
+}
+
+PyDoc_STRVAR(_io__TextDecoder_setstate__doc__,
+"setstate($self, state, /)\n"
+"--\n"
+"\n");
+
+#define _IO__TEXTDECODER_SETSTATE_METHODDEF    \
+    {"setstate", (PyCFunction)_io__TextDecoder_setstate, METH_O, _io__TextDecoder_setstate__doc__},
+
+PyDoc_STRVAR(_io__TextDecoder_reset__doc__,
+"reset($self, /)\n"
+"--\n"
+"\n");
+
+#define _IO__TEXTDECODER_RESET_METHODDEF    \
+    {"reset", (PyCFunction)_io__TextDecoder_reset, METH_NOARGS, _io__TextDecoder_reset__doc__},
+
+static PyObject *
+_io__TextDecoder_reset_impl(textdecoder_object *self);
+
+static PyObject *
+_io__TextDecoder_reset(textdecoder_object *self, PyObject *Py_UNUSED(ignored))
+{
+    return _io__TextDecoder_reset_impl(self);
+}
+
 PyDoc_STRVAR(_io_IncrementalNewlineDecoder___init____doc__,
 "IncrementalNewlineDecoder(decoder, translate, errors=\'strict\')\n"
 "--\n"
@@ -264,6 +339,37 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(_io_TextIOWrapper_readlines__doc__,
+"readlines($self, hint=-1, /)\n"
+"--\n"
+"\n"
+"Return a list of lines from the stream.\n"
+"\n"
+"hint can be specified to control the number of lines read: no more\n"
+"lines will be read if the total size (in characters) of all lines so\n"
+"far exceeds hint.");
+
+#define _IO_TEXTIOWRAPPER_READLINES_METHODDEF    \
+    {"readlines", (PyCFunction)_io_TextIOWrapper_readlines, METH_VARARGS, _io_TextIOWrapper_readlines__doc__},
+
+static PyObject *
+_io_TextIOWrapper_readlines_impl(textio *self, Py_ssize_t hint);
+
+static PyObject *
+_io_TextIOWrapper_readlines(textio *self, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t hint = -1;
+
+    if (!PyArg_ParseTuple(args, "|O&:readlines",
+        _PyIO_ConvertSsize_t, &hint))
+        goto exit;
+    return_value = _io_TextIOWrapper_readlines_impl(self, hint);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(_io_TextIOWrapper_seek__doc__,
 "seek($self, cookie, whence=0, /)\n"
 "--\n"
@@ -453,4 +559,4 @@ _io_TextIOWrapper_close(textio *self, PyObject *Py_UNUSED(ignored))
 {
     return _io_TextIOWrapper_close_impl(self);
 }
-/*[clinic end generated code: output=690608f85aab8ba5 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=8143987650ea136b input=a9049054013a1b77]*/
@@ -9,14 +9,20 @@
 #define PY_SSIZE_T_CLEAN
 #include "Python.h"
 #include "structmember.h"
+#include "pycpu.h"
 #include "_iomodule.h"
 
+#ifdef Py_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
 /*[clinic input]
 module _io
+class _io._TextDecoder "textdecoder_object *" "&_PyTextDecoder_Type"
 class _io.IncrementalNewlineDecoder "nldecoder_object *" "&PyIncrementalNewlineDecoder_Type"
 class _io.TextIOWrapper "textio *" "&TextIOWrapper_TYpe"
 [clinic start generated code]*/
-/*[clinic end generated code: output=da39a3ee5e6b4b0d input=2097a4fc85670c26]*/
+/*[clinic end generated code: output=da39a3ee5e6b4b0d input=9476cf769cea3830]*/
 
 /*[python input]
 class io_ssize_t_converter(CConverter):
@@ -38,6 +44,7 @@ _Py_IDENTIFIER(raw);
 _Py_IDENTIFIER(read);
 _Py_IDENTIFIER(read1);
 _Py_IDENTIFIER(readable);
+_Py_IDENTIFIER(readlines);
 _Py_IDENTIFIER(replace);
 _Py_IDENTIFIER(reset);
 _Py_IDENTIFIER(seek);
@@ -222,6 +229,294 @@ PyTypeObject PyTextIOBase_Type = {
 };
 
 
+/* TextDecoder */
+
+/* TextIOWrapper decodes the most common codecs with a _TextDecoder instead
+   of the incremental decoder of the codec registry.  It behaves like the
+   decoders of the encodings package (same output, same errors, same state
+   for tell() and seek()), but TextIOWrapper and IncrementalNewlineDecoder
+   call it directly, and it decodes the input without concatenating it to
+   the undecoded bytes of the previous call when there are none. */
+
+enum {
+    TEXTDECODER_ASCII,
+    TEXTDECODER_LATIN1,
+    TEXTDECODER_UTF8,
+    TEXTDECODER_UTF16,
+    TEXTDECODER_UTF16_LE,
+    TEXTDECODER_UTF16_BE
+};
+
+typedef struct {
+    const char *name;
+    int codec;
+} textdecoderentry;
+
+/* Indexed by the name of the codec in the registry */
+static textdecoderentry textdecoders[] = {
+    {"ascii",       TEXTDECODER_ASCII},
+    {"iso8859-1",   TEXTDECODER_LATIN1},
+    {"utf-8",       TEXTDECODER_UTF8},
+    {"utf-16",      TEXTDECODER_UTF16},
+    {"utf-16-le",   TEXTDECODER_UTF16_LE},
+    {"utf-16-be",   TEXTDECODER_UTF16_BE},
+    {NULL, 0}
+};
+
+#if PY_LITTLE_ENDIAN
+#define NATIVE_BYTEORDER (-1)
+#else
+#define NATIVE_BYTEORDER 1
+#endif
+
+typedef struct {
+    PyObject_HEAD
+    int codec;
+    int byteorder;              /* UTF-16: -1 for little endian, 1 for big
+                                   endian, 0 until the BOM is read */
+    PyObject *errors;           /* bytes */
+    PyObject *pending;          /* bytes not decoded yet, or NULL */
+} textdecoder_object;
+
+/* Return a decoder for the codec named name, or NULL without setting an
+   exception if there is no _TextDecoder for this codec. */
+PyObject *
+_PyTextDecoder_New(PyObject *name, PyObject *errors)
+{
+    textdecoderentry *e;
+    textdecoder_object *self;
+
+    assert(PyBytes_Check(errors));
+    for (e = textdecoders; e->name != NULL; e++) {
+        if (!PyUnicode_CompareWithASCIIString(name, e->name))
+            break;
+    }
+    if (e->name == NULL)
+        return NULL;
+    self = PyObject_New(textdecoder_object, &_PyTextDecoder_Type);
+    if (self == NULL)
+        return NULL;
+    self->codec = e->codec;
+    if (e->codec == TEXTDECODER_UTF16_LE)
+        self->byteorder = -1;
+    else if (e->codec == TEXTDECODER_UTF16_BE)
+        self->byteorder = 1;
+    else
+        self->byteorder = 0;
+    Py_INCREF(errors);
+    self->errors = errors;
+    self->pending = NULL;
+    return (PyObject *)self;
+}
+
+static void
+textdecoder_dealloc(textdecoder_object *self)
+{
+    Py_CLEAR(self->errors);
+    Py_CLEAR(self->pending);
+    PyObject_Del(self);
+}
+
+/* Decode data, which starts with the pending bytes if there are any */
+static PyObject *
+textdecoder_decode_data(textdecoder_object *self,
+                        const char *data, Py_ssize_t size, int final)
+{
+    const char *errors = PyBytes_AS_STRING(self->errors);
+    /* This is overwritten unless final is true. */
+    Py_ssize_t consumed = size;
+    PyObject *output, *pending = NULL;
+    int byteorder;
+
+    switch (self->codec) {
+    case TEXTDECODER_ASCII:
+        return PyUnicode_DecodeASCII(data, size, errors);
+    case TEXTDECODER_LATIN1:
+        return PyUnicode_DecodeLatin1(data, size, errors);
+    case TEXTDECODER_UTF8:
+        output = PyUnicode_DecodeUTF8Stateful(data, size, errors,
+                                              final ? NULL : &consumed);
+        if (output == NULL)
+            return NULL;
+        break;
+    default:
+        byteorder = self->byteorder;
+        output = PyUnicode_DecodeUTF16Stateful(data, size, errors,
+                                               &byteorder,
+                                               final ? NULL : &consumed);
+        if (output == NULL)
+            return NULL;
+        if (self->byteorder == 0) {
+            if (byteorder != 0)
+                self->byteorder = byteorder;
+            else if (consumed >= 2) {
+                Py_DECREF(output);
+                PyErr_SetString(PyExc_UnicodeError,
+                                "UTF-16 stream does not start with BOM");
+                return NULL;
+            }
+        }
+        break;
+    }
+
+    /* Keep the undecoded bytes until the next call */
+    if (consumed < size) {
+        pending = PyBytes_FromStringAndSize(data + consumed, size - consumed);
+        if (pending == NULL) {
+            Py_DECREF(output);
+            return NULL;
+        }
+    }
+    Py_XSETREF(self->pending, pending);
+    return output;
+}
+
+static PyObject *
+textdecoder_decode(textdecoder_object *self,
+                   const char *input, Py_ssize_t size, int final)
+{
+    PyObject *data, *output;
+    Py_ssize_t pending_size;
+
+    if (self->pending == NULL)
+        return textdecoder_decode_data(self, input, size, final);
+
+    pending_size = PyBytes_GET_SIZE(self->pending);
+    if (size > PY_SSIZE_T_MAX - pending_size)
+        return PyErr_NoMemory();
+    data = PyBytes_FromStringAndSize(NULL, pending_size + size);
+    if (data == NULL)
+        return NULL;
+    memcpy(PyBytes_AS_STRING(data), PyBytes_AS_STRING(self->pending),
+           pending_size);
+    memcpy(PyBytes_AS_STRING(data) + pending_size, input, size);
+    output = textdecoder_decode_data(self, PyBytes_AS_STRING(data),
+                                     PyBytes_GET_SIZE(data), final);
+    Py_DECREF(data);
+    return output;
+}
+
+/* Shortcut to the _TextDecoder.decode method */
+PyObject *
+_PyTextDecoder_Decode(PyObject *self, PyObject *input, int final)
+{
+    Py_buffer buffer;
+    PyObject *output;
+
+    if (PyBytes_Check(input))
+        return textdecoder_decode((textdecoder_object *)self,
+                                  PyBytes_AS_STRING(input),
+                                  PyBytes_GET_SIZE(input), final);
+    if (PyObject_GetBuffer(input, &buffer, PyBUF_SIMPLE) < 0)
+        return NULL;
+    output = textdecoder_decode((textdecoder_object *)self,
+                                buffer.buf, buffer.len, final);
+    PyBuffer_Release(&buffer);
+    return output;
+}
+
+/*[clinic input]
+_io._TextDecoder.decode
+    input: Py_buffer
+    final: int(c_default="0") = False
+[clinic start generated code]*/
+
+static PyObject *
+_io__TextDecoder_decode_impl(textdecoder_object *self, Py_buffer *input,
+                             int final)
+/*[clinic end generated code: output=79c23d21f109a36e input=9e1eb3bd98cbe571]*/
+{
+    return textdecoder_decode(self, input->buf, input->len, final);
+}
+
+/*[clinic input]
+_io._TextDecoder.getstate
+[clinic start generated code]*/
+
+static PyObject *
+_io__TextDecoder_getstate_impl(textdecoder_object *self)
+/*[clinic end generated code: output=dedfc3c9d6751ff7 input=80b3456fba8d04a6]*/
+{
+    PyObject *buffer;
+    int flag = 0;
+
+    if (self->pending != NULL) {
+        buffer = self->pending;
+        Py_INCREF(buffer);
+    }
+    else {
+        buffer = PyBytes_FromStringAndSize(NULL, 0);
+        if (buffer == NULL)
+            return NULL;
+    }
+    /* Same flags as the UTF-16 decoder of the encodings package:
+       0 for the native byte order, 1 for the other one, and 2 if the
+       BOM hasn't been read yet */
+    if (self->codec == TEXTDECODER_UTF16) {
+        if (self->byteorder == 0)
+            flag = 2;
+        else if (self->byteorder != NATIVE_BYTEORDER)
+            flag = 1;
+    }
+    return Py_BuildValue("Ni", buffer, flag);
+}
+
+/*[clinic input]
+_io._TextDecoder.setstate
+    state: object
+    /
+[clinic start generated code]*/
+
+static PyObject *
+_io__TextDecoder_setstate(textdecoder_object *self, PyObject *state)
+/*[clinic end generated code: output=3fd869a5b907926f input=38324c3068d0b3f5]*/
+{
+    PyObject *buffer;
+    int flag;
+
+    /* The ASCII and Latin-1 decoders have no state */
+    if (self->codec == TEXTDECODER_ASCII || self->codec == TEXTDECODER_LATIN1)
+        Py_RETURN_NONE;
+
+    if (!PyTuple_Check(state)) {
+        PyErr_SetString(PyExc_TypeError, "state argument must be a tuple");
+        return NULL;
+    }
+    if (!PyArg_ParseTuple(state, "O!i", &PyBytes_Type, &buffer, &flag))
+        return NULL;
+
+    if (PyBytes_GET_SIZE(buffer) > 0) {
+        Py_INCREF(buffer);
+        Py_XSETREF(self->pending, buffer);
+    }
+    else
+        Py_CLEAR(self->pending);
+    if (self->codec == TEXTDECODER_UTF16) {
+        if (flag == 0)
+            self->byteorder = NATIVE_BYTEORDER;
+        else if (flag == 1)
+            self->byteorder = -NATIVE_BYTEORDER;
+        else
+            self->byteorder = 0;
+    }
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+_io._TextDecoder.reset
+[clinic start generated code]*/
+
+static PyObject *
+_io__TextDecoder_reset_impl(textdecoder_object *self)
+/*[clinic end generated code: output=e7fdcbf476dfce0a input=92abe21b6a9e28af]*/
+{
+    Py_CLEAR(self->pending);
+    if (self->codec == TEXTDECODER_UTF16)
+        self->byteorder = 0;
+    Py_RETURN_NONE;
+}
+
+
 /* IncrementalNewlineDecoder */
 
 typedef struct {
@@ -307,6 +602,62 @@ check_decoded(PyObject *decoded)
 #define SEEN_CRLF 4
 #define SEEN_ALL (SEEN_CR | SEEN_LF | SEEN_CRLF)
 
+#ifdef Py_CPU_DISPATCH
+/* Line ending search with AVX2: find_eol_avx2() returns the index of the
+   first ch1 or ch2 character in the n characters of s (pass the same
+   character twice to search for one), or -1.  32 bytes are compared at
+   a time, whatever the kind of the string.  The bits of
+   _mm256_movemask_epi8() come in groups of `kind` for each character;
+   KEEP keeps one bit per character. */
+#define EOL_SET1_UCS1(ch) _mm256_set1_epi8((char)(ch))
+#define EOL_SET1_UCS2(ch) _mm256_set1_epi16((short)(ch))
+#define EOL_SET1_UCS4(ch) _mm256_set1_epi32((int)(ch))
+
+#define FIND_EOL_AVX2(NAME, TYPE, SET1, CMPEQ, KEEP)                        \
+Py_TARGET_AVX2 static Py_ssize_t                                             \
+NAME(const TYPE *s, Py_ssize_t n, Py_UCS4 ch1, Py_UCS4 ch2)                  \
+{                                                                            \
+    const __m256i v1 = SET1(ch1);                                            \
+    const __m256i v2 = SET1(ch2);                                            \
+    const Py_ssize_t step = 32 / sizeof(TYPE);                               \
+    Py_ssize_t i;                                                            \
+                                                                             \
+    for (i = 0; i + step <= n; i += step) {                                  \
+        __m256i block = _mm256_loadu_si256((const __m256i *)(s + i));        \
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(              \
+            _mm256_or_si256(CMPEQ(block, v1), CMPEQ(block, v2))) & (KEEP);   \
+        if (mask)                                                            \
+            return i + __builtin_ctz(mask) / sizeof(TYPE);                   \
+    }                                                                        \
+    for (; i < n; i++) {                                                     \
+        if (s[i] == ch1 || s[i] == ch2)                                      \
+            return i;                                                        \
+    }                                                                        \
+    return -1;                                                               \
+}
+
+FIND_EOL_AVX2(find_eol_avx2_ucs1, Py_UCS1, EOL_SET1_UCS1,
+              _mm256_cmpeq_epi8, 0xFFFFFFFFu)
+FIND_EOL_AVX2(find_eol_avx2_ucs2, Py_UCS2, EOL_SET1_UCS2,
+              _mm256_cmpeq_epi16, 0x55555555u)
+FIND_EOL_AVX2(find_eol_avx2_ucs4, Py_UCS4, EOL_SET1_UCS4,
+              _mm256_cmpeq_epi32, 0x11111111u)
+
+/* Must only be called if _Py_CPU_HAS(_Py_CPU_AVX2) */
+static Py_ssize_t
+find_eol_avx2(int kind, const char *s, Py_ssize_t n, Py_UCS4 ch1, Py_UCS4 ch2)
+{
+    switch (kind) {
+    case PyUnicode_1BYTE_KIND:
+        return find_eol_avx2_ucs1((const Py_UCS1 *)s, n, ch1, ch2);
+    case PyUnicode_2BYTE_KIND:
+        return find_eol_avx2_ucs2((const Py_UCS2 *)s, n, ch1, ch2);
+    default:
+        return find_eol_avx2_ucs4((const Py_UCS4 *)s, n, ch1, ch2);
+    }
+}
+#endif
+
 PyObject *
 _PyIncrementalNewlineDecoder_decode(PyObject *myself,
                                     PyObject *input, int final)
@@ -322,7 +673,9 @@ _PyIncrementalNewlineDecoder_decode(PyObject *myself,
     }
 
     /* decode input (with the eventual \r from a previous pass) */
-    if (self->decoder != Py_None) {
+    if (Py_TYPE(self->decoder) == &_PyTextDecoder_Type)
+        output = _PyTextDecoder_Decode(self->decoder, input, final);
+    else if (self->decoder != Py_None) {
         output = PyObject_CallMethodObjArgs(self->decoder,
             _PyIO_str_decode, input, final ? Py_True : Py_False, NULL);
     }
@@ -427,6 +780,26 @@ _PyIncrementalNewlineDecoder_decode(PyObject *myself,
             /* We have already seen all newline types, no need to scan again */
             if (seennl == SEEN_ALL)
                 goto endscan;
+#ifdef Py_CPU_DISPATCH
+            if (_Py_CPU_HAS(_Py_CPU_AVX2)) {
+                while (i < len && seennl != SEEN_ALL) {
+                    Py_ssize_t run = find_eol_avx2(kind, (char *)in_str + i * kind,
+                                                   len - i, '\r', '\n');
+                    if (run < 0)
+                        break;
+                    i += run;
+                    if (PyUnicode_READ(kind, in_str, i++) == '\n')
+                        seennl |= SEEN_LF;
+                    else if (PyUnicode_READ(kind, in_str, i) == '\n') {
+                        seennl |= SEEN_CRLF;
+                        i++;
+                    }
+                    else
+                        seennl |= SEEN_CR;
+                }
+                goto endscan;
+            }
+#endif
             for (;;) {
                 Py_UCS4 c;
                 /* Fast loop for non-control characters */
@@ -468,6 +841,33 @@ _PyIncrementalNewlineDecoder_decode(PyObject *myself,
                 goto error;
             }
             in = out = 0;
+#ifdef Py_CPU_DISPATCH
+            if (_Py_CPU_HAS(_Py_CPU_AVX2)) {
+                /* Copy the runs between line endings with memcpy() */
+                while (in < len) {
+                    Py_ssize_t run = find_eol_avx2(kind, (char *)in_str + in * kind,
+                                                   len - in, '\r', '\n');
+                    if (run < 0)
+                        run = len - in;
+                    memcpy((char *)translated + out * kind,
+                           (char *)in_str + in * kind, run * kind);
+                    in += run;
+                    out += run;
+                    if (in == len)
+                        break;
+                    if (PyUnicode_READ(kind, in_str, in++) == '\n')
+                        seennl |= SEEN_LF;
+                    else if (PyUnicode_READ(kind, in_str, in) == '\n') {
+                        in++;
+                        seennl |= SEEN_CRLF;
+                    }
+                    else
+                        seennl |= SEEN_CR;
+                    PyUnicode_WRITE(kind, translated, out++, '\n');
+                }
+            }
+            else
+#endif
             for (;;) {
                 Py_UCS4 c;
                 /* Fast loop for non-control characters */
@@ -534,8 +934,13 @@ _io_IncrementalNewlineDecoder_getstate_impl(nldecoder_object *self)
     unsigned PY_LONG_LONG flag;
 
     if (self->decoder != Py_None) {
-        PyObject *state = PyObject_CallMethodObjArgs(self->decoder,
-           _PyIO_str_getstate, NULL);
+        PyObject *state;
+        if (Py_TYPE(self->decoder) == &_PyTextDecoder_Type)
+            state = _io__TextDecoder_getstate_impl(
+                (textdecoder_object *)self->decoder);
+        else
+            state = PyObject_CallMethodObjArgs(self->decoder,
+                                               _PyIO_str_getstate, NULL);
         if (state == NULL)
             return NULL;
         if (!PyArg_ParseTuple(state, "OK", &buffer, &flag)) {
@@ -832,7 +1237,7 @@ _io_TextIOWrapper___init___impl(textio *self, PyObject *buffer,
                                 int write_through)
 /*[clinic end generated code: output=56a83402ce2a8381 input=3126cb3101a2c99b]*/
 {
-    PyObject *raw, *codec_info = NULL;
+    PyObject *raw, *codec_info = NULL, *codec_name = NULL;
     _PyIO_State *state = NULL;
     PyObject *res;
     int r;
@@ -975,6 +1380,17 @@ _io_TextIOWrapper___init___impl(textio *self, PyObject *buffer,
         self->writenl = "\r\n";
 #endif
 
+    /* Get the normalized named of the codec */
+    codec_name = _PyObject_GetAttrId(codec_info, &PyId_name);
+    if (codec_name == NULL) {
+        if (PyErr_ExceptionMatches(PyExc_AttributeError))
+            PyErr_Clear();
+        else
+            goto error;
+    }
+    else if (!PyUnicode_Check(codec_name))
+        Py_CLEAR(codec_name);
+
     /* Build the decoder object */
     res = _PyObject_CallMethodId(buffer, &PyId_readable, NULL);
     if (res == NULL)
@@ -984,10 +1400,17 @@ _io_TextIOWrapper___init___impl(textio *self, PyObject *buffer,
     if (r == -1)
         goto error;
     if (r == 1) {
-        self->decoder = _PyCodecInfo_GetIncrementalDecoder(codec_info,
-                                                           errors);
-        if (self->decoder == NULL)
-            goto error;
+        if (codec_name != NULL) {
+            self->decoder = _PyTextDecoder_New(codec_name, self->errors);
+            if (self->decoder == NULL && PyErr_Occurred())
+                goto error;
+        }
+        if (self->decoder == NULL) {
+            self->decoder = _PyCodecInfo_GetIncrementalDecoder(codec_info,
+                                                               errors);
+            if (self->decoder == NULL)
+                goto error;
+        }
 
         if (self->readuniversal) {
             PyObject *incrementalDecoder = PyObject_CallFunction(
@@ -1012,29 +1435,21 @@ _io_TextIOWrapper___init___impl(textio *self, PyObject *buffer,
                                                            errors);
         if (self->encoder == NULL)
             goto error;
-        /* Get the normalized named of the codec */
-        res = _PyObject_GetAttrId(codec_info, &PyId_name);
-        if (res == NULL) {
-            if (PyErr_ExceptionMatches(PyExc_AttributeError))
-                PyErr_Clear();
-            else
-                goto error;
-        }
-        else if (PyUnicode_Check(res)) {
+        if (codec_name != NULL) {
             encodefuncentry *e = encodefuncs;
             while (e->name != NULL) {
-                if (!PyUnicode_CompareWithASCIIString(res, e->name)) {
+                if (!PyUnicode_CompareWithASCIIString(codec_name, e->name)) {
                     self->encodefunc = e->encodefunc;
                     break;
                 }
                 e++;
             }
         }
-        Py_XDECREF(res);
     }
 
     /* Finished sorting out the codec details */
     Py_CLEAR(codec_info);
+    Py_CLEAR(codec_name);
 
     self->buffer = buffer;
     Py_INCREF(buffer);
@@ -1099,6 +1514,7 @@ _io_TextIOWrapper___init___impl(textio *self, PyObject *buffer,
 
   error:
     Py_XDECREF(codec_info);
+    Py_XDECREF(codec_name);
     return -1;
 }
 
@@ -1440,8 +1856,16 @@ textiowrapper_read_chunk(textio *self, Py_ssize_t size_hint)
          * where the decoder's input buffer is empty.
          */
 
-        PyObject *state = PyObject_CallMethodObjArgs(self->decoder,
-                                                     _PyIO_str_getstate, NULL);
+        PyObject *state;
+        if (Py_TYPE(self->decoder) == &PyIncrementalNewlineDecoder_Type)
+            state = _io_IncrementalNewlineDecoder_getstate_impl(
+                (nldecoder_object *)self->decoder);
+        else if (Py_TYPE(self->decoder) == &_PyTextDecoder_Type)
+            state = _io__TextDecoder_getstate_impl(
+                (textdecoder_object *)self->decoder);
+        else
+            state = PyObject_CallMethodObjArgs(self->decoder,
+                                               _PyIO_str_getstate, NULL);
         if (state == NULL)
             return -1;
         /* Given this, we know there was a valid snapshot point
@@ -1494,6 +1918,9 @@ textiowrapper_read_chunk(textio *self, Py_ssize_t size_hint)
         decoded_chars = _PyIncrementalNewlineDecoder_decode(
             self->decoder, input_chunk, eof);
     }
+    else if (Py_TYPE(self->decoder) == &_PyTextDecoder_Type) {
+        decoded_chars = _PyTextDecoder_Decode(self->decoder, input_chunk, eof);
+    }
     else {
         decoded_chars = PyObject_CallMethodObjArgs(self->decoder,
             _PyIO_str_decode, input_chunk, eof ? Py_True : Py_False, NULL);
@@ -1565,6 +1992,8 @@ _io_TextIOWrapper_read_impl(textio *self, Py_ssize_t n)
         if (Py_TYPE(self->decoder) == &PyIncrementalNewlineDecoder_Type)
             decoded = _PyIncrementalNewlineDecoder_decode(self->decoder,
                                                           bytes, 1);
+        else if (Py_TYPE(self->decoder) == &_PyTextDecoder_Type)
+            decoded = _PyTextDecoder_Decode(self->decoder, bytes, 1);
         else
             decoded = PyObject_CallMethodObjArgs(
                 self->decoder, _PyIO_str_decode, bytes, Py_True, NULL);
@@ -1651,6 +2080,12 @@ find_control_char(int kind, char *s, char *end, Py_UCS4 ch)
         assert(ch < 256);
         return (char *) memchr((void *) s, (char) ch, end - s);
     }
+#ifdef Py_CPU_DISPATCH
+    if (_Py_CPU_HAS(_Py_CPU_AVX2)) {
+        Py_ssize_t i = find_eol_avx2(kind, s, (end - s) / kind, ch, ch);
+        return i < 0 ? NULL : s + i * kind;
+    }
+#endif
     for (;;) {
         while (PyUnicode_READ(kind, s, 0) > ch)
             s += kind;
@@ -1684,6 +2119,20 @@ _PyIO_find_line_ending(
          * The decoder ensures that \r\n are not split in two pieces
          */
         char *s = start;
+#ifdef Py_CPU_DISPATCH
+        if (_Py_CPU_HAS(_Py_CPU_AVX2)) {
+            Py_ssize_t i = find_eol_avx2(kind, start, len, '\r', '\n');
+            if (i < 0) {
+                *consumed = len;
+                return -1;
+            }
+            s = start + i * kind;
+            if (PyUnicode_READ(kind, s, 0) == '\n' ||
+                PyUnicode_READ(kind, s, 1) != '\n')
+                return i + 1;
+            return i + 2;
+        }
+#endif
         for (;;) {
             Py_UCS4 ch;
             /* Fast path for non-control chars. The loop always ends
@@ -1925,6 +2374,105 @@ _io_TextIOWrapper_readline_impl(textio *self, Py_ssize_t size)
     return _textiowrapper_readline(self, size);
 }
 
+/*[clinic input]
+_io.TextIOWrapper.readlines
+    hint: io_ssize_t = -1
+    /
+
+Return a list of lines from the stream.
+
+hint can be specified to control the number of lines read: no more
+lines will be read if the total size (in characters) of all lines so
+far exceeds hint.
+[clinic start generated code]*/
+
+static PyObject *
+_io_TextIOWrapper_readlines_impl(textio *self, Py_ssize_t hint)
+/*[clinic end generated code: output=7f9edfd8c77fdbf8 input=b89917e42434890b]*/
+{
+    PyObject *result, *line;
+    Py_ssize_t length = 0;
+
+    CHECK_ATTACHED(self);
+
+    if (Py_TYPE(self) != &PyTextIOWrapper_Type) {
+        /* readline() may be overridden */
+        return _PyObject_CallMethodId((PyObject *)&PyIOBase_Type,
+                                      &PyId_readlines, "On", self, hint);
+    }
+
+    CHECK_CLOSED(self);
+    if (_textiowrapper_writeflush(self) < 0)
+        return NULL;
+
+    result = PyList_New(0);
+    if (result == NULL)
+        return NULL;
+
+    /* Like iterating over the file, reading all lines disables tell()
+       snapshots until the end of the file */
+    if (hint <= 0)
+        self->telling = 0;
+
+    for (;;) {
+        /* Split the complete lines of the decoded chunk in one go... */
+        if (self->decoded_chars != NULL) {
+            PyObject *chars = self->decoded_chars;
+            int kind = PyUnicode_KIND(chars);
+            char *data = PyUnicode_DATA(chars);
+            Py_ssize_t len = PyUnicode_GET_LENGTH(chars);
+
+            while (self->decoded_chars_used < len) {
+                Py_ssize_t start = self->decoded_chars_used;
+                Py_ssize_t consumed = 0, endpos;
+
+                endpos = _PyIO_find_line_ending(
+                    self->readtranslate, self->readuniversal, self->readnl,
+                    kind, data + kind * start, data + kind * len, &consumed);
+                if (endpos < 0)
+                    break;
+                line = PyUnicode_Substring(chars, start, start + endpos);
+                if (line == NULL)
+                    goto error;
+                if (PyList_Append(result, line) < 0) {
+                    Py_DECREF(line);
+                    goto error;
+                }
+                Py_DECREF(line);
+                self->decoded_chars_used += endpos;
+                length += endpos;
+                if (hint > 0 && length > hint)
+                    return result;
+            }
+        }
+
+        /* ...and let readline() join the line which spans several chunks
+           and decode the next chunk */
+        line = _textiowrapper_readline(self, -1);
+        if (line == NULL)
+            goto error;
+        if (PyUnicode_GET_LENGTH(line) == 0) {
+            /* Reached EOF or would have blocked */
+            Py_DECREF(line);
+            if (hint <= 0)
+                self->telling = self->seekable;
+            return result;
+        }
+        if (PyList_Append(result, line) < 0) {
+            Py_DECREF(line);
+            goto error;
+        }
+        length += PyUnicode_GET_LENGTH(line);
+        Py_DECREF(line);
+        if (hint > 0 && length > hint)
+            return result;
+    }
+
+  error:
+    Py_DECREF(result);
+    return NULL;
+}
+
 /* Seek and Tell */
 
 typedef struct {
@@ -2777,6 +3325,45 @@ textiowrapper_chunk_size_set(textio *self, PyObject *arg, void *context)
 
 #include "clinic/textio.c.h"
 
+static PyMethodDef textdecoder_methods[] = {
+    _IO__TEXTDECODER_DECODE_METHODDEF
+    _IO__TEXTDECODER_GETSTATE_METHODDEF
+    _IO__TEXTDECODER_SETSTATE_METHODDEF
+    _IO__TEXTDECODER_RESET_METHODDEF
+    {NULL}
+};
+
+PyTypeObject _PyTextDecoder_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_io._TextDecoder",         /*tp_name*/
+    sizeof(textdecoder_object), /*tp_basicsize*/
+    0,                          /*tp_itemsize*/
+    (destructor)textdecoder_dealloc, /*tp_dealloc*/
+    0,                          /*tp_print*/
+    0,                          /*tp_getattr*/
+    0,                          /*tp_setattr*/
+    0,                          /*tp_compare */
+    0,                          /*tp_repr*/
+    0,                          /*tp_as_number*/
+    0,                          /*tp_as_sequence*/
+    0,                          /*tp_as_mapping*/
+    0,                          /*tp_hash */
+    0,                          /*tp_call*/
+    0,                          /*tp_str*/
+    0,                          /*tp_getattro*/
+    0,                          /*tp_setattro*/
+    0,                          /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,         /*tp_flags*/
+    0,                          /* tp_doc */
+    0,                          /* tp_traverse */
+    0,                          /* tp_clear */
+    0,                          /* tp_richcompare */
+    0,                          /*tp_weaklistoffset*/
+    0,                          /* tp_iter */
+    0,                          /* tp_iternext */
+    textdecoder_methods,        /* tp_methods */
+};
+
 static PyMethodDef incrementalnewlinedecoder_methods[] = {
     _IO_INCREMENTALNEWLINEDECODER_DECODE_METHODDEF
     _IO_INCREMENTALNEWLINEDECODER_GETSTATE_METHODDEF
@@ -2837,6 +3424,7 @@ static PyMethodDef textiowrapper_methods[] = {
     _IO_TEXTIOWRAPPER_WRITE_METHODDEF
     _IO_TEXTIOWRAPPER_READ_METHODDEF
     _IO_TEXTIOWRAPPER_READLINE_METHODDEF
+    _IO_TEXTIOWRAPPER_READLINES_METHODDEF
     _IO_TEXTIOWRAPPER_FLUSH_METHODDEF
     _IO_TEXTIOWRAPPER_CLOSE_METHODDEF
 
@@ -0,0 +1,717 @@
+/*[clinic input]
+preserve
+[clinic start generated code]*/
+
+PyDoc_STRVAR(_asyncio_Future___init____doc__,
+"Future(*, loop=None)\n"
+"--\n"
+"\n"
+"This class is *almost* compatible with concurrent.futures.Future.\n"
+"\n"
+"    Differences:\n"
+"\n"
+"    - result() and exception() do not take a timeout argument and\n"
+"      raise an exception when the future isn\'t done yet.\n"
+"\n"
+"    - Callbacks registered with add_done_callback() are always called\n"
+"      via the event loop\'s call_soon_threadsafe().\n"
+"\n"
+"    - This class is not compatible with the wait() and as_completed()\n"
+"      methods in the concurrent.futures package.");
+
+static int
+_asyncio_Future___init___impl(FutureObj *self, PyObject *loop);
+
+static int
+_asyncio_Future___init__(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int return_value = -1;
+    static char *_keywords[] = {"loop", NULL};
+    PyObject *loop = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$O:Future", _keywords,
+        &loop))
+        goto exit;
+    return_value = _asyncio_Future___init___impl((FutureObj *)self, loop);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_Future_result__doc__,
+"result($self, /)\n"
+"--\n"
+"\n"
+"Return the result this future represents.\n"
+"\n"
+"If the future has been cancelled, raises CancelledError.  If the\n"
+"future\'s result isn\'t yet available, raises InvalidStateError.  If\n"
+"the future is done and has an exception set, this exception is raised.");
+
+#define _ASYNCIO_FUTURE_RESULT_METHODDEF    \
+    {"result", (PyCFunction)_asyncio_Future_result, METH_NOARGS, _asyncio_Future_result__doc__},
+
+static PyObject *
+_asyncio_Future_result_impl(FutureObj *self);
+
+static PyObject *
+_asyncio_Future_result(FutureObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Future_result_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Future_exception__doc__,
+"exception($self, /)\n"
+"--\n"
+"\n"
+"Return the exception that was set on this future.\n"
+"\n"
+"The exception (or None if no exception was set) is returned only if\n"
+"the future is done.  If the future has been cancelled, raises\n"
+"CancelledError.  If the future isn\'t done yet, raises\n"
+"InvalidStateError.");
+
+#define _ASYNCIO_FUTURE_EXCEPTION_METHODDEF    \
+    {"exception", (PyCFunction)_asyncio_Future_exception, METH_NOARGS, _asyncio_Future_exception__doc__},
+
+static PyObject *
+_asyncio_Future_exception_impl(FutureObj *self);
+
+static PyObject *
+_asyncio_Future_exception(FutureObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Future_exception_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Future_set_result__doc__,
+"set_result($self, res, /)\n"
+"--\n"
+"\n"
+"Mark the future done and set its result.\n"
+"\n"
+"If the future is already done when this method is called, raises\n"
+"InvalidStateError.");
+
+#define _ASYNCIO_FUTURE_SET_RESULT_METHODDEF    \
+    {"set_result", (PyCFunction)_asyncio_Future_set_result, METH_O, _asyncio_Future_set_result__doc__},
+
+PyDoc_STRVAR(_asyncio_Future_set_exception__doc__,
+"set_exception($self, exception, /)\n"
+"--\n"
+"\n"
+"Mark the future done and set an exception.\n"
+"\n"
+"If the future is already done when this method is called, raises\n"
+"InvalidStateError.");
+
+#define _ASYNCIO_FUTURE_SET_EXCEPTION_METHODDEF    \
+    {"set_exception", (PyCFunction)_asyncio_Future_set_exception, METH_O, _asyncio_Future_set_exception__doc__},
+
+PyDoc_STRVAR(_asyncio_Future_add_done_callback__doc__,
+"add_done_callback($self, fn, /)\n"
+"--\n"
+"\n"
+"Add a callback to be run when the future becomes done.\n"
+"\n"
+"The callback is called with a single argument - the future object. If\n"
+"the future is already done when this is called, the callback is\n"
+"scheduled with call_soon.");
+
+#define _ASYNCIO_FUTURE_ADD_DONE_CALLBACK_METHODDEF    \
+    {"add_done_callback", (PyCFunction)_asyncio_Future_add_done_callback, METH_O, _asyncio_Future_add_done_callback__doc__},
+
+PyDoc_STRVAR(_asyncio_Future_remove_done_callback__doc__,
+"remove_done_callback($self, fn, /)\n"
+"--\n"
+"\n"
+"Remove all instances of a callback from the \"call when done\" list.\n"
+"\n"
+"Returns the number of callbacks removed.");
+
+#define _ASYNCIO_FUTURE_REMOVE_DONE_CALLBACK_METHODDEF    \
+    {"remove_done_callback", (PyCFunction)_asyncio_Future_remove_done_callback, METH_O, _asyncio_Future_remove_done_callback__doc__},
+
+PyDoc_STRVAR(_asyncio_Future_cancel__doc__,
+"cancel($self, /)\n"
+"--\n"
+"\n"
+"Cancel the future and schedule callbacks.\n"
+"\n"
+"If the future is already done or cancelled, return False.  Otherwise,\n"
+"change the future\'s state to cancelled, schedule the callbacks and\n"
+"return True.");
+
+#define _ASYNCIO_FUTURE_CANCEL_METHODDEF    \
+    {"cancel", (PyCFunction)_asyncio_Future_cancel, METH_NOARGS, _asyncio_Future_cancel__doc__},
+
+static PyObject *
+_asyncio_Future_cancel_impl(FutureObj *self);
+
+static PyObject *
+_asyncio_Future_cancel(FutureObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Future_cancel_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Future_cancelled__doc__,
+"cancelled($self, /)\n"
+"--\n"
+"\n"
+"Return True if the future was cancelled.");
+
+#define _ASYNCIO_FUTURE_CANCELLED_METHODDEF    \
+    {"cancelled", (PyCFunction)_asyncio_Future_cancelled, METH_NOARGS, _asyncio_Future_cancelled__doc__},
+
+static PyObject *
+_asyncio_Future_cancelled_impl(FutureObj *self);
+
+static PyObject *
+_asyncio_Future_cancelled(FutureObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Future_cancelled_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Future_done__doc__,
+"done($self, /)\n"
+"--\n"
+"\n"
+"Return True if the future is done.\n"
+"\n"
+"Done means either that a result / exception are available, or that the\n"
+"future was cancelled.");
+
+#define _ASYNCIO_FUTURE_DONE_METHODDEF    \
+    {"done", (PyCFunction)_asyncio_Future_done, METH_NOARGS, _asyncio_Future_done__doc__},
+
+static PyObject *
+_asyncio_Future_done_impl(FutureObj *self);
+
+static PyObject *
+_asyncio_Future_done(FutureObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Future_done_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Future__schedule_callbacks__doc__,
+"_schedule_callbacks($self, /)\n"
+"--\n"
+"\n"
+"Internal: Ask the event loop to call all callbacks.\n"
+"\n"
+"The callbacks are scheduled to be called as soon as possible. Also\n"
+"clears the callback list.");
+
+#define _ASYNCIO_FUTURE__SCHEDULE_CALLBACKS_METHODDEF    \
+    {"_schedule_callbacks", (PyCFunction)_asyncio_Future__schedule_callbacks, METH_NOARGS, _asyncio_Future__schedule_callbacks__doc__},
+
+static PyObject *
+_asyncio_Future__schedule_callbacks_impl(FutureObj *self);
+
+static PyObject *
+_asyncio_Future__schedule_callbacks(FutureObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Future__schedule_callbacks_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Future__repr_info__doc__,
+"_repr_info($self, /)\n"
+"--\n"
+"\n");
+
+#define _ASYNCIO_FUTURE__REPR_INFO_METHODDEF    \
+    {"_repr_info", (PyCFunction)_asyncio_Future__repr_info, METH_NOARGS, _asyncio_Future__repr_info__doc__},
+
+static PyObject *
+_asyncio_Future__repr_info_impl(FutureObj *self);
+
+static PyObject *
+_asyncio_Future__repr_info(FutureObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Future__repr_info_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Task___init____doc__,
+"Task(coro, *, loop=None)\n"
+"--\n"
+"\n"
+"A coroutine wrapped in a Future.");
+
+static int
+_asyncio_Task___init___impl(TaskObj *self, PyObject *coro, PyObject *loop);
+
+static int
+_asyncio_Task___init__(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    int return_value = -1;
+    static char *_keywords[] = {"coro", "loop", NULL};
+    PyObject *coro;
+    PyObject *loop = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|$O:Task", _keywords,
+        &coro, &loop))
+        goto exit;
+    return_value = _asyncio_Task___init___impl((TaskObj *)self, coro, loop);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_Task_current_task__doc__,
+"current_task($type, /, loop=None)\n"
+"--\n"
+"\n"
+"Return the currently running task in an event loop or None.\n"
+"\n"
+"By default the current task for the current event loop is returned.\n"
+"\n"
+"None is returned when called not in the context of a Task.");
+
+#define _ASYNCIO_TASK_CURRENT_TASK_METHODDEF    \
+    {"current_task", (PyCFunction)_asyncio_Task_current_task, METH_VARARGS|METH_KEYWORDS|METH_CLASS, _asyncio_Task_current_task__doc__},
+
+static PyObject *
+_asyncio_Task_current_task_impl(PyTypeObject *type, PyObject *loop);
+
+static PyObject *
+_asyncio_Task_current_task(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"loop", NULL};
+    PyObject *loop = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:current_task", _keywords,
+        &loop))
+        goto exit;
+    return_value = _asyncio_Task_current_task_impl(type, loop);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_Task_all_tasks__doc__,
+"all_tasks($type, /, loop=None)\n"
+"--\n"
+"\n"
+"Return a set of all tasks for an event loop.\n"
+"\n"
+"By default all tasks for the current event loop are returned.");
+
+#define _ASYNCIO_TASK_ALL_TASKS_METHODDEF    \
+    {"all_tasks", (PyCFunction)_asyncio_Task_all_tasks, METH_VARARGS|METH_KEYWORDS|METH_CLASS, _asyncio_Task_all_tasks__doc__},
+
+static PyObject *
+_asyncio_Task_all_tasks_impl(PyTypeObject *type, PyObject *loop);
+
+static PyObject *
+_asyncio_Task_all_tasks(PyTypeObject *type, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"loop", NULL};
+    PyObject *loop = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:all_tasks", _keywords,
+        &loop))
+        goto exit;
+    return_value = _asyncio_Task_all_tasks_impl(type, loop);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_Task__repr_info__doc__,
+"_repr_info($self, /)\n"
+"--\n"
+"\n");
+
+#define _ASYNCIO_TASK__REPR_INFO_METHODDEF    \
+    {"_repr_info", (PyCFunction)_asyncio_Task__repr_info, METH_NOARGS, _asyncio_Task__repr_info__doc__},
+
+static PyObject *
+_asyncio_Task__repr_info_impl(TaskObj *self);
+
+static PyObject *
+_asyncio_Task__repr_info(TaskObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Task__repr_info_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Task_cancel__doc__,
+"cancel($self, /)\n"
+"--\n"
+"\n"
+"Request that this task cancel itself.\n"
+"\n"
+"This arranges for a CancelledError to be thrown into the\n"
+"wrapped coroutine on the next cycle through the event loop.\n"
+"The coroutine then has a chance to clean up or even deny\n"
+"the request using try/except/finally.\n"
+"\n"
+"Unlike Future.cancel, this does not guarantee that the\n"
+"task will be cancelled: the exception might be caught and\n"
+"acted upon, delaying cancellation of the task or preventing\n"
+"cancellation completely.  The task may also return a value or\n"
+"raise a different exception.\n"
+"\n"
+"Immediately after this method is called, Task.cancelled() will\n"
+"not return True (unless the task was already cancelled).  A\n"
+"task will be marked as cancelled when the wrapped coroutine\n"
+"terminates with a CancelledError exception (even if cancel()\n"
+"was not called).");
+
+#define _ASYNCIO_TASK_CANCEL_METHODDEF    \
+    {"cancel", (PyCFunction)_asyncio_Task_cancel, METH_NOARGS, _asyncio_Task_cancel__doc__},
+
+static PyObject *
+_asyncio_Task_cancel_impl(TaskObj *self);
+
+static PyObject *
+_asyncio_Task_cancel(TaskObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_Task_cancel_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_Task_get_stack__doc__,
+"get_stack($self, /, *, limit=None)\n"
+"--\n"
+"\n"
+"Return the list of stack frames for this task\'s coroutine.\n"
+"\n"
+"If the coroutine is not done, this returns the stack where it is\n"
+"suspended.  If the coroutine has completed successfully or was\n"
+"cancelled, this returns an empty list.  If the coroutine was\n"
+"terminated by an exception, this returns the list of traceback\n"
+"frames.\n"
+"\n"
+"The frames are always ordered from oldest to newest.\n"
+"\n"
+"The optional limit gives the maximum number of frames to\n"
+"return; by default all available frames are returned.  Its\n"
+"meaning differs depending on whether a stack or a traceback is\n"
+"returned: the newest frames of a stack are returned, but the\n"
+"oldest frames of a traceback are returned.  (This matches the\n"
+"behavior of the traceback module.)\n"
+"\n"
+"For reasons beyond our control, only one stack frame is\n"
+"returned for a suspended coroutine.");
+
+#define _ASYNCIO_TASK_GET_STACK_METHODDEF    \
+    {"get_stack", (PyCFunction)_asyncio_Task_get_stack, METH_VARARGS|METH_KEYWORDS, _asyncio_Task_get_stack__doc__},
+
+static PyObject *
+_asyncio_Task_get_stack_impl(TaskObj *self, PyObject *limit);
+
+static PyObject *
+_asyncio_Task_get_stack(TaskObj *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"limit", NULL};
+    PyObject *limit = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$O:get_stack", _keywords,
+        &limit))
+        goto exit;
+    return_value = _asyncio_Task_get_stack_impl(self, limit);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_Task_print_stack__doc__,
+"print_stack($self, /, *, limit=None, file=None)\n"
+"--\n"
+"\n"
+"Print the stack or traceback for this task\'s coroutine.\n"
+"\n"
+"This produces output similar to that of the traceback module,\n"
+"for the frames retrieved by get_stack().  The limit argument\n"
+"is passed to get_stack().  The file argument is an I/O stream\n"
+"to which the output is written; by default output is written\n"
+"to sys.stderr.");
+
+#define _ASYNCIO_TASK_PRINT_STACK_METHODDEF    \
+    {"print_stack", (PyCFunction)_asyncio_Task_print_stack, METH_VARARGS|METH_KEYWORDS, _asyncio_Task_print_stack__doc__},
+
+static PyObject *
+_asyncio_Task_print_stack_impl(TaskObj *self, PyObject *limit,
+                               PyObject *file);
+
+static PyObject *
+_asyncio_Task_print_stack(TaskObj *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"limit", "file", NULL};
+    PyObject *limit = Py_None;
+    PyObject *file = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|$OO:print_stack", _keywords,
+        &limit, &file))
+        goto exit;
+    return_value = _asyncio_Task_print_stack_impl(self, limit, file);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_Task__step__doc__,
+"_step($self, /, exc=None)\n"
+"--\n"
+"\n");
+
+#define _ASYNCIO_TASK__STEP_METHODDEF    \
+    {"_step", (PyCFunction)_asyncio_Task__step, METH_VARARGS|METH_KEYWORDS, _asyncio_Task__step__doc__},
+
+static PyObject *
+_asyncio_Task__step_impl(TaskObj *self, PyObject *exc);
+
+static PyObject *
+_asyncio_Task__step(TaskObj *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"exc", NULL};
+    PyObject *exc = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:_step", _keywords,
+        &exc))
+        goto exit;
+    return_value = _asyncio_Task__step_impl(self, exc);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_Task__wakeup__doc__,
+"_wakeup($self, /, future)\n"
+"--\n"
+"\n");
+
+#define _ASYNCIO_TASK__WAKEUP_METHODDEF    \
+    {"_wakeup", (PyCFunction)_asyncio_Task__wakeup, METH_VARARGS|METH_KEYWORDS, _asyncio_Task__wakeup__doc__},
+
+static PyObject *
+_asyncio_Task__wakeup_impl(TaskObj *self, PyObject *future);
+
+static PyObject *
+_asyncio_Task__wakeup(TaskObj *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"future", NULL};
+    PyObject *future;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O:_wakeup", _keywords,
+        &future))
+        goto exit;
+    return_value = _asyncio_Task__wakeup_impl(self, future);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio__run_ready__doc__,
+"_run_ready($module, ready, ntodo, /)\n"
+"--\n"
+"\n"
+"Run the ntodo first handles of the ready queue of an event loop.\n"
+"\n"
+"This is the loop of BaseEventLoop._run_once() outside of debug mode:\n"
+"pop the handles from the left of the ready deque and run the ones which\n"
+"are not cancelled.");
+
+#define _ASYNCIO__RUN_READY_METHODDEF    \
+    {"_run_ready", (PyCFunction)_asyncio__run_ready, METH_VARARGS, _asyncio__run_ready__doc__},
+
+static PyObject *
+_asyncio__run_ready_impl(PyModuleDef *module, PyObject *ready,
+                         Py_ssize_t ntodo);
+
+static PyObject *
+_asyncio__run_ready(PyModuleDef *module, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    PyObject *ready;
+    Py_ssize_t ntodo;
+
+    if (!PyArg_ParseTuple(args, "On:_run_ready",
+        &ready, &ntodo))
+        goto exit;
+    return_value = _asyncio__run_ready_impl(module, ready, ntodo);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_extend__doc__,
+"extend($self, data, /)\n"
+"--\n"
+"\n"
+"Append data at the end of the buffer.");
+
+#define _ASYNCIO_STREAMBUFFER_EXTEND_METHODDEF    \
+    {"extend", (PyCFunction)_asyncio_StreamBuffer_extend, METH_O, _asyncio_StreamBuffer_extend__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_extend_impl(StreamBufferObj *self, Py_buffer *data);
+
+static PyObject *
+_asyncio_StreamBuffer_extend(StreamBufferObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_buffer data = {NULL, NULL};
+
+    if (!PyArg_Parse(arg, "y*:extend", &data))
+        goto exit;
+    return_value = _asyncio_StreamBuffer_extend_impl(self, &data);
+
+exit:
+    /* Cleanup for data */
+    if (data.obj)
+       PyBuffer_Release(&data);
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_clear__doc__,
+"clear($self, /)\n"
+"--\n"
+"\n"
+"Remove all the data of the buffer.");
+
+#define _ASYNCIO_STREAMBUFFER_CLEAR_METHODDEF    \
+    {"clear", (PyCFunction)_asyncio_StreamBuffer_clear, METH_NOARGS, _asyncio_StreamBuffer_clear__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_clear_impl(StreamBufferObj *self);
+
+static PyObject *
+_asyncio_StreamBuffer_clear(StreamBufferObj *self, PyObject *Py_UNUSED(ignored))
+{
+    return _asyncio_StreamBuffer_clear_impl(self);
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_find__doc__,
+"find($self, sub, start=0, /)\n"
+"--\n"
+"\n"
+"Return the lowest index of sub in the buffer at or after start, or -1.");
+
+#define _ASYNCIO_STREAMBUFFER_FIND_METHODDEF    \
+    {"find", (PyCFunction)_asyncio_StreamBuffer_find, METH_VARARGS, _asyncio_StreamBuffer_find__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_find_impl(StreamBufferObj *self, Py_buffer *sub,
+                                Py_ssize_t start);
+
+static PyObject *
+_asyncio_StreamBuffer_find(StreamBufferObj *self, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    Py_buffer sub = {NULL, NULL};
+    Py_ssize_t start = 0;
+
+    if (!PyArg_ParseTuple(args, "y*|n:find",
+        &sub, &start))
+        goto exit;
+    return_value = _asyncio_StreamBuffer_find_impl(self, &sub, start);
+
+exit:
+    /* Cleanup for sub */
+    if (sub.obj)
+       PyBuffer_Release(&sub);
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_startswith__doc__,
+"startswith($self, prefix, start=0, /)\n"
+"--\n"
+"\n"
+"Return True if the data of the buffer at start begins with prefix.");
+
+#define _ASYNCIO_STREAMBUFFER_STARTSWITH_METHODDEF    \
+    {"startswith", (PyCFunction)_asyncio_StreamBuffer_startswith, METH_VARARGS, _asyncio_StreamBuffer_startswith__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_startswith_impl(StreamBufferObj *self,
+                                      Py_buffer *prefix, Py_ssize_t start);
+
+static PyObject *
+_asyncio_StreamBuffer_startswith(StreamBufferObj *self, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    Py_buffer prefix = {NULL, NULL};
+    Py_ssize_t start = 0;
+
+    if (!PyArg_ParseTuple(args, "y*|n:startswith",
+        &prefix, &start))
+        goto exit;
+    return_value = _asyncio_StreamBuffer_startswith_impl(self, &prefix, start);
+
+exit:
+    /* Cleanup for prefix */
+    if (prefix.obj)
+       PyBuffer_Release(&prefix);
+
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_consume__doc__,
+"consume($self, n, /)\n"
+"--\n"
+"\n"
+"Remove the first n bytes of the buffer and return them as bytes.");
+
+#define _ASYNCIO_STREAMBUFFER_CONSUME_METHODDEF    \
+    {"consume", (PyCFunction)_asyncio_StreamBuffer_consume, METH_O, _asyncio_StreamBuffer_consume__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_consume_impl(StreamBufferObj *self, Py_ssize_t n);
+
+static PyObject *
+_asyncio_StreamBuffer_consume(StreamBufferObj *self, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t n;
+
+    if (!PyArg_Parse(arg, "n:consume", &n))
+        goto exit;
+    return_value = _asyncio_StreamBuffer_consume_impl(self, n);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(_asyncio_StreamBuffer_readuntil__doc__,
+"readuntil($self, separator, limit, /)\n"
+"--\n"
+"\n"
+"Remove and return the data up to and including the first separator.\n"
+"\n"
+"Return None if the buffer doesn\'t contain separator, or if more than limit\n"
+"bytes precede it.");
+
+#define _ASYNCIO_STREAMBUFFER_READUNTIL_METHODDEF    \
+    {"readuntil", (PyCFunction)_asyncio_StreamBuffer_readuntil, METH_VARARGS, _asyncio_StreamBuffer_readuntil__doc__},
+
+static PyObject *
+_asyncio_StreamBuffer_readuntil_impl(StreamBufferObj *self,
+                                     Py_buffer *separator, Py_ssize_t limit);
+
+static PyObject *
+_asyncio_StreamBuffer_readuntil(StreamBufferObj *self, PyObject *args)
+{
+    PyObject *return_value = NULL;
+    Py_buffer separator = {NULL, NULL};
+    Py_ssize_t limit;
+
+    if (!PyArg_ParseTuple(args, "y*n:readuntil",
+        &separator, &limit))
+        goto exit;
+    return_value = _asyncio_StreamBuffer_readuntil_impl(self, &separator, limit);
+
+exit:
+    /* Cleanup for separator */
+    if (separator.obj)
+       PyBuffer_Release(&separator);
+
+    return return_value;
+}
+/*[clinic end generated code: output=4d74d599cf24f891 input=a9049054013a1b77]*/
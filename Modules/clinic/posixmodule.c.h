@@ -3763,6 +3763,67 @@ exit:
 
 #endif /* defined(HAVE_PWRITE) */
 
+#if defined(HAVE_SPLICE)
+
+PyDoc_STRVAR(os_splice__doc__,
+"splice($module, /, src, dst, count, offset_src=None, offset_dst=None,\n"
+"       flags=0)\n"
+"--\n"
+"\n"
+"Move data between two file descriptors without copying it to user space.\n"
+"\n"
+"  src\n"
+"    Source file descriptor.\n"
+"  dst\n"
+"    Destination file descriptor.\n"
+"  count\n"
+"    Number of bytes to move.\n"
+"  offset_src\n"
+"    Offset to read from in src, or None to use the file position.\n"
+"  offset_dst\n"
+"    Offset to write to in dst, or None to use the file position.\n"
+"  flags\n"
+"    Bitwise OR of the SPLICE_F_* constants.\n"
+"\n"
+"At least one of src and dst must refer to a pipe; the offsets must be\n"
+"None for pipes.  Returns the number of bytes moved, 0 at the end of the\n"
+"input.");
+
+#define OS_SPLICE_METHODDEF    \
+    {"splice", (PyCFunction)os_splice, METH_VARARGS|METH_KEYWORDS, os_splice__doc__},
+
+static Py_ssize_t
+os_splice_impl(PyModuleDef *module, int src, int dst, Py_ssize_t count,
+               PyObject *offset_src, PyObject *offset_dst,
+               unsigned int flags);
+
+static PyObject *
+os_splice(PyModuleDef *module, PyObject *args, PyObject *kwargs)
+{
+    PyObject *return_value = NULL;
+    static char *_keywords[] = {"src", "dst", "count", "offset_src", "offset_dst", "flags", NULL};
+    int src;
+    int dst;
+    Py_ssize_t count;
+    PyObject *offset_src = Py_None;
+    PyObject *offset_dst = Py_None;
+    unsigned int flags = 0;
+    Py_ssize_t _return_value;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "iin|OOI:splice", _keywords,
+        &src, &dst, &count, &offset_src, &offset_dst, &flags))
+        goto exit;
+    _return_value = os_splice_impl(module, src, dst, count, offset_src, offset_dst, flags);
+    if ((_return_value == -1) && PyErr_Occurred())
+        goto exit;
+    return_value = PyLong_FromSsize_t(_return_value);
+
+exit:
+    return return_value;
+}
+
+#endif /* defined(HAVE_SPLICE) */
+
 #if defined(HAVE_MKFIFO)
 
 PyDoc_STRVAR(os_mkfifo__doc__,
@@ -5641,6 +5702,10 @@ exit:
     #define OS_PWRITE_METHODDEF
 #endif /* !defined(OS_PWRITE_METHODDEF) */
 
+#ifndef OS_SPLICE_METHODDEF
+    #define OS_SPLICE_METHODDEF
+#endif /* !defined(OS_SPLICE_METHODDEF) */
+
 #ifndef OS_MKFIFO_METHODDEF
     #define OS_MKFIFO_METHODDEF
 #endif /* !defined(OS_MKFIFO_METHODDEF) */
@@ -5788,4 +5853,4 @@ exit:
 #ifndef OS_SET_HANDLE_INHERITABLE_METHODDEF
     #define OS_SET_HANDLE_INHERITABLE_METHODDEF
 #endif /* !defined(OS_SET_HANDLE_INHERITABLE_METHODDEF) */
-/*[clinic end generated code: output=95824c52fd034654 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=7ce83cf4de4e7cf0 input=a9049054013a1b77]*/
@@ -26,6 +26,12 @@
 #include "Python.h"
 #include "frameobject.h"        /* for PyFrame_ClearFreeList */
 #include "pytime.h"             /* for _PyTime_GetMonotonicClock() */
+#ifdef WITH_THREAD
+#include "pythread.h"           /* for the parallel mark phase */
+#endif
+#ifdef HAVE_SCHED_H
+#include <sched.h>              /* for sched_yield() */
+#endif
 
 /* Get an object's GC head */
 #define AS_GC(o) ((PyGC_Head *)(o)-1)
@@ -158,6 +164,15 @@ static Py_ssize_t long_lived_pending = 0;
    the algorithm was refined in response to issue #14775.
 */
 
+/* Full collections may compute gc_refs using several threads; this needs
+   atomic operations on gc_refs. */
+#if defined(WITH_THREAD) && defined(HAVE_BUILTIN_ATOMIC)
+#define GC_PARALLEL_MARK
+#endif
+
+/* number of threads used to compute gc_refs in full collections */
+static int mark_threads = 1;
+
 /* set for debugging information */
 #define DEBUG_STATS             (1<<0) /* print collection statistics */
 #define DEBUG_COLLECTABLE       (1<<1) /* print collectable objects */
@@ -176,6 +191,9 @@ struct gc_generation_stats {
     Py_ssize_t collected;
     /* total number of uncollectable objects (put into gc.garbage) */
     Py_ssize_t uncollectable;
+    /* total number of objects untracked because they can't be part of
+       a reference cycle */
+    Py_ssize_t untracked;
 };
 
 static struct gc_generation_stats generation_stats[NUM_GENERATIONS];
@@ -332,15 +350,14 @@ append_objects(PyObject *py_list, PyGC_Head *gc_list)
 /*** end of list stuff ***/
 
 
-/* Set all gc_refs = ob_refcnt.  After this, gc_refs is > 0 for all objects
- * in containers, and is GC_REACHABLE for all tracked gc objects not in
- * containers.
+/* Set all gc_refs = ob_refcnt for the objects from start up to (but not
+ * including) end.
  */
 static void
-update_refs(PyGC_Head *containers)
+update_refs_range(PyGC_Head *start, PyGC_Head *end)
 {
-    PyGC_Head *gc = containers->gc.gc_next;
-    for (; gc != containers; gc = gc->gc.gc_next) {
+    PyGC_Head *gc = start;
+    for (; gc != end; gc = gc->gc.gc_next) {
         assert(_PyGCHead_REFS(gc) == GC_REACHABLE);
         _PyGCHead_SET_REFS(gc, Py_REFCNT(FROM_GC(gc)));
         /* Python's cyclic gc should never see an incoming refcount
@@ -365,6 +382,16 @@ update_refs(PyGC_Head *containers)
     }
 }
 
+/* Set all gc_refs = ob_refcnt.  After this, gc_refs is > 0 for all objects
+ * in containers, and is GC_REACHABLE for all tracked gc objects not in
+ * containers.
+ */
+static void
+update_refs(PyGC_Head *containers)
+{
+    update_refs_range(containers->gc.gc_next, containers);
+}
+
 /* A traversal callback for subtract_refs. */
 static int
 visit_decref(PyObject *op, void *data)
@@ -383,6 +410,22 @@ visit_decref(PyObject *op, void *data)
     return 0;
 }
 
+/* Subtract the references held by the objects from start up to (but not
+ * including) end, using visit to decrement gc_refs.
+ */
+static void
+subtract_refs_range(PyGC_Head *start, PyGC_Head *end, visitproc visit)
+{
+    traverseproc traverse;
+    PyGC_Head *gc = start;
+    for (; gc != end; gc=gc->gc.gc_next) {
+        traverse = Py_TYPE(FROM_GC(gc))->tp_traverse;
+        (void) traverse(FROM_GC(gc),
+                       visit,
+                       NULL);
+    }
+}
+
 /* Subtract internal references from gc_refs.  After this, gc_refs is >= 0
  * for all objects in containers, and is GC_REACHABLE for all tracked gc
  * objects not in containers.  The ones with gc_refs > 0 are directly
@@ -391,15 +434,235 @@ visit_decref(PyObject *op, void *data)
 static void
 subtract_refs(PyGC_Head *containers)
 {
-    traverseproc traverse;
-    PyGC_Head *gc = containers->gc.gc_next;
-    for (; gc != containers; gc=gc->gc.gc_next) {
-        traverse = Py_TYPE(FROM_GC(gc))->tp_traverse;
-        (void) traverse(FROM_GC(gc),
-                       (visitproc)visit_decref,
-                       NULL);
+    subtract_refs_range(containers->gc.gc_next, containers,
+                        (visitproc)visit_decref);
+}
+
+#ifdef GC_PARALLEL_MARK
+/*--------------------------------------------------------------------------
+Parallel computation of gc_refs.
+
+In a full collection, update_refs() and subtract_refs() can be split over
+several threads: the generation list is cut into contiguous chunks, and
+each worker first copies the refcounts of its chunk, then (once every chunk
+has been copied) calls tp_traverse on the objects of its chunk.  Since an
+object may be referenced from several chunks, gc_refs is then decremented
+atomically.
+
+The workers never touch the interpreter state: the thread running the
+collection keeps the GIL, so no other thread can mutate objects meanwhile,
+and tp_traverse implementations only read the objects they visit.
+move_unreachable() depends on list order and stays sequential.
+
+The workers are started by gc.set_threads() and sleep between collections.
+A worker about to exit flags it as its very last action, so that its locks
+are freed only once it doesn't use them anymore.
+----------------------------------------------------------------------------
+*/
+
+/* A collection is only split over several threads when every thread gets
+   at least this many objects to process. */
+#define PARALLEL_MARK_MIN_OBJECTS 20000
+
+/* Upper bound for gc.set_threads() */
+#define PARALLEL_MARK_MAX_THREADS 256
+
+/* Tasks of the workers */
+#define MARK_UPDATE 0
+#define MARK_SUBTRACT 1
+#define MARK_QUIT 2
+
+struct mark_worker {
+    PyGC_Head *start;               /* first object of the chunk */
+    PyGC_Head *end;                 /* object after the last one */
+    int task;
+    int exited;                     /* set when the thread is gone */
+    PyThread_type_lock wake;        /* released to hand out the task */
+    PyThread_type_lock done;        /* released when the task is done */
+};
+
+/* The workers helping the thread running the collection */
+static struct mark_worker **mark_pool = NULL;
+static int mark_pool_size = 0;
+
+/* A traversal callback for subtract_refs, when several threads decrement
+   gc_refs concurrently. */
+static int
+visit_decref_atomic(PyObject *op, void *data)
+{
+    assert(op != NULL);
+    if (PyObject_IS_GC(op)) {
+        PyGC_Head *gc = AS_GC(op);
+        Py_ssize_t refs = __atomic_load_n(&gc->gc.gc_refs, __ATOMIC_RELAXED);
+        /* See visit_decref().  Every decrement of an object of the
+           generation is matched by one of the references counted in its
+           refcount, so gc_refs can't drop to zero under our feet. */
+        assert((refs >> _PyGC_REFS_SHIFT) != 0);
+        if ((refs >> _PyGC_REFS_SHIFT) > 0)
+            __atomic_fetch_sub(&gc->gc.gc_refs,
+                               (Py_ssize_t)1 << _PyGC_REFS_SHIFT,
+                               __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+static void
+mark_worker_run(void *arg)
+{
+    struct mark_worker *w = (struct mark_worker *)arg;
+
+    for (;;) {
+        PyThread_acquire_lock(w->wake, WAIT_LOCK);
+        if (w->task == MARK_QUIT)
+            break;
+        if (w->task == MARK_UPDATE)
+            update_refs_range(w->start, w->end);
+        else
+            subtract_refs_range(w->start, w->end, visit_decref_atomic);
+        PyThread_release_lock(w->done);
+    }
+    PyThread_release_lock(w->done);
+    /* w may be freed as soon as this is visible */
+    __atomic_store_n(&w->exited, 1, __ATOMIC_RELEASE);
+}
+
+static void
+mark_worker_free(struct mark_worker *w)
+{
+    if (w->wake)
+        PyThread_free_lock(w->wake);
+    if (w->done)
+        PyThread_free_lock(w->done);
+    PyMem_RawFree(w);
+}
+
+static PyThread_type_lock
+mark_lock_new(void)
+{
+    /* Locks are used as binary semaphores: they start out acquired, and
+       are released by the thread signalling the event. */
+    PyThread_type_lock lock = PyThread_allocate_lock();
+    if (lock != NULL)
+        PyThread_acquire_lock(lock, WAIT_LOCK);
+    return lock;
+}
+
+/* Start or stop workers so that there are n of them.  Return -1 if some
+   workers couldn't be started: the pool is left with the ones which
+   could. */
+static int
+mark_pool_resize(int n)
+{
+    struct mark_worker *w;
+
+    if (n > mark_pool_size) {
+        struct mark_worker **pool;
+        pool = PyMem_RawRealloc(mark_pool, n * sizeof(struct mark_worker *));
+        if (pool == NULL)
+            return -1;
+        mark_pool = pool;
+    }
+    while (mark_pool_size < n) {
+        w = PyMem_RawCalloc(1, sizeof(struct mark_worker));
+        if (w == NULL)
+            return -1;
+        if ((w->wake = mark_lock_new()) == NULL ||
+            (w->done = mark_lock_new()) == NULL ||
+            PyThread_start_new_thread(mark_worker_run, w) == -1) {
+            mark_worker_free(w);
+            return -1;
+        }
+        mark_pool[mark_pool_size++] = w;
+    }
+    while (mark_pool_size > n) {
+        w = mark_pool[--mark_pool_size];
+        w->task = MARK_QUIT;
+        PyThread_release_lock(w->wake);
+        PyThread_acquire_lock(w->done, WAIT_LOCK);
+        while (!__atomic_load_n(&w->exited, __ATOMIC_ACQUIRE)) {
+#ifdef HAVE_SCHED_H
+            sched_yield();
+#endif
+        }
+        mark_worker_free(w);
     }
+    if (n == 0) {
+        PyMem_RawFree(mark_pool);
+        mark_pool = NULL;
+    }
+    return 0;
+}
+
+/* Hand the task to the first n workers and do the first chunk, then wait
+   for the workers to be done. */
+static void
+mark_pool_run(int task, PyGC_Head *start, PyGC_Head *end, int n)
+{
+    int i;
+
+    for (i = 0; i < n; i++) {
+        mark_pool[i]->task = task;
+        PyThread_release_lock(mark_pool[i]->wake);
+    }
+    if (task == MARK_UPDATE)
+        update_refs_range(start, end);
+    else
+        subtract_refs_range(start, end, visit_decref_atomic);
+    for (i = 0; i < n; i++)
+        PyThread_acquire_lock(mark_pool[i]->done, WAIT_LOCK);
+}
+
+/* Same as update_refs(containers) followed by subtract_refs(containers),
+ * using up to nthreads threads (including the current one).  Return 0 on
+ * success, or -1 if the work couldn't be split, in which case nothing has
+ * been done yet.
+ */
+static int
+update_and_subtract_refs_parallel(PyGC_Head *containers, int nthreads)
+{
+    Py_ssize_t size, chunk, i;
+    PyGC_Head *gc, *first_end;
+    int n;
+
+    size = gc_list_size(containers);
+    if (size / PARALLEL_MARK_MIN_OBJECTS < nthreads)
+        nthreads = (int)(size / PARALLEL_MARK_MIN_OBJECTS);
+    /* The workers are missing in a child process, or couldn't all be
+       started */
+    if (mark_pool_size < nthreads - 1)
+        (void)mark_pool_resize(nthreads - 1);
+    if (nthreads > mark_pool_size + 1)
+        nthreads = mark_pool_size + 1;
+    if (nthreads < 2)
+        return -1;
+
+    /* Cut the list into nthreads chunks of (nearly) the same size: the
+       current thread takes the first one. */
+    chunk = size / nthreads;
+    gc = containers->gc.gc_next;
+    for (i = 0; i < chunk; i++)
+        gc = gc->gc.gc_next;
+    first_end = gc;
+    for (n = 0; n < nthreads - 1; n++) {
+        mark_pool[n]->start = gc;
+        if (n == nthreads - 2) {
+            gc = containers;
+        }
+        else {
+            for (i = 0; i < chunk; i++)
+                gc = gc->gc.gc_next;
+        }
+        mark_pool[n]->end = gc;
+    }
+
+    /* Every chunk must be copied before any is subtracted */
+    mark_pool_run(MARK_UPDATE, containers->gc.gc_next, first_end,
+                  nthreads - 1);
+    mark_pool_run(MARK_SUBTRACT, containers->gc.gc_next, first_end,
+                  nthreads - 1);
+    return 0;
 }
+#endif /* GC_PARALLEL_MARK */
 
 /* A traversal callback for move_unreachable. */
 static int
@@ -444,16 +707,40 @@ visit_reachable(PyObject *op, PyGC_Head *reachable)
     return 0;
 }
 
+/* Untrack op if it is a container which can't take part in a reference
+ * cycle: a tuple or frozenset holding only atomic objects, or a split-table
+ * (instance) dict whose values are all atomic.  Split-table dicts are small
+ * and bounded by their shared keys, so checking them on every collection
+ * is cheap, unlike combined-table dicts (see untrack_dicts()).
+ * Return 1 if op was untracked.
+ */
+static int
+untrack_atomic_container(PyObject *op)
+{
+    if (PyTuple_CheckExact(op))
+        _PyTuple_MaybeUntrack(op);
+    else if (PyFrozenSet_CheckExact(op))
+        _PyFrozenSet_MaybeUntrack(op);
+    else if (PyDict_CheckExact(op) &&
+             _PyDict_HasSplitTable((PyDictObject *)op))
+        _PyDict_MaybeUntrack(op);
+    else
+        return 0;
+    return !IS_TRACKED(op);
+}
+
 /* Move the unreachable objects from young to unreachable.  After this,
  * all objects in young have gc_refs = GC_REACHABLE, and all objects in
  * unreachable have gc_refs = GC_TENTATIVELY_UNREACHABLE.  All tracked
  * gc objects not in young or unreachable still have gc_refs = GC_REACHABLE.
  * All objects in young after this are directly or indirectly reachable
  * from outside the original young; and all objects in unreachable are
- * not.
+ * not.  Reachable objects which don't need to be tracked anymore are
+ * untracked on the way, and counted in *n_untracked.
  */
 static void
-move_unreachable(PyGC_Head *young, PyGC_Head *unreachable)
+move_unreachable(PyGC_Head *young, PyGC_Head *unreachable,
+                 Py_ssize_t *n_untracked)
 {
     PyGC_Head *gc = young->gc.gc_next;
 
@@ -486,9 +773,7 @@ move_unreachable(PyGC_Head *young, PyGC_Head *unreachable)
                             (visitproc)visit_reachable,
                             (void *)young);
             next = gc->gc.gc_next;
-            if (PyTuple_CheckExact(op)) {
-                _PyTuple_MaybeUntrack(op);
-            }
+            *n_untracked += untrack_atomic_container(op);
         }
         else {
             /* This *may* be unreachable.  To make progress,
@@ -506,18 +791,25 @@ move_unreachable(PyGC_Head *young, PyGC_Head *unreachable)
     }
 }
 
-/* Try to untrack all currently tracked dictionaries */
-static void
+/* Try to untrack all currently tracked dictionaries.  Return the number
+ * of dictionaries untracked.
+ */
+static Py_ssize_t
 untrack_dicts(PyGC_Head *head)
 {
+    Py_ssize_t n = 0;
     PyGC_Head *next, *gc = head->gc.gc_next;
     while (gc != head) {
         PyObject *op = FROM_GC(gc);
         next = gc->gc.gc_next;
-        if (PyDict_CheckExact(op))
+        if (PyDict_CheckExact(op)) {
             _PyDict_MaybeUntrack(op);
+            if (!IS_TRACKED(op))
+                n++;
+        }
         gc = next;
     }
+    return n;
 }
 
 /* Return true if object has a pre-PEP 442 finalization method. */
@@ -903,6 +1195,7 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
     int i;
     Py_ssize_t m = 0; /* # objects collected */
     Py_ssize_t n = 0; /* # unreachable objects that couldn't be collected */
+    Py_ssize_t u = 0; /* # reachable objects untracked */
     PyGC_Head *young; /* the generation we are examining */
     PyGC_Head *old; /* next older generation */
     PyGC_Head unreachable; /* non-problematic unreachable trash */
@@ -947,8 +1240,14 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
      * refcount greater than 0 when all the references within the
      * set are taken into account).
      */
-    update_refs(young);
-    subtract_refs(young);
+#ifdef GC_PARALLEL_MARK
+    if (generation != NUM_GENERATIONS - 1 || mark_threads < 2 ||
+        update_and_subtract_refs_parallel(young, mark_threads) < 0)
+#endif
+    {
+        update_refs(young);
+        subtract_refs(young);
+    }
 
     /* Leave everything reachable from outside young in young, and move
      * everything else (in young) to unreachable.
@@ -957,7 +1256,7 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
      * so it's more efficient to move the unreachable things.
      */
     gc_list_init(&unreachable);
-    move_unreachable(young, &unreachable);
+    move_unreachable(young, &unreachable, &u);
 
     /* Move reachable objects to next generation. */
     if (young != old) {
@@ -967,9 +1266,9 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
         gc_list_merge(young, old);
     }
     else {
-        /* We only untrack dicts in full collections, to avoid quadratic
-           dict build-up. See issue #14775. */
-        untrack_dicts(young);
+        /* We only untrack combined-table dicts in full collections, to
+           avoid quadratic dict build-up. See issue #14775. */
+        u += untrack_dicts(young);
         long_lived_pending = 0;
         long_lived_total = gc_list_size(young);
     }
@@ -1068,6 +1367,7 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
     stats->collections++;
     stats->collected += m;
     stats->uncollectable += n;
+    stats->untracked += u;
     return n+m;
 }
 
@@ -1276,6 +1576,60 @@ gc_set_thresh(PyObject *self, PyObject *args)
     return Py_None;
 }
 
+PyDoc_STRVAR(gc_set_threads__doc__,
+"set_threads(n) -> None\n"
+"\n"
+"Sets the number of threads used to find unreachable objects in full\n"
+"collections, and starts or stops the helper threads accordingly.\n");
+
+static PyObject *
+gc_set_threads(PyObject *self, PyObject *args)
+{
+    int n;
+    if (!PyArg_ParseTuple(args, "i:set_threads", &n))
+        return NULL;
+    if (n < 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "number of threads must be at least 1");
+        return NULL;
+    }
+#ifdef GC_PARALLEL_MARK
+    if (n > PARALLEL_MARK_MAX_THREADS) {
+        PyErr_Format(PyExc_ValueError,
+                     "number of threads must be at most %d",
+                     PARALLEL_MARK_MAX_THREADS);
+        return NULL;
+    }
+    if (mark_pool_resize(n - 1) < 0) {
+        (void)mark_pool_resize(mark_threads - 1);
+        PyErr_SetString(PyExc_RuntimeError, "can't start new thread");
+        return NULL;
+    }
+#else
+    if (n > 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "parallel collection is not supported on this "
+                        "platform");
+        return NULL;
+    }
+#endif
+    mark_threads = n;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_get_threads__doc__,
+"get_threads() -> n\n"
+"\n"
+"Return the number of threads used in full collections.\n");
+
+static PyObject *
+gc_get_threads(PyObject *self, PyObject *noargs)
+{
+    return PyLong_FromLong(mark_threads);
+}
+
 PyDoc_STRVAR(gc_get_thresh__doc__,
 "get_threshold() -> (threshold0, threshold1, threshold2)\n"
 "\n"
@@ -1425,11 +1779,13 @@ gc_get_stats(PyObject *self, PyObject *noargs)
     int i;
     PyObject *result;
     struct gc_generation_stats stats[NUM_GENERATIONS], *st;
+    Py_ssize_t tracked[NUM_GENERATIONS];
 
     /* To get consistent values despite allocations while constructing
        the result list, we use a snapshot of the running stats. */
     for (i = 0; i < NUM_GENERATIONS; i++) {
         stats[i] = generation_stats[i];
+        tracked[i] = gc_list_size(GEN_HEAD(i));
     }
 
     result = PyList_New(0);
@@ -1439,10 +1795,12 @@ gc_get_stats(PyObject *self, PyObject *noargs)
     for (i = 0; i < NUM_GENERATIONS; i++) {
         PyObject *dict;
         st = &stats[i];
-        dict = Py_BuildValue("{snsnsn}",
+        dict = Py_BuildValue("{snsnsnsnsn}",
                              "collections", st->collections,
                              "collected", st->collected,
-                             "uncollectable", st->uncollectable
+                             "uncollectable", st->uncollectable,
+                             "tracked", tracked[i],
+                             "untracked", st->untracked
                             );
         if (dict == NULL)
             goto error;
@@ -1494,6 +1852,8 @@ PyDoc_STRVAR(gc__doc__,
 "get_debug() -- Get debugging flags.\n"
 "set_threshold() -- Set the collection thresholds.\n"
 "get_threshold() -- Return the current the collection thresholds.\n"
+"set_threads() -- Set the number of threads used in full collections.\n"
+"get_threads() -- Return the number of threads used in full collections.\n"
 "get_objects() -- Return a list of all objects tracked by the collector.\n"
 "is_tracked() -- Returns true if a given object is tracked.\n"
 "get_referrers() -- Return the list of objects that refer to an object.\n"
@@ -1508,6 +1868,8 @@ static PyMethodDef GcMethods[] = {
     {"get_count",          gc_get_count,  METH_NOARGS,  gc_get_count__doc__},
     {"set_threshold",  gc_set_thresh, METH_VARARGS, gc_set_thresh__doc__},
     {"get_threshold",  gc_get_thresh, METH_NOARGS,  gc_get_thresh__doc__},
+    {"set_threads",    gc_set_threads, METH_VARARGS, gc_set_threads__doc__},
+    {"get_threads",    gc_get_threads, METH_NOARGS,  gc_get_threads__doc__},
     {"collect",            (PyCFunction)gc_collect,
         METH_VARARGS | METH_KEYWORDS,           gc_collect__doc__},
     {"get_objects",    gc_get_objects,METH_NOARGS,  gc_get_objects__doc__},
@@ -1608,6 +1970,25 @@ _PyGC_CollectNoFail(void)
     return n;
 }
 
+/* Call visit() on every object tracked by the collector, and stop if it
+   returns non-zero.  visit() must not track, untrack or deallocate
+   tracked objects. */
+int
+_PyGC_VisitTracked(visitproc visit, void *arg)
+{
+    int i, res;
+    PyGC_Head *gc;
+
+    for (i = 0; i < NUM_GENERATIONS; i++) {
+        for (gc = GEN_HEAD(i)->gc.gc_next; gc != GEN_HEAD(i);
+             gc = gc->gc.gc_next) {
+            if ((res = visit(FROM_GC(gc), arg)) != 0)
+                return res;
+        }
+    }
+    return 0;
+}
+
 void
 _PyGC_DumpShutdownStats(void)
 {
@@ -1648,6 +2029,21 @@ void
 _PyGC_Fini(void)
 {
     Py_CLEAR(callbacks);
+#ifdef GC_PARALLEL_MARK
+    (void)mark_pool_resize(0);
+#endif
+}
+
+/* Called in the child process by PyOS_AfterFork() */
+void
+_PyGC_AfterFork(void)
+{
+#ifdef GC_PARALLEL_MARK
+    /* The workers don't exist in this process and their locks may be held:
+       forget them, the next full collection starts new ones */
+    mark_pool = NULL;
+    mark_pool_size = 0;
+#endif
 }
 
 /* for debugging */
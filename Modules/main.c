@@ -100,6 +100,8 @@ PYTHONHASHSEED: if this variable is set to 'random', a random value is used\n\
    to seed the hashes of str, bytes and datetime objects.  It can also be\n\
    set to an integer in the range [0,4294967295] to get hash values with a\n\
    predictable seed.\n\
+PYTHONHASHALGORITHM: hash algorithm of str, bytes and memoryview objects:\n\
+   siphash24, siphash13 or fnv (default: chosen at build time).\n\
 ";
 
 static int
@@ -8654,6 +8654,69 @@ os_pwrite_impl(PyModuleDef *module, int fd, Py_buffer *buffer,
 #endif /* HAVE_PWRITE */
 
 
+#ifdef HAVE_SPLICE
+/*[clinic input]
+os.splice -> Py_ssize_t
+
+    src: int
+        Source file descriptor.
+    dst: int
+        Destination file descriptor.
+    count: Py_ssize_t
+        Number of bytes to move.
+    offset_src: object = None
+        Offset to read from in src, or None to use the file position.
+    offset_dst: object = None
+        Offset to write to in dst, or None to use the file position.
+    flags: unsigned_int(bitwise=True) = 0
+        Bitwise OR of the SPLICE_F_* constants.
+
+Move data between two file descriptors without copying it to user space.
+
+At least one of src and dst must refer to a pipe; the offsets must be
+None for pipes.  Returns the number of bytes moved, 0 at the end of the
+input.
+[clinic start generated code]*/
+
+static Py_ssize_t
+os_splice_impl(PyModuleDef *module, int src, int dst, Py_ssize_t count,
+               PyObject *offset_src, PyObject *offset_dst,
+               unsigned int flags)
+/*[clinic end generated code: output=fb850411404e0048 input=59ce343834441860]*/
+{
+    Py_off_t off_src, off_dst;
+    Py_off_t *p_offset_src = NULL, *p_offset_dst = NULL;
+    Py_ssize_t result;
+    int async_err = 0;
+
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "count must not be negative");
+        return -1;
+    }
+    if (offset_src != Py_None) {
+        if (!Py_off_t_converter(offset_src, &off_src))
+            return -1;
+        p_offset_src = &off_src;
+    }
+    if (offset_dst != Py_None) {
+        if (!Py_off_t_converter(offset_dst, &off_dst))
+            return -1;
+        p_offset_dst = &off_dst;
+    }
+
+    do {
+        Py_BEGIN_ALLOW_THREADS
+        result = splice(src, p_offset_src, dst, p_offset_dst, count, flags);
+        Py_END_ALLOW_THREADS
+    } while (result < 0 && errno == EINTR && !(async_err = PyErr_CheckSignals()));
+
+    if (result < 0 && !async_err)
+        posix_error();
+    return result;
+}
+#endif /* HAVE_SPLICE */
+
+
 #ifdef HAVE_MKFIFO
 /*[clinic input]
 os.mkfifo
@@ -12300,6 +12363,7 @@ static PyMethodDef posix_methods[] = {
     OS_WRITE_METHODDEF
     OS_WRITEV_METHODDEF
     OS_PWRITE_METHODDEF
+    OS_SPLICE_METHODDEF
 #ifdef HAVE_SENDFILE
     {"sendfile",        (PyCFunction)posix_sendfile, METH_VARARGS | METH_KEYWORDS,
                             posix_sendfile__doc__},
@@ -12681,6 +12745,17 @@ all_ins(PyObject *m)
     if (PyModule_AddIntMacro(m, SF_SYNC)) return -1;
 #endif
 
+    /* constants for splice */
+#ifdef SPLICE_F_MOVE
+    if (PyModule_AddIntMacro(m, SPLICE_F_MOVE)) return -1;
+#endif
+#ifdef SPLICE_F_NONBLOCK
+    if (PyModule_AddIntMacro(m, SPLICE_F_NONBLOCK)) return -1;
+#endif
+#ifdef SPLICE_F_MORE
+    if (PyModule_AddIntMacro(m, SPLICE_F_MORE)) return -1;
+#endif
+
     /* constants for posix_fadvise */
 #ifdef POSIX_FADV_NORMAL
     if (PyModule_AddIntMacro(m, POSIX_FADV_NORMAL)) return -1;
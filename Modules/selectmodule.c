@@ -1220,6 +1220,9 @@ static int select_have_broken_poll(void)
 typedef struct {
     PyObject_HEAD
     SOCKET epfd;                        /* epoll control file descriptor */
+    struct epoll_event *evs;            /* events buffer reused by poll() */
+    int nevs;                           /* size of evs */
+    int evs_busy;                       /* evs is used by another thread */
 } pyEpoll_Object;
 
 static PyTypeObject pyEpoll_Type;
@@ -1310,6 +1313,7 @@ static void
 pyepoll_dealloc(pyEpoll_Object *self)
 {
     (void)pyepoll_internal_close(self);
+    PyMem_Free(self->evs);
     Py_TYPE(self)->tp_free(self);
 }
 
@@ -1482,33 +1486,1360 @@ PyDoc_STRVAR(pyepoll_unregister_doc,
 \n\
 fd is the target file descriptor of the operation.");
 
+/* Wait for up to maxevents events with epoll_wait().  The events are
+   stored in the buffer of the epoll object, which is allocated once and
+   reused by the next calls, or in a temporary buffer if another thread is
+   already polling.  Return the number of events and set *pevs, or return
+   -1 with an exception set.  The caller must pass *pevs to
+   pyepoll_release_events(). */
+static int
+pyepoll_internal_wait(pyEpoll_Object *self, PyObject *timeout_obj,
+                      int maxevents, struct epoll_event **pevs)
+{
+    int nfds;
+    struct epoll_event *evs;
+    _PyTime_t timeout, ms, deadline;
+
+    if (self->epfd < 0) {
+        pyepoll_err_closed();
+        return -1;
+    }
+
+    if (timeout_obj == NULL || timeout_obj == Py_None) {
+        timeout = -1;
+        ms = -1;
+        deadline = 0;   /* initialize to prevent gcc warning */
+    }
+    else {
+        /* epoll_wait() has a resolution of 1 millisecond, round towards
+           infinity to wait at least timeout seconds. */
+        if (_PyTime_FromSecondsObject(&timeout, timeout_obj,
+                                      _PyTime_ROUND_CEILING) < 0) {
+            if (PyErr_ExceptionMatches(PyExc_TypeError)) {
+                PyErr_SetString(PyExc_TypeError,
+                                "timeout must be an integer or None");
+            }
+            return -1;
+        }
+
+        ms = _PyTime_AsMilliseconds(timeout, _PyTime_ROUND_CEILING);
+        if (ms < INT_MIN || ms > INT_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "timeout is too large");
+            return -1;
+        }
+
+        deadline = _PyTime_GetMonotonicClock() + timeout;
+    }
+
+    if (maxevents == -1) {
+        maxevents = FD_SETSIZE-1;
+    }
+    else if (maxevents < 1) {
+        PyErr_Format(PyExc_ValueError,
+                     "maxevents must be greater than 0, got %d",
+                     maxevents);
+        return -1;
+    }
+
+    if (self->evs_busy) {
+        /* The buffer is used by a thread blocked in epoll_wait() */
+        evs = PyMem_New(struct epoll_event, maxevents);
+    }
+    else {
+        evs = self->evs;
+        if (self->nevs < maxevents) {
+            PyMem_Resize(evs, struct epoll_event, maxevents);
+            if (evs != NULL) {
+                self->evs = evs;
+                self->nevs = maxevents;
+            }
+        }
+    }
+    if (evs == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (evs == self->evs)
+        self->evs_busy = 1;
+    *pevs = evs;
+
+    do {
+        Py_BEGIN_ALLOW_THREADS
+        errno = 0;
+        nfds = epoll_wait(self->epfd, evs, maxevents, (int)ms);
+        Py_END_ALLOW_THREADS
+
+        if (errno != EINTR)
+            break;
+
+        /* poll() was interrupted by a signal */
+        if (PyErr_CheckSignals())
+            return -1;
+
+        if (timeout >= 0) {
+            timeout = deadline - _PyTime_GetMonotonicClock();
+            if (timeout < 0) {
+                nfds = 0;
+                break;
+            }
+            ms = _PyTime_AsMilliseconds(timeout, _PyTime_ROUND_CEILING);
+            /* retry epoll_wait() with the recomputed timeout */
+        }
+    } while(1);
+
+    if (nfds < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        return -1;
+    }
+    return nfds;
+}
+
+static void
+pyepoll_release_events(pyEpoll_Object *self, struct epoll_event *evs)
+{
+    if (evs == NULL)
+        return;
+    if (evs == self->evs)
+        self->evs_busy = 0;
+    else
+        PyMem_Free(evs);
+}
+
+static PyObject *
+pyepoll_poll(pyEpoll_Object *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"timeout", "maxevents", NULL};
+    PyObject *timeout_obj = NULL;
+    int maxevents = -1;
+    int nfds, i;
+    PyObject *elist = NULL, *etuple = NULL;
+    struct epoll_event *evs = NULL;
+
+    if (self->epfd < 0)
+        return pyepoll_err_closed();
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oi:poll", kwlist,
+                                     &timeout_obj, &maxevents)) {
+        return NULL;
+    }
+
+    nfds = pyepoll_internal_wait(self, timeout_obj, maxevents, &evs);
+    if (nfds < 0)
+        goto error;
+
+    elist = PyList_New(nfds);
+    if (elist == NULL) {
+        goto error;
+    }
+
+    for (i = 0; i < nfds; i++) {
+        etuple = Py_BuildValue("iI", evs[i].data.fd, evs[i].events);
+        if (etuple == NULL) {
+            Py_CLEAR(elist);
+            goto error;
+        }
+        PyList_SET_ITEM(elist, i, etuple);
+    }
+
+    error:
+    pyepoll_release_events(self, evs);
+    return elist;
+}
+
+PyDoc_STRVAR(pyepoll_poll_doc,
+"poll([timeout=-1[, maxevents=-1]]) -> [(fd, events), (...)]\n\
+\n\
+Wait for events on the epoll file descriptor for a maximum time of timeout\n\
+in seconds (as float). -1 makes poll wait indefinitely.\n\
+Up to maxevents are returned to the caller.");
+
+static PyObject *
+pyepoll_poll_into(pyEpoll_Object *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"buffer", "timeout", NULL};
+    PyObject *timeout_obj = NULL;
+    Py_buffer pbuf;
+    Py_ssize_t maxevents;
+    unsigned int *out;
+    int nfds, i;
+    struct epoll_event *evs = NULL;
+
+    if (self->epfd < 0)
+        return pyepoll_err_closed();
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "w*|O:poll_into", kwlist,
+                                     &pbuf, &timeout_obj)) {
+        return NULL;
+    }
+
+    maxevents = pbuf.len / (2 * sizeof(unsigned int));
+    if (maxevents < 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "buffer is too small to store one event");
+        goto error;
+    }
+    if (maxevents > INT_MAX)
+        maxevents = INT_MAX;
+
+    nfds = pyepoll_internal_wait(self, timeout_obj, (int)maxevents, &evs);
+    if (nfds < 0)
+        goto error;
+
+    out = (unsigned int *)pbuf.buf;
+    for (i = 0; i < nfds; i++) {
+        /* the buffer is not always aligned, e.g. a bytearray slice */
+        unsigned int pair[2];
+        pair[0] = (unsigned int)evs[i].data.fd;
+        pair[1] = evs[i].events;
+        memcpy(out + 2 * i, pair, sizeof(pair));
+    }
+    pyepoll_release_events(self, evs);
+    PyBuffer_Release(&pbuf);
+    return PyLong_FromLong(nfds);
+
+error:
+    pyepoll_release_events(self, evs);
+    PyBuffer_Release(&pbuf);
+    return NULL;
+}
+
+PyDoc_STRVAR(pyepoll_poll_into_doc,
+"poll_into(buffer[, timeout=-1]) -> int\n\
+\n\
+Like poll(), but store the events into the writable buffer instead of\n\
+creating a list.  Each event is stored as a pair of C unsigned int: the\n\
+file descriptor followed by the event mask, so that an array.array('I')\n\
+can be reused by each call.  Up to len(buffer) // 2 events are stored.\n\
+Return the number of events.");
+
+/* Values of selectors.EVENT_READ and selectors.EVENT_WRITE */
+#define SELECTOR_EVENT_READ (1 << 0)
+#define SELECTOR_EVENT_WRITE (1 << 1)
+
+static PyObject *
+pyepoll_select(pyEpoll_Object *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"keys", "timeout", "maxevents", NULL};
+    _Py_IDENTIFIER(events);
+    PyObject *keys, *timeout_obj = NULL;
+    int maxevents = -1;
+    int nfds, i;
+    PyObject *ready = NULL;
+    struct epoll_event *evs = NULL;
+
+    if (self->epfd < 0)
+        return pyepoll_err_closed();
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|Oi:select", kwlist,
+                                     &PyDict_Type, &keys,
+                                     &timeout_obj, &maxevents)) {
+        return NULL;
+    }
+
+    nfds = pyepoll_internal_wait(self, timeout_obj, maxevents, &evs);
+    if (nfds < 0)
+        goto error;
+
+    ready = PyList_New(0);
+    if (ready == NULL)
+        goto error;
+
+    for (i = 0; i < nfds; i++) {
+        PyObject *fd, *key, *key_events, *item;
+        uint32_t event = evs[i].events;
+        long events = 0, mask;
+
+        fd = PyLong_FromLong(evs[i].data.fd);
+        if (fd == NULL)
+            goto error;
+        key = PyDict_GetItemWithError(keys, fd);
+        Py_DECREF(fd);
+        if (key == NULL) {
+            if (PyErr_Occurred())
+                goto error;
+            /* the file descriptor is not registered in the selector */
+            continue;
+        }
+
+        if (PyTuple_Check(key) && PyTuple_GET_SIZE(key) > 2) {
+            /* fast path for SelectorKey */
+            key_events = PyTuple_GET_ITEM(key, 2);
+            Py_INCREF(key_events);
+        }
+        else {
+            key_events = _PyObject_GetAttrId(key, &PyId_events);
+            if (key_events == NULL)
+                goto error;
+        }
+        mask = PyLong_AsLong(key_events);
+        Py_DECREF(key_events);
+        if (mask == -1 && PyErr_Occurred())
+            goto error;
+
+        if (event & ~EPOLLIN)
+            events |= SELECTOR_EVENT_WRITE;
+        if (event & ~EPOLLOUT)
+            events |= SELECTOR_EVENT_READ;
+
+        item = Py_BuildValue("(Ol)", key, events & mask);
+        if (item == NULL)
+            goto error;
+        if (PyList_Append(ready, item) < 0) {
+            Py_DECREF(item);
+            goto error;
+        }
+        Py_DECREF(item);
+    }
+    pyepoll_release_events(self, evs);
+    return ready;
+
+error:
+    Py_XDECREF(ready);
+    pyepoll_release_events(self, evs);
+    return NULL;
+}
+
+PyDoc_STRVAR(pyepoll_select_doc,
+"select(keys[, timeout=-1[, maxevents=-1]]) -> [(key, events), (...)]\n\
+\n\
+Like poll(), but return the ready keys of a selectors.EpollSelector.\n\
+keys is a dict mapping registered file descriptors to selectors.SelectorKey\n\
+objects.  events is a mask of selectors.EVENT_READ and\n\
+selectors.EVENT_WRITE, restricted to the events of the key.  File\n\
+descriptors missing from keys are skipped.");
+
+static PyObject *
+pyepoll_enter(pyEpoll_Object *self, PyObject *args)
+{
+    if (self->epfd < 0)
+        return pyepoll_err_closed();
+
+    Py_INCREF(self);
+    return (PyObject *)self;
+}
+
+static PyObject *
+pyepoll_exit(PyObject *self, PyObject *args)
+{
+    _Py_IDENTIFIER(close);
+
+    return _PyObject_CallMethodId(self, &PyId_close, NULL);
+}
+
+static PyMethodDef pyepoll_methods[] = {
+    {"fromfd",          (PyCFunction)pyepoll_fromfd,
+     METH_VARARGS | METH_CLASS, pyepoll_fromfd_doc},
+    {"close",           (PyCFunction)pyepoll_close,     METH_NOARGS,
+     pyepoll_close_doc},
+    {"fileno",          (PyCFunction)pyepoll_fileno,    METH_NOARGS,
+     pyepoll_fileno_doc},
+    {"modify",          (PyCFunction)pyepoll_modify,
+     METH_VARARGS | METH_KEYWORDS,      pyepoll_modify_doc},
+    {"register",        (PyCFunction)pyepoll_register,
+     METH_VARARGS | METH_KEYWORDS,      pyepoll_register_doc},
+    {"unregister",      (PyCFunction)pyepoll_unregister,
+     METH_VARARGS | METH_KEYWORDS,      pyepoll_unregister_doc},
+    {"poll",            (PyCFunction)pyepoll_poll,
+     METH_VARARGS | METH_KEYWORDS,      pyepoll_poll_doc},
+    {"poll_into",       (PyCFunction)pyepoll_poll_into,
+     METH_VARARGS | METH_KEYWORDS,      pyepoll_poll_into_doc},
+    {"select",          (PyCFunction)pyepoll_select,
+     METH_VARARGS | METH_KEYWORDS,      pyepoll_select_doc},
+    {"__enter__",           (PyCFunction)pyepoll_enter,     METH_NOARGS,
+     NULL},
+    {"__exit__",           (PyCFunction)pyepoll_exit,     METH_VARARGS,
+     NULL},
+    {NULL,      NULL},
+};
+
+static PyGetSetDef pyepoll_getsetlist[] = {
+    {"closed", (getter)pyepoll_get_closed, NULL,
+     "True if the epoll handler is closed"},
+    {0},
+};
+
+PyDoc_STRVAR(pyepoll_doc,
+"select.epoll(sizehint=-1, flags=0)\n\
+\n\
+Returns an epolling object\n\
+\n\
+sizehint must be a positive integer or -1 for the default size. The\n\
+sizehint is used to optimize internal data structures. It doesn't limit\n\
+the maximum number of monitored events.");
+
+static PyTypeObject pyEpoll_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "select.epoll",                                     /* tp_name */
+    sizeof(pyEpoll_Object),                             /* tp_basicsize */
+    0,                                                  /* tp_itemsize */
+    (destructor)pyepoll_dealloc,                        /* tp_dealloc */
+    0,                                                  /* tp_print */
+    0,                                                  /* tp_getattr */
+    0,                                                  /* tp_setattr */
+    0,                                                  /* tp_reserved */
+    0,                                                  /* tp_repr */
+    0,                                                  /* tp_as_number */
+    0,                                                  /* tp_as_sequence */
+    0,                                                  /* tp_as_mapping */
+    0,                                                  /* tp_hash */
+    0,                                                  /* tp_call */
+    0,                                                  /* tp_str */
+    PyObject_GenericGetAttr,                            /* tp_getattro */
+    0,                                                  /* tp_setattro */
+    0,                                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                                 /* tp_flags */
+    pyepoll_doc,                                        /* tp_doc */
+    0,                                                  /* tp_traverse */
+    0,                                                  /* tp_clear */
+    0,                                                  /* tp_richcompare */
+    0,                                                  /* tp_weaklistoffset */
+    0,                                                  /* tp_iter */
+    0,                                                  /* tp_iternext */
+    pyepoll_methods,                                    /* tp_methods */
+    0,                                                  /* tp_members */
+    pyepoll_getsetlist,                                 /* tp_getset */
+    0,                                                  /* tp_base */
+    0,                                                  /* tp_dict */
+    0,                                                  /* tp_descr_get */
+    0,                                                  /* tp_descr_set */
+    0,                                                  /* tp_dictoffset */
+    0,                                                  /* tp_init */
+    0,                                                  /* tp_alloc */
+    pyepoll_new,                                        /* tp_new */
+    0,                                                  /* tp_free */
+};
+
+#endif /* HAVE_EPOLL */
+
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+/* IORING_FEAT_EXT_ARG (Linux 5.11) is needed to wait with a timeout */
+#if defined(__NR_io_uring_setup) && defined(IORING_FEAT_EXT_ARG)
+#define HAVE_IO_URING
+#endif
+#endif
+
+#ifdef HAVE_IO_URING
+/* **************************************************************************
+ *                      io_uring interface for Linux 5.11+
+ *
+ * The submission and completion queues are shared with the kernel: the
+ * methods queuing an operation fill a submission queue entry, and wait()
+ * submits the queued entries and reaps the completion queue entries with
+ * a single io_uring_enter() system call.
+ */
+
+typedef struct {
+    PyObject_HEAD
+    int ring_fd;                        /* io_uring file descriptor */
+    unsigned int features;
+    /* submission queue */
+    void *sq_ring;
+    size_t sq_ring_size;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int sq_mask;
+    unsigned int sq_entries;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned int to_submit;             /* entries queued, not submitted */
+    /* completion queue */
+    void *cq_ring;
+    size_t cq_ring_size;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int cq_mask;
+    struct io_uring_cqe *cqes;
+    /* user_data => memoryview, registered buffer index (or None) of the
+       operations in flight */
+    PyObject *pending;
+    /* registered buffers */
+    Py_buffer *fixed;
+    Py_ssize_t nfixed;
+    Py_ssize_t fixed_pending;           /* operations in flight on them */
+    /* threads in a system call on the ring with the GIL released */
+    int busy;
+} pyIoUring_Object;
+
+static PyTypeObject pyIoUring_Type;
+
+#define ring_load_acquire(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ring_store_release(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static PyObject *
+pyiouring_err_closed(void)
+{
+    PyErr_SetString(PyExc_ValueError,
+                    "I/O operation on closed io_uring object");
+    return NULL;
+}
+
+static void
+pyiouring_release_fixed(pyIoUring_Object *self)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < self->nfixed; i++)
+        PyBuffer_Release(&self->fixed[i]);
+    PyMem_Free(self->fixed);
+    self->fixed = NULL;
+    self->nfixed = 0;
+}
+
+/* Forget the operation user_data, which completed, and release its
+   buffer.  Return -1 with an exception set on error. */
+static int
+pyiouring_complete(pyIoUring_Object *self, PyObject *user_data)
+{
+    PyObject *buffer = PyDict_GetItem(self->pending, user_data);
+
+    if (buffer == NULL)
+        return 0;
+    if (PyLong_CheckExact(buffer))
+        self->fixed_pending--;
+    return PyDict_DelItem(self->pending, user_data);
+}
+
+/* Submit the queued entries and, if wait_ms is positive, wait up to
+   wait_ms milliseconds for a completion.  Used by close(): EINTR is
+   retried without running the signal handlers.  Return -1 on timeout or
+   error, without setting an exception. */
+static int
+pyiouring_enter_closing(pyIoUring_Object *self, int ring_fd, int wait_ms)
+{
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    int ret;
+
+    memset(&arg, 0, sizeof(arg));
+    ts.tv_sec = wait_ms / 1000;
+    ts.tv_nsec = (wait_ms % 1000) * 1000000L;
+    arg.ts = (__u64)(uintptr_t)&ts;
+    do {
+        Py_BEGIN_ALLOW_THREADS
+        ret = (int)syscall(__NR_io_uring_enter, ring_fd,
+                           self->to_submit, wait_ms > 0 ? 1 : 0,
+                           IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                           &arg, sizeof(arg));
+        Py_END_ALLOW_THREADS
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 0)
+        return -1;
+    self->to_submit -= Py_MIN((unsigned int)ret, self->to_submit);
+    return 0;
+}
+
+/* Reap the available completions of the operations in flight, ignoring
+   those of the cancellations queued by pyiouring_cancel_all() */
+static void
+pyiouring_reap_closing(pyIoUring_Object *self, unsigned long long cancel_data)
+{
+    unsigned int head = *self->cq_head;
+    unsigned int tail = ring_load_acquire(self->cq_tail);
+
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = &self->cqes[head & self->cq_mask];
+        PyObject *user_data;
+
+        if (cqe->user_data == cancel_data || (cqe->flags & IORING_CQE_F_MORE))
+            continue;
+        user_data = PyLong_FromUnsignedLongLong(cqe->user_data);
+        if (user_data == NULL || pyiouring_complete(self, user_data) < 0)
+            PyErr_Clear();
+        Py_XDECREF(user_data);
+    }
+    ring_store_release(self->cq_head, head);
+}
+
+/* Number of times the cancellation of the operations in flight is
+   attempted by close(), and how long their completions are waited for */
+#define IOURING_CANCEL_ROUNDS 50
+#define IOURING_CANCEL_WAIT_MS 100
+
+/* Cancel the operations in flight and reap all their completions: the
+   kernel may access their buffers until they complete, even after the
+   ring is closed.  Return -1 if some operations could not be reaped. */
+static int
+pyiouring_cancel_all(pyIoUring_Object *self, int ring_fd)
+{
+    PyObject *exc, *val, *tb, *key, *value;
+    unsigned long long cancel_data = PY_ULLONG_MAX;
+    Py_ssize_t pos;
+    int round, res = 0;
+
+    if (PyDict_Size(self->pending) == 0)
+        return 0;
+    PyErr_Fetch(&exc, &val, &tb);
+    /* The user_data of the cancellations must not be used by an operation
+       in flight */
+    while (1) {
+        PyObject *obj = PyLong_FromUnsignedLongLong(cancel_data);
+
+        if (obj == NULL) {
+            res = -1;
+            goto done;
+        }
+        value = PyDict_GetItem(self->pending, obj);
+        Py_DECREF(obj);
+        if (value == NULL)
+            break;
+        cancel_data--;
+    }
+
+    for (round = 0; round < IOURING_CANCEL_ROUNDS; round++) {
+        /* Queue a cancellation of each operation in flight, after the
+           entries which were not submitted yet */
+        pos = 0;
+        while (PyDict_Next(self->pending, &pos, &key, &value)) {
+            unsigned int tail = *self->sq_tail;
+            struct io_uring_sqe *sqe;
+
+            if (tail - ring_load_acquire(self->sq_head) >= self->sq_entries) {
+                if (pyiouring_enter_closing(self, ring_fd, 0) < 0 ||
+                    tail - ring_load_acquire(self->sq_head) >=
+                        self->sq_entries)
+                    break;
+            }
+            sqe = &self->sqes[tail & self->sq_mask];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->addr = PyLong_AsUnsignedLongLong(key);
+            sqe->user_data = cancel_data;
+            ring_store_release(self->sq_tail, tail + 1);
+            self->to_submit++;
+        }
+        /* An operation which was already running may take a while to
+           complete; cancel the remaining ones again if none completes */
+        while (PyDict_Size(self->pending) > 0) {
+            if (ring_load_acquire(self->cq_tail) == *self->cq_head &&
+                pyiouring_enter_closing(self, ring_fd,
+                                        IOURING_CANCEL_WAIT_MS) < 0)
+                break;
+            pyiouring_reap_closing(self, cancel_data);
+        }
+        if (PyDict_Size(self->pending) == 0)
+            goto done;
+    }
+    res = -1;
+
+done:
+    PyErr_Restore(exc, val, tb);
+    return res;
+}
+
+static int
+pyiouring_internal_close(pyIoUring_Object *self)
+{
+    int save_errno = 0, cancelled = 1;
+    int ring_fd = self->ring_fd;
+
+    /* The other threads see the ring closed while the operations are
+       cancelled with the GIL released */
+    self->ring_fd = -1;
+    if (ring_fd >= 0 && self->cqes != NULL && self->pending != NULL)
+        cancelled = (pyiouring_cancel_all(self, ring_fd) == 0);
+    if (self->sqes != NULL)
+        munmap(self->sqes, self->sqes_size);
+    if (self->cq_ring != NULL && self->cq_ring != self->sq_ring)
+        munmap(self->cq_ring, self->cq_ring_size);
+    if (self->sq_ring != NULL)
+        munmap(self->sq_ring, self->sq_ring_size);
+    self->sqes = NULL;
+    self->cq_ring = NULL;
+    self->sq_ring = NULL;
+    if (ring_fd >= 0) {
+        Py_BEGIN_ALLOW_THREADS
+        if (close(ring_fd) < 0)
+            save_errno = errno;
+        Py_END_ALLOW_THREADS
+    }
+    if (cancelled) {
+        pyiouring_release_fixed(self);
+        Py_CLEAR(self->pending);
+    }
+    else {
+        /* The kernel may still write to the buffers of the operations
+           which could not be reaped: leak them rather than release them */
+        self->fixed = NULL;
+        self->nfixed = 0;
+        self->pending = NULL;
+    }
+    self->fixed_pending = 0;
+    return save_errno;
+}
+
+static PyObject *
+pyiouring_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"entries", NULL};
+    int entries = 256;
+    struct io_uring_params p;
+    pyIoUring_Object *self;
+    void *ptr;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|i:io_uring", kwlist,
+                                     &entries))
+        return NULL;
+    if (entries < 1) {
+        PyErr_SetString(PyExc_ValueError, "entries must be positive");
+        return NULL;
+    }
+
+    assert(type != NULL && type->tp_alloc != NULL);
+    self = (pyIoUring_Object *) type->tp_alloc(type, 0);
+    if (self == NULL)
+        return NULL;
+    self->ring_fd = -1;
+    if ((self->pending = PyDict_New()) == NULL)
+        goto error;
+
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CLAMP;
+    Py_BEGIN_ALLOW_THREADS
+    /* The file descriptor is created non-inheritable */
+    self->ring_fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    Py_END_ALLOW_THREADS
+    if (self->ring_fd < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        goto error;
+    }
+    if (!(p.features & IORING_FEAT_EXT_ARG)) {
+        errno = ENOSYS;
+        PyErr_SetFromErrno(PyExc_OSError);
+        goto error;
+    }
+    self->features = p.features;
+
+    self->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+    self->cq_ring_size = p.cq_off.cqes +
+                         p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        self->sq_ring_size = self->cq_ring_size =
+            Py_MAX(self->sq_ring_size, self->cq_ring_size);
+    ptr = mmap(NULL, self->sq_ring_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, self->ring_fd, IORING_OFF_SQ_RING);
+    if (ptr == MAP_FAILED)
+        goto mmap_error;
+    self->sq_ring = ptr;
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        self->cq_ring = ptr;
+    else {
+        ptr = mmap(NULL, self->cq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, self->ring_fd,
+                   IORING_OFF_CQ_RING);
+        if (ptr == MAP_FAILED)
+            goto mmap_error;
+        self->cq_ring = ptr;
+    }
+    self->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    ptr = mmap(NULL, self->sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, self->ring_fd, IORING_OFF_SQES);
+    if (ptr == MAP_FAILED)
+        goto mmap_error;
+    self->sqes = ptr;
+
+    self->sq_head = (unsigned int *)((char *)self->sq_ring + p.sq_off.head);
+    self->sq_tail = (unsigned int *)((char *)self->sq_ring + p.sq_off.tail);
+    self->sq_mask = *(unsigned int *)((char *)self->sq_ring +
+                                      p.sq_off.ring_mask);
+    self->sq_entries = p.sq_entries;
+    self->cq_head = (unsigned int *)((char *)self->cq_ring + p.cq_off.head);
+    self->cq_tail = (unsigned int *)((char *)self->cq_ring + p.cq_off.tail);
+    self->cq_mask = *(unsigned int *)((char *)self->cq_ring +
+                                      p.cq_off.ring_mask);
+    self->cqes = (struct io_uring_cqe *)((char *)self->cq_ring +
+                                         p.cq_off.cqes);
+    /* Each submission queue slot always holds the entry of same index */
+    {
+        unsigned int i, *array;
+
+        array = (unsigned int *)((char *)self->sq_ring + p.sq_off.array);
+        for (i = 0; i < p.sq_entries; i++)
+            array[i] = i;
+    }
+    return (PyObject *)self;
+
+mmap_error:
+    PyErr_SetFromErrno(PyExc_OSError);
+error:
+    Py_DECREF(self);
+    return NULL;
+}
+
+static void
+pyiouring_dealloc(pyIoUring_Object *self)
+{
+    (void)pyiouring_internal_close(self);
+    Py_TYPE(self)->tp_free(self);
+}
+
+/* Call io_uring_enter() with the GIL released, retrying on EINTR.
+   Return the number of entries submitted, or -1 with an exception set.
+   If timeout is 0, don't wait for completions; if it is negative, wait
+   for one completion without timeout. */
+static int
+pyiouring_enter(pyIoUring_Object *self, _PyTime_t timeout)
+{
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    _PyTime_t deadline = 0;
+    unsigned int min_complete;
+    int ret;
+
+    if (timeout > 0)
+        deadline = _PyTime_GetMonotonicClock() + timeout;
+    while (1) {
+        /* GETEVENTS also flushes the completions which overflowed the
+           completion queue */
+        memset(&arg, 0, sizeof(arg));
+        min_complete = 0;
+        if (timeout != 0) {
+            min_complete = 1;
+            if (timeout > 0) {
+                struct timespec tmp;
+
+                if (_PyTime_AsTimespec(timeout, &tmp) < 0)
+                    return -1;
+                ts.tv_sec = tmp.tv_sec;
+                ts.tv_nsec = tmp.tv_nsec;
+                arg.ts = (__u64)(uintptr_t)&ts;
+            }
+        }
+
+        self->busy++;
+        Py_BEGIN_ALLOW_THREADS
+        ret = (int)syscall(__NR_io_uring_enter, self->ring_fd,
+                           self->to_submit, min_complete,
+                           IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                           &arg, sizeof(arg));
+        Py_END_ALLOW_THREADS
+        self->busy--;
+
+        /* close() refuses to unmap the rings while a thread is busy, but
+           check anyway before touching them */
+        if (self->ring_fd < 0) {
+            pyiouring_err_closed();
+            return -1;
+        }
+        if (ret >= 0) {
+            self->to_submit -= Py_MIN((unsigned int)ret, self->to_submit);
+            return ret;
+        }
+        if (errno == ETIME)
+            return 0;
+        if (errno != EINTR) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return -1;
+        }
+
+        /* io_uring_enter() was interrupted by a signal */
+        if (PyErr_CheckSignals())
+            return -1;
+
+        if (timeout > 0) {
+            timeout = deadline - _PyTime_GetMonotonicClock();
+            if (timeout <= 0)
+                timeout = 0;
+            /* retry io_uring_enter() with the recomputed timeout */
+        }
+        if (timeout == 0 && self->to_submit == 0)
+            return 0;
+    }
+}
+
+/* Return a free submission queue entry, submitting the queued entries if
+   the submission queue is full, or NULL with an exception set. */
+static struct io_uring_sqe *
+pyiouring_get_sqe(pyIoUring_Object *self, PyObject *user_data,
+                  PyObject *buffer)
+{
+    struct io_uring_sqe *sqe;
+    unsigned int tail = *self->sq_tail;
+    unsigned long long data;
+
+    if (self->ring_fd < 0) {
+        pyiouring_err_closed();
+        return NULL;
+    }
+    data = PyLong_AsUnsignedLongLong(user_data);
+    if (data == (unsigned long long)-1 && PyErr_Occurred())
+        return NULL;
+    if (PyDict_GetItem(self->pending, user_data) != NULL) {
+        PyErr_Format(PyExc_ValueError,
+                     "user_data %R is already in use", user_data);
+        return NULL;
+    }
+    if (tail - ring_load_acquire(self->sq_head) >= self->sq_entries) {
+        if (pyiouring_enter(self, 0) < 0)
+            return NULL;
+        if (tail - ring_load_acquire(self->sq_head) >= self->sq_entries) {
+            PyErr_SetString(PyExc_BlockingIOError,
+                            "io_uring submission queue is full");
+            return NULL;
+        }
+    }
+    if (PyDict_SetItem(self->pending, user_data,
+                       buffer != NULL ? buffer : Py_None) < 0)
+        return NULL;
+    sqe = &self->sqes[tail & self->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = data;
+    return sqe;
+}
+
+/* Make the entry returned by pyiouring_get_sqe() visible to the kernel */
+static PyObject *
+pyiouring_push_sqe(pyIoUring_Object *self)
+{
+    ring_store_release(self->sq_tail, *self->sq_tail + 1);
+    self->to_submit++;
+    Py_RETURN_NONE;
+}
+
+/* Return a memoryview of a C-contiguous buffer, or NULL */
+static PyObject *
+pyiouring_buffer(PyObject *obj, int writable)
+{
+    PyObject *view = PyMemoryView_FromObject(obj);
+    Py_buffer *buf;
+
+    if (view == NULL)
+        return NULL;
+    buf = PyMemoryView_GET_BUFFER(view);
+    if (!PyBuffer_IsContiguous(buf, 'C')) {
+        PyErr_SetString(PyExc_BufferError, "buffer is not contiguous");
+        goto error;
+    }
+    if (writable && buf->readonly) {
+        PyErr_SetString(PyExc_TypeError, "buffer must be writable");
+        goto error;
+    }
+    if (buf->len > UINT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "buffer is too large");
+        goto error;
+    }
+    return view;
+
+error:
+    Py_DECREF(view);
+    return NULL;
+}
+
+/* Queue a recv() or send() of a socket, or a read() or write() of a file
+   at an offset.  The argument after user_data is the flags of the socket
+   operations and the offset of the file operations. */
+static PyObject *
+pyiouring_queue_io(pyIoUring_Object *self, PyObject *args, PyObject *kwds,
+                   const char *format, int opcode)
+{
+    static char *sock_kwlist[] = {"fd", "buffer", "user_data", "flags",
+                                  NULL};
+    static char *file_kwlist[] = {"fd", "buffer", "user_data", "offset",
+                                  NULL};
+    int fd, sock_op;
+    long long arg = 0;
+    PyObject *obj, *user_data, *view, *res = NULL;
+    Py_buffer *buf;
+    struct io_uring_sqe *sqe;
+
+    sock_op = (opcode == IORING_OP_RECV || opcode == IORING_OP_SEND);
+    if (!sock_op)
+        arg = -1;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, format,
+                                     sock_op ? sock_kwlist : file_kwlist,
+                                     &fd, &obj, &user_data, &arg))
+        return NULL;
+    view = pyiouring_buffer(obj, (opcode == IORING_OP_RECV ||
+                                  opcode == IORING_OP_READ));
+    if (view == NULL)
+        return NULL;
+    buf = PyMemoryView_GET_BUFFER(view);
+    /* The memoryview keeps the buffer exported until the completion */
+    sqe = pyiouring_get_sqe(self, user_data, view);
+    if (sqe != NULL) {
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->addr = (__u64)(uintptr_t)buf->buf;
+        sqe->len = (__u32)buf->len;
+        if (sock_op)
+            sqe->msg_flags = (__u32)arg;
+        else
+            sqe->off = (__u64)arg;
+        res = pyiouring_push_sqe(self);
+    }
+    Py_DECREF(view);
+    return res;
+}
+
+static PyObject *
+pyiouring_recv(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    return pyiouring_queue_io(self, args, kwds, "iOO|L:recv",
+                              IORING_OP_RECV);
+}
+
+PyDoc_STRVAR(pyiouring_recv_doc,
+"recv(fd, buffer, user_data, flags=0) -> None\n\
+\n\
+Queue a recv() of the socket fd into the writable buffer.  The result\n\
+of the completion is the number of bytes received.");
+
+static PyObject *
+pyiouring_send(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    return pyiouring_queue_io(self, args, kwds, "iOO|L:send",
+                              IORING_OP_SEND);
+}
+
+PyDoc_STRVAR(pyiouring_send_doc,
+"send(fd, buffer, user_data, flags=0) -> None\n\
+\n\
+Queue a send() of the buffer to the socket fd.  The result of the\n\
+completion is the number of bytes sent.");
+
+static PyObject *
+pyiouring_read(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    return pyiouring_queue_io(self, args, kwds, "iOO|L:read",
+                              IORING_OP_READ);
+}
+
+PyDoc_STRVAR(pyiouring_read_doc,
+"read(fd, buffer, user_data, offset=-1) -> None\n\
+\n\
+Queue a read of fd into the writable buffer, at the current file\n\
+position if offset is -1.  The result of the completion is the number\n\
+of bytes read.");
+
 static PyObject *
-pyepoll_poll(pyEpoll_Object *self, PyObject *args, PyObject *kwds)
+pyiouring_write(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"timeout", "maxevents", NULL};
-    PyObject *timeout_obj = NULL;
-    int maxevents = -1;
-    int nfds, i;
-    PyObject *elist = NULL, *etuple = NULL;
-    struct epoll_event *evs = NULL;
-    _PyTime_t timeout, ms, deadline;
+    return pyiouring_queue_io(self, args, kwds, "iOO|L:write",
+                              IORING_OP_WRITE);
+}
 
-    if (self->epfd < 0)
-        return pyepoll_err_closed();
+PyDoc_STRVAR(pyiouring_write_doc,
+"write(fd, buffer, user_data, offset=-1) -> None\n\
+\n\
+Queue a write of the buffer to fd, at the current file position if\n\
+offset is -1.  The result of the completion is the number of bytes\n\
+written.");
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oi:poll", kwlist,
-                                     &timeout_obj, &maxevents)) {
+static PyObject *
+pyiouring_accept(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"fd", "user_data", "flags", NULL};
+    int fd, flags = SOCK_CLOEXEC;
+    PyObject *user_data;
+    struct io_uring_sqe *sqe;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iO|i:accept", kwlist,
+                                     &fd, &user_data, &flags))
+        return NULL;
+    sqe = pyiouring_get_sqe(self, user_data, NULL);
+    if (sqe == NULL)
+        return NULL;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->accept_flags = (__u32)flags;
+    return pyiouring_push_sqe(self);
+}
+
+PyDoc_STRVAR(pyiouring_accept_doc,
+"accept(fd, user_data, flags=SOCK_CLOEXEC) -> None\n\
+\n\
+Queue an accept4() on the listening socket fd.  The result of the\n\
+completion is the file descriptor of the new connection.");
+
+static PyObject *
+pyiouring_poll_add(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"fd", "eventmask", "user_data", NULL};
+    int fd;
+    unsigned int eventmask;
+    PyObject *user_data;
+    struct io_uring_sqe *sqe;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iIO:poll_add", kwlist,
+                                     &fd, &eventmask, &user_data))
+        return NULL;
+    sqe = pyiouring_get_sqe(self, user_data, NULL);
+    if (sqe == NULL)
+        return NULL;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+#ifdef WORDS_BIGENDIAN
+    eventmask = (eventmask << 16) | (eventmask >> 16);
+#endif
+    sqe->poll32_events = eventmask;
+    return pyiouring_push_sqe(self);
+}
+
+PyDoc_STRVAR(pyiouring_poll_add_doc,
+"poll_add(fd, eventmask, user_data) -> None\n\
+\n\
+Queue a one-shot wait for the POLL* events of eventmask on fd.  The\n\
+result of the completion is the mask of the events which occurred.");
+
+static PyObject *
+pyiouring_cancel(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"target", "user_data", NULL};
+    unsigned long long target;
+    PyObject *user_data;
+    struct io_uring_sqe *sqe;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "KO:cancel", kwlist,
+                                     &target, &user_data))
+        return NULL;
+    sqe = pyiouring_get_sqe(self, user_data, NULL);
+    if (sqe == NULL)
+        return NULL;
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    return pyiouring_push_sqe(self);
+}
+
+PyDoc_STRVAR(pyiouring_cancel_doc,
+"cancel(target, user_data) -> None\n\
+\n\
+Queue the cancellation of the operation queued with the user_data\n\
+target.  The cancelled operation completes with -ECANCELED.  The result\n\
+of the completion of the cancellation is 0, -ENOENT if the operation\n\
+was not found, or -EALREADY if it is already running.");
+
+static PyObject *
+pyiouring_register_buffers(pyIoUring_Object *self, PyObject *arg)
+{
+    PyObject *fast;
+    Py_ssize_t i, n, nbufs = 0;
+    Py_buffer *bufs = NULL;
+    struct iovec *iovs = NULL;
+    int ret;
+
+    if (self->ring_fd < 0)
+        return pyiouring_err_closed();
+    if (self->fixed != NULL) {
+        PyErr_SetString(PyExc_ValueError, "buffers are already registered");
+        return NULL;
+    }
+    fast = PySequence_Fast(arg, "register_buffers() argument must be an "
+                                "iterable");
+    if (fast == NULL)
         return NULL;
+    n = PySequence_Fast_GET_SIZE(fast);
+    if (n == 0 || n > UIO_MAXIOV) {
+        PyErr_Format(PyExc_ValueError,
+                     "between 1 and %d buffers can be registered",
+                     UIO_MAXIOV);
+        goto error;
+    }
+    if ((bufs = PyMem_New(Py_buffer, n)) == NULL ||
+        (iovs = PyMem_New(struct iovec, n)) == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    for (; nbufs < n; nbufs++) {
+        if (!PyArg_Parse(PySequence_Fast_GET_ITEM(fast, nbufs),
+                         "w*;register_buffers() argument must be an "
+                         "iterable of single-segment read-write buffers",
+                         &bufs[nbufs]))
+            goto error;
+        iovs[nbufs].iov_base = bufs[nbufs].buf;
+        iovs[nbufs].iov_len = bufs[nbufs].len;
     }
 
-    if (timeout_obj == NULL || timeout_obj == Py_None) {
-        timeout = -1;
-        ms = -1;
-        deadline = 0;   /* initialize to prevent gcc warning */
+    self->busy++;
+    Py_BEGIN_ALLOW_THREADS
+    ret = (int)syscall(__NR_io_uring_register, self->ring_fd,
+                       IORING_REGISTER_BUFFERS, iovs, (unsigned int)n);
+    Py_END_ALLOW_THREADS
+    self->busy--;
+    if (ret < 0) {
+        PyErr_SetFromErrno(PyExc_OSError);
+        goto error;
+    }
+    PyMem_Free(iovs);
+    Py_DECREF(fast);
+    self->fixed = bufs;
+    self->nfixed = n;
+    Py_RETURN_NONE;
+
+error:
+    for (i = 0; i < nbufs; i++)
+        PyBuffer_Release(&bufs[i]);
+    PyMem_Free(bufs);
+    PyMem_Free(iovs);
+    Py_DECREF(fast);
+    return NULL;
+}
+
+PyDoc_STRVAR(pyiouring_register_buffers_doc,
+"register_buffers(buffers) -> None\n\
+\n\
+Register writable buffers with the kernel, for read_fixed() and\n\
+write_fixed().  The buffers stay exported until unregister_buffers() or\n\
+close() is called, so they cannot be resized.");
+
+static PyObject *
+pyiouring_unregister_buffers(pyIoUring_Object *self)
+{
+    int ret;
+
+    if (self->ring_fd < 0)
+        return pyiouring_err_closed();
+    if (self->fixed == NULL) {
+        PyErr_SetString(PyExc_ValueError, "no buffers are registered");
+        return NULL;
+    }
+    if (self->fixed_pending > 0) {
+        PyErr_SetString(PyExc_BufferError,
+                        "registered buffers are used by operations in "
+                        "flight");
+        return NULL;
+    }
+    self->busy++;
+    Py_BEGIN_ALLOW_THREADS
+    ret = (int)syscall(__NR_io_uring_register, self->ring_fd,
+                       IORING_UNREGISTER_BUFFERS, NULL, 0);
+    Py_END_ALLOW_THREADS
+    self->busy--;
+    if (ret < 0)
+        return PyErr_SetFromErrno(PyExc_OSError);
+    pyiouring_release_fixed(self);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(pyiouring_unregister_buffers_doc,
+"unregister_buffers() -> None\n\
+\n\
+Unregister the buffers registered by register_buffers().  Raise\n\
+BufferError if a read_fixed() or write_fixed() operation is in flight.");
+
+static PyObject *
+pyiouring_queue_fixed(pyIoUring_Object *self, PyObject *args,
+                      PyObject *kwds, const char *format, int opcode)
+{
+    static char *kwlist[] = {"fd", "index", "user_data", "nbytes", "offset",
+                             NULL};
+    int fd;
+    Py_ssize_t index, nbytes = -1;
+    long long offset = -1;
+    PyObject *user_data, *index_obj;
+    Py_buffer *buf;
+    struct io_uring_sqe *sqe;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, format, kwlist,
+                                     &fd, &index, &user_data, &nbytes,
+                                     &offset))
+        return NULL;
+    if (self->ring_fd < 0)
+        return pyiouring_err_closed();
+    if (index < 0 || index >= self->nfixed) {
+        PyErr_SetString(PyExc_IndexError,
+                        "registered buffer index out of range");
+        return NULL;
+    }
+    buf = &self->fixed[index];
+    if (nbytes < 0 || nbytes > buf->len)
+        nbytes = buf->len;
+    if (nbytes > UINT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "nbytes is too large");
+        return NULL;
     }
+    /* The index marks the operation as using a registered buffer */
+    index_obj = PyLong_FromSsize_t(index);
+    if (index_obj == NULL)
+        return NULL;
+    sqe = pyiouring_get_sqe(self, user_data, index_obj);
+    Py_DECREF(index_obj);
+    if (sqe == NULL)
+        return NULL;
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (__u64)(uintptr_t)buf->buf;
+    sqe->len = (__u32)nbytes;
+    sqe->off = (__u64)offset;
+    sqe->buf_index = (__u16)index;
+    self->fixed_pending++;
+    return pyiouring_push_sqe(self);
+}
+
+static PyObject *
+pyiouring_read_fixed(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    return pyiouring_queue_fixed(self, args, kwds, "inO|nL:read_fixed",
+                                 IORING_OP_READ_FIXED);
+}
+
+PyDoc_STRVAR(pyiouring_read_fixed_doc,
+"read_fixed(fd, index, user_data, nbytes=-1, offset=-1) -> None\n\
+\n\
+Queue a read of up to nbytes from fd into the registered buffer index,\n\
+by default as many bytes as the buffer holds.  An offset of -1 reads\n\
+from the current file position.  The result of the completion is the\n\
+number of bytes read.");
+
+static PyObject *
+pyiouring_write_fixed(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    return pyiouring_queue_fixed(self, args, kwds, "inO|nL:write_fixed",
+                                 IORING_OP_WRITE_FIXED);
+}
+
+PyDoc_STRVAR(pyiouring_write_fixed_doc,
+"write_fixed(fd, index, user_data, nbytes=-1, offset=-1) -> None\n\
+\n\
+Queue a write of the first nbytes of the registered buffer index to fd,\n\
+by default the whole buffer.  An offset of -1 writes at the current\n\
+file position.  The result of the completion is the number of bytes\n\
+written.");
+
+static PyObject *
+pyiouring_submit(pyIoUring_Object *self)
+{
+    int ret;
+
+    if (self->ring_fd < 0)
+        return pyiouring_err_closed();
+    if (self->to_submit == 0)
+        return PyLong_FromLong(0);
+    ret = pyiouring_enter(self, 0);
+    if (ret < 0)
+        return NULL;
+    return PyLong_FromLong(ret);
+}
+
+PyDoc_STRVAR(pyiouring_submit_doc,
+"submit() -> int\n\
+\n\
+Submit the queued operations to the kernel without waiting for their\n\
+completion, and return the number of operations submitted.");
+
+static PyObject *
+pyiouring_wait(pyIoUring_Object *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"timeout", NULL};
+    PyObject *timeout_obj = NULL, *list = NULL;
+    _PyTime_t timeout;
+    unsigned int head, tail, i;
+
+    if (self->ring_fd < 0)
+        return pyiouring_err_closed();
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O:wait", kwlist,
+                                     &timeout_obj))
+        return NULL;
+
+    if (timeout_obj == NULL || timeout_obj == Py_None)
+        timeout = -1;
     else {
-        /* epoll_wait() has a resolution of 1 millisecond, round towards
-           infinity to wait at least timeout seconds. */
         if (_PyTime_FromSecondsObject(&timeout, timeout_obj,
                                       _PyTime_ROUND_CEILING) < 0) {
             if (PyErr_ExceptionMatches(PyExc_TypeError)) {
@@ -1517,148 +2848,195 @@ pyepoll_poll(pyEpoll_Object *self, PyObject *args, PyObject *kwds)
             }
             return NULL;
         }
+        if (timeout < 0)
+            timeout = 0;
+    }
 
-        ms = _PyTime_AsMilliseconds(timeout, _PyTime_ROUND_CEILING);
-        if (ms < INT_MIN || ms > INT_MAX) {
-            PyErr_SetString(PyExc_OverflowError, "timeout is too large");
+    /* Don't wait if completions are already available */
+    if (ring_load_acquire(self->cq_tail) != *self->cq_head)
+        timeout = 0;
+    if (timeout != 0 || self->to_submit != 0) {
+        if (pyiouring_enter(self, timeout) < 0)
             return NULL;
-        }
-
-        deadline = _PyTime_GetMonotonicClock() + timeout;
     }
 
-    if (maxevents == -1) {
-        maxevents = FD_SETSIZE-1;
-    }
-    else if (maxevents < 1) {
-        PyErr_Format(PyExc_ValueError,
-                     "maxevents must be greater than 0, got %d",
-                     maxevents);
+    head = *self->cq_head;
+    tail = ring_load_acquire(self->cq_tail);
+    list = PyList_New(tail - head);
+    if (list == NULL)
         return NULL;
-    }
+    for (i = 0; head != tail; head++, i++) {
+        struct io_uring_cqe *cqe = &self->cqes[head & self->cq_mask];
+        PyObject *user_data, *item;
 
-    evs = PyMem_New(struct epoll_event, maxevents);
-    if (evs == NULL) {
-        PyErr_NoMemory();
-        return NULL;
+        user_data = PyLong_FromUnsignedLongLong(cqe->user_data);
+        if (user_data == NULL)
+            goto error;
+        /* The buffer of the operation can be released */
+        if (!(cqe->flags & IORING_CQE_F_MORE) &&
+            pyiouring_complete(self, user_data) < 0) {
+            Py_DECREF(user_data);
+            goto error;
+        }
+        item = Py_BuildValue("NiI", user_data, cqe->res, cqe->flags);
+        if (item == NULL)
+            goto error;
+        PyList_SET_ITEM(list, i, item);
     }
+    ring_store_release(self->cq_head, head);
+    return list;
 
-    do {
-        Py_BEGIN_ALLOW_THREADS
-        errno = 0;
-        nfds = epoll_wait(self->epfd, evs, maxevents, (int)ms);
-        Py_END_ALLOW_THREADS
-
-        if (errno != EINTR)
-            break;
-
-        /* poll() was interrupted by a signal */
-        if (PyErr_CheckSignals())
-            goto error;
+error:
+    /* Consume the completions reaped so far */
+    ring_store_release(self->cq_head, head);
+    Py_DECREF(list);
+    return NULL;
+}
 
-        if (timeout >= 0) {
-            timeout = deadline - _PyTime_GetMonotonicClock();
-            if (timeout < 0) {
-                nfds = 0;
-                break;
-            }
-            ms = _PyTime_AsMilliseconds(timeout, _PyTime_ROUND_CEILING);
-            /* retry epoll_wait() with the recomputed timeout */
-        }
-    } while(1);
+PyDoc_STRVAR(pyiouring_wait_doc,
+"wait([timeout]) -> [(user_data, res, flags), ...]\n\
+\n\
+Submit the queued operations and wait for a maximum time of timeout\n\
+in seconds for at least one completion; wait indefinitely if timeout\n\
+is None.  Return the list of completions: res is the result of the\n\
+operation, or a negated errno value on failure.");
 
-    if (nfds < 0) {
+static PyObject*
+pyiouring_close(pyIoUring_Object *self)
+{
+    if (self->busy > 0) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "cannot close an io_uring object while another "
+                        "thread uses it");
+        return NULL;
+    }
+    errno = pyiouring_internal_close(self);
+    if (errno != 0) {
         PyErr_SetFromErrno(PyExc_OSError);
-        goto error;
+        return NULL;
     }
+    Py_RETURN_NONE;
+}
 
-    elist = PyList_New(nfds);
-    if (elist == NULL) {
-        goto error;
-    }
+PyDoc_STRVAR(pyiouring_close_doc,
+"close() -> None\n\
+\n\
+Cancel the operations in flight, wait for their completion and close\n\
+the io_uring file descriptor.  Further operations on the io_uring object\n\
+will raise an exception.  Raise RuntimeError if another thread is\n\
+waiting on the io_uring object.");
 
-    for (i = 0; i < nfds; i++) {
-        etuple = Py_BuildValue("iI", evs[i].data.fd, evs[i].events);
-        if (etuple == NULL) {
-            Py_CLEAR(elist);
-            goto error;
-        }
-        PyList_SET_ITEM(elist, i, etuple);
-    }
+static PyObject*
+pyiouring_get_closed(pyIoUring_Object *self)
+{
+    if (self->ring_fd < 0)
+        Py_RETURN_TRUE;
+    else
+        Py_RETURN_FALSE;
+}
 
-    error:
-    PyMem_Free(evs);
-    return elist;
+static PyObject*
+pyiouring_get_pending(pyIoUring_Object *self)
+{
+    if (self->ring_fd < 0)
+        return PyLong_FromLong(0);
+    return PyLong_FromSsize_t(PyDict_Size(self->pending));
 }
 
-PyDoc_STRVAR(pyepoll_poll_doc,
-"poll([timeout=-1[, maxevents=-1]]) -> [(fd, events), (...)]\n\
+static PyObject*
+pyiouring_fileno(pyIoUring_Object *self)
+{
+    if (self->ring_fd < 0)
+        return pyiouring_err_closed();
+    return PyLong_FromLong(self->ring_fd);
+}
+
+PyDoc_STRVAR(pyiouring_fileno_doc,
+"fileno() -> int\n\
 \n\
-Wait for events on the epoll file descriptor for a maximum time of timeout\n\
-in seconds (as float). -1 makes poll wait indefinitely.\n\
-Up to maxevents are returned to the caller.");
+Return the io_uring file descriptor.");
 
 static PyObject *
-pyepoll_enter(pyEpoll_Object *self, PyObject *args)
+pyiouring_enter_ctx(pyIoUring_Object *self, PyObject *args)
 {
-    if (self->epfd < 0)
-        return pyepoll_err_closed();
+    if (self->ring_fd < 0)
+        return pyiouring_err_closed();
 
     Py_INCREF(self);
     return (PyObject *)self;
 }
 
 static PyObject *
-pyepoll_exit(PyObject *self, PyObject *args)
+pyiouring_exit_ctx(PyObject *self, PyObject *args)
 {
     _Py_IDENTIFIER(close);
 
     return _PyObject_CallMethodId(self, &PyId_close, NULL);
 }
 
-static PyMethodDef pyepoll_methods[] = {
-    {"fromfd",          (PyCFunction)pyepoll_fromfd,
-     METH_VARARGS | METH_CLASS, pyepoll_fromfd_doc},
-    {"close",           (PyCFunction)pyepoll_close,     METH_NOARGS,
-     pyepoll_close_doc},
-    {"fileno",          (PyCFunction)pyepoll_fileno,    METH_NOARGS,
-     pyepoll_fileno_doc},
-    {"modify",          (PyCFunction)pyepoll_modify,
-     METH_VARARGS | METH_KEYWORDS,      pyepoll_modify_doc},
-    {"register",        (PyCFunction)pyepoll_register,
-     METH_VARARGS | METH_KEYWORDS,      pyepoll_register_doc},
-    {"unregister",      (PyCFunction)pyepoll_unregister,
-     METH_VARARGS | METH_KEYWORDS,      pyepoll_unregister_doc},
-    {"poll",            (PyCFunction)pyepoll_poll,
-     METH_VARARGS | METH_KEYWORDS,      pyepoll_poll_doc},
-    {"__enter__",           (PyCFunction)pyepoll_enter,     METH_NOARGS,
+static PyMethodDef pyiouring_methods[] = {
+    {"close",           (PyCFunction)pyiouring_close,   METH_NOARGS,
+     pyiouring_close_doc},
+    {"fileno",          (PyCFunction)pyiouring_fileno,  METH_NOARGS,
+     pyiouring_fileno_doc},
+    {"recv",            (PyCFunction)pyiouring_recv,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_recv_doc},
+    {"send",            (PyCFunction)pyiouring_send,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_send_doc},
+    {"read",            (PyCFunction)pyiouring_read,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_read_doc},
+    {"write",           (PyCFunction)pyiouring_write,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_write_doc},
+    {"accept",          (PyCFunction)pyiouring_accept,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_accept_doc},
+    {"poll_add",        (PyCFunction)pyiouring_poll_add,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_poll_add_doc},
+    {"cancel",          (PyCFunction)pyiouring_cancel,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_cancel_doc},
+    {"register_buffers", (PyCFunction)pyiouring_register_buffers, METH_O,
+     pyiouring_register_buffers_doc},
+    {"unregister_buffers", (PyCFunction)pyiouring_unregister_buffers,
+     METH_NOARGS,       pyiouring_unregister_buffers_doc},
+    {"read_fixed",      (PyCFunction)pyiouring_read_fixed,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_read_fixed_doc},
+    {"write_fixed",     (PyCFunction)pyiouring_write_fixed,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_write_fixed_doc},
+    {"submit",          (PyCFunction)pyiouring_submit,  METH_NOARGS,
+     pyiouring_submit_doc},
+    {"wait",            (PyCFunction)pyiouring_wait,
+     METH_VARARGS | METH_KEYWORDS,      pyiouring_wait_doc},
+    {"__enter__",       (PyCFunction)pyiouring_enter_ctx, METH_NOARGS,
      NULL},
-    {"__exit__",           (PyCFunction)pyepoll_exit,     METH_VARARGS,
+    {"__exit__",        (PyCFunction)pyiouring_exit_ctx, METH_VARARGS,
      NULL},
     {NULL,      NULL},
 };
 
-static PyGetSetDef pyepoll_getsetlist[] = {
-    {"closed", (getter)pyepoll_get_closed, NULL,
-     "True if the epoll handler is closed"},
+static PyGetSetDef pyiouring_getsetlist[] = {
+    {"closed", (getter)pyiouring_get_closed, NULL,
+     "True if the io_uring object is closed"},
+    {"pending", (getter)pyiouring_get_pending, NULL,
+     "Number of operations queued and not completed"},
     {0},
 };
 
-PyDoc_STRVAR(pyepoll_doc,
-"select.epoll(sizehint=-1, flags=0)\n\
+PyDoc_STRVAR(pyiouring_doc,
+"select.io_uring(entries=256)\n\
 \n\
-Returns an epolling object\n\
+Returns an io_uring object with a submission queue of entries entries.\n\
 \n\
-sizehint must be a positive integer or -1 for the default size. The\n\
-sizehint is used to optimize internal data structures. It doesn't limit\n\
-the maximum number of monitored events.");
+Operations are queued with the recv(), send(), read(), write(),\n\
+accept(), poll_add(), cancel(), read_fixed() and write_fixed() methods,\n\
+each tagged with an integer user_data which identifies its completion.\n\
+wait() submits them and returns the completions.  Buffers passed to the\n\
+operations are kept exported until their completion.");
 
-static PyTypeObject pyEpoll_Type = {
+static PyTypeObject pyIoUring_Type = {
     PyVarObject_HEAD_INIT(NULL, 0)
-    "select.epoll",                                     /* tp_name */
-    sizeof(pyEpoll_Object),                             /* tp_basicsize */
+    "select.io_uring",                                  /* tp_name */
+    sizeof(pyIoUring_Object),                           /* tp_basicsize */
     0,                                                  /* tp_itemsize */
-    (destructor)pyepoll_dealloc,                        /* tp_dealloc */
+    (destructor)pyiouring_dealloc,                      /* tp_dealloc */
     0,                                                  /* tp_print */
     0,                                                  /* tp_getattr */
     0,                                                  /* tp_setattr */
@@ -1674,16 +3052,16 @@ static PyTypeObject pyEpoll_Type = {
     0,                                                  /* tp_setattro */
     0,                                                  /* tp_as_buffer */
     Py_TPFLAGS_DEFAULT,                                 /* tp_flags */
-    pyepoll_doc,                                        /* tp_doc */
+    pyiouring_doc,                                      /* tp_doc */
     0,                                                  /* tp_traverse */
     0,                                                  /* tp_clear */
     0,                                                  /* tp_richcompare */
     0,                                                  /* tp_weaklistoffset */
     0,                                                  /* tp_iter */
     0,                                                  /* tp_iternext */
-    pyepoll_methods,                                    /* tp_methods */
+    pyiouring_methods,                                  /* tp_methods */
     0,                                                  /* tp_members */
-    pyepoll_getsetlist,                                 /* tp_getset */
+    pyiouring_getsetlist,                               /* tp_getset */
     0,                                                  /* tp_base */
     0,                                                  /* tp_dict */
     0,                                                  /* tp_descr_get */
@@ -1691,11 +3069,11 @@ static PyTypeObject pyEpoll_Type = {
     0,                                                  /* tp_dictoffset */
     0,                                                  /* tp_init */
     0,                                                  /* tp_alloc */
-    pyepoll_new,                                        /* tp_new */
+    pyiouring_new,                                      /* tp_new */
     0,                                                  /* tp_free */
 };
 
-#endif /* HAVE_EPOLL */
+#endif /* HAVE_IO_URING */
 
 #ifdef HAVE_KQUEUE
 /* **************************************************************************
@@ -2501,6 +3879,15 @@ PyInit_select(void)
 #endif
 #endif /* HAVE_EPOLL */
 
+#ifdef HAVE_IO_URING
+    Py_TYPE(&pyIoUring_Type) = &PyType_Type;
+    if (PyType_Ready(&pyIoUring_Type) < 0)
+        return NULL;
+
+    Py_INCREF(&pyIoUring_Type);
+    PyModule_AddObject(m, "io_uring", (PyObject *) &pyIoUring_Type);
+#endif /* HAVE_IO_URING */
+
 #ifdef HAVE_KQUEUE
     kqueue_event_Type.tp_new = PyType_GenericNew;
     Py_TYPE(&kqueue_event_Type) = &PyType_Type;
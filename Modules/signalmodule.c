@@ -1657,6 +1657,7 @@ PyOS_AfterFork(void)
     main_thread = PyThread_get_thread_ident();
     main_pid = getpid();
     _PyImport_ReInitLock();
+    _PyGC_AfterFork();
 #endif
 }
 
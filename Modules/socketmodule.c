@@ -163,6 +163,10 @@ if_indextoname(index) -- return the corresponding interface name\n\
 # include <sys/uio.h>
 #endif
 
+#ifdef HAVE_SYS_SENDFILE_H
+# include <sys/sendfile.h>
+#endif
+
 #ifndef WITH_THREAD
 # undef HAVE_GETHOSTBYNAME_R
 #endif
@@ -3977,6 +3981,420 @@ data sent.");
 #endif    /* CMSG_LEN */
 
 
+#ifdef HAVE_RECVMMSG
+struct sock_recvmmsg {
+    struct mmsghdr *msgs;
+    unsigned int vlen;
+    int flags;
+    int result;
+};
+
+static int
+sock_recvmmsg_impl(PySocketSockObject *s, void *data)
+{
+    struct sock_recvmmsg *ctx = data;
+
+    ctx->result = recvmmsg(s->sock_fd, ctx->msgs, ctx->vlen, ctx->flags,
+                           NULL);
+    return (ctx->result >= 0);
+}
+
+/* s.recvmmsg_into(buffers[, flags[, sizes]]) method */
+
+static PyObject *
+sock_recvmmsg_into(PySocketSockObject *s, PyObject *args)
+{
+    int flags = 0;
+    struct mmsghdr *msgs = NULL;
+    struct iovec *iovs = NULL;
+    sock_addr_t *addrs = NULL;
+    socklen_t addrbuflen = 0;
+    Py_ssize_t i, nitems, nbufs = 0;
+    Py_buffer *bufs = NULL, sizes = {NULL, NULL};
+    PyObject *buffers_arg, *sizes_arg = NULL, *fast, *retval = NULL;
+    struct sock_recvmmsg ctx;
+
+    if (!PyArg_ParseTuple(args, "O|iO:recvmmsg_into",
+                          &buffers_arg, &flags, &sizes_arg))
+        return NULL;
+
+    if ((fast = PySequence_Fast(buffers_arg,
+                                "recvmmsg_into() argument 1 must be an "
+                                "iterable")) == NULL)
+        return NULL;
+    nitems = PySequence_Fast_GET_SIZE(fast);
+    if (nitems > INT_MAX) {
+        PyErr_SetString(PyExc_OSError,
+                        "recvmmsg_into() argument 1 is too long");
+        goto finally;
+    }
+
+    /* The sizes buffer replaces the list of (nbytes, address) pairs:
+       the size of each datagram is stored into it and no object is
+       created per datagram. */
+    if (sizes_arg != NULL && sizes_arg != Py_None) {
+        if (PyObject_GetBuffer(sizes_arg, &sizes,
+                               PyBUF_WRITABLE | PyBUF_FORMAT |
+                               PyBUF_C_CONTIGUOUS) < 0)
+            goto finally;
+        if (sizes.itemsize != sizeof(unsigned int) ||
+            sizes.format == NULL ||
+            (strcmp(sizes.format, "I") != 0 &&
+             strcmp(sizes.format, "@I") != 0)) {
+            PyErr_SetString(PyExc_TypeError,
+                            "recvmmsg_into() sizes must be a buffer of "
+                            "unsigned ints (format 'I')");
+            goto finally;
+        }
+        if (sizes.len / sizes.itemsize < nitems) {
+            PyErr_SetString(PyExc_ValueError,
+                            "recvmmsg_into() sizes is shorter than buffers");
+            goto finally;
+        }
+    }
+    if (nitems == 0) {
+        retval = (sizes.obj != NULL) ? PyLong_FromLong(0) : PyList_New(0);
+        goto finally;
+    }
+
+    if ((msgs = PyMem_New(struct mmsghdr, nitems)) == NULL ||
+        (iovs = PyMem_New(struct iovec, nitems)) == NULL ||
+        (bufs = PyMem_New(Py_buffer, nitems)) == NULL) {
+        PyErr_NoMemory();
+        goto finally;
+    }
+    if (sizes.obj == NULL) {
+        if (!getsockaddrlen(s, &addrbuflen))
+            goto finally;
+        if ((addrs = PyMem_New(sock_addr_t, nitems)) == NULL) {
+            PyErr_NoMemory();
+            goto finally;
+        }
+    }
+    memset(msgs, 0, nitems * sizeof(struct mmsghdr));
+    /* Receive one datagram into each buffer. */
+    for (; nbufs < nitems; nbufs++) {
+        struct msghdr *hdr = &msgs[nbufs].msg_hdr;
+
+        if (!PyArg_Parse(PySequence_Fast_GET_ITEM(fast, nbufs),
+                         "w*;recvmmsg_into() argument 1 must be an iterable "
+                         "of single-segment read-write buffers",
+                         &bufs[nbufs]))
+            goto finally;
+        iovs[nbufs].iov_base = bufs[nbufs].buf;
+        iovs[nbufs].iov_len = bufs[nbufs].len;
+        hdr->msg_iov = &iovs[nbufs];
+        hdr->msg_iovlen = 1;
+        if (addrs != NULL) {
+            /* See the comment in sock_recvmsg_guts() */
+            memset(&addrs[nbufs], 0, addrbuflen);
+            SAS2SA(&addrs[nbufs])->sa_family = AF_UNSPEC;
+            hdr->msg_name = &addrs[nbufs];
+            hdr->msg_namelen = addrbuflen;
+        }
+    }
+
+    /* Make the system call. */
+    if (!IS_SELECTABLE(s)) {
+        select_error();
+        goto finally;
+    }
+
+    ctx.msgs = msgs;
+    ctx.vlen = (unsigned int)nitems;
+    /* Don't wait for the other buffers to be filled once a datagram
+       was received. */
+    ctx.flags = flags | MSG_WAITFORONE;
+    if (sock_call(s, 0, sock_recvmmsg_impl, &ctx) < 0)
+        goto finally;
+
+    if (sizes.obj != NULL) {
+        unsigned int *sizep = sizes.buf;
+
+        for (i = 0; i < ctx.result; i++)
+            sizep[i] = msgs[i].msg_len;
+        retval = PyLong_FromLong(ctx.result);
+    }
+    else {
+        PyObject *addr = NULL, *item;
+        struct msghdr *prev = NULL;
+
+        if ((retval = PyList_New(ctx.result)) == NULL)
+            goto finally;
+        for (i = 0; i < ctx.result; i++) {
+            struct msghdr *hdr = &msgs[i].msg_hdr;
+            socklen_t namelen = Py_MIN(hdr->msg_namelen, addrbuflen);
+
+            /* Datagrams usually come from a few peers: share the
+               address object of consecutive datagrams from the same
+               peer. */
+            if (prev == NULL || prev->msg_namelen != hdr->msg_namelen ||
+                memcmp(prev->msg_name, hdr->msg_name, namelen) != 0) {
+                Py_XDECREF(addr);
+                addr = makesockaddr(s->sock_fd, hdr->msg_name, namelen,
+                                    s->sock_proto);
+                if (addr == NULL)
+                    break;
+                prev = hdr;
+            }
+            item = Py_BuildValue("IO", msgs[i].msg_len, addr);
+            if (item == NULL)
+                break;
+            PyList_SET_ITEM(retval, i, item);
+        }
+        Py_XDECREF(addr);
+        if (i < ctx.result)
+            Py_CLEAR(retval);
+    }
+
+finally:
+    for (i = 0; i < nbufs; i++)
+        PyBuffer_Release(&bufs[i]);
+    if (sizes.obj != NULL)
+        PyBuffer_Release(&sizes);
+    PyMem_Free(addrs);
+    PyMem_Free(bufs);
+    PyMem_Free(iovs);
+    PyMem_Free(msgs);
+    Py_DECREF(fast);
+    return retval;
+}
+
+PyDoc_STRVAR(recvmmsg_into_doc,
+"recvmmsg_into(buffers[, flags[, sizes]]) -> [(nbytes, address), ...]\n\
+\n\
+Receive several datagrams from the socket with a single system call,\n\
+one datagram into each buffer.  The buffers argument must be an\n\
+iterable of objects that export writable buffers (e.g. bytearray\n\
+objects); datagrams larger than their buffer are truncated.  The flags\n\
+argument defaults to 0 and has the same meaning as for recv().  The\n\
+call waits for the first datagram only, and returns with the datagrams\n\
+already queued.\n\
+\n\
+The return value is a list of (nbytes, address) pairs for the buffers\n\
+which were filled, in order.  If sizes is given, it must be a writable\n\
+buffer of at least len(buffers) unsigned ints (format 'I', e.g. an\n\
+array('I')): the size of each datagram is stored into it and the\n\
+number of datagrams received is returned instead of the list.");
+#endif    /* HAVE_RECVMMSG */
+
+
+#ifdef HAVE_SENDMMSG
+struct sock_sendmmsg {
+    struct mmsghdr *msgs;
+    unsigned int vlen;
+    int flags;
+    int result;
+};
+
+static int
+sock_sendmmsg_impl(PySocketSockObject *s, void *data)
+{
+    struct sock_sendmmsg *ctx = data;
+
+    ctx->result = sendmmsg(s->sock_fd, ctx->msgs, ctx->vlen, ctx->flags);
+    return (ctx->result >= 0);
+}
+
+/* s.sendmmsg(buffers[, flags[, address]]) method */
+
+static PyObject *
+sock_sendmmsg(PySocketSockObject *s, PyObject *args)
+{
+    int flags = 0, addrlen = 0;
+    struct mmsghdr *msgs = NULL;
+    struct iovec *iovs = NULL;
+    sock_addr_t addrbuf;
+    Py_ssize_t i, nitems, nbufs = 0;
+    Py_buffer *bufs = NULL;
+    PyObject *buffers_arg, *addr_arg = NULL, *fast, *retval = NULL;
+    struct sock_sendmmsg ctx;
+
+    if (!PyArg_ParseTuple(args, "O|iO:sendmmsg",
+                          &buffers_arg, &flags, &addr_arg))
+        return NULL;
+
+    if ((fast = PySequence_Fast(buffers_arg,
+                                "sendmmsg() argument 1 must be an "
+                                "iterable")) == NULL)
+        return NULL;
+    nitems = PySequence_Fast_GET_SIZE(fast);
+    if (nitems > INT_MAX) {
+        PyErr_SetString(PyExc_OSError, "sendmmsg() argument 1 is too long");
+        goto finally;
+    }
+
+    /* Parse destination address. */
+    if (addr_arg != NULL && addr_arg != Py_None) {
+        if (!getsockaddrarg(s, addr_arg, SAS2SA(&addrbuf), &addrlen))
+            goto finally;
+    }
+    if (nitems == 0) {
+        retval = PyLong_FromLong(0);
+        goto finally;
+    }
+
+    if ((msgs = PyMem_New(struct mmsghdr, nitems)) == NULL ||
+        (iovs = PyMem_New(struct iovec, nitems)) == NULL ||
+        (bufs = PyMem_New(Py_buffer, nitems)) == NULL) {
+        PyErr_NoMemory();
+        goto finally;
+    }
+    memset(msgs, 0, nitems * sizeof(struct mmsghdr));
+    /* Send each buffer as one datagram. */
+    for (; nbufs < nitems; nbufs++) {
+        struct msghdr *hdr = &msgs[nbufs].msg_hdr;
+
+        if (!PyArg_Parse(PySequence_Fast_GET_ITEM(fast, nbufs),
+                         "y*;sendmmsg() argument 1 must be an iterable of "
+                         "bytes-like objects",
+                         &bufs[nbufs]))
+            goto finally;
+        iovs[nbufs].iov_base = bufs[nbufs].buf;
+        iovs[nbufs].iov_len = bufs[nbufs].len;
+        hdr->msg_iov = &iovs[nbufs];
+        hdr->msg_iovlen = 1;
+        if (addrlen > 0) {
+            hdr->msg_name = &addrbuf;
+            hdr->msg_namelen = addrlen;
+        }
+    }
+
+    /* Make the system call. */
+    if (!IS_SELECTABLE(s)) {
+        select_error();
+        goto finally;
+    }
+
+    ctx.msgs = msgs;
+    ctx.vlen = (unsigned int)nitems;
+    ctx.flags = flags;
+    if (sock_call(s, 1, sock_sendmmsg_impl, &ctx) < 0)
+        goto finally;
+
+    retval = PyLong_FromLong(ctx.result);
+
+finally:
+    for (i = 0; i < nbufs; i++)
+        PyBuffer_Release(&bufs[i]);
+    PyMem_Free(bufs);
+    PyMem_Free(iovs);
+    PyMem_Free(msgs);
+    Py_DECREF(fast);
+    return retval;
+}
+
+PyDoc_STRVAR(sendmmsg_doc,
+"sendmmsg(buffers[, flags[, address]]) -> count\n\
+\n\
+Send several datagrams to the socket with a single system call.  The\n\
+buffers argument is an iterable of bytes-like objects, each of which\n\
+is sent as one datagram.  The flags argument defaults to 0 and has the\n\
+same meaning as for send().  If address is supplied and not None, it\n\
+sets the destination address of all the datagrams.  The return value\n\
+is the number of datagrams sent, which may be less than len(buffers).");
+#endif    /* HAVE_SENDMMSG */
+
+
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+struct sock_sendfile {
+    int in_fd;
+    off_t *offset;
+    size_t count;
+    Py_ssize_t result;
+};
+
+static int
+sock_sendfile_impl(PySocketSockObject *s, void *data)
+{
+    struct sock_sendfile *ctx = data;
+
+    ctx->result = sendfile(s->sock_fd, ctx->in_fd, ctx->offset, ctx->count);
+    return (ctx->result >= 0);
+}
+
+/* s._sendfile(in_fd, offset, count) method */
+
+static PyObject *
+sock_sendfile(PySocketSockObject *s, PyObject *args)
+{
+    int in_fd;
+    long long offset_arg;
+    off_t offset;
+    Py_ssize_t count, total = 0;
+    struct sock_sendfile ctx;
+    int has_timeout = (s->sock_timeout > 0);
+    _PyTime_t interval = s->sock_timeout;
+    _PyTime_t deadline = 0;
+    int deadline_initialized = 0;
+
+    if (!PyArg_ParseTuple(args, "iLn:_sendfile", &in_fd, &offset_arg, &count))
+        return NULL;
+    offset = (off_t)offset_arg;
+    if (offset_arg < 0 || offset != offset_arg || count < 0) {
+        PyErr_SetString(PyExc_ValueError, "offset or count out of range");
+        return NULL;
+    }
+
+    if (!IS_SELECTABLE(s))
+        return select_error();
+
+    /* Call sendfile() until count bytes were sent or the end of the file
+       is reached, with the same deadline as sendall().  If an error occurs
+       after some data was sent, return the number of bytes sent instead,
+       so that the caller can update its offset: the next call reports
+       the error. */
+    while (total < count) {
+        if (has_timeout) {
+            if (deadline_initialized) {
+                /* recompute the timeout */
+                interval = deadline - _PyTime_GetMonotonicClock();
+            }
+            else {
+                deadline_initialized = 1;
+                deadline = _PyTime_GetMonotonicClock() + s->sock_timeout;
+            }
+
+            if (interval <= 0) {
+                if (total > 0)
+                    break;
+                PyErr_SetString(socket_timeout, "timed out");
+                return NULL;
+            }
+        }
+
+        ctx.in_fd = in_fd;
+        ctx.offset = &offset;
+        ctx.count = count - total;
+        if (sock_call_ex(s, 1, sock_sendfile_impl, &ctx, 0, NULL,
+                         interval) < 0) {
+            /* Exceptions raised by signal handlers are not deferred */
+            if (total == 0 || !PyErr_ExceptionMatches(PyExc_OSError))
+                return NULL;
+            PyErr_Clear();
+            break;
+        }
+        if (ctx.result == 0)
+            break;  /* EOF */
+        total += ctx.result;
+
+        /* sendfile() can return a successful partial write when it is
+           interrupted, as send() does */
+        if (PyErr_CheckSignals())
+            return NULL;
+    }
+    return PyLong_FromSsize_t(total);
+}
+
+PyDoc_STRVAR(sendfile_doc,
+"_sendfile(in_fd, offset, count) -> sent\n\
+\n\
+Send up to count bytes of the file descriptor in_fd, starting at\n\
+offset, with the sendfile() system call.  Return the number of bytes\n\
+sent, 0 at the end of the file.  Used by sendfile().");
+#endif    /* HAVE_SENDFILE && HAVE_SYS_SENDFILE_H */
+
+
 /* s.shutdown(how) method */
 
 static PyObject *
@@ -4142,6 +4560,18 @@ static PyMethodDef sock_methods[] = {
                       recvmsg_into_doc,},
     {"sendmsg",           (PyCFunction)sock_sendmsg, METH_VARARGS,
                       sendmsg_doc},
+#endif
+#ifdef HAVE_RECVMMSG
+    {"recvmmsg_into",     (PyCFunction)sock_recvmmsg_into, METH_VARARGS,
+                      recvmmsg_into_doc},
+#endif
+#ifdef HAVE_SENDMMSG
+    {"sendmmsg",          (PyCFunction)sock_sendmmsg, METH_VARARGS,
+                      sendmmsg_doc},
+#endif
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+    {"_sendfile",         (PyCFunction)sock_sendfile, METH_VARARGS,
+                      sendfile_doc},
 #endif
     {NULL,                      NULL}           /* sentinel */
 };
@@ -2,6 +2,11 @@
 
 #include "Python.h"
 #include "accu.h"
+#include "longintrepr.h"
+#include "pycpu.h"
+#ifdef WITH_THREAD
+#include "pythread.h"
+#endif
 
 #ifdef STDC_HEADERS
 #include <stddef.h>
@@ -1031,11 +1036,210 @@ sortslice_advance(sortslice *slice, Py_ssize_t n)
         slice->values += n;
 }
 
-/* Comparison function: PyObject_RichCompareBool with Py_LT.
+/* The maximum number of entries in a MergeState's pending-runs stack.
+ * This is enough to sort arrays of size up to about
+ *     32 * phi ** MAX_MERGE_PENDING
+ * where phi ~= 1.618.  85 is ridiculouslylarge enough, good for an array
+ * with 2**64 elements.
+ */
+#define MAX_MERGE_PENDING 85
+
+/* When we get into galloping mode, we stay there until both runs win less
+ * often than MIN_GALLOP consecutive times.  See listsort.txt for more info.
+ */
+#define MIN_GALLOP 7
+
+/* Avoid malloc for small temp arrays. */
+#define MERGESTATE_TEMP_SIZE 256
+
+/* One MergeState exists on the stack per invocation of mergesort.  It's just
+ * a convenient way to pass state around among the helper functions.
+ */
+struct s_slice {
+    sortslice base;
+    Py_ssize_t len;
+};
+
+typedef struct s_MergeState {
+    /* This controls when we get *into* galloping mode.  It's initialized
+     * to MIN_GALLOP.  merge_lo and merge_hi tend to nudge it higher for
+     * random data, and lower for highly structured data.
+     */
+    Py_ssize_t min_gallop;
+
+    /* 'a' is temp storage to help with merges.  It contains room for
+     * alloced entries.
+     */
+    sortslice a;        /* may point to temparray below */
+    Py_ssize_t alloced;
+
+    /* A stack of n pending runs yet to be merged.  Run #i starts at
+     * address base[i] and extends for len[i] elements.  It's always
+     * true (so long as the indices are in bounds) that
+     *
+     *     pending[i].base + pending[i].len == pending[i+1].base
+     *
+     * so we could cut the storage for this, but it's a minor amount,
+     * and keeping all the info explicit simplifies the code.
+     */
+    int n;
+    struct s_slice pending[MAX_MERGE_PENDING];
+
+    /* 'a' points to this when possible, rather than muck with malloc. */
+    PyObject *temparray[MERGESTATE_TEMP_SIZE];
+
+    /* This is the function we will use to compare two keys, even when
+     * none of our special cases apply and we have to use
+     * PyObject_RichCompareBool.  listsort() picks it after looking at the
+     * types of all the keys.
+     */
+    int (*key_compare)(PyObject *, PyObject *, struct s_MergeState *);
+
+    /* The kind shared by all the keys, when key_compare is
+     * unsafe_unicode_compare().
+     */
+    int key_kind;
+} MergeState;
+
+/* Comparison functions.  All of them return -1 on error, 1 if x < y,
+ * 0 if x >= y.  safe_object_compare() works for any keys; the others
+ * assume listsort() checked that all the keys are of the type they handle,
+ * and skip PyObject_RichCompareBool's type dispatch.  Comparing exact ints,
+ * floats and strs never runs Python code, so the keys can't change under
+ * our feet while the specialized functions are in use.
+ */
+
+static int
+safe_object_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    return PyObject_RichCompareBool(v, w, Py_LT);
+}
+
+/* Exact ints whose absolute value fits in a single digit. */
+static int
+unsafe_long_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    PyLongObject *vl = (PyLongObject *)v, *wl = (PyLongObject *)w;
+    sdigit v0, w0;
+
+    assert(PyLong_CheckExact(v) && PyLong_CheckExact(w));
+    assert(Py_ABS(Py_SIZE(v)) <= 1 && Py_ABS(Py_SIZE(w)) <= 1);
+    /* ob_digit[0] may be garbage for zero, but then Py_SIZE() is 0. */
+    v0 = Py_SIZE(vl) == 0 ? 0 : (sdigit)vl->ob_digit[0];
+    w0 = Py_SIZE(wl) == 0 ? 0 : (sdigit)wl->ob_digit[0];
+    if (Py_SIZE(vl) < 0)
+        v0 = -v0;
+    if (Py_SIZE(wl) < 0)
+        w0 = -w0;
+    return v0 < w0;
+}
+
+/* Exact floats.  A NaN compares false, as with float.__lt__. */
+static int
+unsafe_float_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    assert(PyFloat_CheckExact(v) && PyFloat_CheckExact(w));
+    return PyFloat_AS_DOUBLE(v) < PyFloat_AS_DOUBLE(w);
+}
+
+/* Exact, ready strs, all of kind ms->key_kind.  Code points are compared
+ * in order, like unicode_compare() does.
+ */
+#define COMPARE_CODE_POINTS(TYPE)                               \
+    do {                                                        \
+        const TYPE *p1 = (const TYPE *)PyUnicode_DATA(v);       \
+        const TYPE *p2 = (const TYPE *)PyUnicode_DATA(w);       \
+        const TYPE *end = p1 + len;                             \
+        for (; p1 < end; p1++, p2++) {                          \
+            if (*p1 != *p2)                                     \
+                return *p1 < *p2;                               \
+        }                                                       \
+    } while (0)
+
+static int
+unsafe_unicode_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    Py_ssize_t len1, len2, len;
+    int res;
+
+    assert(PyUnicode_CheckExact(v) && PyUnicode_CheckExact(w));
+    assert(PyUnicode_KIND(v) == ms->key_kind);
+    assert(PyUnicode_KIND(w) == ms->key_kind);
+    len1 = PyUnicode_GET_LENGTH(v);
+    len2 = PyUnicode_GET_LENGTH(w);
+    len = Py_MIN(len1, len2);
+    switch (ms->key_kind) {
+    case PyUnicode_1BYTE_KIND:
+        res = memcmp(PyUnicode_DATA(v), PyUnicode_DATA(w), len);
+        if (res != 0)
+            return res < 0;
+        break;
+    case PyUnicode_2BYTE_KIND:
+        COMPARE_CODE_POINTS(Py_UCS2);
+        break;
+    case PyUnicode_4BYTE_KIND:
+        COMPARE_CODE_POINTS(Py_UCS4);
+        break;
+    default:
+        assert(0);
+    }
+    return len1 < len2;
+}
+
+#undef COMPARE_CODE_POINTS
+
+/* Choose ms->key_compare by looking at the n keys. */
+static void
+select_key_compare(MergeState *ms, PyObject **keys, Py_ssize_t n)
+{
+    PyTypeObject *key_type;
+    int kind = 0;
+    int small_ints = 1;
+    Py_ssize_t i;
+
+    ms->key_compare = safe_object_compare;
+    if (n < 2)
+        return;
+    key_type = Py_TYPE(keys[0]);
+    if (key_type != &PyLong_Type && key_type != &PyFloat_Type &&
+        key_type != &PyUnicode_Type)
+        return;
+    if (key_type == &PyUnicode_Type) {
+        if (!PyUnicode_IS_READY(keys[0]))
+            return;
+        kind = PyUnicode_KIND(keys[0]);
+    }
+    for (i = 0; i < n; i++) {
+        PyObject *key = keys[i];
+        if (Py_TYPE(key) != key_type)
+            return;
+        if (key_type == &PyUnicode_Type) {
+            if (!PyUnicode_IS_READY(key) || PyUnicode_KIND(key) != kind)
+                return;
+        }
+        else if (key_type == &PyLong_Type) {
+            if (Py_ABS(Py_SIZE(key)) > 1) {
+                small_ints = 0;
+                break;
+            }
+        }
+    }
+    if (key_type == &PyUnicode_Type) {
+        ms->key_kind = kind;
+        ms->key_compare = unsafe_unicode_compare;
+    }
+    else if (key_type == &PyFloat_Type)
+        ms->key_compare = unsafe_float_compare;
+    else if (small_ints)
+        ms->key_compare = unsafe_long_compare;
+}
+
+/* Comparison function: ms->key_compare, which acts like
+ * PyObject_RichCompareBool with Py_LT.
  * Returns -1 on error, 1 if x < y, 0 if x >= y.
  */
 
-#define ISLT(X, Y) (PyObject_RichCompareBool(X, Y, Py_LT))
+#define ISLT(X, Y) (*(ms->key_compare))(X, Y, ms)
 
 /* Compare X to Y via "<".  Goto "fail" if the comparison raises an
    error.  Else "k" is set to true iff X<Y, and an "if (k)" block is
@@ -1056,7 +1260,7 @@ sortslice_advance(sortslice *slice, Py_ssize_t n)
    the input (nothing is lost or duplicated).
 */
 static int
-binarysort(sortslice lo, PyObject **hi, PyObject **start)
+binarysort(MergeState *ms, sortslice lo, PyObject **hi, PyObject **start)
 {
     Py_ssize_t k;
     PyObject **l, **p, **r;
@@ -1130,7 +1334,7 @@ elements to get out of order).
 Returns -1 in case of error.
 */
 static Py_ssize_t
-count_run(PyObject **lo, PyObject **hi, int *descending)
+count_run(MergeState *ms, PyObject **lo, PyObject **hi, int *descending)
 {
     Py_ssize_t k;
     Py_ssize_t n;
@@ -1185,7 +1389,8 @@ key, and the last n-k should follow key.
 Returns -1 on error.  See listsort.txt for info on the method.
 */
 static Py_ssize_t
-gallop_left(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint)
+gallop_left(MergeState *ms, PyObject *key, PyObject **a, Py_ssize_t n,
+            Py_ssize_t hint)
 {
     Py_ssize_t ofs;
     Py_ssize_t lastofs;
@@ -1276,7 +1481,8 @@ we're sticking to "<" comparisons that it's much harder to follow if
 written as one routine with yet another "left or right?" flag.
 */
 static Py_ssize_t
-gallop_right(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint)
+gallop_right(MergeState *ms, PyObject *key, PyObject **a, Py_ssize_t n,
+             Py_ssize_t hint)
 {
     Py_ssize_t ofs;
     Py_ssize_t lastofs;
@@ -1352,59 +1558,6 @@ fail:
     return -1;
 }
 
-/* The maximum number of entries in a MergeState's pending-runs stack.
- * This is enough to sort arrays of size up to about
- *     32 * phi ** MAX_MERGE_PENDING
- * where phi ~= 1.618.  85 is ridiculouslylarge enough, good for an array
- * with 2**64 elements.
- */
-#define MAX_MERGE_PENDING 85
-
-/* When we get into galloping mode, we stay there until both runs win less
- * often than MIN_GALLOP consecutive times.  See listsort.txt for more info.
- */
-#define MIN_GALLOP 7
-
-/* Avoid malloc for small temp arrays. */
-#define MERGESTATE_TEMP_SIZE 256
-
-/* One MergeState exists on the stack per invocation of mergesort.  It's just
- * a convenient way to pass state around among the helper functions.
- */
-struct s_slice {
-    sortslice base;
-    Py_ssize_t len;
-};
-
-typedef struct s_MergeState {
-    /* This controls when we get *into* galloping mode.  It's initialized
-     * to MIN_GALLOP.  merge_lo and merge_hi tend to nudge it higher for
-     * random data, and lower for highly structured data.
-     */
-    Py_ssize_t min_gallop;
-
-    /* 'a' is temp storage to help with merges.  It contains room for
-     * alloced entries.
-     */
-    sortslice a;        /* may point to temparray below */
-    Py_ssize_t alloced;
-
-    /* A stack of n pending runs yet to be merged.  Run #i starts at
-     * address base[i] and extends for len[i] elements.  It's always
-     * true (so long as the indices are in bounds) that
-     *
-     *     pending[i].base + pending[i].len == pending[i+1].base
-     *
-     * so we could cut the storage for this, but it's a minor amount,
-     * and keeping all the info explicit simplifies the code.
-     */
-    int n;
-    struct s_slice pending[MAX_MERGE_PENDING];
-
-    /* 'a' points to this when possible, rather than muck with malloc. */
-    PyObject *temparray[MERGESTATE_TEMP_SIZE];
-} MergeState;
-
 /* Conceptually a MergeState's constructor. */
 static void
 merge_init(MergeState *ms, Py_ssize_t list_size, int has_keyfunc)
@@ -1557,7 +1710,7 @@ merge_lo(MergeState *ms, sortslice ssa, Py_ssize_t na,
             assert(na > 1 && nb > 0);
             min_gallop -= min_gallop > 1;
             ms->min_gallop = min_gallop;
-            k = gallop_right(ssb.keys[0], ssa.keys, na, 0);
+            k = gallop_right(ms, ssb.keys[0], ssa.keys, na, 0);
             acount = k;
             if (k) {
                 if (k < 0)
@@ -1580,7 +1733,7 @@ merge_lo(MergeState *ms, sortslice ssa, Py_ssize_t na,
             if (nb == 0)
                 goto Succeed;
 
-            k = gallop_left(ssa.keys[0], ssb.keys, nb, 0);
+            k = gallop_left(ms, ssa.keys[0], ssb.keys, nb, 0);
             bcount = k;
             if (k) {
                 if (k < 0)
@@ -1695,7 +1848,7 @@ merge_hi(MergeState *ms, sortslice ssa, Py_ssize_t na,
             assert(na > 0 && nb > 1);
             min_gallop -= min_gallop > 1;
             ms->min_gallop = min_gallop;
-            k = gallop_right(ssb.keys[0], basea.keys, na, na-1);
+            k = gallop_right(ms, ssb.keys[0], basea.keys, na, na-1);
             if (k < 0)
                 goto Fail;
             k = na - k;
@@ -1713,7 +1866,7 @@ merge_hi(MergeState *ms, sortslice ssa, Py_ssize_t na,
             if (nb == 1)
                 goto CopyA;
 
-            k = gallop_left(ssa.keys[0], baseb.keys, nb, nb-1);
+            k = gallop_left(ms, ssa.keys[0], baseb.keys, nb, nb-1);
             if (k < 0)
                 goto Fail;
             k = nb - k;
@@ -1790,7 +1943,7 @@ merge_at(MergeState *ms, Py_ssize_t i)
     /* Where does b start in a?  Elements in a before that can be
      * ignored (already in place).
      */
-    k = gallop_right(*ssb.keys, ssa.keys, na, 0);
+    k = gallop_right(ms, *ssb.keys, ssa.keys, na, 0);
     if (k < 0)
         return -1;
     sortslice_advance(&ssa, k);
@@ -1801,7 +1954,7 @@ merge_at(MergeState *ms, Py_ssize_t i)
     /* Where does a end in b?  Elements in b after that can be
      * ignored (already in place).
      */
-    nb = gallop_left(ssa.keys[na-1], ssb.keys, nb, nb-1);
+    nb = gallop_left(ms, ssa.keys[na-1], ssb.keys, nb, nb-1);
     if (nb <= 0)
         return nb;
 
@@ -1901,6 +2054,237 @@ reverse_sortslice(sortslice *s, Py_ssize_t n)
         reverse_slice(s->values, &s->values[n]);
 }
 
+/* Sort the n elements of the slice lo with timsort: march over the array
+ * once, left to right, finding natural runs, extending short natural runs
+ * to minrun elements, and merging them.  Returns 0 on success, -1 on error.
+ */
+static int
+sort_slice(MergeState *ms, sortslice lo, Py_ssize_t n)
+{
+    Py_ssize_t nremaining = n;
+    Py_ssize_t minrun;
+    PyObject **start = lo.keys;
+
+    assert(ms->n == 0);
+    if (nremaining < 2)
+        return 0;
+    minrun = merge_compute_minrun(nremaining);
+    do {
+        int descending;
+        Py_ssize_t n;
+
+        /* Identify next run. */
+        n = count_run(ms, lo.keys, lo.keys + nremaining, &descending);
+        if (n < 0)
+            return -1;
+        if (descending)
+            reverse_sortslice(&lo, n);
+        /* If short, extend to min(minrun, nremaining). */
+        if (n < minrun) {
+            const Py_ssize_t force = nremaining <= minrun ?
+                              nremaining : minrun;
+            if (binarysort(ms, lo, lo.keys + force, lo.keys + n) < 0)
+                return -1;
+            n = force;
+        }
+        /* Push run onto pending-runs stack, and maybe merge. */
+        assert(ms->n < MAX_MERGE_PENDING);
+        ms->pending[ms->n].base = lo;
+        ms->pending[ms->n].len = n;
+        ++ms->n;
+        if (merge_collapse(ms) < 0)
+            return -1;
+        /* Advance to find next run. */
+        sortslice_advance(&lo, n);
+        nremaining -= n;
+    } while (nremaining);
+
+    if (merge_force_collapse(ms) < 0)
+        return -1;
+    assert(ms->n == 1);
+    assert(ms->pending[0].base.keys == start);
+    assert(ms->pending[0].len == n);
+    (void)start;
+    return 0;
+}
+
+/* Don't bother with chunks smaller than this. */
+#define PARALLEL_SORT_MIN_CHUNK 32768
+
+/* Upper bound on the number of threads of a parallel sort. */
+#define PARALLEL_SORT_MAX_THREADS 64
+
+#ifdef WITH_THREAD
+
+/* Parallel sorting.
+ *
+ * The slice is cut into nthreads chunks of about the same size, which are
+ * sorted by sort_slice() in as many threads.  Pairs of adjacent sorted
+ * chunks are then merged by merge_at() in parallel, until a single run is
+ * left.  Since the chunks are contiguous and each merge keeps the left run
+ * on the left, the sort is as stable as the serial one.
+ *
+ * The threads run without the GIL, so this is only done when
+ * ms->key_compare is one of the specialized comparisons, which never call
+ * into Python and never fail.  The merge memory of every task is allocated
+ * up front by the calling thread, so merge_getmem() never has to allocate
+ * from a worker either.
+ */
+
+typedef struct {
+    MergeState ms;
+    sortslice lo;           /* start of the chunk or of the first run */
+    Py_ssize_t n;           /* length of the chunk or of the first run */
+    Py_ssize_t n2;          /* length of the second run, or 0 for a chunk */
+    Py_ssize_t result;
+    PyThread_type_lock done;
+} sort_task;
+
+static void
+sort_task_run(void *arg)
+{
+    sort_task *t = (sort_task *)arg;
+
+    if (t->n2 == 0)
+        t->result = sort_slice(&t->ms, t->lo, t->n);
+    else {
+        t->ms.n = 2;
+        t->ms.pending[0].base = t->lo;
+        t->ms.pending[0].len = t->n;
+        t->ms.pending[1].base = t->lo;
+        sortslice_advance(&t->ms.pending[1].base, t->n);
+        t->ms.pending[1].len = t->n2;
+        t->result = merge_at(&t->ms, 0);
+    }
+    assert(t->result >= 0);
+    t->ms.n = 0;
+}
+
+static void
+sort_task_thread(void *arg)
+{
+    sort_task *t = (sort_task *)arg;
+
+    sort_task_run(t);
+    PyThread_release_lock(t->done);
+}
+
+/* Run the first ntasks tasks, the first one in the calling thread. */
+static void
+sort_tasks_run(sort_task *tasks, int ntasks)
+{
+    int i;
+    char started[PARALLEL_SORT_MAX_THREADS];
+
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 1; i < ntasks; i++) {
+        PyThread_acquire_lock(tasks[i].done, WAIT_LOCK);
+        started[i] = PyThread_start_new_thread(sort_task_thread,
+                                               &tasks[i]) != -1;
+        if (!started[i]) {
+            /* Out of threads: do the work ourselves. */
+            PyThread_release_lock(tasks[i].done);
+            sort_task_run(&tasks[i]);
+        }
+    }
+    sort_task_run(&tasks[0]);
+    for (i = 1; i < ntasks; i++) {
+        if (started[i]) {
+            /* Wait until the worker releases the lock. */
+            PyThread_acquire_lock(tasks[i].done, WAIT_LOCK);
+            PyThread_release_lock(tasks[i].done);
+        }
+    }
+    Py_END_ALLOW_THREADS
+}
+
+static int
+parallel_sort(MergeState *ms, sortslice lo, Py_ssize_t n, int nthreads)
+{
+    sort_task *tasks;
+    struct s_slice runs[PARALLEL_SORT_MAX_THREADS];
+    Py_ssize_t chunk;
+    int nruns, ntasks, i;
+    int result = -1;
+
+    assert(nthreads > 1 && nthreads <= PARALLEL_SORT_MAX_THREADS);
+    tasks = PyMem_New(sort_task, nthreads);
+    if (tasks == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    chunk = n / nthreads;
+    for (i = 0; i < nthreads; i++) {
+        sort_task *t = &tasks[i];
+
+        t->lo = lo;
+        sortslice_advance(&t->lo, i * chunk);
+        t->n = i == nthreads - 1 ? n - i * chunk : chunk;
+        t->n2 = 0;
+        merge_init(&t->ms, t->n, lo.values != NULL);
+        t->ms.key_compare = ms->key_compare;
+        t->ms.key_kind = ms->key_kind;
+        t->done = PyThread_allocate_lock();
+        if (t->done == NULL) {
+            PyErr_SetString(PyExc_MemoryError, "can't allocate lock");
+            nthreads = i;
+            merge_freemem(&t->ms);
+            goto done;
+        }
+    }
+    /* Merging two runs needs at most half of their total length. */
+    for (i = 0; i < nthreads; i++) {
+        if (merge_getmem(&tasks[i].ms, (tasks[i].n + 1) / 2) < 0)
+            goto done;
+    }
+    sort_tasks_run(tasks, nthreads);
+    for (i = 0; i < nthreads; i++) {
+        runs[i].base = tasks[i].lo;
+        runs[i].len = tasks[i].n;
+    }
+
+    /* Merge the sorted chunks, pairwise. */
+    nruns = nthreads;
+    while (nruns > 1) {
+        ntasks = nruns / 2;
+        for (i = 0; i < nthreads; i++) {
+            sort_task *t = &tasks[i];
+
+            if (i >= ntasks) {
+                /* Give back the memory of the idle tasks. */
+                merge_freemem(&t->ms);
+                merge_init(&t->ms, 0, lo.values != NULL);
+                continue;
+            }
+            t->lo = runs[2 * i].base;
+            t->n = runs[2 * i].len;
+            t->n2 = runs[2 * i + 1].len;
+            if (merge_getmem(&t->ms, Py_MIN(t->n, t->n2)) < 0)
+                goto done;
+        }
+        sort_tasks_run(tasks, ntasks);
+        for (i = 0; i < ntasks; i++) {
+            runs[i].base = tasks[i].lo;
+            runs[i].len = tasks[i].n + tasks[i].n2;
+        }
+        if (nruns & 1)
+            runs[ntasks++] = runs[nruns - 1];
+        nruns = ntasks;
+    }
+    assert(runs[0].len == n);
+    result = 0;
+
+done:
+    for (i = 0; i < nthreads; i++) {
+        merge_freemem(&tasks[i].ms);
+        PyThread_free_lock(tasks[i].done);
+    }
+    PyMem_Free(tasks);
+    return result;
+}
+
+#endif /* WITH_THREAD */
+
 /* An adaptive, stable, natural mergesort.  See listsort.txt.
  * Returns Py_None on success, NULL on error.  Even in case of error, the
  * list will be some permutation of its input state (nothing is lost or
@@ -1911,7 +2295,6 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
 {
     MergeState ms;
     Py_ssize_t nremaining;
-    Py_ssize_t minrun;
     sortslice lo;
     Py_ssize_t saved_ob_size, saved_allocated;
     PyObject **saved_ob_item;
@@ -1919,15 +2302,17 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
     PyObject *result = NULL;            /* guilty until proved innocent */
     int reverse = 0;
     PyObject *keyfunc = NULL;
+    PyObject *parallel = NULL;
+    int nthreads = 1;
     Py_ssize_t i;
-    static char *kwlist[] = {"key", "reverse", 0};
+    static char *kwlist[] = {"key", "reverse", "parallel", 0};
     PyObject **keys;
 
     assert(self != NULL);
     assert (PyList_Check(self));
     if (args != NULL) {
-        if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oi:sort",
-            kwlist, &keyfunc, &reverse))
+        if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OiO:sort",
+            kwlist, &keyfunc, &reverse, &parallel))
             return NULL;
         if (Py_SIZE(args) > 0) {
             PyErr_SetString(PyExc_TypeError,
@@ -1937,6 +2322,30 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
     }
     if (keyfunc == Py_None)
         keyfunc = NULL;
+    if (parallel != NULL && parallel != Py_None) {
+        /* True means one thread per CPU, an int is a number of threads. */
+        if (PyBool_Check(parallel)) {
+            if (parallel == Py_True)
+                nthreads = Py_MIN(_Py_cpu_count, PARALLEL_SORT_MAX_THREADS);
+        }
+        else if (PyLong_Check(parallel)) {
+            Py_ssize_t n = PyLong_AsSsize_t(parallel);
+            if (n == -1 && PyErr_Occurred())
+                return NULL;
+            if (n < 0) {
+                PyErr_SetString(PyExc_ValueError,
+                                "parallel must not be negative");
+                return NULL;
+            }
+            nthreads = (int)Py_MIN(n, PARALLEL_SORT_MAX_THREADS);
+        }
+        else {
+            PyErr_Format(PyExc_TypeError,
+                         "parallel must be a bool or an int, not %.200s",
+                         Py_TYPE(parallel)->tp_name);
+            return NULL;
+        }
+    }
 
     /* The list is temporarily made empty, so that mutations performed
      * by comparison functions can't affect the slice of memory we're
@@ -1984,6 +2393,7 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
     }
 
     merge_init(&ms, saved_ob_size, keys != NULL);
+    select_key_compare(&ms, lo.keys, saved_ob_size);
 
     nremaining = saved_ob_size;
     if (nremaining < 2)
@@ -1997,48 +2407,19 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
         reverse_slice(&saved_ob_item[0], &saved_ob_item[saved_ob_size]);
     }
 
-    /* March over the array once, left to right, finding natural runs,
-     * and extending short natural runs to minrun elements.
-     */
-    minrun = merge_compute_minrun(nremaining);
-    do {
-        int descending;
-        Py_ssize_t n;
-
-        /* Identify next run. */
-        n = count_run(lo.keys, lo.keys + nremaining, &descending);
-        if (n < 0)
-            goto fail;
-        if (descending)
-            reverse_sortslice(&lo, n);
-        /* If short, extend to min(minrun, nremaining). */
-        if (n < minrun) {
-            const Py_ssize_t force = nremaining <= minrun ?
-                              nremaining : minrun;
-            if (binarysort(lo, lo.keys + force, lo.keys + n) < 0)
+#ifdef WITH_THREAD
+    if (nthreads > 1 && ms.key_compare != safe_object_compare) {
+        if (nthreads > nremaining / PARALLEL_SORT_MIN_CHUNK)
+            nthreads = (int)(nremaining / PARALLEL_SORT_MIN_CHUNK);
+        if (nthreads > 1) {
+            if (parallel_sort(&ms, lo, nremaining, nthreads) < 0)
                 goto fail;
-            n = force;
+            goto succeed;
         }
-        /* Push run onto pending-runs stack, and maybe merge. */
-        assert(ms.n < MAX_MERGE_PENDING);
-        ms.pending[ms.n].base = lo;
-        ms.pending[ms.n].len = n;
-        ++ms.n;
-        if (merge_collapse(&ms) < 0)
-            goto fail;
-        /* Advance to find next run. */
-        sortslice_advance(&lo, n);
-        nremaining -= n;
-    } while (nremaining);
-
-    if (merge_force_collapse(&ms) < 0)
+    }
+#endif
+    if (sort_slice(&ms, lo, nremaining) < 0)
         goto fail;
-    assert(ms.n == 1);
-    assert(keys == NULL
-           ? ms.pending[0].base.keys == saved_ob_item
-           : ms.pending[0].base.keys == &keys[0]);
-    assert(ms.pending[0].len == saved_ob_size);
-    lo = ms.pending[0].base;
 
 succeed:
     result = Py_None;
@@ -2361,7 +2742,7 @@ PyDoc_STRVAR(count_doc,
 PyDoc_STRVAR(reverse_doc,
 "L.reverse() -- reverse *IN PLACE*");
 PyDoc_STRVAR(sort_doc,
-"L.sort(key=None, reverse=False) -> None -- stable sort *IN PLACE*");
+"L.sort(key=None, reverse=False, parallel=False) -> None -- stable sort *IN PLACE*");
 
 static PyObject *list_subscript(PyListObject*, PyObject*);
 
@@ -1599,6 +1599,13 @@ long_to_decimal_string_internal(PyObject *aa,
     size_a = Py_ABS(Py_SIZE(a));
     negative = Py_SIZE(a) < 0;
 
+    /* "0" to "9" are shared strings */
+    if (writer == NULL && !negative
+        && (size_a == 0 || (size_a == 1 && a->ob_digit[0] < 10))) {
+        *p_output = PyUnicode_FromOrdinal('0' + (size_a ? a->ob_digit[0] : 0));
+        return *p_output != NULL ? 0 : -1;
+    }
+
     /* quick and dirty upper bound for the number of digits
        required to express a in base _PyLong_DECIMAL_BASE:
 
@@ -26,8 +26,13 @@
 
 #include "Python.h"
 #include "structmember.h"
+#include "pycpu.h"
 #include "stringlib/eq.h"
 
+#ifdef Py_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
 /* Object used as dummy key to fill deleted entries */
 static PyObject _dummy_struct;
 
@@ -45,6 +50,57 @@ static PyObject _dummy_struct;
 /* This must be >= 1 */
 #define PERTURB_SHIFT 5
 
+/* The entries following the first probe are examined as a group: a bitmask
+   flags the entries of the group which need a closer look, i.e. the unused
+   entries, the dummies and the entries with the searched hash.  Without
+   vector instructions, all of them are flagged. */
+#define LINEAR_PROBES_ALL ((1U << LINEAR_PROBES) - 1)
+
+#ifdef Py_CPU_DISPATCH
+/* Two entries fit in an AVX2 register, as (key, hash, key, hash).
+   Comparing it against (NULL, hash, NULL, hash) and (NULL, -1, NULL, -1)
+   flags both entries at once.  Hashes are never -1, except for dummies. */
+Py_TARGET_AVX2 static unsigned int
+linear_probes_avx2(setentry *entry, Py_hash_t hash)
+{
+    const __m256i target = _mm256_set_epi64x(hash, 0, hash, 0);
+    const __m256i dummies = _mm256_set_epi64x(-1, 0, -1, 0);
+    unsigned int bits = 0, m;
+    int j;
+
+    for (j = 0; j + 1 < LINEAR_PROBES; j += 2) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(entry + j));
+        __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi64(v, target),
+                                     _mm256_cmpeq_epi64(v, dummies));
+        m = (unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(eq));
+        /* bits 0-1 are for the first entry, bits 2-3 for the second one */
+        m |= m >> 1;
+        bits |= ((m & 1) | ((m >> 1) & 2)) << j;
+    }
+#if LINEAR_PROBES & 1
+    if (entry[j].key == NULL || entry[j].hash == hash || entry[j].hash == -1)
+        bits |= 1U << j;
+#endif
+    return bits;
+}
+#endif
+
+/* Index of the lowest bit set in bits, which must not be 0 */
+static int
+lowest_bit(unsigned int bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(bits);
+#else
+    int n = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
 static setentry *
 set_lookkey(PySetObject *so, PyObject *key, Py_hash_t hash)
 {
@@ -54,7 +110,6 @@ set_lookkey(PySetObject *so, PyObject *key, Py_hash_t hash)
     size_t perturb = hash;
     size_t mask = so->mask;
     size_t i = (size_t)hash & mask; /* Unsigned for defined overflow behavior */
-    size_t j;
     int cmp;
 
     entry = &table[i];
@@ -87,8 +142,15 @@ set_lookkey(PySetObject *so, PyObject *key, Py_hash_t hash)
             freeslot = entry;
 
         if (i + LINEAR_PROBES <= mask) {
-            for (j = 0 ; j < LINEAR_PROBES ; j++) {
-                entry++;
+            setentry *group = entry + 1;
+            unsigned int candidates = LINEAR_PROBES_ALL;
+#ifdef Py_CPU_DISPATCH
+            if (_Py_CPU_HAS(_Py_CPU_AVX2))
+                candidates = linear_probes_avx2(group, hash);
+#endif
+            while (candidates) {
+                entry = group + lowest_bit(candidates);
+                candidates &= candidates - 1;
                 if (entry->key == NULL)
                     goto found_null;
                 if (entry->hash == hash) {
@@ -170,6 +232,18 @@ set_insert_clean(PySetObject *so, PyObject *key, Py_hash_t hash)
 /* ======================================================================== */
 
 
+/* Exact frozensets holding only atomic keys may be untracked (see
+   _PyFrozenSet_MaybeUntrack).  A frozenset is still filled in place while it
+   is being built, so any insertion of a key which may be tracked has to put
+   the set back under the collector's control. */
+#define MAINTAIN_TRACKING(so, key) \
+    do { \
+        if (!_PyObject_GC_IS_TRACKED(so) && \
+            _PyObject_GC_MAY_BE_TRACKED(key)) { \
+            _PyObject_GC_TRACK(so); \
+        } \
+    } while(0)
+
 /*
 Internal routine to insert a new key into the table.
 Used by the public insert routine.
@@ -185,12 +259,14 @@ set_insert_key(PySetObject *so, PyObject *key, Py_hash_t hash)
         return -1;
     if (entry->key == NULL) {
         /* UNUSED */
+        MAINTAIN_TRACKING(so, key);
         entry->key = key;
         entry->hash = hash;
         so->fill++;
         so->used++;
     } else if (entry->key == dummy) {
         /* DUMMY */
+        MAINTAIN_TRACKING(so, key);
         entry->key = key;
         entry->hash = hash;
         so->used++;
@@ -574,6 +650,7 @@ set_merge(PySetObject *so, PyObject *otherset)
             key = other_entry->key;
             if (key != NULL) {
                 assert(so_entry->key == NULL);
+                MAINTAIN_TRACKING(so, key);
                 Py_INCREF(key);
                 so_entry->key = key;
                 so_entry->hash = other_entry->hash;
@@ -589,6 +666,7 @@ set_merge(PySetObject *so, PyObject *otherset)
         for (i = 0; i <= other->mask; i++, other_entry++) {
             key = other_entry->key;
             if (key != NULL && key != dummy) {
+                MAINTAIN_TRACKING(so, key);
                 Py_INCREF(key);
                 set_insert_clean(so, key, other_entry->hash);
             }
@@ -671,6 +749,26 @@ set_pop(PySetObject *so)
 PyDoc_STRVAR(pop_doc, "Remove and return an arbitrary set element.\n\
 Raises KeyError if the set is empty.");
 
+/* Untrack an exact frozenset whose keys are all atomic.  Like tuples,
+   frozensets can't change once they are built, so such a set can never
+   take part in a reference cycle. */
+void
+_PyFrozenSet_MaybeUntrack(PyObject *op)
+{
+    PySetObject *so;
+    Py_ssize_t pos = 0;
+    setentry *entry;
+
+    if (!PyFrozenSet_CheckExact(op) || !_PyObject_GC_IS_TRACKED(op))
+        return;
+    so = (PySetObject *)op;
+    while (set_next(so, &pos, &entry)) {
+        if (_PyObject_GC_MAY_BE_TRACKED(entry->key))
+            return;
+    }
+    _PyObject_GC_UNTRACK(op);
+}
+
 static int
 set_traverse(PySetObject *so, visitproc visit, void *arg)
 {
@@ -1031,8 +1129,12 @@ frozenset_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
             return iterable;
         }
         result = make_new_set(type, iterable);
-        if (result == NULL || PySet_GET_SIZE(result))
+        if (result == NULL)
+            return NULL;
+        if (PySet_GET_SIZE(result)) {
+            _PyFrozenSet_MaybeUntrack(result);
             return result;
+        }
         Py_DECREF(result);
     }
     /* The empty frozenset is a singleton */
@@ -32,6 +32,20 @@
 #define STRINGLIB_BLOOM(mask, ch)     \
     ((mask &  (1UL << ((ch) & (STRINGLIB_BLOOM_WIDTH -1)))))
 
+/* Forward searches give up on the candidate filtering and switch to the
+   two-way algorithm once the characters compared to verify candidates
+   exceed the needle length plus a quarter of the haystack scanned so far.
+   This keeps the worst case linear, without slowing down the common case
+   where candidates fail early. */
+#define STRINGLIB_TWO_WAY_MIN_NEEDLE 8
+#define STRINGLIB_TOO_MANY_HITS(hits, m, scanned) \
+    ((m) >= STRINGLIB_TWO_WAY_MIN_NEEDLE && (hits) > (m) + ((scanned) >> 2))
+
+#include "pycpu.h"
+#ifdef Py_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
 
 Py_LOCAL_INLINE(Py_ssize_t)
 STRINGLIB(fastsearch_memchr_1char)(const STRINGLIB_CHAR* s, Py_ssize_t n,
@@ -80,13 +94,272 @@ STRINGLIB(fastsearch_memchr_1char)(const STRINGLIB_CHAR* s, Py_ssize_t n,
 #undef DO_MEMCHR
 }
 
+/* The two-way string matching algorithm of Crochemore and Perrin, which
+   runs in linear time and constant space.  The needle is cut at a
+   critical position found from its two maximal suffixes (for opposite
+   orders); the right part is matched left to right, then the left part
+   right to left.  See "Two-way string-matching", J. ACM 38(3), 1991. */
+
+/* Return the start of the maximal suffix of p (for the usual order of
+   characters, or the reverse one if invert is true), and set *period to
+   the period of that suffix. */
+Py_LOCAL_INLINE(Py_ssize_t)
+STRINGLIB(_maximal_suffix)(const STRINGLIB_CHAR *p, Py_ssize_t m,
+                           Py_ssize_t *period, int invert)
+{
+    Py_ssize_t ms = -1, j = 0, k = 1, per = 1;
+
+    while (j + k < m) {
+        STRINGLIB_CHAR a = p[j + k];
+        STRINGLIB_CHAR b = p[ms + k];
+        if (invert ? (a > b) : (a < b)) {
+            j += k;
+            k = 1;
+            per = j - ms;
+        }
+        else if (a == b) {
+            if (k != per)
+                k++;
+            else {
+                j += per;
+                k = 1;
+            }
+        }
+        else {
+            ms = j;
+            j = ms + 1;
+            k = per = 1;
+        }
+    }
+    *period = per;
+    return ms;
+}
+
+/* Forward search (FAST_SEARCH or FAST_COUNT) for p in s with the two-way
+   algorithm.  Counted matches don't overlap, as in FASTSEARCH(). */
+Py_LOCAL_INLINE(Py_ssize_t)
+STRINGLIB(_two_way)(const STRINGLIB_CHAR *s, Py_ssize_t n,
+                    const STRINGLIB_CHAR *p, Py_ssize_t m,
+                    Py_ssize_t maxcount, int mode)
+{
+    Py_ssize_t ell, per, ell2, per2, i, j, memory;
+    Py_ssize_t count = 0;
+    int periodic;
+
+    assert(m >= 1 && mode != FAST_RSEARCH);
+    if (n < m)
+        return mode == FAST_COUNT ? 0 : -1;
+
+    ell = STRINGLIB(_maximal_suffix)(p, m, &per, 0);
+    ell2 = STRINGLIB(_maximal_suffix)(p, m, &per2, 1);
+    if (ell2 > ell) {
+        ell = ell2;
+        per = per2;
+    }
+    /* p[:ell+1] is then a suffix of p[:per+ell+1] iff p is periodic */
+    periodic = per + ell + 1 <= m &&
+        memcmp(p, p + per, (ell + 1) * sizeof(STRINGLIB_CHAR)) == 0;
+    if (!periodic)
+        per = Py_MAX(ell + 1, m - ell - 1) + 1;
+
+    j = 0;
+    memory = -1;
+    while (j <= n - m) {
+        i = Py_MAX(ell, memory) + 1;
+        while (i < m && p[i] == s[i + j])
+            i++;
+        if (i < m) {
+            j += i - ell;
+            memory = -1;
+            continue;
+        }
+        i = ell;
+        while (i > memory && p[i] == s[i + j])
+            i--;
+        if (i > memory) {
+            j += per;
+            if (periodic)
+                memory = m - per - 1;
+            continue;
+        }
+        /* got a match! */
+        if (mode != FAST_COUNT)
+            return j;
+        count++;
+        if (count == maxcount)
+            return maxcount;
+        j += m;
+        memory = -1;
+    }
+    return mode == FAST_COUNT ? count : -1;
+}
+
+#ifdef Py_CPU_DISPATCH
+
+/* AVX2 versions of the searches, for the width of STRINGLIB_CHAR.  Bits
+   of _mm256_movemask_epi8() come in groups of STRINGLIB_SIZEOF_CHAR for
+   each character; STRINGLIB_AVX2_KEEP keeps one bit per character. */
+#if STRINGLIB_SIZEOF_CHAR == 1
+#  define STRINGLIB_AVX2_SET1(ch)   _mm256_set1_epi8((char)(ch))
+#  define STRINGLIB_AVX2_CMPEQ      _mm256_cmpeq_epi8
+#  define STRINGLIB_AVX2_KEEP       0xFFFFFFFFu
+#elif STRINGLIB_SIZEOF_CHAR == 2
+#  define STRINGLIB_AVX2_SET1(ch)   _mm256_set1_epi16((short)(ch))
+#  define STRINGLIB_AVX2_CMPEQ      _mm256_cmpeq_epi16
+#  define STRINGLIB_AVX2_KEEP       0x55555555u
+#else
+#  define STRINGLIB_AVX2_SET1(ch)   _mm256_set1_epi32((int)(ch))
+#  define STRINGLIB_AVX2_CMPEQ      _mm256_cmpeq_epi32
+#  define STRINGLIB_AVX2_KEEP       0x11111111u
+#endif
+/* Characters per vector */
+#define STRINGLIB_AVX2_CHARS (32 / STRINGLIB_SIZEOF_CHAR)
+
+Py_TARGET_AVX2 static unsigned int
+STRINGLIB(_avx2_match)(const STRINGLIB_CHAR *s, __m256i v)
+{
+    __m256i block = _mm256_loadu_si256((const __m256i *)s);
+    return (unsigned int)_mm256_movemask_epi8(STRINGLIB_AVX2_CMPEQ(block, v))
+        & STRINGLIB_AVX2_KEEP;
+}
+
+Py_TARGET_AVX2 static Py_ssize_t
+STRINGLIB(_avx2_find_char)(const STRINGLIB_CHAR *s, Py_ssize_t n,
+                           STRINGLIB_CHAR ch)
+{
+    __m256i v = STRINGLIB_AVX2_SET1(ch);
+    Py_ssize_t i;
+
+    for (i = 0; i + STRINGLIB_AVX2_CHARS <= n; i += STRINGLIB_AVX2_CHARS) {
+        unsigned int mask = STRINGLIB(_avx2_match)(s + i, v);
+        if (mask)
+            return i + __builtin_ctz(mask) / STRINGLIB_SIZEOF_CHAR;
+    }
+    for (; i < n; i++)
+        if (s[i] == ch)
+            return i;
+    return -1;
+}
+
+Py_TARGET_AVX2 static Py_ssize_t
+STRINGLIB(_avx2_rfind_char)(const STRINGLIB_CHAR *s, Py_ssize_t n,
+                            STRINGLIB_CHAR ch)
+{
+    __m256i v = STRINGLIB_AVX2_SET1(ch);
+    Py_ssize_t i = n;
+
+    for (; i >= STRINGLIB_AVX2_CHARS; i -= STRINGLIB_AVX2_CHARS) {
+        unsigned int mask = STRINGLIB(_avx2_match)(
+            s + i - STRINGLIB_AVX2_CHARS, v);
+        if (mask)
+            return i - STRINGLIB_AVX2_CHARS
+                + (31 - __builtin_clz(mask)) / STRINGLIB_SIZEOF_CHAR;
+    }
+    while (--i >= 0)
+        if (s[i] == ch)
+            return i;
+    return -1;
+}
+
+Py_TARGET_AVX2 static Py_ssize_t
+STRINGLIB(_avx2_count_char)(const STRINGLIB_CHAR *s, Py_ssize_t n,
+                            STRINGLIB_CHAR ch, Py_ssize_t maxcount)
+{
+    __m256i v = STRINGLIB_AVX2_SET1(ch);
+    Py_ssize_t i, count = 0;
+
+    for (i = 0; i + STRINGLIB_AVX2_CHARS <= n; i += STRINGLIB_AVX2_CHARS) {
+        count += __builtin_popcount(STRINGLIB(_avx2_match)(s + i, v));
+        if (count >= maxcount)
+            return maxcount;
+    }
+    for (; i < n; i++)
+        if (s[i] == ch) {
+            count++;
+            if (count == maxcount)
+                return maxcount;
+        }
+    return count;
+}
+
+/* Forward search for a needle of 2 characters or more: compare the first
+   and the last characters of the needle with a block of positions at once,
+   and only verify the positions where both match (the "generic SIMD"
+   algorithm of Wojciech Mula). */
+Py_TARGET_AVX2 static Py_ssize_t
+STRINGLIB(_avx2_find)(const STRINGLIB_CHAR *s, Py_ssize_t n,
+                      const STRINGLIB_CHAR *p, Py_ssize_t m,
+                      Py_ssize_t maxcount, int mode)
+{
+    const Py_ssize_t w = n - m, mlast = m - 1;
+    const __m256i first = STRINGLIB_AVX2_SET1(p[0]);
+    const __m256i last = STRINGLIB_AVX2_SET1(p[mlast]);
+    Py_ssize_t i = 0, next = 0, count = 0, hits = 0;
+
+    assert(m >= 2 && w >= 0 && mode != FAST_RSEARCH);
+    while (i <= w) {
+        unsigned int mask;
+        Py_ssize_t block;
+
+        if (i + STRINGLIB_AVX2_CHARS - 1 <= w) {
+            mask = STRINGLIB(_avx2_match)(s + i, first)
+                & STRINGLIB(_avx2_match)(s + i + mlast, last);
+            block = STRINGLIB_AVX2_CHARS;
+        }
+        else {
+            /* Fewer than a vector of positions left. */
+            Py_ssize_t k;
+            mask = 0;
+            block = w - i + 1;
+            for (k = 0; k < block; k++)
+                if (s[i + k] == p[0] && s[i + k + mlast] == p[mlast])
+                    mask |= 1u << (k * STRINGLIB_SIZEOF_CHAR);
+        }
+        while (mask) {
+            Py_ssize_t pos = i + __builtin_ctz(mask) / STRINGLIB_SIZEOF_CHAR;
+            Py_ssize_t j;
+
+            mask &= mask - 1;
+            if (pos < next)
+                /* overlaps the previous match */
+                continue;
+            for (j = 1; j < mlast; j++)
+                if (s[pos + j] != p[j])
+                    break;
+            if (j < mlast) {
+                hits += j;
+                if (STRINGLIB_TOO_MANY_HITS(hits, m, pos)) {
+                    Py_ssize_t res = STRINGLIB(_two_way)(
+                        s + pos + 1, n - pos - 1, p, m,
+                        maxcount - count, mode);
+                    if (mode == FAST_COUNT)
+                        return count + res;
+                    return res == -1 ? -1 : pos + 1 + res;
+                }
+                continue;
+            }
+            /* got a match! */
+            if (mode != FAST_COUNT)
+                return pos;
+            count++;
+            if (count == maxcount)
+                return maxcount;
+            next = pos + m;
+        }
+        i = Py_MAX(i + block, next);
+    }
+    return mode == FAST_COUNT ? count : -1;
+}
+
+#endif /* Py_CPU_DISPATCH */
+
 Py_LOCAL_INLINE(Py_ssize_t)
 FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
            const STRINGLIB_CHAR* p, Py_ssize_t m,
            Py_ssize_t maxcount, int mode)
 {
     unsigned long mask;
-    Py_ssize_t skip, count = 0;
+    Py_ssize_t skip, count = 0, hits = 0;
     Py_ssize_t i, j, mlast, w;
 
     w = n - m;
@@ -98,6 +371,17 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
     if (m <= 1) {
         if (m <= 0)
             return -1;
+#ifdef Py_CPU_DISPATCH
+        if (_Py_CPU_HAS(_Py_CPU_AVX2)) {
+            if (mode == FAST_COUNT)
+                return STRINGLIB(_avx2_count_char)(s, n, p[0], maxcount);
+            /* memchr() and memrchr() do well enough on bytes */
+            if (STRINGLIB_SIZEOF_CHAR > 1 && mode == FAST_SEARCH)
+                return STRINGLIB(_avx2_find_char)(s, n, p[0]);
+            if (STRINGLIB_SIZEOF_CHAR > 1 && mode == FAST_RSEARCH)
+                return STRINGLIB(_avx2_rfind_char)(s, n, p[0]);
+        }
+#endif
         /* use special case for 1-character strings */
         if (n > 10 && (mode == FAST_SEARCH
 #ifdef HAVE_MEMRCHR
@@ -137,6 +421,11 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
         return -1;
     }
 
+#ifdef Py_CPU_DISPATCH
+    if (mode != FAST_RSEARCH && _Py_CPU_HAS(_Py_CPU_AVX2))
+        return STRINGLIB(_avx2_find)(s, n, p, m, maxcount, mode);
+#endif
+
     mlast = m - 1;
     skip = mlast - 1;
     mask = 0;
@@ -173,6 +462,14 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
                     i = i + mlast;
                     continue;
                 }
+                hits += j + 1;
+                if (STRINGLIB_TOO_MANY_HITS(hits, m, i)) {
+                    Py_ssize_t res = STRINGLIB(_two_way)(
+                        s + i + 1, n - i - 1, p, m, maxcount - count, mode);
+                    if (mode == FAST_COUNT)
+                        return count + res;
+                    return res == -1 ? -1 : i + 1 + res;
+                }
                 /* miss: check if next character is part of pattern */
                 if (!STRINGLIB_BLOOM(mask, ss[i+1]))
                     i = i + m;
@@ -50,6 +50,141 @@
 /* Always force the list to the expected size. */
 #define FIX_PREALLOC_SIZE(list) Py_SIZE(list) = count
 
+#ifdef Py_CPU_DISPATCH
+
+/* With AVX2, split_char(), rsplit_char() and splitlines() don't test the
+   characters one at a time: a scanner compares a block of
+   STRINGLIB_AVX2_CHARS characters at once, keeps the positions of the
+   matches as a bit mask (one bit per character, as in fastsearch.h) and
+   hands them out in order.  For line breaks, the block is compared with a
+   superset of them which is cheap to test with vectors (all characters
+   from '\n' to '\x1e' for str); the callers check the candidates with
+   STRINGLIB_ISLINEBREAK(). */
+
+#define STRINGLIB_SCAN_MIN_LENGTH (2 * STRINGLIB_AVX2_CHARS)
+
+#if STRINGLIB_SIZEOF_CHAR == 1
+#  define STRINGLIB_AVX2_SUB        _mm256_sub_epi8
+#  define STRINGLIB_AVX2_MIN        _mm256_min_epu8
+#elif STRINGLIB_SIZEOF_CHAR == 2
+#  define STRINGLIB_AVX2_SUB        _mm256_sub_epi16
+#  define STRINGLIB_AVX2_MIN        _mm256_min_epu16
+#else
+#  define STRINGLIB_AVX2_SUB        _mm256_sub_epi32
+#  define STRINGLIB_AVX2_MIN        _mm256_min_epu32
+#endif
+
+typedef struct {
+    const STRINGLIB_CHAR *str;
+    Py_ssize_t len;
+    Py_ssize_t block;           /* start of the current block */
+    unsigned int mask;          /* matches not handed out yet */
+    STRINGLIB_CHAR ch;
+    int linebreaks;             /* scan for line breaks instead of ch */
+} STRINGLIB(_scanner);
+
+Py_TARGET_AVX2 static unsigned int
+STRINGLIB(_avx2_linebreaks)(const STRINGLIB_CHAR *s)
+{
+    const __m256i v = _mm256_loadu_si256((const __m256i *)s);
+    __m256i hits;
+
+#if defined(STRINGLIB_IS_UNICODE) && STRINGLIB_IS_UNICODE
+    /* '\n' <= c <= '\x1e', c == '\x85', or c is U+2028 or U+2029 */
+    const __m256i off = STRINGLIB_AVX2_SUB(v, STRINGLIB_AVX2_SET1('\n'));
+    hits = STRINGLIB_AVX2_CMPEQ(
+        STRINGLIB_AVX2_MIN(off, STRINGLIB_AVX2_SET1(0x1e - '\n')), off);
+    hits = _mm256_or_si256(
+        hits, STRINGLIB_AVX2_CMPEQ(v, STRINGLIB_AVX2_SET1(0x85)));
+#if STRINGLIB_SIZEOF_CHAR > 1
+    hits = _mm256_or_si256(
+        hits, STRINGLIB_AVX2_CMPEQ(
+            _mm256_and_si256(v, STRINGLIB_AVX2_SET1(~1)),
+            STRINGLIB_AVX2_SET1(0x2028)));
+#endif
+#else
+    hits = _mm256_or_si256(STRINGLIB_AVX2_CMPEQ(v, STRINGLIB_AVX2_SET1('\n')),
+                           STRINGLIB_AVX2_CMPEQ(v, STRINGLIB_AVX2_SET1('\r')));
+#endif
+    return (unsigned int)_mm256_movemask_epi8(hits) & STRINGLIB_AVX2_KEEP;
+}
+
+/* Return the mask of the matches in str[start:stop], a block of at most
+   STRINGLIB_AVX2_CHARS characters. */
+Py_TARGET_AVX2 static unsigned int
+STRINGLIB(_scanner_block)(STRINGLIB(_scanner) *sc,
+                          Py_ssize_t start, Py_ssize_t stop)
+{
+    const STRINGLIB_CHAR *s = sc->str + start;
+    unsigned int mask = 0;
+    Py_ssize_t i;
+
+    if (stop - start == STRINGLIB_AVX2_CHARS) {
+        if (sc->linebreaks)
+            return STRINGLIB(_avx2_linebreaks)(s);
+        return STRINGLIB(_avx2_match)(s, STRINGLIB_AVX2_SET1(sc->ch));
+    }
+    /* Fewer than a vector of characters left. */
+    for (i = 0; i < stop - start; i++)
+        if (sc->linebreaks ? STRINGLIB_ISLINEBREAK(s[i]) : s[i] == sc->ch)
+            mask |= 1u << (i * STRINGLIB_SIZEOF_CHAR);
+    return mask;
+}
+
+Py_LOCAL_INLINE(void)
+STRINGLIB(_scanner_init)(STRINGLIB(_scanner) *sc,
+                         const STRINGLIB_CHAR *str, Py_ssize_t str_len,
+                         STRINGLIB_CHAR ch, int linebreaks, int reverse)
+{
+    sc->str = str;
+    sc->len = str_len;
+    sc->block = reverse ? str_len : -STRINGLIB_AVX2_CHARS;
+    sc->mask = 0;
+    sc->ch = ch;
+    sc->linebreaks = linebreaks;
+}
+
+/* Return the index of the next match, or -1. */
+Py_LOCAL_INLINE(Py_ssize_t)
+STRINGLIB(_scanner_next)(STRINGLIB(_scanner) *sc)
+{
+    unsigned int bit;
+
+    while (sc->mask == 0) {
+        sc->block += STRINGLIB_AVX2_CHARS;
+        if (sc->block >= sc->len)
+            return -1;
+        sc->mask = STRINGLIB(_scanner_block)(
+            sc, sc->block, Py_MIN(sc->block + STRINGLIB_AVX2_CHARS, sc->len));
+    }
+    bit = __builtin_ctz(sc->mask);
+    sc->mask &= sc->mask - 1;
+    return sc->block + bit / STRINGLIB_SIZEOF_CHAR;
+}
+
+/* Return the index of the previous match, or -1. */
+Py_LOCAL_INLINE(Py_ssize_t)
+STRINGLIB(_scanner_prev)(STRINGLIB(_scanner) *sc)
+{
+    unsigned int bit;
+
+    while (sc->mask == 0) {
+        Py_ssize_t stop = sc->block;
+        if (stop == 0)
+            return -1;
+        sc->block = Py_MAX(stop - STRINGLIB_AVX2_CHARS, 0);
+        sc->mask = STRINGLIB(_scanner_block)(sc, sc->block, stop);
+    }
+    bit = 31 - __builtin_clz(sc->mask);
+    sc->mask &= ~(1u << bit);
+    return sc->block + bit / STRINGLIB_SIZEOF_CHAR;
+}
+
+#undef STRINGLIB_AVX2_SUB
+#undef STRINGLIB_AVX2_MIN
+
+#endif /* Py_CPU_DISPATCH */
+
 Py_LOCAL_INLINE(PyObject *)
 STRINGLIB(split_whitespace)(PyObject* str_obj,
                            const STRINGLIB_CHAR* str, Py_ssize_t str_len,
@@ -112,6 +247,18 @@ STRINGLIB(split_char)(PyObject* str_obj,
         return NULL;
 
     i = j = 0;
+#ifdef Py_CPU_DISPATCH
+    if (str_len >= STRINGLIB_SCAN_MIN_LENGTH && _Py_CPU_HAS(_Py_CPU_AVX2)) {
+        STRINGLIB(_scanner) sc;
+
+        STRINGLIB(_scanner_init)(&sc, str, str_len, ch, 0, 0);
+        while (maxcount-- > 0 && (j = STRINGLIB(_scanner_next)(&sc)) >= 0) {
+            SPLIT_ADD(str, i, j);
+            i = j + 1;
+        }
+    }
+    else
+#endif
     while ((j < str_len) && (maxcount-- > 0)) {
         for(; j < str_len; j++) {
             /* I found that using memchr makes no difference */
@@ -253,6 +400,18 @@ STRINGLIB(rsplit_char)(PyObject* str_obj,
         return NULL;
 
     i = j = str_len - 1;
+#ifdef Py_CPU_DISPATCH
+    if (str_len >= STRINGLIB_SCAN_MIN_LENGTH && _Py_CPU_HAS(_Py_CPU_AVX2)) {
+        STRINGLIB(_scanner) sc;
+
+        STRINGLIB(_scanner_init)(&sc, str, str_len, ch, 0, 1);
+        while (maxcount-- > 0 && (i = STRINGLIB(_scanner_prev)(&sc)) >= 0) {
+            SPLIT_ADD(str, i + 1, j + 1);
+            j = i - 1;
+        }
+    }
+    else
+#endif
     while ((i >= 0) && (maxcount-- > 0)) {
         for(; i >= 0; i--) {
             if (str[i] == ch) {
@@ -349,14 +508,35 @@ STRINGLIB(splitlines)(PyObject* str_obj,
     Py_ssize_t j;
     PyObject *list = PyList_New(0);
     PyObject *sub;
+#ifdef Py_CPU_DISPATCH
+    STRINGLIB(_scanner) sc;
+    int scan = (str_len >= STRINGLIB_SCAN_MIN_LENGTH &&
+                _Py_CPU_HAS(_Py_CPU_AVX2));
+#endif
 
     if (list == NULL)
         return NULL;
 
+#ifdef Py_CPU_DISPATCH
+    if (scan)
+        STRINGLIB(_scanner_init)(&sc, str, str_len, 0, 1, 0);
+#endif
     for (i = j = 0; i < str_len; ) {
         Py_ssize_t eol;
 
         /* Find a line and append it */
+#ifdef Py_CPU_DISPATCH
+        if (scan) {
+            /* Skip the candidates which aren't line breaks, and the '\n'
+               of a CRLF already consumed below. */
+            do {
+                i = STRINGLIB(_scanner_next)(&sc);
+            } while (i >= 0 && (i < j || !STRINGLIB_ISLINEBREAK(str[i])));
+            if (i < 0)
+                i = str_len;
+        }
+        else
+#endif
         while (i < str_len && !STRINGLIB_ISLINEBREAK(str[i]))
             i++;
 
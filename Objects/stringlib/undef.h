@@ -9,3 +9,7 @@
 #undef  _Py_InsertThousandsGrouping
 #undef STRINGLIB_IS_UNICODE
 
+#undef STRINGLIB_AVX2_SET1
+#undef STRINGLIB_AVX2_CMPEQ
+#undef STRINGLIB_AVX2_KEEP
+#undef STRINGLIB_AVX2_CHARS
@@ -485,14 +485,15 @@ error:
     get_field_and_spec, and renders the field into the output string.
 
     render_field calls fieldobj.__format__(format_spec) method, and
-    appends to the output.
+    appends to the output.  format_spec_object is format_spec as a str
+    object if the caller has one, or NULL.
 */
 static int
-render_field(PyObject *fieldobj, SubString *format_spec, _PyUnicodeWriter *writer)
+render_field(PyObject *fieldobj, SubString *format_spec,
+             PyObject *format_spec_object, _PyUnicodeWriter *writer)
 {
     int ok = 0;
     PyObject *result = NULL;
-    PyObject *format_spec_object = NULL;
     int (*formatter) (_PyUnicodeWriter*, PyObject *, PyObject *, Py_ssize_t, Py_ssize_t) = NULL;
     int err;
 
@@ -514,6 +515,10 @@ render_field(PyObject *fieldobj, SubString *format_spec, _PyUnicodeWriter *write
                         format_spec->start, format_spec->end);
         return (err == 0);
     }
+    else if (format_spec_object != NULL) {
+        Py_INCREF(format_spec_object);
+        result = PyObject_Format(fieldobj, format_spec_object);
+    }
     else {
         /* We need to create an object out of the pointers we have, because
            __format__ takes a string/unicode object for format_spec. */
@@ -837,7 +842,7 @@ output_markup(SubString *field_name, SubString *format_spec,
     else
         actual_format_spec = format_spec;
 
-    if (render_field(fieldobj, actual_format_spec, writer) == 0)
+    if (render_field(fieldobj, actual_format_spec, NULL, writer) == 0)
         goto done;
 
     result = 1;
@@ -924,6 +929,239 @@ build_string(SubString *input, PyObject *args, PyObject *kwargs,
     return _PyUnicodeWriter_Finish(&writer);
 }
 
+/************************************************************************/
+/*********** compiled format strings ************************************/
+/************************************************************************/
+
+/* A compiled format string is a list of fields, each preceded by literal
+   text.  The last field may consist of literal text only.  Only fields
+   whose name is a plain argument index or keyword, without attribute or
+   index lookups, and whose format spec contains no replacement fields are
+   supported; see format_cache_get(). */
+
+typedef struct {
+    Py_ssize_t literal_start, literal_end;
+    int field_present;
+    /* index of the positional argument, or -1 for a keyword argument */
+    Py_ssize_t index;
+    PyObject *name;
+    Py_UCS4 conversion;
+    SubString format_spec;
+    /* format_spec as a str, for types without a builtin formatter */
+    PyObject *format_spec_object;
+} CompiledField;
+
+static void
+compiled_fields_clear(format_template *t)
+{
+    CompiledField *fields = t->items;
+    Py_ssize_t i;
+
+    for (i = 0; i < t->nitems; i++) {
+        Py_XDECREF(fields[i].name);
+        Py_XDECREF(fields[i].format_spec_object);
+    }
+}
+
+/* Free the fields of a template being compiled */
+static void
+compiled_fields_free(CompiledField *fields, Py_ssize_t nfields)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < nfields; i++) {
+        Py_XDECREF(fields[i].name);
+        Py_XDECREF(fields[i].format_spec_object);
+    }
+    PyMem_Free(fields);
+}
+
+static int
+compile_field(CompiledField *field, SubString *field_name,
+              SubString *format_spec, Py_UCS4 conversion,
+              AutoNumber *auto_number)
+{
+    SubString first;
+    FieldNameIterator rest;
+
+    if (!field_name_split(field_name->str, field_name->start, field_name->end,
+                          &first, &field->index, &rest, auto_number))
+        return 0;
+    if (rest.str.start < rest.str.end)
+        return 0;
+    if (conversion != '\0' && conversion != 'r' && conversion != 's'
+        && conversion != 'a')
+        return 0;
+    if (field->index == -1) {
+        field->name = SubString_new_object(&first);
+        if (field->name == NULL)
+            return 0;
+        PyUnicode_InternInPlace(&field->name);
+    }
+    field->conversion = conversion;
+    field->format_spec = *format_spec;
+    field->format_spec_object = SubString_new_object_or_empty(format_spec);
+    if (field->format_spec_object == NULL)
+        return 0;
+    return 1;
+}
+
+static format_template *
+compile_format(PyObject *format)
+{
+    format_template *t;
+    CompiledField *fields = NULL, *field;
+    Py_ssize_t nfields = 0, allocated = 0;
+    MarkupIterator iter;
+    AutoNumber auto_number;
+    SubString literal, field_name, format_spec;
+    Py_UCS4 conversion;
+    int field_present, format_spec_needs_expanding;
+    int result;
+
+    t = format_template_new(format, FORMAT_BRACES);
+    if (t == NULL)
+        return NULL;
+
+    AutoNumber_Init(&auto_number);
+    MarkupIterator_init(&iter, format, 0, PyUnicode_GET_LENGTH(format));
+    while ((result = MarkupIterator_next(&iter, &literal, &field_present,
+                                         &field_name, &format_spec,
+                                         &conversion,
+                                         &format_spec_needs_expanding)) == 2) {
+        if (format_spec_needs_expanding)
+            goto not_compiled;
+        if (nfields == allocated) {
+            CompiledField *tmp;
+            allocated = allocated ? allocated * 2 : 4;
+            tmp = PyMem_Realloc(fields, allocated * sizeof(CompiledField));
+            if (tmp == NULL) {
+                PyErr_NoMemory();
+                goto error;
+            }
+            fields = tmp;
+        }
+        field = &fields[nfields++];
+        field->literal_start = literal.start;
+        field->literal_end = literal.end;
+        field->field_present = field_present;
+        field->name = NULL;
+        field->format_spec_object = NULL;
+        if (literal.end > literal.start) {
+            Py_UCS4 maxchar = _PyUnicode_FindMaxChar(format, literal.start,
+                                                     literal.end);
+            t->literal_maxchar = Py_MAX(t->literal_maxchar, maxchar);
+        }
+        if (field_present && !compile_field(field, &field_name, &format_spec,
+                                            conversion, &auto_number))
+            goto not_compiled;
+    }
+    if (result == 0)
+        goto not_compiled;
+
+    t->items = fields;
+    t->nitems = nfields;
+    t->clear_items = compiled_fields_clear;
+    return t;
+
+not_compiled:
+    if (PyErr_ExceptionMatches(PyExc_MemoryError))
+        goto error;
+    /* Leave the errors to the generic code */
+    PyErr_Clear();
+    compiled_fields_free(fields, nfields);
+    t->literal_maxchar = 127;
+    return t;
+
+error:
+    compiled_fields_free(fields, nfields);
+    format_template_decref(t);
+    return NULL;
+}
+
+static PyObject *
+compiled_field_object(CompiledField *field, PyObject *args, PyObject *kwargs)
+{
+    PyObject *obj;
+
+    if (field->index == -1) {
+        if (kwargs == NULL || (obj = PyObject_GetItem(kwargs, field->name)) == NULL) {
+            PyErr_SetObject(PyExc_KeyError, field->name);
+            return NULL;
+        }
+        return obj;
+    }
+    if (args == NULL) {
+        PyErr_SetString(PyExc_ValueError, "Format string contains "
+                        "positional fields");
+        return NULL;
+    }
+    if (PyTuple_CheckExact(args) && field->index < PyTuple_GET_SIZE(args)) {
+        obj = PyTuple_GET_ITEM(args, field->index);
+        Py_INCREF(obj);
+        return obj;
+    }
+    return PySequence_GetItem(args, field->index);
+}
+
+static PyObject *
+render_compiled_format(format_template *t, PyObject *args, PyObject *kwargs)
+{
+    _PyUnicodeWriter writer;
+    CompiledField *field = t->items;
+    Py_ssize_t i;
+    PyObject *fieldobj, *tmp;
+    int ok;
+
+    _PyUnicodeWriter_Init(&writer);
+    writer.overallocate = 1;
+    if (t->length > 0)
+        writer.min_length = t->length;
+    else
+        writer.min_length = PyUnicode_GET_LENGTH(t->format) + 100;
+    writer.min_char = t->literal_maxchar;
+
+    for (i = 0; i < t->nitems; i++, field++) {
+        int last = (i == t->nitems - 1);
+
+        if (field->literal_end != field->literal_start) {
+            if (last && !field->field_present)
+                writer.overallocate = 0;
+            if (_PyUnicodeWriter_WriteSubstring(&writer, t->format,
+                                                field->literal_start,
+                                                field->literal_end) < 0)
+                goto error;
+        }
+        if (!field->field_present)
+            continue;
+        if (last)
+            writer.overallocate = 0;
+
+        fieldobj = compiled_field_object(field, args, kwargs);
+        if (fieldobj == NULL)
+            goto error;
+        if (field->conversion != '\0') {
+            tmp = do_conversion(fieldobj, field->conversion);
+            Py_DECREF(fieldobj);
+            if (tmp == NULL || PyUnicode_READY(tmp) == -1) {
+                Py_XDECREF(tmp);
+                goto error;
+            }
+            fieldobj = tmp;
+        }
+        ok = render_field(fieldobj, &field->format_spec,
+                          field->format_spec_object, &writer);
+        Py_DECREF(fieldobj);
+        if (!ok)
+            goto error;
+    }
+    return _PyUnicodeWriter_Finish(&writer);
+
+error:
+    _PyUnicodeWriter_Dealloc(&writer);
+    return NULL;
+}
+
 /************************************************************************/
 /*********** main routine ***********************************************/
 /************************************************************************/
@@ -941,10 +1179,25 @@ do_string_format(PyObject *self, PyObject *args, PyObject *kwargs)
     int recursion_depth = 2;
 
     AutoNumber auto_number;
+    format_template *t;
+    PyObject *result;
 
     if (PyUnicode_READY(self) == -1)
         return NULL;
 
+    t = format_cache_get(self, FORMAT_BRACES, compile_format);
+    if (t != NULL) {
+        if (t->nitems >= 0) {
+            result = render_compiled_format(t, args, kwargs);
+            format_template_done(t, result);
+            format_template_decref(t);
+            return result;
+        }
+        format_template_decref(t);
+    }
+    else if (PyErr_Occurred())
+        return NULL;
+
     AutoNumber_Init(&auto_number);
     SubString_init(&input, self, 0, PyUnicode_GET_LENGTH(self));
     return build_string(&input, args, kwargs, recursion_depth, &auto_number);
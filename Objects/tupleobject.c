@@ -195,6 +195,21 @@ _PyTuple_MaybeUntrack(PyObject *op)
     _PyObject_GC_UNTRACK(op);
 }
 
+/* A tuple built only from items of an untracked exact tuple holds nothing
+   but atomic objects, so it can be untracked without looking at its items. */
+static void
+untrack_from_source(PyTupleObject *np, PyTupleObject *src)
+{
+    if (PyTuple_CheckExact(src) && !_PyObject_GC_IS_TRACKED(src) &&
+        _PyObject_GC_IS_TRACKED(np)) {
+#ifdef SHOW_TRACK_COUNT
+        count_tracked--;
+        count_untracked++;
+#endif
+        _PyObject_GC_UNTRACK(np);
+    }
+}
+
 PyObject *
 PyTuple_Pack(Py_ssize_t n, ...)
 {
@@ -419,6 +434,7 @@ tupleslice(PyTupleObject *a, Py_ssize_t ilow,
         Py_INCREF(v);
         dest[i] = v;
     }
+    untrack_from_source(np, a);
     return (PyObject *)np;
 }
 
@@ -467,6 +483,8 @@ tupleconcat(PyTupleObject *a, PyObject *bb)
         Py_INCREF(v);
         dest[i] = v;
     }
+    if (PyTuple_CheckExact(b) && !_PyObject_GC_IS_TRACKED(b))
+        untrack_from_source(np, a);
     return (PyObject *)np;
 #undef b
 }
@@ -505,6 +523,7 @@ tuplerepeat(PyTupleObject *a, Py_ssize_t n)
             p++;
         }
     }
+    untrack_from_source(np, a);
     return (PyObject *) np;
 }
 
@@ -652,8 +671,14 @@ tuple_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 
     if (arg == NULL)
         return PyTuple_New(0);
-    else
-        return PySequence_Tuple(arg);
+    else {
+        PyObject *result = PySequence_Tuple(arg);
+        /* The items were all just touched, so checking them now is cheap
+           and spares the collector from traversing an atomic tuple. */
+        if (result != NULL)
+            _PyTuple_MaybeUntrack(result);
+        return result;
+    }
 }
 
 static PyObject *
@@ -740,6 +765,7 @@ tuplesubscript(PyTupleObject* self, PyObject* item)
                 Py_INCREF(it);
                 dest[i] = it;
             }
+            untrack_from_source((PyTupleObject *)result, self);
 
             return result;
         }
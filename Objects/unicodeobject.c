@@ -42,11 +42,17 @@ OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #include "Python.h"
 #include "ucnhash.h"
 #include "bytes_methods.h"
+#include "pycpu.h"
+#include "frameobject.h"
 
 #ifdef MS_WINDOWS
 #include <windows.h>
 #endif
 
+#ifdef Py_CPU_DISPATCH
+#include <immintrin.h>
+#endif
+
 /*[clinic input]
 class str "PyUnicodeObject *" "&PyUnicode_Type"
 [clinic start generated code]*/
@@ -90,8 +96,9 @@ extern "C" {
      PyUnicode_IS_COMPACT_ASCII(op) ?                   \
          ((PyASCIIObject*)(op))->length :               \
          _PyUnicode_UTF8_LENGTH(op))
+/* Not valid for compact ASCII strings: see ascii_wstr_get() */
 #define _PyUnicode_WSTR(op)                             \
-    (((PyASCIIObject*)(op))->wstr)
+    (((PyCompactUnicodeObject*)(op))->wstr)
 #define _PyUnicode_WSTR_LENGTH(op)                      \
     (((PyCompactUnicodeObject*)(op))->wstr_length)
 #define _PyUnicode_LENGTH(op)                           \
@@ -109,6 +116,17 @@ extern "C" {
 #define _PyUnicode_DATA_ANY(op)                         \
     (((PyUnicodeObject*)(op))->data.any)
 
+/* A view (state.view set) holds the buffer exported by the bytes object
+   which owns its characters, see unicode_view_new() */
+typedef struct {
+    PyUnicodeObject base;
+    Py_buffer buffer;
+} unicode_view;
+
+#define _PyUnicode_VIEW(op)                             \
+    (assert(_PyUnicode_STATE(op).view),                 \
+     &((unicode_view *)(op))->buffer)
+
 #undef PyUnicode_READY
 #define PyUnicode_READY(op)                             \
     (assert(_PyUnicode_CHECK(op)),                      \
@@ -122,7 +140,8 @@ extern "C" {
      (_PyUnicode_UTF8(op) == PyUnicode_DATA(op)))
 #define _PyUnicode_SHARE_WSTR(op)                       \
     (assert(_PyUnicode_CHECK(op)),                      \
-     (_PyUnicode_WSTR(unicode) == PyUnicode_DATA(op)))
+     (!PyUnicode_IS_COMPACT_ASCII(op)                   \
+      && _PyUnicode_WSTR(op) == PyUnicode_DATA(op)))
 
 /* true if the Unicode object has an allocated UTF-8 memory block
    (not shared with other data) */
@@ -132,11 +151,13 @@ extern "C" {
       && _PyUnicode_UTF8(op) != PyUnicode_DATA(op)))
 
 /* true if the Unicode object has an allocated wstr memory block
-   (not shared with other data) */
+   (not shared with other data).  The wstr memory of compact ASCII strings
+   is in the ascii_wstrs table. */
 #define _PyUnicode_HAS_WSTR_MEMORY(op)                  \
-    ((_PyUnicode_WSTR(op) &&                            \
-      (!PyUnicode_IS_READY(op) ||                       \
-       _PyUnicode_WSTR(op) != PyUnicode_DATA(op))))
+    ((!PyUnicode_IS_COMPACT_ASCII(op)                   \
+      && _PyUnicode_WSTR(op)                            \
+      && (!PyUnicode_IS_READY(op) ||                    \
+          _PyUnicode_WSTR(op) != PyUnicode_DATA(op))))
 
 /* Generic helper macro to convert characters of different types.
    from_type and to_type have to be valid type names, begin and end
@@ -162,15 +183,28 @@ extern "C" {
             *_to++ = (to_type) *_iter++;                \
     } while (0)
 
-/* This dictionary holds all interned unicode strings.  Note that references
-   to strings in this dictionary are *not* counted in the string's ob_refcnt.
+/* A set of exact strings: an open addressing hash table of borrowed
+   references, probed like dicts.  See "String Sets" below. */
+typedef struct {
+    PyObject **table;
+    size_t mask;
+    Py_ssize_t used;            /* number of strings */
+    Py_ssize_t fill;            /* number of strings and dummy slots */
+} unicode_set;
+
+/* This set holds all interned unicode strings.  Note that references
+   to strings in this set are *not* counted in the string's ob_refcnt.
    When the interned string reaches a refcnt of 0 the string deallocation
-   function will delete the reference from this dictionary.
+   function will remove it from this set.
 
-   Another way to look at this is that to say that the actual reference
-   count of a string is:  s->ob_refcnt + (s->state ? 2 : 0)
-*/
-static PyObject *interned = NULL;
+   The set only stores a pointer per slot, a third of the size of a dict
+   entry (hash, key and value). */
+static unicode_set interned = {NULL, 0, 0, 0};
+
+static int unicode_set_discard(unicode_set *set, PyObject *s);
+
+static wchar_t *ascii_wstr_get(PyObject *unicode);
+static void ascii_wstr_clear(PyObject *unicode);
 
 /* The empty Unicode object is shared to improve performance. */
 static PyObject *unicode_empty = NULL;
@@ -240,6 +274,7 @@ const unsigned char _Py_ascii_whitespace[] = {
 static PyUnicodeObject *_PyUnicode_New(Py_ssize_t length);
 static PyObject* get_latin1_char(unsigned char ch);
 static int unicode_modifiable(PyObject *unicode);
+int _Py_normalize_encoding(const char *, char *, size_t);
 
 
 static PyObject *
@@ -321,11 +356,15 @@ _PyUnicode_CheckConsistency(PyObject *op, int check_content)
     if (ascii->state.ascii == 1 && ascii->state.compact == 1) {
         assert(kind == PyUnicode_1BYTE_KIND);
         assert(ascii->state.ready == 1);
+        if (ascii->state.ascii_wstr)
+            assert(ascii_wstr_get(op) != NULL);
     }
     else {
         PyCompactUnicodeObject *compact = (PyCompactUnicodeObject *)op;
         void *data;
 
+        assert(ascii->state.ascii_wstr == 0);
+
         if (ascii->state.compact == 1) {
             data = compact + 1;
             assert(kind == PyUnicode_1BYTE_KIND
@@ -333,6 +372,8 @@ _PyUnicode_CheckConsistency(PyObject *op, int check_content)
                    || kind == PyUnicode_4BYTE_KIND);
             assert(ascii->state.ascii == 0);
             assert(ascii->state.ready == 1);
+            assert(ascii->state.shared == 0);
+            assert(ascii->state.view == 0);
             assert (compact->utf8 != data);
         }
         else {
@@ -345,8 +386,10 @@ _PyUnicode_CheckConsistency(PyObject *op, int check_content)
                 assert(ascii->state.compact == 0);
                 assert(ascii->state.ascii == 0);
                 assert(ascii->state.ready == 0);
+                assert(ascii->state.shared == 0);
+                assert(ascii->state.view == 0);
                 assert(ascii->state.interned == SSTATE_NOT_INTERNED);
-                assert(ascii->wstr != NULL);
+                assert(compact->wstr != NULL);
                 assert(data == NULL);
                 assert(compact->utf8 == NULL);
             }
@@ -357,7 +400,14 @@ _PyUnicode_CheckConsistency(PyObject *op, int check_content)
                 assert(ascii->state.compact == 0);
                 assert(ascii->state.ready == 1);
                 assert(data != NULL);
-                if (ascii->state.ascii) {
+                if (ascii->state.view) {
+                    assert(kind == PyUnicode_1BYTE_KIND);
+                    assert(!ascii->state.shared);
+                    assert(_PyUnicode_VIEW(op)->buf == data);
+                    assert(((Py_UCS1 *)data)[ascii->length] == 0);
+                }
+                if (ascii->state.ascii && !ascii->state.shared
+                    && !ascii->state.view) {
                     assert (compact->utf8 == data);
                     assert (compact->utf8_length == ascii->length);
                 }
@@ -366,23 +416,23 @@ _PyUnicode_CheckConsistency(PyObject *op, int check_content)
             }
         }
         if (kind != PyUnicode_WCHAR_KIND) {
-            if (
+            if (!ascii->state.shared && !ascii->state.view && (
 #if SIZEOF_WCHAR_T == 2
                 kind == PyUnicode_2BYTE_KIND
 #else
                 kind == PyUnicode_4BYTE_KIND
 #endif
-               )
+               ))
             {
-                assert(ascii->wstr == data);
+                assert(compact->wstr == data);
                 assert(compact->wstr_length == ascii->length);
             } else
-                assert(ascii->wstr != data);
+                assert(compact->wstr != data);
         }
 
         if (compact->utf8 == NULL)
             assert(compact->utf8_length == 0);
-        if (ascii->wstr == NULL)
+        if (compact->wstr == NULL)
             assert(compact->wstr_length == 0);
     }
     /* check that the best kind is used */
@@ -638,6 +688,357 @@ make_bloom_mask(int kind, void* ptr, Py_ssize_t len)
 #include "stringlib/find.h"
 #include "stringlib/undef.h"
 
+/* --- Append Buffers ----------------------------------------------------- */
+
+/* Appending to a string which can't be resized in place because other
+   references to it exist ("self.text += s", "lines[-1] += s", a variable
+   of an enclosing function, ...) used to copy the whole string each time,
+   which made building a string with repeated += take quadratic time.
+
+   Instead, PyUnicode_Append() copies a long string into an append buffer,
+   a block of characters which several strings can share.  The strings
+   sharing a buffer are non-compact strings with state.shared set; their
+   data is the start of the buffer and their length covers a prefix of the
+   characters written to it.  Appending to the string which covers all the
+   characters written so far writes the new characters after them, in
+   place, and returns a new string sharing the buffer: the other strings
+   don't see the new characters since their length doesn't cover them.
+   When the buffer is full, the characters are copied into a new buffer
+   with room to grow, so that repeated appends take amortized linear
+   time. */
+
+typedef struct {
+    Py_ssize_t refcnt;          /* Number of strings sharing the buffer */
+    Py_ssize_t length;          /* Number of characters written */
+    Py_ssize_t allocated;       /* Number of characters allocated, not
+                                   counting the null character */
+} unicode_buffer;
+
+/* Only strings at least this long are copied into an append buffer */
+#define UNICODE_BUFFER_MIN_LENGTH 256
+
+#define UNICODE_BUFFER_DATA(buffer) ((void *)((buffer) + 1))
+#define _PyUnicode_BUFFER(op)                           \
+    (assert(_PyUnicode_STATE(op).shared),               \
+     (unicode_buffer *)_PyUnicode_DATA_ANY(op) - 1)
+
+static unicode_buffer *
+unicode_buffer_new(Py_ssize_t allocated, unsigned int kind)
+{
+    unicode_buffer *buffer;
+
+    if (allocated > (PY_SSIZE_T_MAX - (Py_ssize_t)sizeof(unicode_buffer))
+                    / kind - 1)
+        return (unicode_buffer *)PyErr_NoMemory();
+    buffer = (unicode_buffer *)PyObject_MALLOC(sizeof(unicode_buffer)
+                                               + (allocated + 1) * kind);
+    if (buffer == NULL)
+        return (unicode_buffer *)PyErr_NoMemory();
+    buffer->refcnt = 0;
+    buffer->length = 0;
+    buffer->allocated = allocated;
+    return buffer;
+}
+
+static void
+unicode_buffer_decref(unicode_buffer *buffer)
+{
+    assert(buffer->refcnt > 0);
+    if (--buffer->refcnt == 0)
+        PyObject_FREE(buffer);
+}
+
+/* Create a string sharing the first length characters of buffer.  The
+   caller writes the characters which have not been written yet. */
+static PyObject *
+unicode_buffer_view(unicode_buffer *buffer, Py_ssize_t length,
+                    Py_UCS4 maxchar)
+{
+    PyObject *unicode;
+
+    assert(length <= buffer->allocated);
+    unicode = (PyObject *)PyObject_New(PyUnicodeObject, &PyUnicode_Type);
+    if (unicode == NULL)
+        return NULL;
+    _PyUnicode_LENGTH(unicode) = length;
+    _PyUnicode_HASH(unicode) = -1;
+    _PyUnicode_STATE(unicode).interned = 0;
+    if (maxchar < 256)
+        _PyUnicode_STATE(unicode).kind = PyUnicode_1BYTE_KIND;
+    else if (maxchar < 65536)
+        _PyUnicode_STATE(unicode).kind = PyUnicode_2BYTE_KIND;
+    else
+        _PyUnicode_STATE(unicode).kind = PyUnicode_4BYTE_KIND;
+    _PyUnicode_STATE(unicode).compact = 0;
+    _PyUnicode_STATE(unicode).ready = 1;
+    _PyUnicode_STATE(unicode).ascii = (maxchar < 128);
+    _PyUnicode_STATE(unicode).shared = 1;
+    _PyUnicode_STATE(unicode).ascii_wstr = 0;
+    _PyUnicode_STATE(unicode).view = 0;
+    _PyUnicode_DATA_ANY(unicode) = UNICODE_BUFFER_DATA(buffer);
+    _PyUnicode_UTF8(unicode) = NULL;
+    _PyUnicode_UTF8_LENGTH(unicode) = 0;
+    _PyUnicode_WSTR(unicode) = NULL;
+    _PyUnicode_WSTR_LENGTH(unicode) = 0;
+    buffer->refcnt++;
+    return unicode;
+}
+
+/* Return left + right using an append buffer.  If left doesn't cover the
+   end of an append buffer with room for right, copy both strings into a
+   new buffer if copy is true, or return NULL without setting an exception
+   otherwise. */
+static PyObject *
+unicode_buffer_append(PyObject *left, PyObject *right, int copy)
+{
+    unicode_buffer *buffer;
+    PyObject *res;
+    Py_UCS4 maxchar, maxchar2;
+    Py_ssize_t left_len, right_len, new_len, allocated;
+    unsigned int kind;
+
+    left_len = PyUnicode_GET_LENGTH(left);
+    right_len = PyUnicode_GET_LENGTH(right);
+    assert(left_len <= PY_SSIZE_T_MAX - right_len);
+    new_len = left_len + right_len;
+    maxchar = PyUnicode_MAX_CHAR_VALUE(left);
+    maxchar2 = PyUnicode_MAX_CHAR_VALUE(right);
+    maxchar = Py_MAX(maxchar, maxchar2);
+    if (maxchar < 256)
+        kind = PyUnicode_1BYTE_KIND;
+    else if (maxchar < 65536)
+        kind = PyUnicode_2BYTE_KIND;
+    else
+        kind = PyUnicode_4BYTE_KIND;
+
+    if (_PyUnicode_STATE(left).shared && kind == PyUnicode_KIND(left)) {
+        buffer = _PyUnicode_BUFFER(left);
+        /* The characters written by strings which are gone can be
+           overwritten */
+        if (buffer->refcnt == 1)
+            buffer->length = left_len;
+        if (buffer->length == left_len && new_len <= buffer->allocated) {
+            res = unicode_buffer_view(buffer, new_len, maxchar);
+            if (res == NULL)
+                return NULL;
+            _PyUnicode_FastCopyCharacters(res, left_len, right, 0, right_len);
+            PyUnicode_WRITE(kind, PyUnicode_DATA(res), new_len, 0);
+            buffer->length = new_len;
+            return res;
+        }
+    }
+    if (!copy)
+        return NULL;
+
+    /* Only over-allocate when appending to a string which is already in
+       an append buffer, so that a single concatenation costs no memory */
+    if (_PyUnicode_STATE(left).shared
+        && new_len <= PY_SSIZE_T_MAX - (new_len >> 1))
+        allocated = new_len + (new_len >> 1);
+    else
+        allocated = new_len;
+    buffer = unicode_buffer_new(allocated, kind);
+    if (buffer == NULL)
+        return NULL;
+    res = unicode_buffer_view(buffer, new_len, maxchar);
+    if (res == NULL) {
+        PyObject_FREE(buffer);
+        return NULL;
+    }
+    _PyUnicode_FastCopyCharacters(res, 0, left, 0, left_len);
+    _PyUnicode_FastCopyCharacters(res, left_len, right, 0, right_len);
+    PyUnicode_WRITE(kind, PyUnicode_DATA(res), new_len, 0);
+    buffer->length = new_len;
+    return res;
+}
+
+/* --- Views of Bytes Objects -------------------------------------------- */
+
+/* The ASCII and Latin-1 codecs decode each byte to the character with the
+   same code point, so a UCS1 string can use the bytes as its characters.
+   When PyUnicode_FromEncodedObject() decodes a long bytes object with one
+   of these codecs, it doesn't copy the bytes but creates a view: a
+   non-compact UCS1 string with state.view set, whose data is the buffer of
+   the bytes object.  Only bytes objects are viewed: they are immutable and
+   their characters are null-terminated like those of any string.  Other
+   buffers (bytearray, mmap, memoryview, ...) may change or be released
+   while the string is alive, so they are copied. */
+
+/* Only bytes objects at least this long are viewed instead of copied */
+#define UNICODE_VIEW_MIN_LENGTH 4096
+
+/* Return 1 if encoding is ASCII, 0 if it is Latin-1, -1 otherwise */
+static int
+unicode_view_encoding(const char *encoding)
+{
+    char lower[11];  /* Enough for any encoding shortcut */
+
+    if (!_Py_normalize_encoding(encoding, lower, sizeof(lower)))
+        return -1;
+    if (strcmp(lower, "ascii") == 0
+        || strcmp(lower, "us-ascii") == 0)
+        return 1;
+    if (strcmp(lower, "latin-1") == 0
+        || strcmp(lower, "latin1") == 0
+        || strcmp(lower, "iso-8859-1") == 0
+        || strcmp(lower, "iso8859-1") == 0)
+        return 0;
+    return -1;
+}
+
+/* Create a view of the characters of the buffer of a bytes object, which
+   the view releases when it is destroyed.  Return NULL without setting an
+   exception if ascii_only is true and the buffer contains non-ASCII
+   bytes. */
+static PyObject *
+unicode_view_new(Py_buffer *buffer, int ascii_only)
+{
+    PyObject *unicode;
+    const Py_UCS1 *data = (const Py_UCS1 *)buffer->buf;
+    Py_UCS4 maxchar;
+
+    assert(buffer->readonly && PyBytes_Check(buffer->obj));
+    assert(data[buffer->len] == 0);
+    maxchar = ucs1lib_find_max_char(data, data + buffer->len);
+    if (ascii_only && maxchar >= 128)
+        return NULL;
+    unicode = (PyObject *)PyObject_MALLOC(sizeof(unicode_view));
+    if (unicode == NULL)
+        return PyErr_NoMemory();
+    (void)PyObject_INIT(unicode, &PyUnicode_Type);
+    _PyUnicode_LENGTH(unicode) = buffer->len;
+    _PyUnicode_HASH(unicode) = -1;
+    _PyUnicode_STATE(unicode).interned = 0;
+    _PyUnicode_STATE(unicode).kind = PyUnicode_1BYTE_KIND;
+    _PyUnicode_STATE(unicode).compact = 0;
+    _PyUnicode_STATE(unicode).ready = 1;
+    _PyUnicode_STATE(unicode).ascii = (maxchar < 128);
+    _PyUnicode_STATE(unicode).shared = 0;
+    _PyUnicode_STATE(unicode).ascii_wstr = 0;
+    _PyUnicode_STATE(unicode).view = 1;
+    _PyUnicode_DATA_ANY(unicode) = buffer->buf;
+    _PyUnicode_UTF8(unicode) = NULL;
+    _PyUnicode_UTF8_LENGTH(unicode) = 0;
+    _PyUnicode_WSTR(unicode) = NULL;
+    _PyUnicode_WSTR_LENGTH(unicode) = 0;
+    ((unicode_view *)unicode)->buffer = *buffer;
+    return unicode;
+}
+
+/* --- Wide Characters of ASCII Strings ---------------------------------- */
+
+/* PyASCIIObject has no wstr member, which saves a pointer in every compact
+   ASCII string.  The wchar_t representation of such a string, created by
+   PyUnicode_AsUnicode(), is stored in this table instead, indexed by the
+   address of the string, and state.ascii_wstr is set.
+
+   The table uses linear probing and is at most half full.  A removed entry
+   is filled by moving the following entries back, so there are no dummy
+   entries. */
+typedef struct {
+    PyObject *unicode;
+    wchar_t *wstr;
+} ascii_wstr_entry;
+
+static struct {
+    ascii_wstr_entry *table;
+    size_t mask;
+    Py_ssize_t used;
+} ascii_wstrs = {NULL, 0, 0};
+
+#define ASCII_WSTR_MINSIZE 8
+#define ASCII_WSTR_INDEX(unicode) (((size_t)(unicode) >> 3) & ascii_wstrs.mask)
+
+/* Return the index of the entry of unicode, or of the empty entry where it
+   should be added */
+static size_t
+ascii_wstr_lookup(PyObject *unicode)
+{
+    size_t i = ASCII_WSTR_INDEX(unicode);
+
+    while (ascii_wstrs.table[i].unicode != NULL
+           && ascii_wstrs.table[i].unicode != unicode)
+        i = (i + 1) & ascii_wstrs.mask;
+    return i;
+}
+
+static wchar_t *
+ascii_wstr_get(PyObject *unicode)
+{
+    assert(PyUnicode_IS_COMPACT_ASCII(unicode));
+    if (!_PyUnicode_STATE(unicode).ascii_wstr)
+        return NULL;
+    return ascii_wstrs.table[ascii_wstr_lookup(unicode)].wstr;
+}
+
+/* Store wstr (allocated by PyObject_Malloc()) as the wchar_t
+   representation of the compact ASCII string unicode.  Return -1 on
+   memory error, without setting an exception. */
+static int
+ascii_wstr_set(PyObject *unicode, wchar_t *wstr)
+{
+    size_t size, i;
+
+    assert(PyUnicode_IS_COMPACT_ASCII(unicode));
+    assert(!_PyUnicode_STATE(unicode).ascii_wstr);
+    size = ascii_wstrs.table != NULL ? ascii_wstrs.mask + 1 : 0;
+    if ((size_t)(ascii_wstrs.used + 1) * 2 > size) {
+        ascii_wstr_entry *oldtable = ascii_wstrs.table, *table;
+        size_t oldsize = size;
+
+        size = oldsize ? oldsize * 2 : ASCII_WSTR_MINSIZE;
+        table = PyMem_Calloc(size, sizeof(ascii_wstr_entry));
+        if (table == NULL)
+            return -1;
+        ascii_wstrs.table = table;
+        ascii_wstrs.mask = size - 1;
+        for (i = 0; i < oldsize; i++) {
+            if (oldtable[i].unicode != NULL)
+                table[ascii_wstr_lookup(oldtable[i].unicode)] = oldtable[i];
+        }
+        PyMem_Free(oldtable);
+    }
+    i = ascii_wstr_lookup(unicode);
+    assert(ascii_wstrs.table[i].unicode == NULL);
+    ascii_wstrs.table[i].unicode = unicode;
+    ascii_wstrs.table[i].wstr = wstr;
+    ascii_wstrs.used++;
+    _PyUnicode_STATE(unicode).ascii_wstr = 1;
+    return 0;
+}
+
+/* Free the wchar_t representation of the compact ASCII string unicode */
+static void
+ascii_wstr_clear(PyObject *unicode)
+{
+    ascii_wstr_entry *table = ascii_wstrs.table;
+    size_t mask = ascii_wstrs.mask;
+    size_t i, j, home;
+
+    assert(_PyUnicode_STATE(unicode).ascii_wstr);
+    i = ascii_wstr_lookup(unicode);
+    assert(table[i].unicode == unicode);
+    PyObject_FREE(table[i].wstr);
+    _PyUnicode_STATE(unicode).ascii_wstr = 0;
+
+    /* Move back the following entries of the cluster which can't be
+       reached anymore from their home index */
+    for (j = (i + 1) & mask; table[j].unicode != NULL; j = (j + 1) & mask) {
+        home = ASCII_WSTR_INDEX(table[j].unicode);
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            table[i] = table[j];
+            i = j;
+        }
+    }
+    table[i].unicode = NULL;
+    table[i].wstr = NULL;
+    if (--ascii_wstrs.used == 0) {
+        PyMem_Free(ascii_wstrs.table);
+        ascii_wstrs.table = NULL;
+        ascii_wstrs.mask = 0;
+    }
+}
+
 /* --- Unicode Object ----------------------------------------------------- */
 
 static PyObject *
@@ -727,6 +1128,9 @@ resize_compact(PyObject *unicode, Py_ssize_t length)
         _PyUnicode_UTF8(unicode) = NULL;
         _PyUnicode_UTF8_LENGTH(unicode) = 0;
     }
+    /* The table of wstr is indexed by address */
+    if (_PyUnicode_STATE(unicode).ascii_wstr)
+        ascii_wstr_clear(unicode);
     _Py_DEC_REFTOTAL;
     _Py_ForgetReference(unicode);
 
@@ -742,14 +1146,12 @@ resize_compact(PyObject *unicode, Py_ssize_t length)
     _PyUnicode_LENGTH(unicode) = length;
     if (share_wstr) {
         _PyUnicode_WSTR(unicode) = PyUnicode_DATA(unicode);
-        if (!PyUnicode_IS_ASCII(unicode))
-            _PyUnicode_WSTR_LENGTH(unicode) = length;
+        _PyUnicode_WSTR_LENGTH(unicode) = length;
     }
     else if (_PyUnicode_HAS_WSTR_MEMORY(unicode)) {
         PyObject_DEL(_PyUnicode_WSTR(unicode));
         _PyUnicode_WSTR(unicode) = NULL;
-        if (!PyUnicode_IS_ASCII(unicode))
-            _PyUnicode_WSTR_LENGTH(unicode) = 0;
+        _PyUnicode_WSTR_LENGTH(unicode) = 0;
     }
 #ifdef Py_DEBUG
     unicode_fill_invalid(unicode, old_length);
@@ -914,6 +1316,9 @@ _PyUnicode_New(Py_ssize_t length)
     _PyUnicode_STATE(unicode).compact = 0;
     _PyUnicode_STATE(unicode).ready = 0;
     _PyUnicode_STATE(unicode).ascii = 0;
+    _PyUnicode_STATE(unicode).shared = 0;
+    _PyUnicode_STATE(unicode).ascii_wstr = 0;
+    _PyUnicode_STATE(unicode).view = 0;
     _PyUnicode_DATA_ANY(unicode) = NULL;
     _PyUnicode_LENGTH(unicode) = 0;
     _PyUnicode_UTF8(unicode) = NULL;
@@ -1019,11 +1424,12 @@ _PyUnicode_Dump(PyObject *op)
     printf("%s: len=%" PY_FORMAT_SIZE_T "u, ",
            unicode_kind_name(op), ascii->length);
 
-    if (ascii->wstr == data)
-        printf("shared ");
-    printf("wstr=%p", ascii->wstr);
-
-    if (!(ascii->state.ascii == 1 && ascii->state.compact == 1)) {
+    if (ascii->state.ascii == 1 && ascii->state.compact == 1)
+        printf("wstr=%p", ascii_wstr_get(op));
+    else {
+        if (compact->wstr == data)
+            printf("shared ");
+        printf("wstr=%p", compact->wstr);
         printf(" (%" PY_FORMAT_SIZE_T "u), ", compact->wstr_length);
         if (!ascii->state.compact && compact->utf8 == unicode->data.any)
             printf("shared ");
@@ -1114,9 +1520,11 @@ PyUnicode_New(Py_ssize_t size, Py_UCS4 maxchar)
     _PyUnicode_STATE(unicode).compact = 1;
     _PyUnicode_STATE(unicode).ready = 1;
     _PyUnicode_STATE(unicode).ascii = is_ascii;
+    _PyUnicode_STATE(unicode).shared = 0;
+    _PyUnicode_STATE(unicode).ascii_wstr = 0;
+    _PyUnicode_STATE(unicode).view = 0;
     if (is_ascii) {
         ((char*)data)[size] = 0;
-        _PyUnicode_WSTR(unicode) = NULL;
     }
     else if (kind == PyUnicode_1BYTE_KIND) {
         ((char*)data)[size] = 0;
@@ -1199,6 +1607,55 @@ unicode_check_modifiable(PyObject *unicode)
     return 0;
 }
 
+#ifdef Py_CPU_DISPATCH
+
+/* Widen characters with AVX2, a vector of output at a time.  str.join(),
+   concatenation and _PyUnicodeWriter copy the strings of a narrower kind
+   than the result through _copy_characters(). */
+
+#define WIDEN_AVX2_MIN_LENGTH 32
+
+Py_TARGET_AVX2 static void
+ucs1_to_ucs2_avx2(const Py_UCS1 *in, Py_ssize_t n, Py_UCS2 *out)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_cvtepu8_epi16(v));
+    }
+    for (; i < n; i++)
+        out[i] = in[i];
+}
+
+Py_TARGET_AVX2 static void
+ucs1_to_ucs4_avx2(const Py_UCS1 *in, Py_ssize_t n, Py_UCS4 *out)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadl_epi64((const __m128i *)(in + i));
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_cvtepu8_epi32(v));
+    }
+    for (; i < n; i++)
+        out[i] = in[i];
+}
+
+Py_TARGET_AVX2 static void
+ucs2_to_ucs4_avx2(const Py_UCS2 *in, Py_ssize_t n, Py_UCS4 *out)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_cvtepu16_epi32(v));
+    }
+    for (; i < n; i++)
+        out[i] = in[i];
+}
+
+#endif
+
 static int
 _copy_characters(PyObject *to, Py_ssize_t to_start,
                  PyObject *from, Py_ssize_t from_start,
@@ -1259,6 +1716,12 @@ _copy_characters(PyObject *to, Py_ssize_t to_start,
     else if (from_kind == PyUnicode_1BYTE_KIND
              && to_kind == PyUnicode_2BYTE_KIND)
     {
+#ifdef Py_CPU_DISPATCH
+        if (how_many >= WIDEN_AVX2_MIN_LENGTH && _Py_CPU_HAS(_Py_CPU_AVX2))
+            ucs1_to_ucs2_avx2(PyUnicode_1BYTE_DATA(from) + from_start,
+                              how_many, PyUnicode_2BYTE_DATA(to) + to_start);
+        else
+#endif
         _PyUnicode_CONVERT_BYTES(
             Py_UCS1, Py_UCS2,
             PyUnicode_1BYTE_DATA(from) + from_start,
@@ -1269,6 +1732,12 @@ _copy_characters(PyObject *to, Py_ssize_t to_start,
     else if (from_kind == PyUnicode_1BYTE_KIND
              && to_kind == PyUnicode_4BYTE_KIND)
     {
+#ifdef Py_CPU_DISPATCH
+        if (how_many >= WIDEN_AVX2_MIN_LENGTH && _Py_CPU_HAS(_Py_CPU_AVX2))
+            ucs1_to_ucs4_avx2(PyUnicode_1BYTE_DATA(from) + from_start,
+                              how_many, PyUnicode_4BYTE_DATA(to) + to_start);
+        else
+#endif
         _PyUnicode_CONVERT_BYTES(
             Py_UCS1, Py_UCS4,
             PyUnicode_1BYTE_DATA(from) + from_start,
@@ -1279,6 +1748,12 @@ _copy_characters(PyObject *to, Py_ssize_t to_start,
     else if (from_kind == PyUnicode_2BYTE_KIND
              && to_kind == PyUnicode_4BYTE_KIND)
     {
+#ifdef Py_CPU_DISPATCH
+        if (how_many >= WIDEN_AVX2_MIN_LENGTH && _Py_CPU_HAS(_Py_CPU_AVX2))
+            ucs2_to_ucs4_avx2(PyUnicode_2BYTE_DATA(from) + from_start,
+                              how_many, PyUnicode_4BYTE_DATA(to) + to_start);
+        else
+#endif
         _PyUnicode_CONVERT_BYTES(
             Py_UCS2, Py_UCS4,
             PyUnicode_2BYTE_DATA(from) + from_start,
@@ -1583,9 +2058,7 @@ unicode_dealloc(PyObject *unicode)
         break;
 
     case SSTATE_INTERNED_MORTAL:
-        /* revive dead object temporarily for DelItem */
-        Py_REFCNT(unicode) = 3;
-        if (PyDict_DelItem(interned, unicode) != 0)
+        if (unicode_set_discard(&interned, unicode) < 0)
             Py_FatalError(
                 "deletion of interned string failed");
         break;
@@ -1597,12 +2070,20 @@ unicode_dealloc(PyObject *unicode)
         Py_FatalError("Inconsistent interned string state.");
     }
 
-    if (_PyUnicode_HAS_WSTR_MEMORY(unicode))
+    if (_PyUnicode_STATE(unicode).ascii_wstr)
+        ascii_wstr_clear(unicode);
+    else if (_PyUnicode_HAS_WSTR_MEMORY(unicode))
         PyObject_DEL(_PyUnicode_WSTR(unicode));
     if (_PyUnicode_HAS_UTF8_MEMORY(unicode))
         PyObject_DEL(_PyUnicode_UTF8(unicode));
-    if (!PyUnicode_IS_COMPACT(unicode) && _PyUnicode_DATA_ANY(unicode))
-        PyObject_DEL(_PyUnicode_DATA_ANY(unicode));
+    if (!PyUnicode_IS_COMPACT(unicode) && _PyUnicode_DATA_ANY(unicode)) {
+        if (_PyUnicode_STATE(unicode).shared)
+            unicode_buffer_decref(_PyUnicode_BUFFER(unicode));
+        else if (_PyUnicode_STATE(unicode).view)
+            PyBuffer_Release(_PyUnicode_VIEW(unicode));
+        else
+            PyObject_DEL(_PyUnicode_DATA_ANY(unicode));
+    }
 
     Py_TYPE(unicode)->tp_free(unicode);
 }
@@ -1636,6 +2117,8 @@ unicode_modifiable(PyObject *unicode)
         return 0;
     if (!PyUnicode_CheckExact(unicode))
         return 0;
+    if (_PyUnicode_STATE(unicode).shared || _PyUnicode_STATE(unicode).view)
+        return 0;
 #ifdef Py_DEBUG
     /* singleton refcount is greater than 1 */
     assert(!unicode_is_singleton(unicode));
@@ -2878,6 +3361,7 @@ PyUnicode_FromEncodedObject(PyObject *obj,
 {
     Py_buffer buffer;
     PyObject *v;
+    int ascii_only;
 
     if (obj == NULL) {
         PyErr_BadInternalCall();
@@ -2888,6 +3372,19 @@ PyUnicode_FromEncodedObject(PyObject *obj,
     if (PyBytes_Check(obj)) {
         if (PyBytes_GET_SIZE(obj) == 0)
             _Py_RETURN_UNICODE_EMPTY();
+        /* Don't copy long bytes objects decoded to UCS1 strings */
+        if (PyBytes_GET_SIZE(obj) >= UNICODE_VIEW_MIN_LENGTH
+            && (ascii_only = unicode_view_encoding(encoding)) >= 0) {
+            if (PyObject_GetBuffer(obj, &buffer, PyBUF_SIMPLE) < 0)
+                return NULL;
+            v = unicode_view_new(&buffer, ascii_only);
+            if (v != NULL)
+                return v;
+            PyBuffer_Release(&buffer);
+            if (PyErr_Occurred())
+                return NULL;
+            /* Let the decoder report the non-ASCII bytes */
+        }
         v = PyUnicode_Decode(
                 PyBytes_AS_STRING(obj), PyBytes_GET_SIZE(obj),
                 encoding, errors);
@@ -3755,12 +4252,56 @@ PyUnicode_AsUnicodeAndSize(PyObject *unicode, Py_ssize_t *size)
         PyErr_BadArgument();
         return NULL;
     }
+    if (PyUnicode_IS_COMPACT_ASCII(unicode)) {
+        w = ascii_wstr_get(unicode);
+        if (w == NULL) {
+            if ((size_t)_PyUnicode_LENGTH(unicode) >
+                    PY_SSIZE_T_MAX / sizeof(wchar_t) - 1) {
+                PyErr_NoMemory();
+                return NULL;
+            }
+            w = (wchar_t *) PyObject_MALLOC(sizeof(wchar_t) *
+                                            (_PyUnicode_LENGTH(unicode) + 1));
+            if (w == NULL) {
+                PyErr_NoMemory();
+                return NULL;
+            }
+            one_byte = PyUnicode_1BYTE_DATA(unicode);
+            _PyUnicode_CONVERT_BYTES(Py_UCS1, wchar_t, one_byte,
+                                     one_byte + _PyUnicode_LENGTH(unicode),
+                                     w);
+            w[_PyUnicode_LENGTH(unicode)] = 0;
+            if (ascii_wstr_set(unicode, w) < 0) {
+                PyObject_FREE(w);
+                PyErr_NoMemory();
+                return NULL;
+            }
+        }
+        if (size != NULL)
+            *size = _PyUnicode_LENGTH(unicode);
+        return w;
+    }
     if (_PyUnicode_WSTR(unicode) == NULL) {
         /* Non-ASCII compact unicode object */
         assert(_PyUnicode_KIND(unicode) != 0);
         assert(PyUnicode_IS_READY(unicode));
 
-        if (PyUnicode_KIND(unicode) == PyUnicode_4BYTE_KIND) {
+        if (_PyUnicode_STATE(unicode).shared
+            && PyUnicode_KIND(unicode) == sizeof(wchar_t)) {
+            /* Same layout as wchar_t, but the characters in an append
+               buffer are not null-terminated */
+            _PyUnicode_WSTR(unicode) = (wchar_t *) PyObject_MALLOC(
+                    sizeof(wchar_t) * (_PyUnicode_LENGTH(unicode) + 1));
+            if (!_PyUnicode_WSTR(unicode)) {
+                PyErr_NoMemory();
+                return NULL;
+            }
+            _PyUnicode_WSTR_LENGTH(unicode) = _PyUnicode_LENGTH(unicode);
+            Py_MEMCPY(_PyUnicode_WSTR(unicode), PyUnicode_DATA(unicode),
+                      sizeof(wchar_t) * _PyUnicode_LENGTH(unicode));
+            _PyUnicode_WSTR(unicode)[_PyUnicode_LENGTH(unicode)] = 0;
+        }
+        else if (PyUnicode_KIND(unicode) == PyUnicode_4BYTE_KIND) {
 #if SIZEOF_WCHAR_T == 2
             four_bytes = PyUnicode_4BYTE_DATA(unicode);
             ucs4_end = four_bytes + _PyUnicode_LENGTH(unicode);
@@ -3816,8 +4357,7 @@ PyUnicode_AsUnicodeAndSize(PyObject *unicode, Py_ssize_t *size)
                 PyErr_NoMemory();
                 return NULL;
             }
-            if (!PyUnicode_IS_COMPACT_ASCII(unicode))
-                _PyUnicode_WSTR_LENGTH(unicode) = _PyUnicode_LENGTH(unicode);
+            _PyUnicode_WSTR_LENGTH(unicode) = _PyUnicode_LENGTH(unicode);
             w = _PyUnicode_WSTR(unicode);
             wchar_end = w + _PyUnicode_LENGTH(unicode);
 
@@ -4677,6 +5217,353 @@ ascii_decode(const char *start, const char *end, Py_UCS1 *dest)
     return p - start;
 }
 
+#ifdef Py_CPU_DISPATCH
+
+/* UTF-8 decoding with AVX2, in two passes.
+
+   The first pass validates the whole input 32 bytes at a time, using the
+   lookup table method of Keiser and Lemire ("Validating UTF-8 in less
+   than one instruction per byte"): three table lookups indexed by the
+   nibbles of each byte and of the byte before it classify every pair of
+   adjacent bytes, and the errors which need more context (missing 3rd
+   and 4th bytes) are found with saturated subtractions.  The same pass
+   counts the code points and finds the greatest byte, which tells the
+   kind of the result.
+
+   The second pass decodes the now known valid input straight into the
+   buffer of a string of the right size and kind: blocks of 32 ASCII
+   bytes are widened with vector instructions, other characters are
+   decoded without any check.
+
+   Invalid or truncated input is left to the generic decoder, which knows
+   how to report errors and how to stop before an incomplete sequence. */
+
+/* Don't bother for shorter inputs. */
+#define UTF8_AVX2_MIN_SIZE 32
+
+/* Error classes of a pair of bytes; a pair is invalid if the three
+   lookups agree on at least one class. */
+#define UTF8_TOO_SHORT      (1 << 0)    /* 11______ 0_______ */
+                                        /* 11______ 11______ */
+#define UTF8_TOO_LONG       (1 << 1)    /* 0_______ 10______ */
+#define UTF8_OVERLONG_3     (1 << 2)    /* 11100000 100_____ */
+#define UTF8_TOO_LARGE      (1 << 3)    /* 11110100 1001____ and above */
+#define UTF8_SURROGATE      (1 << 4)    /* 11101101 101_____ */
+#define UTF8_OVERLONG_2     (1 << 5)    /* 1100000_ 10______ */
+#define UTF8_TOO_LARGE_1000 (1 << 6)    /* 11110101 1000____ and above */
+#define UTF8_OVERLONG_4     (1 << 6)    /* 11110000 1000____ */
+#define UTF8_TWO_CONTS      (1 << 7)    /* 10______ 10______ */
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+/* Indexed by the high nibble of the first byte of the pair. */
+static const unsigned char utf8_byte_1_high[16] = {
+    /* 0_______: ASCII */
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    /* 10______: continuation */
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    /* 1100____, 1101____: lead of 2 */
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    UTF8_TOO_SHORT,
+    /* 1110____: lead of 3 */
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    /* 1111____: lead of 4 */
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4
+};
+
+/* Indexed by the low nibble of the first byte of the pair. */
+static const unsigned char utf8_byte_1_low[16] = {
+    /* ____0000 */
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    /* ____0001 */
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    /* ____001_ */
+    UTF8_CARRY,
+    UTF8_CARRY,
+    /* ____0100 */
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    /* ____0101, ____011_, ____1100 */
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    /* ____1101 */
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    /* ____111_ */
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+};
+
+/* Indexed by the high nibble of the second byte of the pair. */
+static const unsigned char utf8_byte_2_high[16] = {
+    /* 0_______: ASCII */
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    /* 1000____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 |
+    UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    /* 1001____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 |
+    UTF8_TOO_LARGE,
+    /* 101_____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE |
+    UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE |
+    UTF8_TOO_LARGE,
+    /* 11______ */
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT
+};
+
+/* The last bytes of a block which start a sequence running past it. */
+static const unsigned char utf8_incomplete_max[32] = {
+    255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+};
+
+typedef struct {
+    __m256i byte_1_high;
+    __m256i byte_1_low;
+    __m256i byte_2_high;
+    __m256i incomplete_max;
+    __m256i error;
+    __m256i prev_input;
+    __m256i prev_incomplete;
+    __m256i max_byte;
+    Py_ssize_t continuations;
+} utf8_checker;
+
+Py_TARGET_AVX2 static void
+utf8_check_init(utf8_checker *c)
+{
+    c->byte_1_high = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)utf8_byte_1_high));
+    c->byte_1_low = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)utf8_byte_1_low));
+    c->byte_2_high = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)utf8_byte_2_high));
+    c->incomplete_max = _mm256_loadu_si256(
+        (const __m256i *)utf8_incomplete_max);
+    c->error = _mm256_setzero_si256();
+    c->prev_input = _mm256_setzero_si256();
+    c->prev_incomplete = _mm256_setzero_si256();
+    c->max_byte = _mm256_setzero_si256();
+    c->continuations = 0;
+}
+
+Py_TARGET_AVX2 static void
+utf8_check_block(utf8_checker *c, __m256i input)
+{
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    __m256i cont;
+
+    c->max_byte = _mm256_max_epu8(c->max_byte, input);
+    /* Continuation bytes are the signed bytes below -64. */
+    cont = _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), input);
+    c->continuations += __builtin_popcount(
+        (unsigned int)_mm256_movemask_epi8(cont));
+
+    if (_mm256_movemask_epi8(input) == 0) {
+        /* All ASCII: only a sequence left open by the previous block can
+           be wrong. */
+        c->error = _mm256_or_si256(c->error, c->prev_incomplete);
+        c->prev_incomplete = _mm256_setzero_si256();
+    }
+    else {
+        /* prevN[i] is the byte N positions before input[i]. */
+        __m256i shifted = _mm256_permute2x128_si256(c->prev_input, input,
+                                                    0x21);
+        __m256i prev1 = _mm256_alignr_epi8(input, shifted, 15);
+        __m256i prev2 = _mm256_alignr_epi8(input, shifted, 14);
+        __m256i prev3 = _mm256_alignr_epi8(input, shifted, 13);
+        __m256i b1h, b1l, b2h, special, third, fourth, must23;
+
+        b1h = _mm256_shuffle_epi8(c->byte_1_high, _mm256_and_si256(
+            _mm256_srli_epi16(prev1, 4), low_nibble));
+        b1l = _mm256_shuffle_epi8(c->byte_1_low,
+                                  _mm256_and_si256(prev1, low_nibble));
+        b2h = _mm256_shuffle_epi8(c->byte_2_high, _mm256_and_si256(
+            _mm256_srli_epi16(input, 4), low_nibble));
+        special = _mm256_and_si256(_mm256_and_si256(b1h, b1l), b2h);
+
+        /* The bytes 2 or 3 positions after a lead of 3 or 4 must be
+           continuations, which the TWO_CONTS class flags; the two must
+           agree. */
+        third = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+        fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+        must23 = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                  _mm256_set1_epi8((char)0x80));
+        c->error = _mm256_or_si256(c->error, _mm256_xor_si256(must23, special));
+        c->prev_incomplete = _mm256_subs_epu8(input, c->incomplete_max);
+    }
+    c->prev_input = input;
+}
+
+/* Validate the UTF-8 input.  On success, return 1 and set *nchars to the
+   number of code points and *maxchar to a bound matching the kind of the
+   decoded string.  Return 0 if the input is invalid or truncated. */
+Py_TARGET_AVX2 static int
+utf8_validate_avx2(const char *s, Py_ssize_t size,
+                   Py_ssize_t *nchars, Py_UCS4 *maxchar)
+{
+    const char *end = s + size;
+    utf8_checker c;
+    unsigned char bytes[32];
+    unsigned char max_byte = 0;
+    int i;
+
+    utf8_check_init(&c);
+    for (; end - s >= 32; s += 32)
+        utf8_check_block(&c, _mm256_loadu_si256((const __m256i *)s));
+    if (s < end) {
+        /* Pad the last block with NULs, which are valid but end any
+           sequence still open. */
+        memset(bytes, 0, sizeof(bytes));
+        memcpy(bytes, s, end - s);
+        utf8_check_block(&c, _mm256_loadu_si256((const __m256i *)bytes));
+    }
+    c.error = _mm256_or_si256(c.error, c.prev_incomplete);
+    if (!_mm256_testz_si256(c.error, c.error))
+        return 0;
+
+    _mm256_storeu_si256((__m256i *)bytes, c.max_byte);
+    for (i = 0; i < 32; i++)
+        max_byte = Py_MAX(max_byte, bytes[i]);
+    /* Leads of 2 above 0xC3 start code points above U+00FF, leads of 3
+       above U+07FF and leads of 4 above U+FFFF. */
+    if (max_byte < 0x80)
+        *maxchar = 0x7F;
+    else if (max_byte < 0xC4)
+        *maxchar = 0xFF;
+    else if (max_byte < 0xF0)
+        *maxchar = 0xFFFF;
+    else
+        *maxchar = MAX_UNICODE;
+    *nchars = size - c.continuations;
+    return 1;
+}
+
+/* Decode one character of valid UTF-8 at p, and advance p. */
+#define UTF8_DECODE_VALID(p, ch)                                        \
+    do {                                                                \
+        const unsigned char *_u = (const unsigned char *)(p);           \
+        (ch) = _u[0];                                                   \
+        if ((ch) < 0x80)                                                \
+            (p) += 1;                                                   \
+        else if ((ch) < 0xE0) {                                         \
+            (ch) = (((ch) & 0x1F) << 6) | (_u[1] & 0x3F);               \
+            (p) += 2;                                                   \
+        }                                                               \
+        else if ((ch) < 0xF0) {                                         \
+            (ch) = (((ch) & 0x0F) << 12) | ((_u[1] & 0x3F) << 6) |      \
+                   (_u[2] & 0x3F);                                      \
+            (p) += 3;                                                   \
+        }                                                               \
+        else {                                                          \
+            (ch) = (((ch) & 0x07) << 18) | ((_u[1] & 0x3F) << 12) |     \
+                   ((_u[2] & 0x3F) << 6) | (_u[3] & 0x3F);              \
+            (p) += 4;                                                   \
+        }                                                               \
+    } while (0)
+
+/* Decode valid UTF-8 into a buffer of code units of type TYPE.  Blocks of
+   32 ASCII bytes are stored by STORE_ASCII(q, v); after a block with
+   non-ASCII bytes, characters are decoded one by one up to the end of the
+   block. */
+#define UTF8_TRANSCODE(NAME, TYPE, STORE_ASCII)                         \
+Py_TARGET_AVX2 static void                                              \
+NAME(const char *p, const char *end, TYPE *q)                           \
+{                                                                       \
+    while (p < end) {                                                   \
+        const char *block_end;                                          \
+        if (end - p >= 32) {                                            \
+            __m256i v = _mm256_loadu_si256((const __m256i *)p);         \
+            if (_mm256_movemask_epi8(v) == 0) {                         \
+                STORE_ASCII(q, v);                                      \
+                p += 32;                                                \
+                q += 32;                                                \
+                continue;                                               \
+            }                                                           \
+            block_end = p + 32;                                         \
+        }                                                               \
+        else                                                            \
+            block_end = end;                                            \
+        while (p < block_end) {                                         \
+            Py_UCS4 ch;                                                 \
+            UTF8_DECODE_VALID(p, ch);                                   \
+            *q++ = (TYPE)ch;                                            \
+        }                                                               \
+    }                                                                   \
+}
+
+#define UCS1_STORE_ASCII(q, v)                                          \
+    _mm256_storeu_si256((__m256i *)(q), (v))
+
+#define UCS2_STORE_ASCII(q, v)                                          \
+    do {                                                                \
+        _mm256_storeu_si256((__m256i *)(q),                             \
+            _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));           \
+        _mm256_storeu_si256((__m256i *)((q) + 16),                      \
+            _mm256_cvtepu8_epi16(_mm256_extracti128_si256((v), 1)));    \
+    } while (0)
+
+#define UCS4_STORE_ASCII(q, v)                                          \
+    do {                                                                \
+        __m128i _lo = _mm256_castsi256_si128(v);                        \
+        __m128i _hi = _mm256_extracti128_si256((v), 1);                 \
+        _mm256_storeu_si256((__m256i *)(q),                             \
+            _mm256_cvtepu8_epi32(_lo));                                 \
+        _mm256_storeu_si256((__m256i *)((q) + 8),                       \
+            _mm256_cvtepu8_epi32(_mm_srli_si128(_lo, 8)));              \
+        _mm256_storeu_si256((__m256i *)((q) + 16),                      \
+            _mm256_cvtepu8_epi32(_hi));                                 \
+        _mm256_storeu_si256((__m256i *)((q) + 24),                      \
+            _mm256_cvtepu8_epi32(_mm_srli_si128(_hi, 8)));              \
+    } while (0)
+
+UTF8_TRANSCODE(utf8_transcode_ucs1, Py_UCS1, UCS1_STORE_ASCII)
+UTF8_TRANSCODE(utf8_transcode_ucs2, Py_UCS2, UCS2_STORE_ASCII)
+UTF8_TRANSCODE(utf8_transcode_ucs4, Py_UCS4, UCS4_STORE_ASCII)
+
+/* Decode size bytes of UTF-8.  Return NULL without an exception set if
+   the input is not valid UTF-8. */
+static PyObject *
+utf8_decode_avx2(const char *s, Py_ssize_t size)
+{
+    Py_ssize_t nchars;
+    Py_UCS4 maxchar;
+    PyObject *res;
+
+    if (!utf8_validate_avx2(s, size, &nchars, &maxchar))
+        return NULL;
+    res = PyUnicode_New(nchars, maxchar);
+    if (res == NULL)
+        return NULL;
+    switch (PyUnicode_KIND(res)) {
+    case PyUnicode_1BYTE_KIND:
+        if (maxchar < 128)
+            memcpy(PyUnicode_1BYTE_DATA(res), s, size);
+        else
+            utf8_transcode_ucs1(s, s + size, PyUnicode_1BYTE_DATA(res));
+        break;
+    case PyUnicode_2BYTE_KIND:
+        utf8_transcode_ucs2(s, s + size, PyUnicode_2BYTE_DATA(res));
+        break;
+    default:
+        utf8_transcode_ucs4(s, s + size, PyUnicode_4BYTE_DATA(res));
+        break;
+    }
+    assert(_PyUnicode_CheckConsistency(res, 1));
+    return res;
+}
+
+#endif /* Py_CPU_DISPATCH */
+
 PyObject *
 PyUnicode_DecodeUTF8Stateful(const char *s,
                              Py_ssize_t size,
@@ -4706,11 +5593,25 @@ PyUnicode_DecodeUTF8Stateful(const char *s,
         return get_latin1_char((unsigned char)s[0]);
     }
 
-    _PyUnicodeWriter_Init(&writer);
-    writer.min_length = size;
-    if (_PyUnicodeWriter_Prepare(&writer, writer.min_length, 127) == -1)
-        goto onError;
-
+#ifdef Py_CPU_DISPATCH
+    if (size >= UTF8_AVX2_MIN_SIZE && _Py_CPU_HAS(_Py_CPU_AVX2)) {
+        PyObject *res = utf8_decode_avx2(s, size);
+        if (res != NULL) {
+            if (consumed)
+                *consumed = size;
+            return res;
+        }
+        if (PyErr_Occurred())
+            return NULL;
+        /* Invalid or truncated: let the generic code sort it out. */
+    }
+#endif
+
+    _PyUnicodeWriter_Init(&writer);
+    writer.min_length = size;
+    if (_PyUnicodeWriter_Prepare(&writer, writer.min_length, 127) == -1)
+        goto onError;
+
     writer.pos = ascii_decode(s, end, writer.data);
     s += writer.pos;
     while (s < end) {
@@ -9443,7 +10344,7 @@ ascii_upper_or_lower(PyObject *self, int lower)
         _Py_bytes_lower(resdata, data, len);
     else
         _Py_bytes_upper(resdata, data, len);
-    return res;
+    return unicode_result(res);
 }
 
 static Py_UCS4
@@ -9658,7 +10559,9 @@ case_operation(PyObject *self,
     }
   leave:
     PyMem_FREE(tmp);
-    return res;
+    if (res == NULL)
+        return NULL;
+    return unicode_result(res);
 }
 
 PyObject *
@@ -9840,7 +10743,7 @@ PyUnicode_Join(PyObject *separator, PyObject *seq)
     Py_DECREF(fseq);
     Py_XDECREF(sep);
     assert(_PyUnicode_CheckConsistency(res, 1));
-    return res;
+    return unicode_result(res);
 
   onError:
     Py_DECREF(fseq);
@@ -10492,7 +11395,7 @@ replace(PyObject *self, PyObject *str1,
     if (release2)
         PyMem_FREE(buf2);
     assert(_PyUnicode_CheckConsistency(u, 1));
-    return u;
+    return unicode_result(u);
 
   nothing:
     /* nothing to replace; return original string (when possible) */
@@ -11014,6 +11917,16 @@ PyUnicode_Concat(PyObject *left, PyObject *right)
     }
     new_len = u_len + v_len;
 
+    /* Extend the append buffer of u if nothing was written after u */
+    if (_PyUnicode_STATE(u).shared) {
+        w = unicode_buffer_append(u, v, 0);
+        if (w != NULL || PyErr_Occurred()) {
+            Py_DECREF(u);
+            Py_DECREF(v);
+            return w;
+        }
+    }
+
     maxchar = PyUnicode_MAX_CHAR_VALUE(u);
     maxchar2 = PyUnicode_MAX_CHAR_VALUE(v);
     maxchar = Py_MAX(maxchar, maxchar2);
@@ -11095,6 +12008,16 @@ PyUnicode_Append(PyObject **p_left, PyObject *right)
         /* copy 'right' into the newly allocated area of 'left' */
         _PyUnicode_FastCopyCharacters(*p_left, left_len, right, 0, right_len);
     }
+    else if (_PyUnicode_STATE(left).shared
+             || left_len >= UNICODE_BUFFER_MIN_LENGTH) {
+        /* append in an append buffer: 'left' can't be resized, but later
+           appends to the result won't have to copy it again */
+        res = unicode_buffer_append(left, right, 1);
+        if (res == NULL)
+            goto error;
+        Py_DECREF(left);
+        *p_left = res;
+    }
     else {
         maxchar = PyUnicode_MAX_CHAR_VALUE(left);
         maxchar2 = PyUnicode_MAX_CHAR_VALUE(right);
@@ -13525,6 +14448,164 @@ _PyUnicodeWriter_Dealloc(_PyUnicodeWriter *writer)
     Py_CLEAR(writer->buffer);
 }
 
+/* --- Format Cache ------------------------------------------------------- */
+
+/* str.format() and the % operator used to parse their format string on
+   every call, while programs tend to format the same few strings over and
+   over (log messages, serialization).  The second time in a row a format
+   string is used, it is compiled into a template listing its literal text
+   and its fields, with the field names and conversion specs already
+   parsed.  Format strings used once are only parsed by the generic code.
+   Templates are kept in a small direct-mapped cache indexed by the hash
+   of the format string, much like the method cache of typeobject.c.  The
+   cache holds at most FORMAT_CACHE_MAX_CHARS characters of format strings
+   in total; it is emptied by sys._clear_type_cache() and at exit.
+
+   A template also remembers the length of the last string formatted with
+   it, so that the output can be allocated in one go the next time, and
+   the largest character of its literal text, so that the output starts
+   with the right kind.
+
+   Format strings using features that templates don't support (e.g.
+   "{0.attr}", replacement fields nested in a format spec, "%*d") or that
+   are invalid are cached as templates without items (nitems == -1); they
+   are formatted by the generic code, which also reports the errors. */
+
+#define FORMAT_CACHE_SIZE 256       /* must be a power of 2 */
+#define FORMAT_CACHE_MAX_LENGTH 4096
+#define FORMAT_CACHE_MAX_CHARS (64 * 1024)
+
+/* Template kinds */
+#define FORMAT_BRACES 0             /* str.format() and str.format_map() */
+#define FORMAT_PERCENT 1            /* PyUnicode_Format() */
+
+typedef struct format_template format_template;
+
+struct format_template {
+    /* Templates are freed when they are evicted from the cache and no
+       call is using them. */
+    Py_ssize_t refcnt;
+    PyObject *format;
+    int engine;
+    /* Number of items, or -1 if the format string must be formatted by the
+       generic code. */
+    Py_ssize_t nitems;
+    void *items;
+    void (*clear_items)(format_template *);
+    Py_UCS4 literal_maxchar;
+    /* Length of the last formatted string, 0 if unknown */
+    Py_ssize_t length;
+};
+
+static format_template *format_cache[FORMAT_CACHE_SIZE];
+/* Hash of the last format string of each slot which wasn't compiled */
+static Py_hash_t format_cache_seen[FORMAT_CACHE_SIZE];
+/* Total length of the format strings in the cache */
+static Py_ssize_t format_cache_chars;
+
+static format_template *
+format_template_new(PyObject *format, int engine)
+{
+    format_template *t = PyMem_Malloc(sizeof(format_template));
+    if (t == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    t->refcnt = 1;
+    Py_INCREF(format);
+    t->format = format;
+    t->engine = engine;
+    t->nitems = -1;
+    t->items = NULL;
+    t->clear_items = NULL;
+    t->literal_maxchar = 127;
+    t->length = 0;
+    return t;
+}
+
+static void
+format_template_decref(format_template *t)
+{
+    if (--t->refcnt > 0)
+        return;
+    if (t->items != NULL) {
+        t->clear_items(t);
+        PyMem_Free(t->items);
+    }
+    Py_DECREF(t->format);
+    PyMem_Free(t);
+}
+
+/* Return the template of the format string if it is in the cache, or
+   compile it with compile() if it was the last format string of its slot
+   not to be compiled.  The caller must release the template with
+   format_template_decref().
+
+   Return NULL without an exception if the format string is not cached,
+   raise an exception and return NULL on error. */
+static format_template *
+format_cache_get(PyObject *format, int engine,
+                 format_template *(*compile)(PyObject *))
+{
+    Py_hash_t hash;
+    size_t index;
+    Py_ssize_t chars;
+    format_template *t;
+
+    if (!PyUnicode_CheckExact(format)
+        || PyUnicode_GET_LENGTH(format) > FORMAT_CACHE_MAX_LENGTH)
+        return NULL;
+    hash = unicode_hash(format);
+    index = ((size_t)hash + engine) & (FORMAT_CACHE_SIZE - 1);
+    t = format_cache[index];
+    if (t == NULL || t->engine != engine
+        || (t->format != format && !unicode_compare_eq(t->format, format))) {
+        /* Only compile the format strings used twice in a row */
+        if (format_cache_seen[index] != hash) {
+            format_cache_seen[index] = hash;
+            return NULL;
+        }
+        chars = format_cache_chars + PyUnicode_GET_LENGTH(format);
+        if (t != NULL)
+            chars -= PyUnicode_GET_LENGTH(t->format);
+        if (chars > FORMAT_CACHE_MAX_CHARS)
+            return NULL;
+        t = compile(format);
+        if (t == NULL)
+            return NULL;
+        if (format_cache[index] != NULL)
+            format_template_decref(format_cache[index]);
+        format_cache[index] = t;
+        format_cache_chars = chars;
+        format_cache_seen[index] = -1;
+    }
+    t->refcnt++;
+    return t;
+}
+
+void
+_PyUnicode_ClearFormatCache(void)
+{
+    int i;
+
+    for (i = 0; i < FORMAT_CACHE_SIZE; i++) {
+        if (format_cache[i] != NULL) {
+            format_template_decref(format_cache[i]);
+            format_cache[i] = NULL;
+        }
+        format_cache_seen[i] = -1;
+    }
+    format_cache_chars = 0;
+}
+
+/* Record the result of a successful call formatting with the template. */
+Py_LOCAL_INLINE(void)
+format_template_done(format_template *t, PyObject *result)
+{
+    if (result != NULL)
+        t->length = PyUnicode_GET_LENGTH(result);
+}
+
 #include "stringlib/unicode_format.h"
 
 PyDoc_STRVAR(format__doc__,
@@ -13567,8 +14648,8 @@ PyDoc_STRVAR(p_format__doc__,
 \n\
 Return a formatted version of S as described by format_spec.");
 
-static PyObject *
-unicode__sizeof__(PyObject *v)
+static Py_ssize_t
+unicode_sizeof(PyObject *v)
 {
     Py_ssize_t size;
 
@@ -13583,18 +14664,27 @@ unicode__sizeof__(PyObject *v)
         /* If it is a two-block object, account for base object, and
            for character block if present. */
         size = sizeof(PyUnicodeObject);
-        if (_PyUnicode_DATA_ANY(v))
+        /* The characters of a view belong to the exporter */
+        if (_PyUnicode_STATE(v).view)
+            size = sizeof(unicode_view);
+        else if (_PyUnicode_DATA_ANY(v))
             size += (PyUnicode_GET_LENGTH(v) + 1) *
                 PyUnicode_KIND(v);
     }
     /* If the wstr pointer is present, account for it unless it is shared
        with the data pointer. Check if the data is not shared. */
-    if (_PyUnicode_HAS_WSTR_MEMORY(v))
+    if (_PyUnicode_HAS_WSTR_MEMORY(v) || _PyUnicode_STATE(v).ascii_wstr)
         size += (PyUnicode_WSTR_LENGTH(v) + 1) * sizeof(wchar_t);
     if (_PyUnicode_HAS_UTF8_MEMORY(v))
         size += PyUnicode_UTF8_LENGTH(v) + 1;
 
-    return PyLong_FromSsize_t(size);
+    return size;
+}
+
+static PyObject *
+unicode__sizeof__(PyObject *v)
+{
+    return PyLong_FromSsize_t(unicode_sizeof(v));
 }
 
 PyDoc_STRVAR(sizeof__doc__,
@@ -13917,11 +15007,18 @@ _PyUnicode_FormatLong(PyObject *val, int alt, int prec, int type)
     if (!result)
         return NULL;
 
+    /* To modify the string in-place, there can only be one reference.
+       Single digits are shared: copy them. */
+    if (PyUnicode_GET_LENGTH(result) == 1) {
+        Py_SETREF(result, _PyUnicode_Copy(result));
+        if (result == NULL)
+            return NULL;
+    }
+
     assert(unicode_modifiable(result));
     assert(PyUnicode_IS_READY(result));
     assert(PyUnicode_IS_ASCII(result));
 
-    /* To modify the string in-place, there can only be one reference. */
     if (Py_REFCNT(result) != 1) {
         Py_DECREF(result);
         PyErr_BadInternalCall();
@@ -14153,61 +15250,67 @@ formatchar(PyObject *v)
    Return 0 if the argument has been formatted into arg->str.
    Return 1 if the argument has been written into ctx->writer,
    Raise an exception and return -1 on error. */
-static int
-unicode_format_arg_parse(struct unicode_formatter_t *ctx,
-                         struct unicode_format_arg_t *arg)
-{
+
 #define FORMAT_READ(ctx) \
         PyUnicode_READ((ctx)->fmtkind, (ctx)->fmtdata, (ctx)->fmtpos)
 
-    PyObject *v;
-
-    if (arg->ch == '(') {
-        /* Get argument value from a dictionary. Example: "%(name)s". */
-        Py_ssize_t keystart;
-        Py_ssize_t keylen;
-        PyObject *key;
-        int pcount = 1;
+/* Parse the key of a mapping argument. Example: "%(name)s" => "name".
+   Return a new reference to the key, or raise an exception and return
+   NULL on error. */
+static PyObject *
+unicode_format_arg_parse_key(struct unicode_formatter_t *ctx,
+                             struct unicode_format_arg_t *arg)
+{
+    Py_ssize_t keystart;
+    Py_ssize_t keylen;
+    int pcount = 1;
+
+    ++ctx->fmtpos;
+    --ctx->fmtcnt;
+    keystart = ctx->fmtpos;
+    /* Skip over balanced parentheses */
+    while (pcount > 0 && --ctx->fmtcnt >= 0) {
+        arg->ch = FORMAT_READ(ctx);
+        if (arg->ch == ')')
+            --pcount;
+        else if (arg->ch == '(')
+            ++pcount;
+        ctx->fmtpos++;
+    }
+    keylen = ctx->fmtpos - keystart - 1;
+    if (ctx->fmtcnt < 0 || pcount > 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "incomplete format key");
+        return NULL;
+    }
+    return PyUnicode_Substring(ctx->fmtstr,
+                               keystart, keystart + keylen);
+}
 
-        if (ctx->dict == NULL) {
-            PyErr_SetString(PyExc_TypeError,
-                            "format requires a mapping");
-            return -1;
-        }
-        ++ctx->fmtpos;
-        --ctx->fmtcnt;
-        keystart = ctx->fmtpos;
-        /* Skip over balanced parentheses */
-        while (pcount > 0 && --ctx->fmtcnt >= 0) {
-            arg->ch = FORMAT_READ(ctx);
-            if (arg->ch == ')')
-                --pcount;
-            else if (arg->ch == '(')
-                ++pcount;
-            ctx->fmtpos++;
-        }
-        keylen = ctx->fmtpos - keystart - 1;
-        if (ctx->fmtcnt < 0 || pcount > 0) {
-            PyErr_SetString(PyExc_ValueError,
-                            "incomplete format key");
-            return -1;
-        }
-        key = PyUnicode_Substring(ctx->fmtstr,
-                                  keystart, keystart + keylen);
-        if (key == NULL)
-            return -1;
-        if (ctx->args_owned) {
-            ctx->args_owned = 0;
-            Py_DECREF(ctx->args);
-        }
-        ctx->args = PyObject_GetItem(ctx->dict, key);
-        Py_DECREF(key);
-        if (ctx->args == NULL)
-            return -1;
-        ctx->args_owned = 1;
-        ctx->arglen = -1;
-        ctx->argidx = -2;
+/* Get the argument value from the mapping.
+   Return 0 on success, raise an exception and return -1 on error. */
+static int
+unicode_format_getdictarg(struct unicode_formatter_t *ctx, PyObject *key)
+{
+    if (ctx->args_owned) {
+        ctx->args_owned = 0;
+        Py_DECREF(ctx->args);
     }
+    ctx->args = PyObject_GetItem(ctx->dict, key);
+    if (ctx->args == NULL)
+        return -1;
+    ctx->args_owned = 1;
+    ctx->arglen = -1;
+    ctx->argidx = -2;
+    return 0;
+}
+
+/* Parse the flags, width and precision of an argument. */
+static int
+unicode_format_arg_parse_spec(struct unicode_formatter_t *ctx,
+                              struct unicode_format_arg_t *arg)
+{
+    PyObject *v;
 
     /* Parse flags. Example: "%+i" => flags=F_SIGN. */
     while (--ctx->fmtcnt >= 0) {
@@ -14322,10 +15425,35 @@ unicode_format_arg_parse(struct unicode_formatter_t *ctx,
         return -1;
     }
     return 0;
+}
 
-#undef FORMAT_READ
+static int
+unicode_format_arg_parse(struct unicode_formatter_t *ctx,
+                         struct unicode_format_arg_t *arg)
+{
+    if (arg->ch == '(') {
+        /* Get argument value from a dictionary. Example: "%(name)s". */
+        PyObject *key;
+        int ret;
+
+        if (ctx->dict == NULL) {
+            PyErr_SetString(PyExc_TypeError,
+                            "format requires a mapping");
+            return -1;
+        }
+        key = unicode_format_arg_parse_key(ctx, arg);
+        if (key == NULL)
+            return -1;
+        ret = unicode_format_getdictarg(ctx, key);
+        Py_DECREF(key);
+        if (ret == -1)
+            return -1;
+    }
+    return unicode_format_arg_parse_spec(ctx, arg);
 }
 
+#undef FORMAT_READ
+
 /* Format one argument. Supported conversion specifiers:
 
    - "s", "r", "a": any type
@@ -14606,38 +15734,27 @@ unicode_format_arg_output(struct unicode_formatter_t *ctx,
     return 0;
 }
 
-/* Helper of PyUnicode_Format(): format one arg.
+/* Format one parsed arg.
    Return 0 on success, raise an exception and return -1 on error. */
 static int
-unicode_format_arg(struct unicode_formatter_t *ctx)
+unicode_format_arg_render(struct unicode_formatter_t *ctx,
+                          struct unicode_format_arg_t *arg)
 {
-    struct unicode_format_arg_t arg;
-    PyObject *str;
+    PyObject *str = NULL;
     int ret;
 
-    arg.ch = PyUnicode_READ(ctx->fmtkind, ctx->fmtdata, ctx->fmtpos);
-    arg.flags = 0;
-    arg.width = -1;
-    arg.prec = -1;
-    arg.sign = 0;
-    str = NULL;
-
-    ret = unicode_format_arg_parse(ctx, &arg);
-    if (ret == -1)
-        return -1;
-
-    ret = unicode_format_arg_format(ctx, &arg, &str);
+    ret = unicode_format_arg_format(ctx, arg, &str);
     if (ret == -1)
         return -1;
 
     if (ret != 1) {
-        ret = unicode_format_arg_output(ctx, &arg, str);
+        ret = unicode_format_arg_output(ctx, arg, str);
         Py_DECREF(str);
         if (ret == -1)
             return -1;
     }
 
-    if (ctx->dict && (ctx->argidx < ctx->arglen) && arg.ch != '%') {
+    if (ctx->dict && (ctx->argidx < ctx->arglen) && arg->ch != '%') {
         PyErr_SetString(PyExc_TypeError,
                         "not all arguments converted during string formatting");
         return -1;
@@ -14645,10 +15762,213 @@ unicode_format_arg(struct unicode_formatter_t *ctx)
     return 0;
 }
 
+Py_LOCAL_INLINE(void)
+unicode_format_arg_init(struct unicode_formatter_t *ctx,
+                        struct unicode_format_arg_t *arg)
+{
+    arg->ch = PyUnicode_READ(ctx->fmtkind, ctx->fmtdata, ctx->fmtpos);
+    arg->flags = 0;
+    arg->width = -1;
+    arg->prec = -1;
+    arg->sign = 0;
+}
+
+/* Helper of PyUnicode_Format(): format one arg.
+   Return 0 on success, raise an exception and return -1 on error. */
+static int
+unicode_format_arg(struct unicode_formatter_t *ctx)
+{
+    struct unicode_format_arg_t arg;
+
+    unicode_format_arg_init(ctx, &arg);
+    if (unicode_format_arg_parse(ctx, &arg) == -1)
+        return -1;
+    return unicode_format_arg_render(ctx, &arg);
+}
+
+/* Compiled format strings (see format_cache_get()): a list of arguments,
+   each preceded by literal text.  The last item may consist of literal
+   text only. */
+
+typedef struct {
+    Py_ssize_t literal_start, literal_end;
+    int arg_present;
+    /* key of a mapping argument, or NULL */
+    PyObject *key;
+    struct unicode_format_arg_t arg;
+} unicode_format_item;
+
+static void
+unicode_format_items_clear(format_template *t)
+{
+    unicode_format_item *items = t->items;
+    Py_ssize_t i;
+
+    for (i = 0; i < t->nitems; i++)
+        Py_XDECREF(items[i].key);
+}
+
+static format_template *
+unicode_format_compile(PyObject *format)
+{
+    struct unicode_formatter_t ctx;
+    format_template *t;
+    unicode_format_item *items = NULL, *item;
+    Py_ssize_t nitems = 0, allocated = 0, i;
+
+    t = format_template_new(format, FORMAT_PERCENT);
+    if (t == NULL)
+        return NULL;
+
+    ctx.fmtstr = format;
+    ctx.fmtdata = PyUnicode_DATA(format);
+    ctx.fmtkind = PyUnicode_KIND(format);
+    ctx.fmtcnt = PyUnicode_GET_LENGTH(format);
+    ctx.fmtpos = 0;
+    /* Without arguments, "*" widths and precisions fail to parse and are
+       left to the generic code */
+    ctx.args = NULL;
+    ctx.args_owned = 0;
+    ctx.arglen = 0;
+    ctx.argidx = 0;
+    ctx.dict = NULL;
+
+    while (--ctx.fmtcnt >= 0) {
+        if (nitems == 0 || items[nitems - 1].arg_present) {
+            if (nitems == allocated) {
+                unicode_format_item *tmp;
+                allocated = allocated ? allocated * 2 : 4;
+                tmp = PyMem_Realloc(items,
+                                    allocated * sizeof(unicode_format_item));
+                if (tmp == NULL) {
+                    PyErr_NoMemory();
+                    goto error;
+                }
+                items = tmp;
+            }
+            item = &items[nitems++];
+            item->literal_start = item->literal_end = ctx.fmtpos;
+            item->arg_present = 0;
+            item->key = NULL;
+        }
+        else
+            item = &items[nitems - 1];
+
+        if (PyUnicode_READ(ctx.fmtkind, ctx.fmtdata, ctx.fmtpos) != '%') {
+            Py_ssize_t nonfmtpos;
+            Py_UCS4 maxchar;
+
+            nonfmtpos = ctx.fmtpos++;
+            while (ctx.fmtcnt >= 0 &&
+                   PyUnicode_READ(ctx.fmtkind, ctx.fmtdata, ctx.fmtpos) != '%') {
+                ctx.fmtpos++;
+                ctx.fmtcnt--;
+            }
+            if (ctx.fmtcnt < 0)
+                ctx.fmtpos--;
+            item->literal_start = nonfmtpos;
+            item->literal_end = ctx.fmtpos;
+            maxchar = _PyUnicode_FindMaxChar(format, nonfmtpos, ctx.fmtpos);
+            t->literal_maxchar = Py_MAX(t->literal_maxchar, maxchar);
+        }
+        else {
+            struct unicode_format_arg_t *arg = &item->arg;
+
+            ctx.fmtpos++;
+            unicode_format_arg_init(&ctx, arg);
+            if (arg->ch == '(') {
+                item->key = unicode_format_arg_parse_key(&ctx, arg);
+                if (item->key == NULL)
+                    goto not_compiled;
+            }
+            if (unicode_format_arg_parse_spec(&ctx, arg) == -1)
+                goto not_compiled;
+            switch (arg->ch) {
+            case '%': case 's': case 'r': case 'a':
+            case 'i': case 'd': case 'u': case 'o': case 'x': case 'X':
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+            case 'c':
+                break;
+            default:
+                goto not_compiled;
+            }
+            item->arg_present = 1;
+        }
+    }
+
+    t->items = items;
+    t->nitems = nitems;
+    t->clear_items = unicode_format_items_clear;
+    return t;
+
+not_compiled:
+    if (PyErr_ExceptionMatches(PyExc_MemoryError))
+        goto error;
+    /* Leave the errors to the generic code */
+    PyErr_Clear();
+    for (i = 0; i < nitems; i++)
+        Py_XDECREF(items[i].key);
+    PyMem_Free(items);
+    t->literal_maxchar = 127;
+    return t;
+
+error:
+    for (i = 0; i < nitems; i++)
+        Py_XDECREF(items[i].key);
+    PyMem_Free(items);
+    format_template_decref(t);
+    return NULL;
+}
+
+/* Helper of PyUnicode_Format(): format the arguments with a compiled
+   format string.
+   Return 0 on success, raise an exception and return -1 on error. */
+static int
+unicode_format_template(struct unicode_formatter_t *ctx, format_template *t)
+{
+    unicode_format_item *item = t->items;
+    struct unicode_format_arg_t arg;
+    Py_ssize_t i;
+
+    for (i = 0; i < t->nitems; i++, item++) {
+        int last = (i == t->nitems - 1);
+
+        if (item->literal_end != item->literal_start) {
+            if (last && !item->arg_present)
+                ctx->writer.overallocate = 0;
+            if (_PyUnicodeWriter_WriteSubstring(&ctx->writer, ctx->fmtstr,
+                                                item->literal_start,
+                                                item->literal_end) < 0)
+                return -1;
+        }
+        if (!item->arg_present)
+            continue;
+
+        if (item->key != NULL) {
+            if (ctx->dict == NULL) {
+                PyErr_SetString(PyExc_TypeError,
+                                "format requires a mapping");
+                return -1;
+            }
+            if (unicode_format_getdictarg(ctx, item->key) == -1)
+                return -1;
+        }
+        /* unicode_format_arg_format() stops overallocating at the last
+           argument */
+        ctx->fmtcnt = last ? 0 : 1;
+        arg = item->arg;
+        if (unicode_format_arg_render(ctx, &arg) == -1)
+            return -1;
+    }
+    return 0;
+}
+
 PyObject *
 PyUnicode_Format(PyObject *format, PyObject *args)
 {
     struct unicode_formatter_t ctx;
+    format_template *t;
+    PyObject *result;
 
     if (format == NULL || args == NULL) {
         PyErr_BadInternalCall();
@@ -14662,13 +15982,23 @@ PyUnicode_Format(PyObject *format, PyObject *args)
         Py_DECREF(ctx.fmtstr);
         return NULL;
     }
+    t = format_cache_get(ctx.fmtstr, FORMAT_PERCENT, unicode_format_compile);
+    if (t == NULL && PyErr_Occurred()) {
+        Py_DECREF(ctx.fmtstr);
+        return NULL;
+    }
     ctx.fmtdata = PyUnicode_DATA(ctx.fmtstr);
     ctx.fmtkind = PyUnicode_KIND(ctx.fmtstr);
     ctx.fmtcnt = PyUnicode_GET_LENGTH(ctx.fmtstr);
     ctx.fmtpos = 0;
 
     _PyUnicodeWriter_Init(&ctx.writer);
-    ctx.writer.min_length = ctx.fmtcnt + 100;
+    if (t != NULL && t->length > 0)
+        ctx.writer.min_length = t->length;
+    else
+        ctx.writer.min_length = ctx.fmtcnt + 100;
+    if (t != NULL)
+        ctx.writer.min_char = t->literal_maxchar;
     ctx.writer.overallocate = 1;
 
     if (PyTuple_Check(args)) {
@@ -14686,29 +16016,35 @@ PyUnicode_Format(PyObject *format, PyObject *args)
         ctx.dict = NULL;
     ctx.args = args;
 
-    while (--ctx.fmtcnt >= 0) {
-        if (PyUnicode_READ(ctx.fmtkind, ctx.fmtdata, ctx.fmtpos) != '%') {
-            Py_ssize_t nonfmtpos;
+    if (t != NULL && t->nitems >= 0) {
+        if (unicode_format_template(&ctx, t) == -1)
+            goto onError;
+    }
+    else {
+        while (--ctx.fmtcnt >= 0) {
+            if (PyUnicode_READ(ctx.fmtkind, ctx.fmtdata, ctx.fmtpos) != '%') {
+                Py_ssize_t nonfmtpos;
+
+                nonfmtpos = ctx.fmtpos++;
+                while (ctx.fmtcnt >= 0 &&
+                       PyUnicode_READ(ctx.fmtkind, ctx.fmtdata, ctx.fmtpos) != '%') {
+                    ctx.fmtpos++;
+                    ctx.fmtcnt--;
+                }
+                if (ctx.fmtcnt < 0) {
+                    ctx.fmtpos--;
+                    ctx.writer.overallocate = 0;
+                }
 
-            nonfmtpos = ctx.fmtpos++;
-            while (ctx.fmtcnt >= 0 &&
-                   PyUnicode_READ(ctx.fmtkind, ctx.fmtdata, ctx.fmtpos) != '%') {
-                ctx.fmtpos++;
-                ctx.fmtcnt--;
+                if (_PyUnicodeWriter_WriteSubstring(&ctx.writer, ctx.fmtstr,
+                                                    nonfmtpos, ctx.fmtpos) < 0)
+                    goto onError;
             }
-            if (ctx.fmtcnt < 0) {
-                ctx.fmtpos--;
-                ctx.writer.overallocate = 0;
+            else {
+                ctx.fmtpos++;
+                if (unicode_format_arg(&ctx) == -1)
+                    goto onError;
             }
-
-            if (_PyUnicodeWriter_WriteSubstring(&ctx.writer, ctx.fmtstr,
-                                                nonfmtpos, ctx.fmtpos) < 0)
-                goto onError;
-        }
-        else {
-            ctx.fmtpos++;
-            if (unicode_format_arg(&ctx) == -1)
-                goto onError;
         }
     }
 
@@ -14722,9 +16058,16 @@ PyUnicode_Format(PyObject *format, PyObject *args)
         Py_DECREF(ctx.args);
     }
     Py_DECREF(ctx.fmtstr);
-    return _PyUnicodeWriter_Finish(&ctx.writer);
+    result = _PyUnicodeWriter_Finish(&ctx.writer);
+    if (t != NULL) {
+        format_template_done(t, result);
+        format_template_decref(t);
+    }
+    return result;
 
   onError:
+    if (t != NULL)
+        format_template_decref(t);
     Py_DECREF(ctx.fmtstr);
     _PyUnicodeWriter_Dealloc(&ctx.writer);
     if (ctx.args_owned) {
@@ -14796,6 +16139,9 @@ unicode_subtype_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     _PyUnicode_STATE(self).compact = 0;
     _PyUnicode_STATE(self).ascii = _PyUnicode_STATE(unicode).ascii;
     _PyUnicode_STATE(self).ready = 1;
+    _PyUnicode_STATE(self).shared = 0;
+    _PyUnicode_STATE(self).ascii_wstr = 0;
+    _PyUnicode_STATE(self).view = 0;
     _PyUnicode_WSTR(self) = NULL;
     _PyUnicode_UTF8_LENGTH(self) = 0;
     _PyUnicode_UTF8(self) = NULL;
@@ -14842,8 +16188,10 @@ unicode_subtype_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
         _PyUnicode_WSTR(self) = (wchar_t *)data;
     }
 
-    Py_MEMCPY(data, PyUnicode_DATA(unicode),
-              kind * (length + 1));
+    /* The characters of a shared string are not followed by a null
+       character */
+    Py_MEMCPY(data, PyUnicode_DATA(unicode), kind * length);
+    PyUnicode_WRITE(kind, data, length, 0);
     assert(_PyUnicode_CheckConsistency(self, 1));
 #ifdef Py_DEBUG
     _PyUnicode_HASH(self) = _PyUnicode_HASH(unicode);
@@ -14975,14 +16323,137 @@ _PyUnicode_Fini(void)
     for (i = 0; i < 256; i++)
         Py_CLEAR(unicode_latin1[i]);
     _PyUnicode_ClearStaticStrings();
+    _PyUnicode_ClearFormatCache();
     (void)PyUnicode_ClearFreeList();
 }
 
+/* --- String Sets -------------------------------------------------------- */
+
+/* Tables have a power of 2 size, at least UNICODE_SET_MINSIZE, and are
+   grown before they are 2/3 full (strings and dummies), to twice the number
+   of strings or more. */
+#define UNICODE_SET_MINSIZE 64
+#define UNICODE_SET_PERTURB_SHIFT 5
+
+/* Removed strings leave a dummy, which lookups skip */
+static PyObject unicode_set_dummy_struct;
+#define UNICODE_SET_DUMMY (&unicode_set_dummy_struct)
+
+/* Return the slot holding the string equal to s, or the slot where s
+   should be added. */
+static PyObject **
+unicode_set_lookup(unicode_set *set, PyObject *s, Py_hash_t hash)
+{
+    PyObject **table = set->table, **freeslot = NULL;
+    size_t perturb = (size_t)hash;
+    size_t i = (size_t)hash & set->mask;
+
+    for (;;) {
+        PyObject *t = table[i];
+        if (t == NULL)
+            return freeslot != NULL ? freeslot : &table[i];
+        if (t == UNICODE_SET_DUMMY) {
+            if (freeslot == NULL)
+                freeslot = &table[i];
+        }
+        else if (t == s || (_PyUnicode_HASH(t) == hash
+                            && unicode_compare_eq(t, s)))
+            return &table[i];
+        perturb >>= UNICODE_SET_PERTURB_SHIFT;
+        i = (i * 5 + perturb + 1) & set->mask;
+    }
+}
+
+static int
+unicode_set_resize(unicode_set *set, Py_ssize_t minused)
+{
+    PyObject **oldtable = set->table, **table;
+    size_t oldsize = oldtable != NULL ? set->mask + 1 : 0;
+    size_t size = UNICODE_SET_MINSIZE;
+    size_t i;
+
+    while (size <= (size_t)minused * 2)
+        size <<= 1;
+    table = PyMem_Calloc(size, sizeof(PyObject *));
+    if (table == NULL)
+        return -1;
+    set->table = table;
+    set->mask = size - 1;
+    set->fill = set->used;
+    for (i = 0; i < oldsize; i++) {
+        PyObject *t = oldtable[i];
+        if (t != NULL && t != UNICODE_SET_DUMMY)
+            *unicode_set_lookup(set, t, _PyUnicode_HASH(t)) = t;
+    }
+    PyMem_Free(oldtable);
+    return 0;
+}
+
+/* Return the string of the set equal to s (a borrowed reference), or NULL */
+static PyObject *
+unicode_set_get(unicode_set *set, PyObject *s, Py_hash_t hash)
+{
+    PyObject *t;
+
+    if (set->table == NULL)
+        return NULL;
+    t = *unicode_set_lookup(set, s, hash);
+    return t != UNICODE_SET_DUMMY ? t : NULL;
+}
+
+/* Add s, which must not be in the set and must have its hash computed.
+   Return -1 on memory error, without setting an exception. */
+static int
+unicode_set_add(unicode_set *set, PyObject *s)
+{
+    PyObject **slot;
+
+    assert(_PyUnicode_HASH(s) != -1);
+    if (set->table == NULL
+        || (size_t)(set->fill + 1) * 3 >= (set->mask + 1) * 2) {
+        if (unicode_set_resize(set, set->used + 1) < 0)
+            return -1;
+    }
+    slot = unicode_set_lookup(set, s, _PyUnicode_HASH(s));
+    assert(*slot == NULL || *slot == UNICODE_SET_DUMMY);
+    if (*slot == NULL)
+        set->fill++;
+    *slot = s;
+    set->used++;
+    return 0;
+}
+
+/* Remove s itself from the set; return -1 if it is not there. */
+static int
+unicode_set_discard(unicode_set *set, PyObject *s)
+{
+    PyObject **slot;
+
+    if (set->table == NULL)
+        return -1;
+    slot = unicode_set_lookup(set, s, _PyUnicode_HASH(s));
+    if (*slot != s)
+        return -1;
+    *slot = UNICODE_SET_DUMMY;
+    set->used--;
+    return 0;
+}
+
+static void
+unicode_set_clear(unicode_set *set)
+{
+    PyMem_Free(set->table);
+    set->table = NULL;
+    set->mask = 0;
+    set->used = set->fill = 0;
+}
+
 void
 PyUnicode_InternInPlace(PyObject **p)
 {
     PyObject *s = *p;
     PyObject *t;
+    Py_hash_t hash;
 #ifdef Py_DEBUG
     assert(s != NULL);
     assert(_PyUnicode_CHECK(s));
@@ -14991,41 +16462,26 @@ PyUnicode_InternInPlace(PyObject **p)
         return;
 #endif
     /* If it's a subclass, we don't really know what putting
-       it in the interned dict might do. */
+       it in the interned set might do. */
     if (!PyUnicode_CheckExact(s))
         return;
     if (PyUnicode_CHECK_INTERNED(s))
         return;
-    if (interned == NULL) {
-        interned = PyDict_New();
-        if (interned == NULL) {
-            PyErr_Clear(); /* Don't leave an exception */
-            return;
-        }
+    hash = PyObject_Hash(s);
+    if (hash == -1) {
+        PyErr_Clear(); /* Don't leave an exception */
+        return;
     }
-    /* It might be that the GetItem call fails even
-       though the key is present in the dictionary,
-       namely when this happens during a stack overflow. */
-    Py_ALLOW_RECURSION
-    t = PyDict_GetItem(interned, s);
-    Py_END_ALLOW_RECURSION
-
+    t = unicode_set_get(&interned, s, hash);
     if (t) {
         Py_INCREF(t);
         Py_SETREF(*p, t);
         return;
     }
-
-    PyThreadState_GET()->recursion_critical = 1;
-    if (PyDict_SetItem(interned, s, s) < 0) {
-        PyErr_Clear();
-        PyThreadState_GET()->recursion_critical = 0;
+    if (unicode_set_add(&interned, s) < 0)
         return;
-    }
-    PyThreadState_GET()->recursion_critical = 0;
-    /* The two references in interned are not counted by refcnt.
+    /* The reference in interned is not counted by refcnt.
        The deallocator will take care of this */
-    Py_REFCNT(s) -= 2;
     _PyUnicode_STATE(s).interned = SSTATE_INTERNED_MORTAL;
 }
 
@@ -15052,56 +16508,197 @@ PyUnicode_InternFromString(const char *cp)
 void
 _Py_ReleaseInternedUnicodeStrings(void)
 {
-    PyObject *keys;
+    unicode_set set = interned;
     PyObject *s;
-    Py_ssize_t i, n;
+    size_t i;
     Py_ssize_t immortal_size = 0, mortal_size = 0;
 
-    if (interned == NULL || !PyDict_Check(interned))
-        return;
-    keys = PyDict_Keys(interned);
-    if (keys == NULL || !PyList_Check(keys)) {
-        PyErr_Clear();
+    if (set.table == NULL)
         return;
-    }
+    interned.table = NULL;
+    interned.mask = 0;
+    interned.used = interned.fill = 0;
 
     /* Since _Py_ReleaseInternedUnicodeStrings() is intended to help a leak
        detector, interned unicode strings are not forcibly deallocated;
-       rather, we give them their stolen references back, and then clear
-       and DECREF the interned dict. */
+       rather, immortal strings get their extra reference released, and
+       the set is freed. */
 
-    n = PyList_GET_SIZE(keys);
     fprintf(stderr, "releasing %" PY_FORMAT_SIZE_T "d interned strings\n",
-            n);
-    for (i = 0; i < n; i++) {
-        s = PyList_GET_ITEM(keys, i);
-        if (PyUnicode_READY(s) == -1) {
-            assert(0 && "could not ready string");
-            fprintf(stderr, "could not ready string\n");
-        }
+            set.used);
+    for (i = 0; i <= set.mask; i++) {
+        s = set.table[i];
+        if (s == NULL || s == UNICODE_SET_DUMMY)
+            continue;
         switch (PyUnicode_CHECK_INTERNED(s)) {
-        case SSTATE_NOT_INTERNED:
-            /* XXX Shouldn't happen */
-            break;
         case SSTATE_INTERNED_IMMORTAL:
-            Py_REFCNT(s) += 1;
             immortal_size += PyUnicode_GET_LENGTH(s);
+            _PyUnicode_STATE(s).interned = SSTATE_NOT_INTERNED;
+            Py_DECREF(s);
             break;
         case SSTATE_INTERNED_MORTAL:
-            Py_REFCNT(s) += 2;
             mortal_size += PyUnicode_GET_LENGTH(s);
+            _PyUnicode_STATE(s).interned = SSTATE_NOT_INTERNED;
             break;
         default:
             Py_FatalError("Inconsistent interned string state.");
         }
-        _PyUnicode_STATE(s).interned = SSTATE_NOT_INTERNED;
     }
     fprintf(stderr, "total size of all interned strings: "
             "%" PY_FORMAT_SIZE_T "d/%" PY_FORMAT_SIZE_T "d "
             "mortal/immortal\n", mortal_size, immortal_size);
-    Py_DECREF(keys);
-    PyDict_Clear(interned);
-    Py_CLEAR(interned);
+    unicode_set_clear(&set);
+}
+
+/* --- String Deduplication ----------------------------------------------- */
+
+/* sys.dedup_strings() replaces each exact string held by the constants and
+   names of code objects by an equal string: the interned one if there is
+   one, else the first one seen.  Only these tuples, which the interpreter
+   owns and never hands out to C code as borrowed references, are changed:
+   a list, a dict or a tuple built at runtime may be iterated by C code
+   with borrowed pointers to its items.  The code objects are reached from
+   the functions, generators, coroutines and frames tracked by the garbage
+   collector, and from the constants of other code objects. */
+
+typedef struct {
+    unicode_set seen;           /* strings kept, not interned */
+    PyObject *visited;          /* addresses of the code objects visited */
+    Py_ssize_t strings;         /* string references visited */
+    Py_ssize_t merged;          /* references replaced */
+    Py_ssize_t freed;           /* strings deallocated */
+    Py_ssize_t reclaimed;       /* size of the strings deallocated */
+} dedup_state;
+
+static int
+dedup_slot(PyObject **slot, dedup_state *state)
+{
+    PyObject *s = *slot, *t;
+    Py_hash_t hash;
+
+    if (!PyUnicode_CheckExact(s) || !PyUnicode_IS_READY(s))
+        return 0;
+    state->strings++;
+    hash = PyObject_Hash(s);
+    if (hash == -1)
+        return -1;
+    t = unicode_set_get(&interned, s, hash);
+    if (t == NULL) {
+        t = unicode_set_get(&state->seen, s, hash);
+        if (t == NULL) {
+            if (unicode_set_add(&state->seen, s) < 0) {
+                PyErr_NoMemory();
+                return -1;
+            }
+            return 0;
+        }
+    }
+    if (t == s)
+        return 0;
+    if (Py_REFCNT(s) == 1) {
+        state->freed++;
+        state->reclaimed += unicode_sizeof(s);
+    }
+    Py_INCREF(t);
+    *slot = t;
+    state->merged++;
+    Py_DECREF(s);
+    return 0;
+}
+
+static int
+dedup_code(PyObject *op, dedup_state *state)
+{
+    PyCodeObject *co = (PyCodeObject *)op;
+    PyObject *tuples[5], *key, *item;
+    Py_ssize_t i, j;
+    int res;
+
+    key = PyLong_FromVoidPtr(op);
+    if (key == NULL)
+        return -1;
+    res = PySet_Contains(state->visited, key);
+    if (res == 0)
+        res = PySet_Add(state->visited, key);
+    else if (res > 0)
+        res = 1;
+    Py_DECREF(key);
+    if (res != 0)
+        return res < 0 ? -1 : 0;
+
+    tuples[0] = co->co_consts;
+    tuples[1] = co->co_names;
+    tuples[2] = co->co_varnames;
+    tuples[3] = co->co_freevars;
+    tuples[4] = co->co_cellvars;
+    for (i = 0; i < 5; i++) {
+        if (tuples[i] == NULL || !PyTuple_Check(tuples[i]))
+            continue;
+        for (j = 0; j < PyTuple_GET_SIZE(tuples[i]); j++) {
+            if (dedup_slot(&((PyTupleObject *)tuples[i])->ob_item[j],
+                           state) < 0)
+                return -1;
+        }
+    }
+
+    /* nested functions and classes */
+    for (j = 0; j < PyTuple_GET_SIZE(co->co_consts); j++) {
+        item = PyTuple_GET_ITEM(co->co_consts, j);
+        if (!PyCode_Check(item))
+            continue;
+        if (Py_EnterRecursiveCall(" while deduplicating strings"))
+            return -1;
+        res = dedup_code(item, state);
+        Py_LeaveRecursiveCall();
+        if (res < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static int
+dedup_tracked(PyObject *op, void *arg)
+{
+    dedup_state *state = (dedup_state *)arg;
+    PyObject *code;
+
+    if (PyFunction_Check(op))
+        code = PyFunction_GET_CODE(op);
+    else if (PyGen_Check(op))
+        code = ((PyGenObject *)op)->gi_code;
+    else if (PyCoro_CheckExact(op))
+        code = ((PyCoroObject *)op)->cr_code;
+    else if (PyFrame_Check(op))
+        code = (PyObject *)((PyFrameObject *)op)->f_code;
+    else
+        return 0;
+    if (code == NULL || !PyCode_Check(code))
+        return 0;
+    return dedup_code(code, state);
+}
+
+PyObject *
+_PyUnicode_DedupStrings(void)
+{
+    dedup_state state;
+    int res;
+
+    memset(&state, 0, sizeof(state));
+    state.visited = PySet_New(NULL);
+    if (state.visited == NULL)
+        return NULL;
+    /* don't let the walk visit it */
+    PyObject_GC_UnTrack(state.visited);
+    res = _PyGC_VisitTracked(dedup_tracked, &state);
+    unicode_set_clear(&state.seen);
+    Py_DECREF(state.visited);
+    if (res < 0)
+        return NULL;
+    return Py_BuildValue("{snsnsnsn}",
+                         "strings", state.strings,
+                         "merged", state.merged,
+                         "freed", state.freed,
+                         "reclaimed", state.reclaimed);
 }
 
 
@@ -2066,21 +2066,26 @@ sorted as builtin_sorted
     iterable as seq: object
     key as keyfunc: object = None
     reverse: object = False
+    parallel: object = False
 
 Return a new list containing all items from the iterable in ascending order.
 
 A custom key function can be supplied to customise the sort order, and the
-reverse flag can be set to request the result in descending order.
+reverse flag can be set to request the result in descending order.  The
+parallel flag allows sorting large lists of ints, floats or strs with
+several threads.
 [end disabled clinic input]*/
 
 PyDoc_STRVAR(builtin_sorted__doc__,
-"sorted($module, iterable, key=None, reverse=False)\n"
+"sorted($module, iterable, key=None, reverse=False, parallel=False)\n"
 "--\n"
 "\n"
 "Return a new list containing all items from the iterable in ascending order.\n"
 "\n"
 "A custom key function can be supplied to customise the sort order, and the\n"
-"reverse flag can be set to request the result in descending order.");
+"reverse flag can be set to request the result in descending order.  The\n"
+"parallel flag allows sorting large lists of ints, floats or strs with\n"
+"several threads.");
 
 #define BUILTIN_SORTED_METHODDEF    \
     {"sorted", (PyCFunction)builtin_sorted, METH_VARARGS|METH_KEYWORDS, builtin_sorted__doc__},
@@ -2088,14 +2093,14 @@ PyDoc_STRVAR(builtin_sorted__doc__,
 static PyObject *
 builtin_sorted(PyObject *self, PyObject *args, PyObject *kwds)
 {
-    PyObject *newlist, *v, *seq, *keyfunc=NULL, *newargs;
+    PyObject *newlist, *v, *seq, *keyfunc=NULL, *parallel=NULL, *newargs;
     PyObject *callable;
-    static char *kwlist[] = {"iterable", "key", "reverse", 0};
+    static char *kwlist[] = {"iterable", "key", "reverse", "parallel", 0};
     int reverse;
 
-    /* args 1-3 should match listsort in Objects/listobject.c */
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|Oi:sorted",
-        kwlist, &seq, &keyfunc, &reverse))
+    /* args 1-4 should match listsort in Objects/listobject.c */
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|OiO:sorted",
+        kwlist, &seq, &keyfunc, &reverse, &parallel))
         return NULL;
 
     newlist = PySequence_List(seq);
@@ -2108,7 +2113,7 @@ builtin_sorted(PyObject *self, PyObject *args, PyObject *kwds)
         return NULL;
     }
 
-    newargs = PyTuple_GetSlice(args, 1, 4);
+    newargs = PyTuple_GetSlice(args, 1, 5);
     if (newargs == NULL) {
         Py_DECREF(newlist);
         Py_DECREF(callable);
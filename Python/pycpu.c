@@ -0,0 +1,55 @@
+/* Detection of the instruction set extensions usable by the interpreter.
+   See Include/pycpu.h. */
+
+#include "Python.h"
+#include "pycpu.h"
+
+#ifdef MS_WINDOWS
+#include <windows.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+int _Py_cpu_features = 0;
+int _Py_cpu_count = 1;
+
+static int
+cpu_count(void)
+{
+    long n = 1;
+#ifdef MS_WINDOWS
+    SYSTEM_INFO sysinfo;
+    GetSystemInfo(&sysinfo);
+    n = sysinfo.dwNumberOfProcessors;
+#elif defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n >= 1 && n <= INT_MAX ? (int)n : 1;
+}
+
+void
+_PyCpu_Init(void)
+{
+    int features = 0;
+    char *p;
+
+#ifdef Py_CPU_DISPATCH
+    /* __builtin_cpu_supports() also checks that the OS saves the AVX
+       registers on context switches. */
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2"))
+        features |= _Py_CPU_SSE42;
+    if (__builtin_cpu_supports("avx2"))
+        features |= _Py_CPU_AVX2;
+#endif
+
+    /* PYTHONNOSIMD disables all the specialized code paths, which is
+       useful to test and benchmark the generic ones. */
+    p = Py_GETENV("PYTHONNOSIMD");
+    if (p != NULL && *p != '\0')
+        features = 0;
+
+    _Py_cpu_features = features;
+    _Py_cpu_count = cpu_count();
+}
@@ -19,11 +19,47 @@ extern "C" {
 
 _Py_HashSecret_t _Py_HashSecret;
 
+/* SipHash needs 64-bit integers and unaligned memory accesses */
+#if (defined(PY_UINT64_T) && defined(PY_UINT32_T) \
+     && !defined(HAVE_ALIGNED_REQUIRED)) \
+    || Py_HASH_ALGORITHM == Py_HASH_SIPHASH24 \
+    || Py_HASH_ALGORITHM == Py_HASH_SIPHASH13
+#  define Py_HASH_HAVE_SIPHASH
+#endif
+
+static PyHash_FuncDef fnv_def;
+#ifdef Py_HASH_HAVE_SIPHASH
+static PyHash_FuncDef siphash24_def;
+static PyHash_FuncDef siphash13_def;
+#endif
+
 #if Py_HASH_ALGORITHM == Py_HASH_EXTERNAL
 extern PyHash_FuncDef PyHash_Func;
+#  define Py_HASH_DEFAULT_DEF PyHash_Func
+#elif Py_HASH_ALGORITHM == Py_HASH_SIPHASH24
+#  define Py_HASH_DEFAULT_DEF siphash24_def
+#elif Py_HASH_ALGORITHM == Py_HASH_SIPHASH13
+#  define Py_HASH_DEFAULT_DEF siphash13_def
 #else
-static PyHash_FuncDef PyHash_Func;
+#  define Py_HASH_DEFAULT_DEF fnv_def
+#endif
+
+/* The hash function of str, bytes and memoryview.  The PYTHONHASHALGORITHM
+   environment variable selects another one of hash_funcs at startup (see
+   _PyHash_Init()); it can't change once objects have cached their hash. */
+static PyHash_FuncDef *hash_func = &Py_HASH_DEFAULT_DEF;
+
+static PyHash_FuncDef *hash_funcs[] = {
+#if Py_HASH_ALGORITHM == Py_HASH_EXTERNAL
+    &PyHash_Func,
+#endif
+#ifdef Py_HASH_HAVE_SIPHASH
+    &siphash24_def,
+    &siphash13_def,
 #endif
+    &fnv_def,
+    NULL
+};
 
 /* Count _Py_HashBytes() calls */
 #ifdef Py_HASH_STATS
@@ -183,7 +219,7 @@ _Py_HashBytes(const void *src, Py_ssize_t len)
     }
     else
 #endif /* Py_HASH_CUTOFF */
-        x = PyHash_Func.hash(src, len);
+        x = hash_func->hash(src, len);
 
     if (x == -1)
         return -2;
@@ -209,10 +245,34 @@ _PyHash_Fini(void)
 #endif
 }
 
+void
+_PyHash_Init(void)
+{
+    static char msg[200];
+    PyHash_FuncDef **def;
+    char *env;
+
+    env = Py_GETENV("PYTHONHASHALGORITHM");
+    if (env == NULL || *env == '\0')
+        return;
+    for (def = hash_funcs; *def != NULL; def++) {
+        if (strcmp((*def)->name, env) == 0) {
+            hash_func = *def;
+            return;
+        }
+    }
+    strcpy(msg, "PYTHONHASHALGORITHM must be one of:");
+    for (def = hash_funcs; *def != NULL; def++) {
+        strcat(msg, def == hash_funcs ? " " : ", ");
+        strcat(msg, (*def)->name);
+    }
+    Py_FatalError(msg);
+}
+
 PyHash_FuncDef *
 PyHash_GetFuncDef(void)
 {
-    return &PyHash_Func;
+    return hash_func;
 }
 
 /* Optimized memcpy() for Windows */
@@ -234,7 +294,6 @@ PyHash_GetFuncDef(void)
 #endif /* _MSC_VER */
 
 
-#if Py_HASH_ALGORITHM == Py_HASH_FNV
 /* **************************************************************************
  * Modified Fowler-Noll-Vo (FNV) hash function
  */
@@ -272,19 +331,17 @@ fnv(const void *src, Py_ssize_t len)
         x = (_PyHASH_MULTIPLIER * x) ^ (Py_uhash_t) *p++;
     x ^= (Py_uhash_t) len;
     x ^= (Py_uhash_t) _Py_HashSecret.fnv.suffix;
-    if (x == -1) {
-        x = -2;
+    if (x == (Py_uhash_t) -1) {
+        x = (Py_uhash_t) -2;
     }
     return x;
 }
 
-static PyHash_FuncDef PyHash_Func = {fnv, "fnv", 8 * SIZEOF_PY_HASH_T,
-                                     16 * SIZEOF_PY_HASH_T};
+static PyHash_FuncDef fnv_def = {fnv, "fnv", 8 * SIZEOF_PY_HASH_T,
+                                 16 * SIZEOF_PY_HASH_T};
 
-#endif /* Py_HASH_ALGORITHM == Py_HASH_FNV */
 
-
-#if Py_HASH_ALGORITHM == Py_HASH_SIPHASH24
+#ifdef Py_HASH_HAVE_SIPHASH
 /* **************************************************************************
  <MIT License>
  Copyright (c) 2013  Marek Majkowski <marek@popcount.org>
@@ -321,6 +378,10 @@ static PyHash_FuncDef PyHash_Func = {fnv, "fnv", 8 * SIZEOF_PY_HASH_T,
     - PY_UINT64_T, PY_UINT32_T and PY_UINT8_T
     - _rotl64() on Windows
     - letoh64() fallback
+    - SipHash-1-3 (one compression round per block and three finalization
+      rounds instead of two and four, as recommended by Jean-Philippe
+      Aumasson for hash tables), which is about twice as fast on long
+      inputs
 */
 
 typedef unsigned char PY_UINT8_T;
@@ -360,15 +421,14 @@ typedef unsigned char PY_UINT8_T;
     d = ROTATE(d, t) ^ c;           \
     a = ROTATE(a, 32);
 
-#define DOUBLE_ROUND(v0,v1,v2,v3)       \
-    HALF_ROUND(v0,v1,v2,v3,13,16);      \
-    HALF_ROUND(v2,v1,v0,v3,17,21);      \
+#define SINGLE_ROUND(v0,v1,v2,v3)       \
     HALF_ROUND(v0,v1,v2,v3,13,16);      \
     HALF_ROUND(v2,v1,v0,v3,17,21);
 
-
-static Py_hash_t
-siphash24(const void *src, Py_ssize_t src_sz) {
+/* SipHash-c-d: c_rounds and d_rounds are constants once inlined, so the
+   loops on the rounds are unrolled. */
+Py_LOCAL_INLINE(PY_UINT64_T)
+siphash(const void *src, Py_ssize_t src_sz, int c_rounds, int d_rounds) {
     PY_UINT64_T k0 = _le64toh(_Py_HashSecret.siphash.k0);
     PY_UINT64_T k1 = _le64toh(_Py_HashSecret.siphash.k1);
     PY_UINT64_T b = (PY_UINT64_T)src_sz << 56;
@@ -382,13 +442,16 @@ siphash24(const void *src, Py_ssize_t src_sz) {
     PY_UINT64_T t;
     PY_UINT8_T *pt;
     PY_UINT8_T *m;
+    int i;
 
     while (src_sz >= 8) {
         PY_UINT64_T mi = _le64toh(*in);
         in += 1;
         src_sz -= 8;
         v3 ^= mi;
-        DOUBLE_ROUND(v0,v1,v2,v3);
+        for (i = 0; i < c_rounds; i++) {
+            SINGLE_ROUND(v0,v1,v2,v3);
+        }
         v0 ^= mi;
     }
 
@@ -407,20 +470,34 @@ siphash24(const void *src, Py_ssize_t src_sz) {
     b |= _le64toh(t);
 
     v3 ^= b;
-    DOUBLE_ROUND(v0,v1,v2,v3);
+    for (i = 0; i < c_rounds; i++) {
+        SINGLE_ROUND(v0,v1,v2,v3);
+    }
     v0 ^= b;
     v2 ^= 0xff;
-    DOUBLE_ROUND(v0,v1,v2,v3);
-    DOUBLE_ROUND(v0,v1,v2,v3);
+    for (i = 0; i < d_rounds; i++) {
+        SINGLE_ROUND(v0,v1,v2,v3);
+    }
 
     /* modified */
     t = (v0 ^ v1) ^ (v2 ^ v3);
-    return (Py_hash_t)t;
+    return t;
+}
+
+static Py_hash_t
+siphash24(const void *src, Py_ssize_t src_sz) {
+    return (Py_hash_t)siphash(src, src_sz, 2, 4);
+}
+
+static Py_hash_t
+siphash13(const void *src, Py_ssize_t src_sz) {
+    return (Py_hash_t)siphash(src, src_sz, 1, 3);
 }
 
-static PyHash_FuncDef PyHash_Func = {siphash24, "siphash24", 64, 128};
+static PyHash_FuncDef siphash24_def = {siphash24, "siphash24", 64, 128};
+static PyHash_FuncDef siphash13_def = {siphash13, "siphash13", 64, 128};
 
-#endif /* Py_HASH_ALGORITHM == Py_HASH_SIPHASH24 */
+#endif /* Py_HASH_HAVE_SIPHASH */
 
 #ifdef __cplusplus
 }
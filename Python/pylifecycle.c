@@ -14,6 +14,7 @@
 #include "ast.h"
 #include "marshal.h"
 #include "osdefs.h"
+#include "pycpu.h"
 #include <locale.h>
 
 #ifdef HAVE_SIGNAL_H
@@ -316,6 +317,7 @@ _Py_InitializeEx_Private(int install_sigs, int install_importlib)
         Py_HashRandomizationFlag = add_flag(Py_HashRandomizationFlag, p);
 
     _PyRandom_Init();
+    _PyCpu_Init();
 
     interp = PyInterpreterState_New();
     if (interp == NULL)
@@ -410,6 +410,9 @@ _PyRandom_Init(void)
         return;
     _Py_HashSecret_Initialized = 1;
 
+    /* Select the hash function before anything is hashed */
+    _PyHash_Init();
+
     /*
       Hash randomization is enabled.  Generate a per-process secret,
       using PYTHONHASHSEED if provided.
@@ -336,6 +336,21 @@ table of interned strings whose purpose is to speed up dictionary lookups.\n\
 Return the string itself or the previously interned string object with the\n\
 same value.");
 
+static PyObject *
+sys_dedup_strings(PyObject *self, PyObject *noargs)
+{
+    return _PyUnicode_DedupStrings();
+}
+
+PyDoc_STRVAR(dedup_strings_doc,
+"dedup_strings() -> dict\n\
+\n\
+Replace the strings held by the constants and names of code objects with\n\
+the interned or first seen string of the same value, so that equal strings\n\
+share a single object.  Return a dict with the number of string references visited\n\
+('strings') and replaced ('merged'), the number of strings freed as a\n\
+result ('freed') and their size in bytes ('reclaimed').");
+
 
 /*
  * Cached interned string objects used for calling the profile and
@@ -1187,12 +1202,13 @@ static PyObject *
 sys_clear_type_cache(PyObject* self, PyObject* args)
 {
     PyType_ClearCache();
+    _PyUnicode_ClearFormatCache();
     Py_RETURN_NONE;
 }
 
 PyDoc_STRVAR(sys_clear_type_cache__doc__,
 "_clear_type_cache() -> None\n\
-Clear the internal type lookup cache.");
+Clear the internal type lookup cache and format string cache.");
 
 static PyObject *
 sys_is_finalizing(PyObject* self, PyObject* args)
@@ -1213,6 +1229,7 @@ static PyMethodDef sys_methods[] = {
      sys_clear_type_cache__doc__},
     {"_current_frames", sys_current_frames, METH_NOARGS,
      current_frames_doc},
+    {"dedup_strings",   sys_dedup_strings, METH_NOARGS, dedup_strings_doc},
     {"displayhook",     sys_displayhook, METH_O, displayhook_doc},
     {"exc_info",        sys_exc_info, METH_NOARGS, exc_info_doc},
     {"excepthook",      sys_excepthook, METH_VARARGS, excepthook_doc},
@@ -564,7 +564,7 @@ dump_ascii(int fd, PyObject *text)
             return;
     }
     else {
-        wstr = ((PyASCIIObject *)text)->wstr;
+        wstr = ((PyCompactUnicodeObject *)text)->wstr;
         if (wstr == NULL)
             return;
         size = ((PyCompactUnicodeObject *)text)->wstr_length;
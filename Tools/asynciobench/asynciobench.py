@@ -0,0 +1,272 @@
+"""Benchmark the asyncio event loop, futures and tasks.
+
+The benchmarks run a server and clients in one event loop, connected by
+socket pairs so that no network is involved:
+
+- echo: each client task writes a message with a StreamWriter and reads
+  it back from the server task with StreamReader.readexactly();
+- rpc: each client sends pipelined length-prefixed requests over a
+  Protocol and waits for the Future of each reply, like an RPC client
+  multiplexing many calls over one connection;
+- tasks: tasks which await futures resolved by call_soon() callbacks,
+  without any I/O, which measures the loop machinery alone.
+
+Each benchmark prints the best time and the number of requests (or
+awaits) per second.  Use --no-accel to disable the _asyncio accelerator
+module and compare with the pure Python implementation.
+"""
+
+import socket
+import struct
+import sys
+import time
+from optparse import OptionParser
+
+
+def echo(asyncio, loop, options):
+    """echo over StreamReader/StreamWriter"""
+    message = b"x" * options.size
+
+    @asyncio.coroutine
+    def serve(reader, writer):
+        while True:
+            data = yield from reader.read(65536)
+            if not data:
+                break
+            writer.write(data)
+        writer.close()
+
+    @asyncio.coroutine
+    def client(reader, writer, count):
+        for i in range(count):
+            writer.write(message)
+            yield from reader.readexactly(len(message))
+        writer.close()
+
+    @asyncio.coroutine
+    def run():
+        clients = []
+        for i in range(options.connections):
+            a, b = socket.socketpair()
+            reader, writer = yield from asyncio.open_connection(
+                sock=a, loop=loop)
+            server_reader, server_writer = yield from asyncio.open_connection(
+                sock=b, loop=loop)
+            clients.append(client(reader, writer, options.requests))
+            loop.create_task(serve(server_reader, server_writer))
+        t = time.perf_counter()
+        yield from asyncio.gather(*clients, loop=loop)
+        return time.perf_counter() - t
+
+    return loop.run_until_complete(run())
+
+
+HEADER = struct.Struct("!II")
+
+
+class RPCServerProtocol:
+
+    def connection_made(self, transport):
+        self.transport = transport
+        self.buffer = bytearray()
+
+    def data_received(self, data):
+        buffer = self.buffer
+        buffer += data
+        pos = 0
+        replies = []
+        while len(buffer) - pos >= HEADER.size:
+            request_id, length = HEADER.unpack_from(buffer, pos)
+            end = pos + HEADER.size + length
+            if len(buffer) < end:
+                break
+            replies.append(buffer[pos:end])
+            pos = end
+        del buffer[:pos]
+        if replies:
+            self.transport.write(b"".join(replies))
+
+    def eof_received(self):
+        pass
+
+    def connection_lost(self, exc):
+        pass
+
+
+class RPCClientProtocol:
+
+    def __init__(self, loop):
+        self.loop = loop
+        self.buffer = bytearray()
+        self.waiters = {}
+        self.next_id = 0
+
+    def connection_made(self, transport):
+        self.transport = transport
+
+    def call(self, payload):
+        request_id = self.next_id
+        self.next_id += 1
+        waiter = self.loop.create_future()
+        self.waiters[request_id] = waiter
+        self.transport.write(HEADER.pack(request_id, len(payload)) + payload)
+        return waiter
+
+    def data_received(self, data):
+        buffer = self.buffer
+        buffer += data
+        pos = 0
+        while len(buffer) - pos >= HEADER.size:
+            request_id, length = HEADER.unpack_from(buffer, pos)
+            end = pos + HEADER.size + length
+            if len(buffer) < end:
+                break
+            self.waiters.pop(request_id).set_result(
+                bytes(buffer[pos + HEADER.size:end]))
+            pos = end
+        del buffer[:pos]
+
+    def eof_received(self):
+        pass
+
+    def connection_lost(self, exc):
+        pass
+
+
+def rpc(asyncio, loop, options):
+    """pipelined RPC over a Protocol"""
+    payload = b"x" * options.size
+
+    @asyncio.coroutine
+    def caller(protocol, count):
+        for i in range(count):
+            result = yield from protocol.call(payload)
+            assert len(result) == len(payload)
+
+    @asyncio.coroutine
+    def run():
+        callers = []
+        transports = []
+        for i in range(options.connections):
+            a, b = socket.socketpair()
+            transport, protocol = yield from loop.create_connection(
+                lambda: RPCClientProtocol(loop), sock=a)
+            transports.append(transport)
+            transport, server = yield from loop.create_connection(
+                RPCServerProtocol, sock=b)
+            transports.append(transport)
+            # Several callers share each connection
+            for j in range(options.pipeline):
+                callers.append(caller(protocol,
+                                      options.requests // options.pipeline))
+        t = time.perf_counter()
+        yield from asyncio.gather(*callers, loop=loop)
+        dt = time.perf_counter() - t
+        for transport in transports:
+            transport.close()
+        return dt
+
+    return loop.run_until_complete(run())
+
+
+def tasks(asyncio, loop, options):
+    """tasks awaiting futures"""
+
+    @asyncio.coroutine
+    def worker(count):
+        for i in range(count):
+            fut = loop.create_future()
+            loop.call_soon(fut.set_result, i)
+            yield from fut
+
+    @asyncio.coroutine
+    def run():
+        t = time.perf_counter()
+        yield from asyncio.gather(*[worker(options.requests)
+                                    for i in range(options.connections)],
+                                  loop=loop)
+        return time.perf_counter() - t
+
+    return loop.run_until_complete(run())
+
+
+BENCHMARKS = [echo, rpc, tasks]
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [benchmark ...]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-c", "--connections",
+                      action="store", type="int", dest="connections",
+                      default=100,
+                      help="number of connections (or tasks) "
+                           "(default: %default)")
+    parser.add_option("-n", "--requests",
+                      action="store", type="int", dest="requests",
+                      default=1000,
+                      help="number of requests per connection "
+                           "(default: %default)")
+    parser.add_option("-p", "--pipeline",
+                      action="store", type="int", dest="pipeline",
+                      default=10,
+                      help="number of concurrent RPC callers per connection "
+                           "(default: %default)")
+    parser.add_option("-s", "--size",
+                      action="store", type="int", dest="size", default=100,
+                      help="size of the messages in bytes "
+                           "(default: %default)")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=3,
+                      help="number of repetitions (default: %default)")
+    parser.add_option("--no-accel",
+                      action="store_true", dest="no_accel", default=False,
+                      help="use the pure Python implementation of asyncio")
+    parser.add_option("-l", "--list",
+                      action="store_true", dest="list", default=False,
+                      help="list the available benchmarks")
+    options, args = parser.parse_args()
+
+    benchmarks = BENCHMARKS
+    if options.list:
+        for bench in benchmarks:
+            print("%-10s %s" % (bench.__name__, bench.__doc__))
+        return
+    if args:
+        names = {bench.__name__: bench for bench in benchmarks}
+        try:
+            benchmarks = [names[name] for name in args]
+        except KeyError as e:
+            parser.error("unknown benchmark %s" % e)
+    if options.pipeline < 1 or options.requests < options.pipeline:
+        parser.error("--pipeline must be between 1 and --requests")
+
+    if options.no_accel:
+        # Make "import _asyncio" fail
+        sys.modules["_asyncio"] = None
+    import asyncio
+    from asyncio import futures
+
+    accel = "C" if futures.Future is not futures._PyFuture else "Python"
+    print("Python %s, %s Future and Task" % (sys.version.split()[0], accel))
+    print("%d connections, %d requests per connection, %d-byte messages"
+          % (options.connections, options.requests, options.size))
+    print("%-35s %12s %14s" % ("benchmark", "best (ms)", "requests/s"))
+    for bench in benchmarks:
+        best = None
+        for i in range(options.repeat):
+            loop = asyncio.new_event_loop()
+            try:
+                dt = bench(asyncio, loop, options)
+            finally:
+                loop.close()
+            if best is None or dt < best:
+                best = dt
+        count = options.connections * options.requests
+        if bench is rpc:
+            count -= count % options.pipeline
+        print("%-35s %12.2f %14.0f"
+              % (bench.__doc__, best * 1e3, count / best))
+
+
+if __name__ == "__main__":
+    main()
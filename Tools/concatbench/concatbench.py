@@ -0,0 +1,177 @@
+"""Benchmark building strings with repeated concatenation.
+
+Each benchmark appends the same pieces, one at a time, to a string held
+in a different kind of place: a local variable, an attribute, a list item,
+a dict value, a variable of an enclosing function, a global variable.
+Only a local variable used to be resized in place, so the other patterns
+took quadratic time; the time per appended character shows how the cost
+grows with the final length of the string.  ''.join() and io.StringIO are
+measured too, for reference.
+"""
+
+import io
+import sys
+import time
+from optparse import OptionParser
+
+
+DEFAULT_SIZES = "1000,10000,100000"
+PIECE = "<td>%d</td>"
+
+
+class Namespace:
+    pass
+
+
+def local_variable(pieces):
+    """s += x (local variable)"""
+    text = ""
+    for piece in pieces:
+        text += piece
+    return text
+
+def local_binary_add(pieces):
+    """s = s + x (local variable)"""
+    text = ""
+    for piece in pieces:
+        text = text + piece
+    return text
+
+def attribute(pieces):
+    """self.s += x"""
+    ns = Namespace()
+    ns.text = ""
+    for piece in pieces:
+        ns.text += piece
+    return ns.text
+
+def list_item(pieces):
+    """lines[-1] += x"""
+    lines = [""]
+    for piece in pieces:
+        lines[-1] += piece
+    return lines[-1]
+
+def dict_value(pieces):
+    """d[k] += x"""
+    d = {"text": ""}
+    for piece in pieces:
+        d["text"] += piece
+    return d["text"]
+
+def nonlocal_variable(pieces):
+    """nonlocal s; s += x"""
+    text = ""
+    def append(piece):
+        nonlocal text
+        text += piece
+    for piece in pieces:
+        append(piece)
+    return text
+
+_text = ""
+
+def global_variable(pieces):
+    """global s; s += x"""
+    global _text
+    _text = ""
+    for piece in pieces:
+        _text += piece
+    text, _text = _text, ""
+    return text
+
+def kept_prefixes(pieces):
+    """s += x, keeping every 100th prefix"""
+    text = ""
+    prefixes = []
+    for i, piece in enumerate(pieces):
+        text += piece
+        if i % 100 == 0:
+            prefixes.append(text)
+    return text
+
+def join(pieces):
+    """''.join(list)"""
+    parts = []
+    for piece in pieces:
+        parts.append(piece)
+    return "".join(parts)
+
+def string_io(pieces):
+    """io.StringIO.write()"""
+    buffer = io.StringIO()
+    for piece in pieces:
+        buffer.write(piece)
+    return buffer.getvalue()
+
+
+BENCHMARKS = [local_variable, local_binary_add, attribute, list_item,
+              dict_value, nonlocal_variable, global_variable,
+              kept_prefixes, join, string_io]
+
+
+def run(bench, pieces, repeat):
+    expected = "".join(pieces)
+    best = None
+    for i in range(repeat):
+        t = time.perf_counter()
+        text = bench(pieces)
+        dt = time.perf_counter() - t
+        if best is None or dt < best:
+            best = dt
+    if text != expected:
+        raise AssertionError("%s built the wrong string" % bench.__name__)
+    return best, len(text)
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [benchmark ...]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-s", "--sizes",
+                      action="store", dest="sizes", default=DEFAULT_SIZES,
+                      help="numbers of appended pieces, separated by commas "
+                           "(default: %default)")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=3,
+                      help="number of repetitions (default: %default)")
+    parser.add_option("-w", "--wide",
+                      action="store_true", dest="wide", default=False,
+                      help="append non-Latin-1 characters")
+    parser.add_option("-l", "--list",
+                      action="store_true", dest="list", default=False,
+                      help="list the available benchmarks")
+    options, args = parser.parse_args()
+
+    benchmarks = BENCHMARKS
+    if options.list:
+        for bench in benchmarks:
+            print("%-20s %s" % (bench.__name__, bench.__doc__))
+        return
+    if args:
+        names = {bench.__name__: bench for bench in benchmarks}
+        try:
+            benchmarks = [names[name] for name in args]
+        except KeyError as e:
+            parser.error("unknown benchmark %s" % e)
+    try:
+        sizes = [int(n) for n in options.sizes.split(",")]
+    except ValueError:
+        parser.error("invalid --sizes value %r" % options.sizes)
+
+    piece = PIECE
+    if options.wide:
+        piece = "€" + piece
+    print("Python %s" % sys.version.split()[0])
+    print("%-40s %8s %10s %12s %10s"
+          % ("benchmark", "pieces", "length", "total (ms)", "ns/char"))
+    for size in sizes:
+        pieces = [piece % i for i in range(size)]
+        for bench in benchmarks:
+            best, length = run(bench, pieces, options.repeat)
+            print("%-40s %8d %10d %12.2f %10.2f"
+                  % (bench.__doc__, size, length, best * 1e3,
+                     best * 1e9 / length))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,143 @@
+"""Benchmark the cyclic garbage collector.
+
+Each benchmark builds a large, long-lived object graph shaped like a
+typical application heap, then times full (generation 2) collections over
+it.  The number of objects the collector still has to traverse is taken
+from gc.get_stats(), so the effect of untracking atomic containers shows
+up next to the pause times.
+"""
+
+import gc
+import sys
+import time
+from optparse import OptionParser
+
+
+class Record:
+    def __init__(self, i):
+        self.id = i
+        self.name = "record-%d" % i
+        self.score = i * 0.5
+        self.flags = (i & 1, i & 2)
+
+
+class Node:
+    def __init__(self, parent):
+        self.parent = parent
+        self.children = []
+        if parent is not None:
+            parent.children.append(self)
+
+
+def int_lists(n):
+    """lists of ints"""
+    return [list(range(i % 10)) for i in range(n)]
+
+def str_lists(n):
+    """lists of strs"""
+    return [[str(i), str(i + 1)] for i in range(n)]
+
+def int_tuples(n):
+    """tuples of ints"""
+    return [tuple(range(i % 10)) for i in range(n)]
+
+def zipped_tuples(n):
+    """zip() tuples"""
+    return list(zip(range(n), map(str, range(n))))
+
+def str_frozensets(n):
+    """frozensets of strs"""
+    return [frozenset((str(i), str(i + 1))) for i in range(n)]
+
+def scalar_instances(n):
+    """instances with scalar attributes"""
+    return [Record(i) for i in range(n)]
+
+def trees(n):
+    """trees with parent links (cyclic)"""
+    root = Node(None)
+    nodes = [root]
+    for i in range(1, n):
+        nodes.append(Node(nodes[(i - 1) // 8]))
+    return root
+
+
+BENCHMARKS = [int_lists, str_lists, int_tuples, zipped_tuples,
+              str_frozensets, scalar_instances, trees]
+
+
+def tracked_objects():
+    return sum(st["tracked"] for st in gc.get_stats())
+
+
+def run(bench, size, repeat):
+    gc.collect()
+    baseline = tracked_objects()
+    heap = bench(size)
+    # Let the collector see the graph once, as a long-running program's
+    # collector would have before it reaches the oldest generation.
+    gc.collect()
+    tracked = tracked_objects() - baseline
+    timings = []
+    for i in range(repeat):
+        t = time.perf_counter()
+        gc.collect()
+        timings.append(time.perf_counter() - t)
+    del heap
+    gc.collect()
+    return tracked, min(timings)
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [benchmark ...]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-n", "--size",
+                      action="store", type="int", dest="size",
+                      default=1000000,
+                      help="number of objects per benchmark "
+                           "(default: %default)")
+    parser.add_option("-t", "--threads",
+                      action="store", dest="threads", default="1",
+                      help="numbers of threads for gc.set_threads(), "
+                           "separated by commas (default: %default)")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=5,
+                      help="number of timed collections (default: %default)")
+    parser.add_option("-l", "--list",
+                      action="store_true", dest="list", default=False,
+                      help="list the available benchmarks")
+    options, args = parser.parse_args()
+
+    benchmarks = BENCHMARKS
+    if options.list:
+        for bench in benchmarks:
+            print("%-20s %s" % (bench.__name__, bench.__doc__))
+        return
+    if args:
+        names = {bench.__name__: bench for bench in benchmarks}
+        try:
+            benchmarks = [names[name] for name in args]
+        except KeyError as e:
+            parser.error("unknown benchmark %s" % e)
+
+    try:
+        threads = [int(n) for n in options.threads.split(",")]
+    except ValueError:
+        parser.error("invalid --threads value %r" % options.threads)
+    if threads != [1] and not hasattr(gc, "set_threads"):
+        parser.error("this Python doesn't support parallel collections")
+
+    print("Python %s" % sys.version.split()[0])
+    print("%-36s %8s %12s %12s"
+          % ("benchmark", "threads", "tracked", "gen2 (ms)"))
+    for bench in benchmarks:
+        for n in threads:
+            if hasattr(gc, "set_threads"):
+                gc.set_threads(n)
+            tracked, best = run(bench, options.size, options.repeat)
+            print("%-36s %8d %12d %12.2f"
+                  % (bench.__doc__, n, tracked, best * 1e3))
+
+
+if __name__ == "__main__":
+    main()
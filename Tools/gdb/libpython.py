@@ -1137,7 +1137,7 @@ class PyUnicodeObjectPtr(PyObjectPtr):
                 # string is not ready
                 field_length = long(compact['wstr_length'])
                 may_have_surrogates = True
-                field_str = ascii['wstr']
+                field_str = compact['wstr']
             else:
                 field_length = long(ascii['length'])
                 if is_compact_ascii:
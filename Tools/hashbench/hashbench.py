@@ -0,0 +1,182 @@
+"""Benchmark hash table lookups and string hashing.
+
+Measures membership tests on sets and dicts of int and str keys, for
+tables from a handful of entries up to several million.  Lookups are
+driven from C (map() over the __contains__ method), so the timings mostly
+reflect the cost of probing the table and comparing keys.
+
+With --hash, measures instead the throughput of the hash function of str,
+bytes and memoryview on keys of various lengths.  Each key is a new bytes
+object, so its hash isn't cached yet (ASCII and Latin-1 str hash the same
+bytes).  With --algorithms, the benchmark is run again in a subprocess for
+each hash algorithm, selected with the PYTHONHASHALGORITHM environment
+variable.
+"""
+
+import collections
+import os
+import random
+import subprocess
+import sys
+import time
+from optparse import OptionParser
+
+
+DEFAULT_SIZES = "8,64,1000,100000,1000000"
+DEFAULT_LENGTHS = "1,8,16,32,64,256,1024,4096,65536"
+
+
+def int_keys(n, seed):
+    rnd = random.Random(seed)
+    return rnd.sample(range(n * 8), 2 * n)
+
+def str_keys(n, seed):
+    return ["key:%x" % k for k in int_keys(n, seed)]
+
+def colliding_int_keys(n, seed):
+    # Multiples of the table size all land on the same initial slot, so
+    # lookups go through the linear probes and the perturbed probes.
+    return [k << 20 for k in int_keys(n, seed)]
+
+KEY_KINDS = [("int", int_keys), ("str", str_keys),
+             ("int (colliding)", colliding_int_keys)]
+
+
+def contains(table, probes):
+    return sum(map(table.__contains__, probes))
+
+
+def bench_lookup(table, probes, min_lookups, repeat):
+    loops = max(1, min_lookups // len(probes))
+    best = None
+    for i in range(repeat):
+        t = time.perf_counter()
+        for j in range(loops):
+            contains(table, probes)
+        dt = (time.perf_counter() - t) / (loops * len(probes))
+        if best is None or dt < best:
+            best = dt
+    return best
+
+
+def key_count(length, total):
+    return min(max(total // length, 100), 10**6)
+
+def hash_keys(length, total, seed):
+    # Overlapping slices of a random buffer: distinct new objects
+    count = key_count(length, total)
+    size = length + count
+    buf = random.Random(seed).getrandbits(8 * size).to_bytes(size, "little")
+    return [buf[i:i + length] for i in range(count)]
+
+
+def bench_hash(length, total, repeat):
+    best = None
+    for i in range(repeat):
+        keys = hash_keys(length, total, i)
+        t = time.perf_counter()
+        collections.deque(map(hash, keys), maxlen=0)
+        dt = (time.perf_counter() - t) / len(keys)
+        if best is None or dt < best:
+            best = dt
+    return best
+
+
+def parse_list(parser, option, value):
+    try:
+        return [int(n) for n in value.split(",")]
+    except ValueError:
+        parser.error("invalid %s value %r" % (option, value))
+
+
+def run_algorithms(options):
+    for algorithm in options.algorithms.split(","):
+        args = [sys.executable, __file__,
+                "--sizes", options.sizes, "--lengths", options.lengths,
+                "--total", str(options.total),
+                "--repeat", str(options.repeat),
+                "--lookups", str(options.lookups)]
+        if options.hash:
+            args.append("--hash")
+        env = dict(os.environ, PYTHONHASHALGORITHM=algorithm)
+        sys.stdout.flush()
+        if subprocess.call(args, env=env):
+            sys.exit(1)
+        print()
+
+
+def main_hash(options, parser):
+    lengths = parse_list(parser, "--lengths", options.lengths)
+    print("%-8s %10s %12s %8s" % ("length", "keys", "hash (ns)", "GB/s"))
+    for length in lengths:
+        keys = key_count(length, options.total)
+        best = bench_hash(length, options.total, options.repeat)
+        print("%-8d %10d %12.1f %8.2f"
+              % (length, keys, best * 1e9, length / best / 1e9))
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-s", "--sizes",
+                      action="store", dest="sizes", default=DEFAULT_SIZES,
+                      help="table sizes, separated by commas "
+                           "(default: %default)")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=3,
+                      help="number of repetitions (default: %default)")
+    parser.add_option("-n", "--lookups",
+                      action="store", type="int", dest="lookups",
+                      default=2000000,
+                      help="minimum number of lookups per measurement "
+                           "(default: %default)")
+    parser.add_option("-H", "--hash",
+                      action="store_true", dest="hash", default=False,
+                      help="measure the hash function throughput instead "
+                           "of lookups")
+    parser.add_option("-l", "--lengths",
+                      action="store", dest="lengths", default=DEFAULT_LENGTHS,
+                      help="key lengths for --hash, separated by commas "
+                           "(default: %default)")
+    parser.add_option("-t", "--total",
+                      action="store", type="int", dest="total",
+                      default=16 * 2**20,
+                      help="bytes hashed per measurement with --hash "
+                           "(default: %default)")
+    parser.add_option("-a", "--algorithms",
+                      action="store", dest="algorithms", default=None,
+                      help="run for each of these hash algorithms, "
+                           "separated by commas (e.g. siphash24,siphash13)")
+    options, args = parser.parse_args()
+    if args:
+        parser.error("unexpected arguments")
+    if options.algorithms:
+        run_algorithms(options)
+        return
+
+    print("Python %s, %s hash" % (sys.version.split()[0],
+                                  sys.hash_info.algorithm))
+    if options.hash:
+        main_hash(options, parser)
+        return
+
+    sizes = parse_list(parser, "--sizes", options.sizes)
+    print("%-6s %-16s %10s %10s %10s" % ("type", "keys", "size",
+                                          "hit (ns)", "miss (ns)"))
+    for size in sizes:
+        for kind, make_keys in KEY_KINDS:
+            keys = make_keys(size, size)
+            present, absent = keys[:size], keys[size:]
+            for name, table in (("set", set(present)),
+                                ("dict", dict.fromkeys(present))):
+                hit = bench_lookup(table, present, options.lookups,
+                                   options.repeat)
+                miss = bench_lookup(table, absent, options.lookups,
+                                    options.repeat)
+                print("%-6s %-16s %10d %10.1f %10.1f"
+                      % (name, kind, size, hit * 1e9, miss * 1e9))
+                del table
+
+
+if __name__ == "__main__":
+    main()
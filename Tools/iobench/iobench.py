@@ -13,6 +13,8 @@ out = sys.stdout
 
 TEXT_ENCODING = 'utf8'
 NEWLINES = 'lf'
+# Extra open() arguments of the read tests
+READ_KWARGS = {}
 
 # Compatibility
 try:
@@ -20,9 +22,9 @@ try:
 except NameError:
     xrange = range
 
-def text_open(fn, mode, encoding=None):
+def text_open(fn, mode, encoding=None, **kwargs):
     try:
-        return open(fn, mode, encoding=encoding or TEXT_ENCODING)
+        return open(fn, mode, encoding=encoding or TEXT_ENCODING, **kwargs)
     except TypeError:
         if 'r' in mode:
             mode += 'U' # 'U' mode is needed only in Python 2.x
@@ -96,6 +98,13 @@ def read_lines(f):
     for line in f:
         pass
 
+@with_open_mode("r")
+@with_sizes("medium")
+def read_all_lines(f):
+    """ read all lines at once (readlines) """
+    f.seek(0)
+    f.readlines()
+
 @with_open_mode("r")
 @with_sizes("medium")
 def seek_forward_bytewise(f):
@@ -225,7 +234,8 @@ def read_modify_blockwise(f, source):
 
 
 read_tests = [
-    read_bytewise, read_small_chunks, read_lines, read_big_chunks,
+    read_bytewise, read_small_chunks, read_lines, read_all_lines,
+    read_big_chunks,
     None, read_whole_file, None,
     seek_forward_bytewise, seek_forward_blockwise,
     read_seek_bytewise, read_seek_blockwise,
@@ -324,16 +334,23 @@ def run_all_tests(options):
         print("Binary unit = one byte")
     if "t" in options:
         print("Text unit = one character (%s-decoded)" % TEXT_ENCODING)
+    if READ_KWARGS.get("mmap"):
+        print("Input files are memory-mapped")
+    if READ_KWARGS.get("readahead"):
+        print("Input files are read ahead by %d buffers"
+              % READ_KWARGS["readahead"])
 
     # Binary reads
     if "b" in options and "r" in options:
         print("\n** Binary input **\n")
-        run_test_family(read_tests, "t", binary_files, lambda fn: open(fn, "rb"))
+        run_test_family(read_tests, "t", binary_files,
+            lambda fn: open(fn, "rb", **READ_KWARGS))
 
     # Text reads
     if "t" in options and "r" in options:
         print("\n** Text input **\n")
-        run_test_family(read_tests, "b", text_files, lambda fn: text_open(fn, "r"))
+        run_test_family(read_tests, "b", text_files,
+            lambda fn: text_open(fn, "r", **READ_KWARGS))
 
     # Binary writes
     if "b" in options and "w" in options:
@@ -438,6 +455,14 @@ def main():
                       action="store", dest="newlines", default='lf',
                       help="line endings for text tests "
                            "(one of: {lf (default), cr, crlf, all})")
+    parser.add_option("-M", "--mmap",
+                      action="store_true", dest="mmap", default=False,
+                      help="memory-map the files of the read tests "
+                           "(open() with mmap=True)")
+    parser.add_option("-R", "--readahead",
+                      action="store", type="int", dest="readahead", default=0,
+                      help="read ahead N buffers of the files of the read "
+                           "tests in a helper thread (open() with readahead=N)")
     parser.add_option("-m", "--io-module",
                       action="store", dest="io_module", default=None,
                       help="io module to test (default: builtin open())")
@@ -465,6 +490,13 @@ def main():
     if options.encoding:
         TEXT_ENCODING = options.encoding
 
+    if options.mmap:
+        READ_KWARGS["mmap"] = True
+    if options.readahead:
+        if options.mmap:
+            parser.error("--mmap and --readahead are mutually exclusive")
+        READ_KWARGS["readahead"] = options.readahead
+
     if options.io_module:
         globals()['open'] = __import__(options.io_module, {}, {}, ['open']).open
 
@@ -0,0 +1,180 @@
+"""Benchmark sending a file over a TCP connection on the loopback interface.
+
+A thread receives the data with recv_into() into a preallocated buffer
+and discards it.  Each benchmark prints the best time and the throughput
+in GB/s:
+
+- send: read() the file in chunks and sendall() each chunk;
+- os.sendfile: call os.sendfile() in a Python loop, waiting for the
+  socket with a selector when it has a timeout (the implementation of
+  socket.sendfile() in Python 3.5);
+- socket.sendfile: socket.sendfile(), which loops over sendfile() in C
+  when the platform supports it;
+- splice: move the data from the file to a pipe and from the pipe to the
+  socket with os.splice(), without copying it to user space.
+"""
+
+import os
+import selectors
+import socket
+import sys
+import tempfile
+import threading
+import time
+from optparse import OptionParser
+
+
+CHUNK_SIZE = 2 ** 16
+
+
+def send(sock, file, size):
+    """read() + sendall()"""
+    read = file.read
+    sendall = sock.sendall
+    while True:
+        data = read(CHUNK_SIZE)
+        if not data:
+            break
+        sendall(data)
+
+def os_sendfile(sock, file, size):
+    """os.sendfile() loop in Python"""
+    sockno = sock.fileno()
+    fileno = file.fileno()
+    timeout = sock.gettimeout()
+    selector = selectors.PollSelector()
+    selector.register(sockno, selectors.EVENT_WRITE)
+    offset = 0
+    with selector:
+        while offset < size:
+            if timeout and not selector.select(timeout):
+                raise socket.timeout('timed out')
+            try:
+                sent = os.sendfile(sockno, fileno, offset, size - offset)
+            except BlockingIOError:
+                continue
+            if sent == 0:
+                break
+            offset += sent
+
+def socket_sendfile(sock, file, size):
+    """socket.sendfile()"""
+    sock.sendfile(file)
+
+def splice(sock, file, size):
+    """os.splice() through a pipe"""
+    sockno = sock.fileno()
+    fileno = file.fileno()
+    # A socket with a timeout is non-blocking
+    selector = selectors.PollSelector()
+    selector.register(sockno, selectors.EVENT_WRITE)
+    r, w = os.pipe()
+    try:
+        offset = 0
+        while offset < size:
+            n = os.splice(fileno, w, min(size - offset, CHUNK_SIZE), offset,
+                          flags=os.SPLICE_F_MOVE | os.SPLICE_F_MORE)
+            if n == 0:
+                break
+            offset += n
+            while n:
+                try:
+                    n -= os.splice(r, sockno, n, flags=os.SPLICE_F_MOVE)
+                except BlockingIOError:
+                    selector.select()
+    finally:
+        selector.close()
+        os.close(r)
+        os.close(w)
+
+BENCHMARKS = [send, os_sendfile, socket_sendfile, splice]
+REQUIRES = {
+    os_sendfile: (os, "sendfile"),
+    splice: (os, "splice"),
+}
+
+
+def receive(conn):
+    buf = bytearray(CHUNK_SIZE * 4)
+    recv_into = conn.recv_into
+    while recv_into(buf):
+        pass
+
+
+def run(bench, filename, size, options):
+    best = None
+    with socket.socket() as listener:
+        listener.bind(("127.0.0.1", 0))
+        listener.listen()
+        for i in range(options.repeat):
+            with open(filename, "rb", buffering=0) as file, \
+                    socket.create_connection(listener.getsockname()) as sock:
+                conn, addr = listener.accept()
+                with conn:
+                    sock.settimeout(options.timeout)
+                    thread = threading.Thread(target=receive, args=(conn,))
+                    thread.start()
+                    t = time.perf_counter()
+                    bench(sock, file, size)
+                    sock.shutdown(socket.SHUT_WR)
+                    thread.join()
+                    dt = time.perf_counter() - t
+            if best is None or dt < best:
+                best = dt
+    return best
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [benchmark ...]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-s", "--size",
+                      action="store", type="int", dest="size", default=256,
+                      help="size of the file in MB (default: %default)")
+    parser.add_option("-t", "--timeout",
+                      action="store", type="float", dest="timeout",
+                      default=None,
+                      help="timeout of the sending socket in seconds "
+                           "(default: blocking socket)")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=5,
+                      help="number of repetitions (default: %default)")
+    parser.add_option("-l", "--list",
+                      action="store_true", dest="list", default=False,
+                      help="list the available benchmarks")
+    options, args = parser.parse_args()
+
+    benchmarks = list(BENCHMARKS)
+    if options.list:
+        for bench in benchmarks:
+            print("%-16s %s" % (bench.__name__, bench.__doc__))
+        return
+    if args:
+        names = {bench.__name__: bench for bench in benchmarks}
+        try:
+            benchmarks = [names[name] for name in args]
+        except KeyError as e:
+            parser.error("unknown benchmark %s" % e)
+    unavailable = [bench for bench in benchmarks
+                   if bench in REQUIRES and not hasattr(*REQUIRES[bench])]
+    for bench in unavailable:
+        print("skipping %s: not available on this platform" % bench.__name__)
+        benchmarks.remove(bench)
+
+    size = options.size * 2 ** 20
+    with tempfile.NamedTemporaryFile() as f:
+        block = os.urandom(2 ** 20)
+        for i in range(options.size):
+            f.write(block)
+        f.flush()
+
+        print("Python %s" % sys.version.split()[0])
+        print("%d MB file, socket timeout: %s" % (options.size, options.timeout))
+        print("%-40s %12s %8s" % ("benchmark", "best (ms)", "GB/s"))
+        for bench in benchmarks:
+            best = run(bench, f.name, size, options)
+            print("%-40s %12.2f %8.2f"
+                  % (bench.__doc__, best * 1e3, size / best / 1e9))
+
+
+if __name__ == "__main__":
+    main()
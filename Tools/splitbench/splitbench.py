@@ -0,0 +1,175 @@
+"""Benchmark the throughput of str.split(), str.splitlines() and str.join().
+
+Each benchmark runs on a large text made of lines of comma-separated
+fields and prints the best time and the throughput in GB/s, counted on the
+memory size of the text (so a UCS-4 string of the same length is 4 times
+bigger than an ASCII string).  The bytes benchmarks use the same text
+encoded to UTF-8.
+
+The join benchmarks rebuild the text from its lines; the widening one
+joins Latin-1 lines with a non-BMP separator, so that every line is
+converted to UCS-4 in the result.
+"""
+
+import sys
+import time
+from optparse import OptionParser
+
+
+KINDS = {
+    "ascii": "a",
+    "latin1": "\xe9",
+    "ucs2": "€",
+    "ucs4": "\U0001f600",
+}
+
+
+def make_text(size, line_length, kind):
+    field = "field"
+    line = ",".join(field for i in range(max(line_length // 6, 1)))
+    line = line[:line_length - 1] + KINDS[kind]
+    count = max(size // (line_length + 1), 1)
+    return "\n".join(line for i in range(count)) + "\n"
+
+
+def str_split_comma(text, data):
+    """str.split(',')"""
+    return text.split(",")
+
+def str_rsplit_comma(text, data):
+    """str.rsplit(',')"""
+    return text.rsplit(",")
+
+def str_split_newline(text, data):
+    """str.split('\\n')"""
+    return text.split("\n")
+
+def str_split_maxsplit(text, data):
+    """str.split(',', 1000)"""
+    return text.split(",", 1000)
+
+def str_splitlines(text, data):
+    """str.splitlines()"""
+    return text.splitlines()
+
+def str_splitlines_keepends(text, data):
+    """str.splitlines(True)"""
+    return text.splitlines(True)
+
+def str_splitlines_crlf(text, data):
+    """str.splitlines() with CRLF"""
+    return data["crlf"].splitlines()
+
+def bytes_split_comma(text, data):
+    """bytes.split(b',')"""
+    return data["bytes"].split(b",")
+
+def bytes_splitlines(text, data):
+    """bytes.splitlines()"""
+    return data["bytes"].splitlines()
+
+def str_join(text, data):
+    """'\\n'.join(lines)"""
+    return "\n".join(data["lines"])
+
+def str_join_widening(text, data):
+    """'\\U0001f600'.join(Latin-1 lines)"""
+    return "\U0001f600".join(data["latin1_lines"])
+
+
+BENCHMARKS = [str_split_comma, str_rsplit_comma, str_split_newline,
+              str_split_maxsplit, str_splitlines, str_splitlines_keepends,
+              str_splitlines_crlf, bytes_split_comma, bytes_splitlines,
+              str_join, str_join_widening]
+
+
+def memory_size(text):
+    maxchar = max(text)
+    if maxchar > "\uffff":
+        return len(text) * 4
+    elif maxchar > "\xff":
+        return len(text) * 2
+    return len(text)
+
+
+def run(bench, text, data, repeat):
+    best = None
+    for i in range(repeat):
+        t = time.perf_counter()
+        result = bench(text, data)
+        dt = time.perf_counter() - t
+        if best is None or dt < best:
+            best = dt
+        del result
+    return best
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [benchmark ...]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-s", "--size",
+                      action="store", type="int", dest="size", default=64,
+                      help="size of the text in millions of characters "
+                           "(default: %default)")
+    parser.add_option("-L", "--line-length",
+                      action="store", type="int", dest="line_length",
+                      default=80,
+                      help="length of the lines of the text "
+                           "(default: %default)")
+    parser.add_option("-k", "--kind",
+                      action="store", dest="kind", default="ascii",
+                      choices=sorted(KINDS),
+                      help="widest character of the text: %s "
+                           "(default: %%default)" % ", ".join(sorted(KINDS)))
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=3,
+                      help="number of repetitions (default: %default)")
+    parser.add_option("-l", "--list",
+                      action="store_true", dest="list", default=False,
+                      help="list the available benchmarks")
+    options, args = parser.parse_args()
+
+    benchmarks = BENCHMARKS
+    if options.list:
+        for bench in benchmarks:
+            print("%-25s %s" % (bench.__name__, bench.__doc__))
+        return
+    if args:
+        names = {bench.__name__: bench for bench in benchmarks}
+        try:
+            benchmarks = [names[name] for name in args]
+        except KeyError as e:
+            parser.error("unknown benchmark %s" % e)
+    if options.line_length < 2:
+        parser.error("--line-length must be at least 2")
+
+    text = make_text(options.size * 10**6, options.line_length, options.kind)
+    lines = text.splitlines()
+    data = {
+        "bytes": text.encode("utf-8"),
+        "crlf": text.replace("\n", "\r\n"),
+        "lines": lines,
+        "latin1_lines": [line.replace(KINDS[options.kind], "\xe9")
+                         for line in lines],
+    }
+
+    print("Python %s" % sys.version.split()[0])
+    print("%s text, %d characters, %d lines"
+          % (options.kind, len(text), len(lines)))
+    print("%-40s %12s %12s %8s"
+          % ("benchmark", "size (MB)", "best (ms)", "GB/s"))
+    text_size = memory_size(text)
+    for bench in benchmarks:
+        if bench is str_splitlines_crlf:
+            size = text_size + len(lines) * text_size // len(text)
+        elif bench.__name__.startswith("bytes"):
+            size = len(data["bytes"])
+        else:
+            size = text_size
+        best = run(bench, text, data, options.repeat)
+        print("%-40s %12.1f %12.2f %8.2f"
+              % (bench.__doc__, size / 1e6, best * 1e3, size / best / 1e9))
+
+
+if __name__ == "__main__":
+    main()
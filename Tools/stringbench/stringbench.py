@@ -219,6 +219,101 @@ def find_test_slow_match_100_characters_bis(STR):
         s1_find(s2)
 
 
+#### Long haystacks, wide characters and pathological patterns
+
+if sys.version_info >= (3,):
+    _WIDE_CHAR = chr(0x20ac)
+else:
+    _WIDE_CHAR = unichr(0x20ac)
+
+def _wide(STR, s):
+    """s with each "#" replaced by a character outside Latin-1"""
+    if STR is BYTES:
+        raise UnsupportedType
+    return STR(s).replace(STR("#"), _WIDE_CHAR)
+
+_LOG_LINE = "127.0.0.1 - - [10/Oct/2000:13:55:36] \"GET /index.html HTTP/1.0\" 200 2326\n"
+
+@bench('("A"*100000).find("B")', "no match, single character, long", 10)
+def find_long_single_character(STR):
+    s1 = STR("A" * 100000)
+    s2 = STR("B")
+    s1_find = s1.find
+    for x in _RANGE_10:
+        s1_find(s2)
+
+@bench('("#"*100000).find("B")', "no match, single wide character, long", 10)
+def find_long_single_wide_character(STR):
+    s1 = _wide(STR, "#" * 100000)
+    s2 = STR("B")
+    s1_find = s1.find
+    for x in _RANGE_10:
+        s1_find(s2)
+
+@bench('("A"*100000).count("A")', "count single character, long", 10)
+def count_long_single_character(STR):
+    s1 = STR("A" * 100000)
+    s2 = STR("A")
+    s1_count = s1.count
+    for x in _RANGE_10:
+        s1_count(s2)
+
+@bench('("ABC"*33334).find("ABD")', "no match, three characters, long", 10)
+def find_long_three_characters(STR):
+    s1 = STR("ABC" * 33334)
+    s2 = STR("ABD")
+    s1_find = s1.find
+    for x in _RANGE_10:
+        s1_find(s2)
+
+@bench('("AB#"*33334).find("AB#D")', "no match, wide characters, long", 10)
+def find_long_wide_characters(STR):
+    s1 = _wide(STR, "AB#" * 33334)
+    s2 = _wide(STR, "AB#D")
+    s1_find = s1.find
+    for x in _RANGE_10:
+        s1_find(s2)
+
+@bench('(log_line*1500).find("POST /")', "no match in a log, long", 10)
+def find_long_log(STR):
+    s1 = STR(_LOG_LINE * 1500)
+    s2 = STR("POST /")
+    s1_find = s1.find
+    for x in _RANGE_10:
+        s1_find(s2)
+
+@bench('(log_line*1500).count(" 200 ")', "count in a log, long", 10)
+def count_long_log(STR):
+    s1 = STR(_LOG_LINE * 1500)
+    s2 = STR(" 200 ")
+    s1_count = s1.count
+    for x in _RANGE_10:
+        s1_count(s2)
+
+@bench('("A"*100000).find("A"*1000+"B")', "pathological, needle tail", 10)
+def find_pathological_tail(STR):
+    s1 = STR("A" * 100000)
+    s2 = STR("A" * 1000 + "B")
+    s1_find = s1.find
+    for x in _RANGE_10:
+        s1_find(s2)
+
+@bench('("A"*100000).count("A"*50+"B"+"A"*50)',
+       "pathological, needle middle", 10)
+def count_pathological_middle(STR):
+    s1 = STR("A" * 100000)
+    s2 = STR("A" * 50 + "B" + "A" * 50)
+    s1_count = s1.count
+    for x in _RANGE_10:
+        s1_count(s2)
+
+@bench('"AB"*300+"BB" in "AB"*50000', "pathological, periodic", 10)
+def in_pathological_periodic(STR):
+    s1 = STR("AB" * 50000)
+    s2 = STR("AB" * 300 + "BB")
+    for x in _RANGE_10:
+        s2 in s1
+
 #### Same tests for 'rfind'
 
 @bench('("A"*1000).rfind("A")', "early match, single character", 1000)
@@ -1353,6 +1448,56 @@ def format_with_dict(STR):
     for x in _RANGE_1000:
         s % d
 
+@bench('"%s - %s [%s] %d %d" % ("127.0.0.1", "GET", "/index.html", 200, 512)',
+       'formatting a log line with a tuple', 1000)
+def format_log_line_with_tuple(STR):
+    s = STR("%s - %s [%s] %d %d")
+    args = (STR("127.0.0.1"), STR("GET"), STR("/index.html"), 200, 512)
+    for x in _RANGE_1000:
+        s % args
+
+@bench('"%-10s|%8.3f|%#x" % ("name", 3.14159, 255)',
+       'formatting with widths and precisions', 1000)
+def format_widths_with_tuple(STR):
+    s = STR("%-10s|%8.3f|%#x")
+    args = (STR("name"), 3.14159, 255)
+    for x in _RANGE_1000:
+        s % args
+
+def _get_str_format(STR, s):
+    if STR is BYTES:
+        raise UnsupportedType
+    return s
+
+@bench('"{} - {} [{}] {} {}".format("127.0.0.1", "GET", "/index.html", 200, 512)',
+       'str.format() of a log line', 1000)
+def str_format_log_line(STR):
+    s = _get_str_format(STR, "{} - {} [{}] {} {}")
+    for x in _RANGE_1000:
+        s.format("127.0.0.1", "GET", "/index.html", 200, 512)
+
+@bench('"{name}={value!r}".format(name="key", value="value")',
+       'str.format() with keywords', 1000)
+def str_format_keywords(STR):
+    s = _get_str_format(STR, "{name}={value!r}")
+    for x in _RANGE_1000:
+        s.format(name="key", value="value")
+
+@bench('"{:<10}|{:8.3f}|{:#x}".format("name", 3.14159, 255)',
+       'str.format() with format specs', 1000)
+def str_format_specs(STR):
+    s = _get_str_format(STR, "{:<10}|{:8.3f}|{:#x}")
+    for x in _RANGE_1000:
+        s.format("name", 3.14159, 255)
+
+@bench('"<td>{}</td>".format("x"*1000)',
+       'str.format() of a long argument', 1000)
+def str_format_long_argument(STR):
+    s = _get_str_format(STR, "<td>{}</td>")
+    arg = "x" * 1000
+    for x in _RANGE_1000:
+        s.format(arg)
+
 
 #### Upper- and lower- case conversion
 
@@ -0,0 +1,94 @@
+"""Measure the memory used by short strings in dicts and records.
+
+For each key length, builds a dict of distinct ASCII keys and a list of
+records (small dicts) whose values are short strings, as parsed from CSV
+or JSON data, and prints the memory allocated per key and per record,
+measured with tracemalloc.  The "block" column is the size of the
+memory block of one key, counting the 8-byte alignment of the small
+object allocator.
+
+Records use single character codes and small numbers formatted with
+str(), which don't need new objects when the interpreter shares them.
+"""
+
+import string
+import sys
+import tracemalloc
+from optparse import OptionParser
+
+
+ALPHABET = string.ascii_letters + string.digits
+DEFAULT_LENGTHS = "1,2,4,8,16,32"
+
+
+def make_key(i, length):
+    chars = []
+    for j in range(length):
+        i, r = divmod(i, len(ALPHABET))
+        chars.append(ALPHABET[r])
+    return "".join(chars)
+
+
+def block_size(obj):
+    return (sys.getsizeof(obj) + 7) & ~7
+
+
+def traced(build, *args):
+    tracemalloc.start()
+    try:
+        before = tracemalloc.get_traced_memory()[0]
+        result = build(*args)
+        after = tracemalloc.get_traced_memory()[0]
+    finally:
+        tracemalloc.stop()
+    return result, after - before
+
+
+def build_dict(count, length):
+    return {make_key(i, length): None for i in range(count)}
+
+
+def build_records(count, length):
+    return [{"name": make_key(i, length),
+             "code": "ABCDEF"[i % 6],
+             "level": str(i % 10),
+             "flag": "YN"[i % 2]}
+            for i in range(count)]
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-n", "--count",
+                      action="store", type="int", dest="count",
+                      default=200000,
+                      help="number of keys and records (default: %default)")
+    parser.add_option("-l", "--lengths",
+                      action="store", dest="lengths", default=DEFAULT_LENGTHS,
+                      help="key lengths, separated by commas "
+                           "(default: %default)")
+    options, args = parser.parse_args()
+    if args:
+        parser.error("unexpected arguments")
+    try:
+        lengths = [int(n) for n in options.lengths.split(",")]
+    except ValueError:
+        parser.error("invalid --lengths value %r" % options.lengths)
+
+    print("Python %s" % sys.version.split()[0])
+    print("%-8s %10s %8s %12s %14s"
+          % ("length", "keys", "block", "dict/key", "record"))
+    for length in lengths:
+        count = min(options.count, len(ALPHABET) ** length)
+        table, dict_size = traced(build_dict, count, length)
+        block = block_size(next(iter(table)))
+        del table
+        records, records_size = traced(build_records, count, length)
+        del records
+        print("%-8d %10d %8d %12.1f %14.1f"
+              % (length, count, block, dict_size / count,
+                 records_size / count))
+
+
+if __name__ == "__main__":
+    main()
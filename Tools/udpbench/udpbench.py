@@ -0,0 +1,146 @@
+"""Benchmark datagram I/O on the UDP loopback interface.
+
+Each benchmark sends datagrams in batches from one socket to another and
+receives every batch before sending the next one, so that the receive
+buffer of the socket never overflows.  It prints the best time and the
+number of datagrams per second, counting one send and one receive for
+each datagram:
+
+- sendto: sendto() and recvfrom_into() for each datagram;
+- sendmsg: sendmsg() and recvmsg_into() for each datagram;
+- mmsg: sendmmsg() and recvmmsg_into() for each batch, which returns a
+  list of (nbytes, address) pairs;
+- mmsg_sizes: sendmmsg() and recvmmsg_into() for each batch, storing the
+  sizes into an array instead of creating a list.
+"""
+
+import array
+import socket
+import sys
+import time
+from optparse import OptionParser
+
+
+def sendto(send, recv, addr, msgs, bufs):
+    """sendto() + recvfrom_into()"""
+    for msg in msgs:
+        send.sendto(msg, addr)
+    recvfrom_into = recv.recvfrom_into
+    for buf in bufs:
+        recvfrom_into(buf)
+
+def sendmsg(send, recv, addr, msgs, bufs):
+    """sendmsg() + recvmsg_into()"""
+    for msg in msgs:
+        send.sendmsg([msg], (), 0, addr)
+    recvmsg_into = recv.recvmsg_into
+    for buf in bufs:
+        recvmsg_into([buf])
+
+def mmsg(send, recv, addr, msgs, bufs):
+    """sendmmsg() + recvmmsg_into()"""
+    sent = 0
+    while sent < len(msgs):
+        sent += send.sendmmsg(msgs[sent:], 0, addr)
+    received = 0
+    while received < len(bufs):
+        received += len(recv.recvmmsg_into(bufs[received:]))
+
+def mmsg_sizes(send, recv, addr, msgs, bufs, sizes=array.array("I")):
+    """sendmmsg() + recvmmsg_into(sizes)"""
+    sent = 0
+    while sent < len(msgs):
+        sent += send.sendmmsg(msgs[sent:], 0, addr)
+    if len(sizes) < len(bufs):
+        sizes.extend([0] * (len(bufs) - len(sizes)))
+    received = recv.recvmmsg_into(bufs, 0, sizes)
+    if received < len(bufs):
+        sizes_view = memoryview(sizes)
+        while received < len(bufs):
+            received += recv.recvmmsg_into(bufs[received:], 0,
+                                           sizes_view[received:])
+
+
+BENCHMARKS = [sendto, sendmsg, mmsg, mmsg_sizes]
+REQUIRES = {
+    sendmsg: ("sendmsg", "recvmsg_into"),
+    mmsg: ("sendmmsg", "recvmmsg_into"),
+    mmsg_sizes: ("sendmmsg", "recvmmsg_into"),
+}
+
+
+def run(bench, options):
+    send = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    recv = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    with send, recv:
+        recv.bind(("127.0.0.1", 0))
+        addr = recv.getsockname()
+        msgs = [b"x" * options.size] * options.batch
+        bufs = [bytearray(options.size) for i in range(options.batch)]
+        count = options.count // options.batch
+        best = None
+        for i in range(options.repeat):
+            t = time.perf_counter()
+            for j in range(count):
+                bench(send, recv, addr, msgs, bufs)
+            dt = time.perf_counter() - t
+            if best is None or dt < best:
+                best = dt
+    return best, count * options.batch
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [benchmark ...]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-n", "--count",
+                      action="store", type="int", dest="count",
+                      default=200000,
+                      help="number of datagrams (default: %default)")
+    parser.add_option("-b", "--batch",
+                      action="store", type="int", dest="batch", default=32,
+                      help="number of datagrams per batch "
+                           "(default: %default)")
+    parser.add_option("-s", "--size",
+                      action="store", type="int", dest="size", default=100,
+                      help="size of the datagrams in bytes "
+                           "(default: %default)")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=3,
+                      help="number of repetitions (default: %default)")
+    parser.add_option("-l", "--list",
+                      action="store_true", dest="list", default=False,
+                      help="list the available benchmarks")
+    options, args = parser.parse_args()
+
+    benchmarks = list(BENCHMARKS)
+    if options.list:
+        for bench in benchmarks:
+            print("%-12s %s" % (bench.__name__, bench.__doc__))
+        return
+    if args:
+        names = {bench.__name__: bench for bench in benchmarks}
+        try:
+            benchmarks = [names[name] for name in args]
+        except KeyError as e:
+            parser.error("unknown benchmark %s" % e)
+    if options.batch < 1 or options.count < options.batch:
+        parser.error("--batch must be between 1 and --count")
+    unavailable = [bench for bench in benchmarks
+                   if not all(hasattr(socket.socket, name)
+                              for name in REQUIRES.get(bench, ()))]
+    for bench in unavailable:
+        print("skipping %s: not available on this platform" % bench.__name__)
+        benchmarks.remove(bench)
+
+    print("Python %s" % sys.version.split()[0])
+    print("%d datagrams of %d bytes, batches of %d"
+          % (options.count, options.size, options.batch))
+    print("%-40s %12s %14s" % ("benchmark", "best (ms)", "datagrams/s"))
+    for bench in benchmarks:
+        best, count = run(bench, options)
+        print("%-40s %12.2f %14.0f"
+              % (bench.__doc__, best * 1e3, count / best))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,94 @@
+"""Benchmark decoding and encoding with text codecs.
+
+Times bytes.decode() and str.encode() on samples of text in several
+scripts, so that the cost of each UTF-8 sequence length shows up: ASCII,
+Latin-1 (2 bytes for accented letters), Cyrillic (2 bytes), CJK (3 bytes)
+and emoji (4 bytes).  Throughput is given in megabytes of encoded data per
+second.
+"""
+
+import sys
+import time
+from optparse import OptionParser
+
+
+SAMPLES = [
+    ("ascii", "The quick brown fox jumps over the lazy dog. "),
+    ("latin1", "Le cœur déçu mais l'âme plutôt naïve, Louÿs rêva de crapaüter. "),
+    ("cyrillic", "Съешь же ещё этих мягких французских булок, да выпей чаю. "),
+    ("cjk", "天地玄黃宇宙洪荒日月盈昃辰宿列張寒來暑往秋收冬藏閏餘成歲律呂調陽"),
+    ("emoji", "\U0001F600\U0001F603\U0001F604 smile \U0001F601\U0001F606 "),
+]
+
+DEFAULT_CODECS = "utf-8"
+DEFAULT_SIZES = "100,10000,1000000"
+
+
+def make_text(sample, size, encoding):
+    """Repeat sample into a string whose encoding is about size bytes."""
+    unit = len(sample.encode(encoding))
+    return sample * max(1, size // unit)
+
+
+def bench(func, arg, nbytes, min_bytes, repeat):
+    loops = max(1, min_bytes // nbytes)
+    best = None
+    for i in range(repeat):
+        t = time.perf_counter()
+        for j in range(loops):
+            func(arg)
+        dt = (time.perf_counter() - t) / loops
+        if best is None or dt < best:
+            best = dt
+    return nbytes / best / 1e6
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-c", "--codecs",
+                      action="store", dest="codecs", default=DEFAULT_CODECS,
+                      help="codecs to test, separated by commas "
+                           "(default: %default)")
+    parser.add_option("-s", "--sizes",
+                      action="store", dest="sizes", default=DEFAULT_SIZES,
+                      help="approximate sizes of the encoded data in bytes, "
+                           "separated by commas (default: %default)")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=3,
+                      help="number of repetitions (default: %default)")
+    parser.add_option("-n", "--bytes",
+                      action="store", type="int", dest="min_bytes",
+                      default=20000000,
+                      help="minimum number of bytes processed per "
+                           "measurement (default: %default)")
+    options, args = parser.parse_args()
+    if args:
+        parser.error("unexpected arguments")
+    try:
+        sizes = [int(n) for n in options.sizes.split(",")]
+    except ValueError:
+        parser.error("invalid --sizes value %r" % options.sizes)
+
+    print("Python %s" % sys.version.split()[0])
+    print("%-10s %-10s %10s %14s %14s"
+          % ("codec", "text", "size", "decode (MB/s)", "encode (MB/s)"))
+    for encoding in options.codecs.split(","):
+        for name, sample in SAMPLES:
+            try:
+                sample.encode(encoding)
+            except UnicodeEncodeError:
+                continue
+            for size in sizes:
+                text = make_text(sample, size, encoding)
+                data = text.encode(encoding)
+                decode = bench(lambda b: b.decode(encoding), data, len(data),
+                               options.min_bytes, options.repeat)
+                encode = bench(lambda s: s.encode(encoding), text, len(data),
+                               options.min_bytes, options.repeat)
+                print("%-10s %-10s %10d %14.1f %14.1f"
+                      % (encoding, name, len(data), decode, encode))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,348 @@
+"""Benchmark the io_uring event loop against the selector event loop.
+
+The benchmarks run a server and clients in one event loop, connected by
+socket pairs so that no network is involved:
+
+- echo: each client writes a message and waits for the server to echo
+  it back, so that every event loop iteration handles one message per
+  connection;
+- rpc: each connection carries several pipelined requests, so that the
+  event loop iterations handle more data per connection.
+
+Each benchmark prints the best time, the number of requests per second
+and the number of system calls made by the event loop per request.  The
+system calls are counted in Python: the selector event loop makes one
+epoll_wait() per iteration plus the recv(), send() and epoll_ctl() calls
+of the transports, while the io_uring event loop only calls
+io_uring_enter() to submit its operations and reap their completions.
+"""
+
+import selectors
+import socket
+import struct
+import sys
+import time
+from optparse import OptionParser
+
+import asyncio
+from asyncio import uring_events
+
+
+HEADER = struct.Struct("!II")
+
+
+class Counter:
+    syscalls = 0
+
+
+class CountingSocket(socket.socket):
+    """Socket counting its recv() and send() calls."""
+
+    def recv(self, *args):
+        Counter.syscalls += 1
+        return super().recv(*args)
+
+    def send(self, *args):
+        Counter.syscalls += 1
+        return super().send(*args)
+
+
+class CountingSelector(selectors.DefaultSelector):
+    """Selector counting its epoll_wait() and epoll_ctl() calls."""
+
+    def select(self, timeout=None):
+        Counter.syscalls += 1
+        return super().select(timeout)
+
+    def register(self, *args):
+        Counter.syscalls += 1
+        return super().register(*args)
+
+    def unregister(self, *args):
+        Counter.syscalls += 1
+        return super().unregister(*args)
+
+    def modify(self, *args):
+        Counter.syscalls += 1
+        return super().modify(*args)
+
+
+class CountingRing:
+    """Proxy of an io_uring object counting its io_uring_enter() calls."""
+
+    def __init__(self, ring):
+        self._ring = ring
+
+    def wait(self, timeout=None):
+        Counter.syscalls += 1
+        return self._ring.wait(timeout)
+
+    def submit(self):
+        Counter.syscalls += 1
+        return self._ring.submit()
+
+    def __getattr__(self, name):
+        return getattr(self._ring, name)
+
+
+def selector_loop():
+    """selector (epoll)"""
+    return asyncio.SelectorEventLoop(CountingSelector())
+
+
+def uring_loop():
+    """io_uring"""
+    proactor = uring_events.IoUringProactor()
+    proactor._ring = CountingRing(proactor._ring)
+    return uring_events.IoUringEventLoop(proactor)
+
+
+LOOPS = {"selector": selector_loop, "io_uring": uring_loop}
+
+
+def socketpair(counting):
+    a, b = socket.socketpair()
+    if counting:
+        a = CountingSocket(a.family, a.type, a.proto, fileno=a.detach())
+        b = CountingSocket(b.family, b.type, b.proto, fileno=b.detach())
+    return a, b
+
+
+class EchoServerProtocol(asyncio.Protocol):
+
+    def connection_made(self, transport):
+        self.transport = transport
+
+    def data_received(self, data):
+        self.transport.write(data)
+
+
+class EchoClientProtocol(asyncio.Protocol):
+
+    def __init__(self, loop, message, count):
+        self.message = message
+        self.count = count
+        self.received = 0
+        self.done = loop.create_future()
+
+    def connection_made(self, transport):
+        self.transport = transport
+        transport.write(self.message)
+
+    def data_received(self, data):
+        self.received += len(data)
+        if self.received < len(self.message):
+            return
+        self.received = 0
+        self.count -= 1
+        if self.count:
+            self.transport.write(self.message)
+        else:
+            self.done.set_result(None)
+
+
+def echo(loop, counting, options):
+    """echo"""
+    message = b"x" * options.size
+
+    @asyncio.coroutine
+    def run():
+        clients = []
+        transports = []
+        for i in range(options.connections):
+            a, b = socketpair(counting)
+            transport, server = yield from loop.create_connection(
+                EchoServerProtocol, sock=b)
+            transports.append(transport)
+            transport, client = yield from loop.create_connection(
+                lambda: EchoClientProtocol(loop, message, options.requests),
+                sock=a)
+            transports.append(transport)
+            clients.append(client.done)
+        Counter.syscalls = 0
+        t = time.perf_counter()
+        yield from asyncio.gather(*clients, loop=loop)
+        dt = time.perf_counter() - t
+        syscalls = Counter.syscalls
+        for transport in transports:
+            transport.close()
+        return dt, syscalls
+
+    return loop.run_until_complete(run())
+
+
+class RPCServerProtocol(asyncio.Protocol):
+
+    def connection_made(self, transport):
+        self.transport = transport
+        self.buffer = bytearray()
+
+    def data_received(self, data):
+        buffer = self.buffer
+        buffer += data
+        pos = 0
+        while len(buffer) - pos >= HEADER.size:
+            request_id, length = HEADER.unpack_from(buffer, pos)
+            end = pos + HEADER.size + length
+            if len(buffer) < end:
+                break
+            pos = end
+        if pos:
+            self.transport.write(bytes(buffer[:pos]))
+            del buffer[:pos]
+
+
+class RPCClientProtocol(asyncio.Protocol):
+
+    def __init__(self, loop, payload, count, pipeline):
+        self.request = HEADER.pack(0, len(payload)) + payload
+        self.pending = count
+        self.unsent = count
+        self.pipeline = pipeline
+        self.buffer = bytearray()
+        self.done = loop.create_future()
+
+    def connection_made(self, transport):
+        self.transport = transport
+        self.send(self.pipeline)
+
+    def send(self, count):
+        count = min(count, self.unsent)
+        if count:
+            self.unsent -= count
+            self.transport.write(self.request * count)
+
+    def data_received(self, data):
+        buffer = self.buffer
+        buffer += data
+        replies = len(buffer) // len(self.request)
+        if not replies:
+            return
+        del buffer[:replies * len(self.request)]
+        self.pending -= replies
+        if self.pending:
+            # Keep the pipeline full
+            self.send(replies)
+        else:
+            self.done.set_result(None)
+
+
+def rpc(loop, counting, options):
+    """pipelined rpc"""
+    payload = b"x" * options.size
+
+    @asyncio.coroutine
+    def run():
+        clients = []
+        transports = []
+        for i in range(options.connections):
+            a, b = socketpair(counting)
+            transport, server = yield from loop.create_connection(
+                RPCServerProtocol, sock=b)
+            transports.append(transport)
+            transport, client = yield from loop.create_connection(
+                lambda: RPCClientProtocol(loop, payload, options.requests,
+                                          options.pipeline),
+                sock=a)
+            transports.append(transport)
+            clients.append(client.done)
+        Counter.syscalls = 0
+        t = time.perf_counter()
+        yield from asyncio.gather(*clients, loop=loop)
+        dt = time.perf_counter() - t
+        syscalls = Counter.syscalls
+        for transport in transports:
+            transport.close()
+        return dt, syscalls
+
+    return loop.run_until_complete(run())
+
+
+BENCHMARKS = [echo, rpc]
+
+
+def main():
+    usage = "usage: %prog [-h|--help] [options] [benchmark ...]"
+    parser = OptionParser(usage=usage)
+    parser.add_option("-c", "--connections",
+                      action="store", type="int", dest="connections",
+                      default=100,
+                      help="number of connections (default: %default)")
+    parser.add_option("-n", "--requests",
+                      action="store", type="int", dest="requests",
+                      default=1000,
+                      help="number of requests per connection "
+                           "(default: %default)")
+    parser.add_option("-p", "--pipeline",
+                      action="store", type="int", dest="pipeline",
+                      default=10,
+                      help="number of pipelined RPC requests per connection "
+                           "(default: %default)")
+    parser.add_option("-s", "--size",
+                      action="store", type="int", dest="size", default=100,
+                      help="size of the messages in bytes "
+                           "(default: %default)")
+    parser.add_option("-L", "--loop",
+                      action="append", dest="loops", choices=sorted(LOOPS),
+                      help="event loop to benchmark: %s (default: all)"
+                           % ", ".join(sorted(LOOPS)))
+    parser.add_option("--no-count",
+                      action="store_true", dest="no_count", default=False,
+                      help="don't count the system calls, which slows down "
+                           "the selector event loop")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=3,
+                      help="number of repetitions (default: %default)")
+    parser.add_option("-l", "--list",
+                      action="store_true", dest="list", default=False,
+                      help="list the available benchmarks")
+    options, args = parser.parse_args()
+
+    benchmarks = BENCHMARKS
+    if options.list:
+        for bench in benchmarks:
+            print("%-10s %s" % (bench.__name__, bench.__doc__))
+        return
+    if args:
+        names = {bench.__name__: bench for bench in benchmarks}
+        try:
+            benchmarks = [names[name] for name in args]
+        except KeyError as e:
+            parser.error("unknown benchmark %s" % e)
+    if options.pipeline < 1:
+        parser.error("--pipeline must be positive")
+    loops = [LOOPS[name] for name in options.loops or ("selector",
+                                                       "io_uring")]
+    if uring_loop in loops:
+        try:
+            uring_events.IoUringProactor().close()
+        except (AttributeError, OSError) as exc:
+            print("io_uring is not available: %r" % exc)
+            loops.remove(uring_loop)
+    counting = not options.no_count
+
+    print("Python %s" % sys.version.split()[0])
+    print("%d connections, %d requests per connection, %d-byte messages"
+          % (options.connections, options.requests, options.size))
+    print("%-35s %12s %14s %14s"
+          % ("benchmark", "best (ms)", "requests/s", "syscalls/req"))
+    for bench in benchmarks:
+        for make_loop in loops:
+            best = None
+            for i in range(options.repeat):
+                loop = make_loop()
+                try:
+                    dt, syscalls = bench(loop, counting, options)
+                finally:
+                    loop.close()
+                if best is None or dt < best:
+                    best = dt
+            count = options.connections * options.requests
+            label = "%s, %s" % (bench.__doc__, make_loop.__doc__)
+            print("%-35s %12.2f %14.0f %14s"
+                  % (label, best * 1e3, count / best,
+                     "%.2f" % (syscalls / count) if counting else "-"))
+
+
+if __name__ == "__main__":
+    main()